@@ -44,7 +44,8 @@ bool CommandLineExporter::process(const QString &inputPath,
                                   int height,
                                   int startFrame,
                                   int endFrame,
-                                  bool transparency)
+                                  bool transparency,
+                                  int motionBlurSamples)
 {
     LayerManager *layerManager = mEditor->layers();
 
@@ -107,7 +108,7 @@ bool CommandLineExporter::process(const QString &inputPath,
 
         if (isMovieFormat(format))
         {
-            exportMovie(outputPath, cameraLayer, exportSize, startFrame, endFrame, transparency);
+            exportMovie(outputPath, cameraLayer, exportSize, startFrame, endFrame, transparency, motionBlurSamples);
             continue;
         }
 
@@ -122,7 +123,8 @@ void CommandLineExporter::exportMovie(const QString &outputPath,
                                       const QSize &exportSize,
                                       int startFrame,
                                       int endFrame,
-                                      bool transparency)
+                                      bool transparency,
+                                      int motionBlurSamples)
 {
     if (transparency)
     {
@@ -138,6 +140,7 @@ void CommandLineExporter::exportMovie(const QString &outputPath,
     desc.fps = mEditor->playback()->fps();
     desc.exportSize = exportSize;
     desc.strCameraName = cameraLayer->name();
+    desc.motionBlurSamples = motionBlurSamples;
 
     MovieExporter ex;
     ex.run(mEditor->object(), desc, [](float, float){}, [](float){}, [](const QString &){});
@@ -50,6 +50,7 @@ public:
      * @param endFrame Last frame to include in the export(s) or -1 to use the last keyframe or -2 to use the last
      *                 keyframe including sound clips
      * @param transparency Whether to export with transparency
+     * @param motionBlurSamples Number of camera positions averaged into each frame of movies, 1 for no motion blur
      * @return `true` if the export was successful
      */
     bool process(const QString &inputPath,
@@ -59,7 +60,8 @@ public:
                  int height,
                  int startFrame,
                  int endFrame,
-                 bool transparency);
+                 bool transparency,
+                 int motionBlurSamples = 1);
 
 private:
     Editor *mEditor;
@@ -70,7 +72,8 @@ private:
                      const QSize &exportSize,
                      int startFrame,
                      int endFrame,
-                     bool transparency);
+                     bool transparency,
+                     int motionBlurSamples);
     void exportImageSequence(const QString &outputPath,
                              const QString &format,
                              const LayerCamera *cameraLayer,
@@ -71,6 +71,11 @@ CommandLineParser::CommandLineParser() : mParser(), mInputPath(), mOutputPaths()
     QCommandLineOption transparencyOption(QStringList() << "transparency",
                                           tr("Render transparency when possible"));
     mParser.addOption(transparencyOption);
+
+    QCommandLineOption motionBlurOption(QStringList() << "motion-blur",
+                                        tr("Blur the camera moves of exported movies by averaging <samples> camera positions per frame"),
+                                        tr("samples"));
+    mParser.addOption(motionBlurOption);
 }
 
 void CommandLineParser::process(QStringList arguments)
@@ -157,5 +162,16 @@ void CommandLineParser::process(QStringList arguments)
 
     mTransparency = mParser.isSet("transparency");
 
+    if (!mParser.value("motion-blur").isEmpty())
+    {
+        bool ok = false;
+        mMotionBlurSamples = mParser.value("motion-blur").toInt(&ok);
+        if (!ok || mMotionBlurSamples < 1 || mMotionBlurSamples > 256)
+        {
+            err << tr("Warning: motion blur value %1 is not an integer between 1 and 256, ignoring.").arg(mParser.value("motion-blur")) << endl;
+            mMotionBlurSamples = 1;
+        }
+    }
+
     mCamera = mParser.value("camera");
 }
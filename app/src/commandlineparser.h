@@ -37,6 +37,7 @@ public:
     int startFrame() const { return mStartFrame; }
     int endFrame() const { return mEndFrame; }
     bool transparency() const { return mTransparency; }
+    int motionBlurSamples() const { return mMotionBlurSamples; }
 
 private:
     QCommandLineParser mParser;
@@ -49,6 +50,7 @@ private:
     int mStartFrame = 1;
     int mEndFrame = -1;
     bool mTransparency = false;
+    int mMotionBlurSamples = 1;
 };
 
 #endif // COMMANDLINEPARSER_H
@@ -180,40 +180,44 @@ void ImportImageSeqDialog::importArbitrarySequence()
 
     QString failedFiles;
     bool failedImport = false;
-    for (const QString& strImgFile : files)
     {
-        QString strImgFileLower = strImgFile.toLower();
-
-        if (strImgFileLower.endsWith(".png") ||
-            strImgFileLower.endsWith(".jpg") ||
-            strImgFileLower.endsWith(".jpeg") ||
-            strImgFileLower.endsWith(".bmp") ||
-            strImgFileLower.endsWith(".tif") ||
-            strImgFileLower.endsWith(".tiff"))
+        // the timeline is extended once, before the warning
+        LayerManager::BatchUpdate batchUpdate(mEditor->layers());
+        for (const QString& strImgFile : files)
         {
-            mEditor->importImage(strImgFile);
+            QString strImgFileLower = strImgFile.toLower();
+
+            if (strImgFileLower.endsWith(".png") ||
+                strImgFileLower.endsWith(".jpg") ||
+                strImgFileLower.endsWith(".jpeg") ||
+                strImgFileLower.endsWith(".bmp") ||
+                strImgFileLower.endsWith(".tif") ||
+                strImgFileLower.endsWith(".tiff"))
+            {
+                mEditor->importImage(strImgFile);
 
-            imagesImportedSoFar++;
-            progress.setValue(imagesImportedSoFar);
-            QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);  // Required to make progress bar update
+                imagesImportedSoFar++;
+                progress.setValue(imagesImportedSoFar);
+                QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);  // Required to make progress bar update
 
-            if (progress.wasCanceled())
-            {
-                break;
+                if (progress.wasCanceled())
+                {
+                    break;
+                }
             }
-        }
-        else
-        {
-            failedFiles += strImgFile + "\n";
-            if (!failedImport)
+            else
             {
-                failedImport = true;
+                failedFiles += strImgFile + "\n";
+                if (!failedImport)
+                {
+                    failedImport = true;
+                }
             }
-        }
 
-        for (int i = 1; i < number; i++)
-        {
-            mEditor->scrubForward();
+            for (int i = 1; i < number; i++)
+            {
+                mEditor->scrubForward();
+            }
         }
     }
 
@@ -318,6 +322,7 @@ void ImportImageSeqDialog::importPredefinedSet()
 
     mEditor->layers()->createBitmapLayer(keySet.layerName());
 
+    LayerManager::BatchUpdate batchUpdate(mEditor->layers());
     for (int i = 0; i < keySet.size(); i++)
     {
         const int& frameIndex = keySet.keyFrameIndexAt(i);
@@ -335,7 +340,10 @@ void ImportImageSeqDialog::importPredefinedSet()
             break;
         }
 
-        if (!ok) { return;}
+        if (!ok)
+        {
+            return;
+        }
     }
 
     emit notifyAnimationLengthChanged();
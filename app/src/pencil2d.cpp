@@ -84,7 +84,8 @@ Status Pencil2D::handleCommandLineOptions()
                          parser.height(),
                          parser.startFrame(),
                          parser.endFrame(),
-                         parser.transparency()))
+                         parser.transparency(),
+                         parser.motionBlurSamples()))
     {
         return Status::SAFE;
     }
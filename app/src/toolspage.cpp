@@ -28,6 +28,7 @@ ToolsPage::ToolsPage() : ui(new Ui::ToolsPage)
     ui->setupUi(this);
 
     connect(ui->useQuickSizingBox, &QCheckBox::stateChanged, this, &ToolsPage::quickSizingChange);
+    connect(ui->strokePredictionBox, &QCheckBox::stateChanged, this, &ToolsPage::strokePredictionChange);
     connect(ui->rotationIncrementSlider, &QSlider::valueChanged, this, &ToolsPage::rotationIncrementChange);
 }
 
@@ -39,6 +40,7 @@ ToolsPage::~ToolsPage()
 void ToolsPage::updateValues()
 {
     ui->useQuickSizingBox->setChecked(mManager->isOn(SETTING::QUICK_SIZING));
+    ui->strokePredictionBox->setChecked(mManager->isOn(SETTING::STROKE_PREDICTION));
     setRotationIncrement(mManager->getInt(SETTING::ROTATION_INCREMENT));
 }
 
@@ -47,6 +49,11 @@ void ToolsPage::quickSizingChange(int b)
     mManager->set(SETTING::QUICK_SIZING, b != Qt::Unchecked);
 }
 
+void ToolsPage::strokePredictionChange(int b)
+{
+    mManager->set(SETTING::STROKE_PREDICTION, b != Qt::Unchecked);
+}
+
 void ToolsPage::setRotationIncrement(int angle)
 {
     int value = qSqrt((angle - 1) / 359.0) * 359;
@@ -35,6 +35,7 @@ public:
 public slots:
     void updateValues();
     void quickSizingChange(int);
+    void strokePredictionChange(int);
     void setRotationIncrement(int);
     void rotationIncrementChange(int);
 private:
@@ -6,7 +6,7 @@
 
 ! include( ../util/common.pri ) { error( Could not find the common.pri file! ) }
 
-QT += core widgets gui xml xmlpatterns multimedia svg
+QT += core widgets gui xml xmlpatterns multimedia svg concurrent
 
 TEMPLATE = lib
 CONFIG += qt staticlib precompile_header
@@ -33,9 +33,19 @@ PRECOMPILED_HEADER = src/corelib-pch.h
 HEADERS +=  \
     src/corelib-pch.h \
     src/graphics/bitmap/bitmapimage.h \
+    src/graphics/bitmap/bitmapcompositor.h \
+    src/graphics/bitmap/bitmapshadow.h \
+    src/graphics/bitmap/brushdabengine.h \
+    src/graphics/bitmap/frameaccumulator.h \
+    src/graphics/bitmap/framecompressor.h \
+    src/graphics/bitmap/smudgeengine.h \
     src/graphics/vector/bezierarea.h \
     src/graphics/vector/beziercurve.h \
+    src/graphics/vector/beziercurvefitter.h \
+    src/graphics/vector/bezierintersector.h \
     src/graphics/vector/colorref.h \
+    src/graphics/vector/vectorfillengine.h \
+    src/graphics/vector/vectorhittester.h \
     src/graphics/vector/vectorimage.h \
     src/graphics/vector/vectorselection.h \
     src/graphics/vector/vertexref.h \
@@ -61,7 +71,11 @@ HEADERS +=  \
     src/managers/soundmanager.h \
     src/movieimporter.h \
     src/structure/camera.h \
+    src/structure/camerapath.h \
     src/structure/keyframe.h \
+    src/structure/keyframeselection.h \
+    src/structure/framerangeset.h \
+    src/structure/keyframeindex.h \
     src/structure/layer.h \
     src/structure/layerbitmap.h \
     src/structure/layercamera.h \
@@ -75,6 +89,7 @@ HEADERS +=  \
     src/tool/basetool.h \
     src/tool/brushtool.h \
     src/tool/buckettool.h \
+    src/tool/cursorcache.h \
     src/tool/erasertool.h \
     src/tool/eyedroppertool.h \
     src/tool/handtool.h \
@@ -85,6 +100,9 @@ HEADERS +=  \
     src/tool/selecttool.h \
     src/tool/smudgetool.h \
     src/tool/strokemanager.h \
+    src/tool/strokeinputbuffer.h \
+    src/tool/strokelatencymonitor.h \
+    src/tool/strokestabilizer.h \
     src/tool/stroketool.h \
     src/util/blitrect.h \
     src/util/colordictionary.h \
@@ -101,6 +119,7 @@ HEADERS +=  \
     src/canvaspainter.h \
     src/soundplayer.h \
     src/movieexporter.h \
+    src/framerenderer.h \
     src/miniz.h \
     src/qminiz.h \
     src/activeframepool.h \
@@ -109,9 +128,19 @@ HEADERS +=  \
 
 
 SOURCES +=  src/graphics/bitmap/bitmapimage.cpp \
+    src/graphics/bitmap/bitmapcompositor.cpp \
+    src/graphics/bitmap/bitmapshadow.cpp \
+    src/graphics/bitmap/brushdabengine.cpp \
+    src/graphics/bitmap/frameaccumulator.cpp \
+    src/graphics/bitmap/framecompressor.cpp \
+    src/graphics/bitmap/smudgeengine.cpp \
     src/graphics/vector/bezierarea.cpp \
     src/graphics/vector/beziercurve.cpp \
+    src/graphics/vector/beziercurvefitter.cpp \
+    src/graphics/vector/bezierintersector.cpp \
     src/graphics/vector/colorref.cpp \
+    src/graphics/vector/vectorfillengine.cpp \
+    src/graphics/vector/vectorhittester.cpp \
     src/graphics/vector/vectorimage.cpp \
     src/graphics/vector/vectorselection.cpp \
     src/graphics/vector/vertexref.cpp \
@@ -137,7 +166,11 @@ SOURCES +=  src/graphics/bitmap/bitmapimage.cpp \
     src/managers/soundmanager.cpp \
     src/movieimporter.cpp \
     src/structure/camera.cpp \
+    src/structure/camerapath.cpp \
     src/structure/keyframe.cpp \
+    src/structure/keyframeselection.cpp \
+    src/structure/framerangeset.cpp \
+    src/structure/keyframeindex.cpp \
     src/structure/layer.cpp \
     src/structure/layerbitmap.cpp \
     src/structure/layercamera.cpp \
@@ -151,6 +184,7 @@ SOURCES +=  src/graphics/bitmap/bitmapimage.cpp \
     src/tool/basetool.cpp \
     src/tool/brushtool.cpp \
     src/tool/buckettool.cpp \
+    src/tool/cursorcache.cpp \
     src/tool/erasertool.cpp \
     src/tool/eyedroppertool.cpp \
     src/tool/handtool.cpp \
@@ -161,6 +195,9 @@ SOURCES +=  src/graphics/bitmap/bitmapimage.cpp \
     src/tool/selecttool.cpp \
     src/tool/smudgetool.cpp \
     src/tool/strokemanager.cpp \
+    src/tool/strokeinputbuffer.cpp \
+    src/tool/strokelatencymonitor.cpp \
+    src/tool/strokestabilizer.cpp \
     src/tool/stroketool.cpp \
     src/util/blitrect.cpp \
     src/util/fileformat.cpp \
@@ -172,6 +209,7 @@ SOURCES +=  src/graphics/bitmap/bitmapimage.cpp \
     src/canvaspainter.cpp \
     src/soundplayer.cpp \
     src/movieexporter.cpp \
+    src/framerenderer.cpp \
     src/miniz.cpp \
     src/qminiz.cpp \
     src/activeframepool.cpp \
@@ -16,6 +16,8 @@ GNU General Public License for more details.
 */
 
 #include "activeframepool.h"
+
+#include <QTemporaryDir>
 #include "keyframe.h"
 #include "pencildef.h"
 
@@ -34,36 +36,37 @@ void ActiveFramePool::put(KeyFrame* key)
 
     Q_ASSERT(key->pos() > 0);
 
-    key->loadFile();
-
-    auto it = mCacheFramesMap.find(key);
-    const bool keyExistsInPool = (it != mCacheFramesMap.end());
-    if (keyExistsInPool)
-    {
-        // move the keyframe to the front of the list, if the key already exists in frame pool
-        mCacheFramesList.erase(it->second);
-    }
-    mCacheFramesList.push_front(key);
-    mCacheFramesMap[key] = mCacheFramesList.begin();
-
-    key->addEventListener(this);
+    touch(key);
+    discardLeastUsedFrames();
+}
 
-    if (!keyExistsInPool)
+/** @brief ActiveFramePool::remove
+ *  Forgets a frame, which is going to be unloaded by someone else.
+ */
+void ActiveFramePool::remove(KeyFrame* key)
+{
+    auto it = mFrames.find(key);
+    if (it != mFrames.end())
     {
-        mTotalUsedMemory += key->memoryUsage();
+        takeOff(it->second);
+        mFrames.erase(it);
+        key->removeEventListner(this);
     }
-
-    discardLeastUsedFrames();
 }
 
 void ActiveFramePool::clear()
 {
-    for (KeyFrame* key : mCacheFramesList)
+    for (auto& it : mFrames)
     {
-        key->removeEventListner(this);
+        it.first->removeEventListner(this);
     }
-    mCacheFramesList.clear();
-    mCacheFramesMap.clear();
+    mCleanFramesList.clear();
+    mModifiedFramesList.clear();
+    mCompressedFramesList.clear();
+    mFrames.clear();
+    mCleanMemory = 0;
+    mDirtyMemory = 0;
+    mCompressedMemory = 0;
 }
 
 void ActiveFramePool::resize(quint64 memoryBudget)
@@ -71,13 +74,23 @@ void ActiveFramePool::resize(quint64 memoryBudget)
     memoryBudget = qMin(memoryBudget, quint64(1024) * 1024 * 1024 * 16); // 16GB
     memoryBudget = qMax(memoryBudget, quint64(1024) * 1024 * 100); // 100MB
     mMemoryBudgetInBytes = memoryBudget;
+    mCompressedBudgetInBytes = memoryBudget / COMPRESSED_BUDGET_DIVISOR;
     discardLeastUsedFrames();
 }
 
+/** @brief ActiveFramePool::setCompressedBudget
+ *  Sets the memory the compressed frames can take, 0 turns the compressed tier off.
+ */
+void ActiveFramePool::setCompressedBudget(quint64 budget)
+{
+    mCompressedBudgetInBytes = budget;
+    discardCompressedFrames();
+}
+
 bool ActiveFramePool::isFrameInPool(KeyFrame* key)
 {
-    auto it = mCacheFramesMap.find(key);
-    return (it != mCacheFramesMap.end());
+    auto it = mFrames.find(key);
+    return (it != mFrames.end());
 }
 
 void ActiveFramePool::setMinFrameCount(size_t frameCount)
@@ -85,48 +98,255 @@ void ActiveFramePool::setMinFrameCount(size_t frameCount)
     mMinFrameCount = frameCount;
 }
 
+void ActiveFramePool::pin(KeyFrame* key)
+{
+    if (key == nullptr)
+        return;
+
+    Frame& frame = touch(key);
+    if (frame.pinCount == 0)
+    {
+        frameList(frame.modified).erase(frame.position);
+    }
+    frame.pinCount++;
+    discardLeastUsedFrames();
+}
+
+void ActiveFramePool::unpin(KeyFrame* key)
+{
+    auto it = mFrames.find(key);
+    if (it == mFrames.end() || it->second.pinCount == 0)
+        return;
+
+    Frame& frame = it->second;
+    if (frame.pinCount > 1)
+    {
+        frame.pinCount--;
+        return;
+    }
+
+    // the frame may have been drawn on while it was pinned
+    takeOff(frame);
+    frame.pinCount = 0;
+    putOn(key, frame);
+    discardLeastUsedFrames();
+}
+
+bool ActiveFramePool::isPinned(KeyFrame* key) const
+{
+    auto it = mFrames.find(key);
+    return (it != mFrames.end()) && (it->second.pinCount > 0);
+}
+
 void ActiveFramePool::onKeyFrameDestroy(KeyFrame* key)
 {
-    auto it = mCacheFramesMap.find(key);
-    if (it != mCacheFramesMap.end())
+    auto it = mFrames.find(key);
+    if (it != mFrames.end())
     {
-        mCacheFramesList.erase(it->second);
-        mCacheFramesMap.erase(it);
+        // Not safe to call key->memoryUsage() here cuz it's in the KeyFrame's destructor,
+        // the memory it had when last put is taken off instead
+        takeOff(it->second);
+        mFrames.erase(it);
+    }
+}
 
-        // Just recalculate the total usage
-        // Not safe to call key->memoryUsage() here cuz it's in the KeyFrame's destructor
-        recalcuateTotalUsedMemory();
+/** @brief ActiveFramePool::touch
+ *  Loads the frame if needed, measures it again and makes it the most recently used one.
+ *  @return the pool entry of the frame
+ */
+ActiveFramePool::Frame& ActiveFramePool::touch(KeyFrame* key)
+{
+    auto it = mFrames.find(key);
+    if (key->isLoaded())
+        mStats.hits++;
+    else if (it != mFrames.end() && it->second.compressed)
+        mStats.compressedHits++;
+    else
+        mStats.misses++;
+
+    key->loadFile();
+
+    if (it == mFrames.end())
+    {
+        it = mFrames.emplace(key, Frame()).first;
+        key->addEventListener(this);
     }
+    else
+    {
+        takeOff(it->second);
+    }
+
+    Frame& frame = it->second;
+    putOn(key, frame);
+    return frame;
+}
+
+/** @brief ActiveFramePool::takeOff
+ *  Takes the frame off its list, unless it's pinned, and its memory off the totals.
+ */
+void ActiveFramePool::takeOff(Frame& frame)
+{
+    if (frame.compressed)
+    {
+        mCompressedFramesList.erase(frame.position);
+        mCompressedMemory -= frame.memory;
+        frame.compressed = false;
+    }
+    else
+    {
+        if (frame.pinCount == 0)
+        {
+            frameList(frame.modified).erase(frame.position);
+        }
+        memoryUsage(frame.modified) -= frame.memory;
+    }
+    frame.memory = 0;
+}
+
+/** @brief ActiveFramePool::putOn
+ *  Measures the loaded frame and puts it on the front of its list, unless it's pinned.
+ */
+void ActiveFramePool::putOn(KeyFrame* key, Frame& frame)
+{
+    frame.memory = key->memoryUsage();
+    frame.modified = key->isModified();
+    frame.lastUse = ++mClock;
+    memoryUsage(frame.modified) += frame.memory;
+    if (frame.pinCount == 0)
+    {
+        pushFront(key, frame);
+    }
+}
+
+void ActiveFramePool::pushFront(KeyFrame* key, Frame& frame)
+{
+    std::list<KeyFrame*>& list = frameList(frame.modified);
+    list.push_front(key);
+    frame.position = list.begin();
+}
+
+KeyFrame* ActiveFramePool::leastUsedFrame()
+{
+    if (mModifiedFramesList.empty())
+    {
+        return mCleanFramesList.empty() ? nullptr : mCleanFramesList.back();
+    }
+    if (mCleanFramesList.empty())
+    {
+        return mModifiedFramesList.back();
+    }
+
+    const quint64 cleanAge = mClock - mFrames.at(mCleanFramesList.back()).lastUse;
+    const quint64 modifiedAge = mClock - mFrames.at(mModifiedFramesList.back()).lastUse;
+    if (modifiedAge > cleanAge * DIRTY_FRAME_WEIGHT)
+    {
+        return mModifiedFramesList.back();
+    }
+    return mCleanFramesList.back();
 }
 
 void ActiveFramePool::discardLeastUsedFrames()
 {
-    while ((mTotalUsedMemory > mMemoryBudgetInBytes) && (mCacheFramesList.size() > mMinFrameCount))
+    // a frame that can't be evicted goes back to the front, so each frame is tried once at most
+    size_t attempts = mCleanFramesList.size() + mModifiedFramesList.size();
+    while ((usedMemory() > mMemoryBudgetInBytes) && (frameCount() > mMinFrameCount) && attempts-- > 0)
     {
-        list_iterator_t last = mCacheFramesList.end();
-        last--;
+        KeyFrame* key = leastUsedFrame();
+        if (key == nullptr)
+        {
+            break; // the frames left are pinned
+        }
 
-        KeyFrame* lastKeyFrame = *last;
-        unloadFrame(lastKeyFrame);
+        Frame& frame = mFrames.at(key);
+        takeOff(frame);
 
-        mCacheFramesMap.erase(lastKeyFrame);
-        mCacheFramesList.pop_back();
+        const quint64 compressedSize = (mCompressedBudgetInBytes > 0) ? key->compress() : 0;
+        if (compressedSize > 0)
+        {
+            mCompressedFramesList.push_front(key);
+            frame.position = mCompressedFramesList.begin();
+            frame.memory = compressedSize;
+            frame.compressed = true;
+            mCompressedMemory += compressedSize;
+            mStats.compressions++;
+        }
+        else if (!evict(key))
+        {
+            putOn(key, frame);
+        }
+    }
+    discardCompressedFrames();
+}
+
+void ActiveFramePool::discardCompressedFrames()
+{
+    size_t attempts = mCompressedFramesList.size();
+    while ((mCompressedMemory > mCompressedBudgetInBytes) && attempts-- > 0)
+    {
+        KeyFrame* key = mCompressedFramesList.back();
+        Frame& frame = mFrames.at(key);
+        const quint64 compressedSize = frame.memory;
+        takeOff(frame);
+
+        if (!evict(key))
+        {
+            // still compressed, it goes back to the front of the compressed list
+            mCompressedFramesList.push_front(key);
+            frame.position = mCompressedFramesList.begin();
+            frame.memory = compressedSize;
+            frame.compressed = true;
+            mCompressedMemory += compressedSize;
+        }
+    }
+}
 
-        lastKeyFrame->removeEventListner(this);
+/** @brief ActiveFramePool::evict
+ *  Unloads a frame that's been taken off, or swaps it out if it's modified, and forgets it.
+ *  @return false if the modified frame can't be swapped out, it stays loaded and in the pool
+ */
+bool ActiveFramePool::evict(KeyFrame* key)
+{
+    // a frame listed as clean may have been drawn on since it was last put
+    if (key->isModified())
+    {
+        if (!swapOutFrame(key))
+        {
+            mStats.swapOutFailures++;
+            return false;
+        }
     }
+    else
+    {
+        unloadFrame(key);
+    }
+
+    mFrames.erase(key);
+    key->removeEventListner(this);
+    return true;
 }
 
 void ActiveFramePool::unloadFrame(KeyFrame* key)
 {
-    mTotalUsedMemory -= key->memoryUsage();
     key->unloadFile();
+    mStats.evictions++;
 }
 
-void ActiveFramePool::recalcuateTotalUsedMemory()
+bool ActiveFramePool::swapOutFrame(KeyFrame* key)
 {
-    mTotalUsedMemory = 0;
-    for (KeyFrame* key : mCacheFramesList)
+    if (mScratchDir == nullptr)
+    {
+        mScratchDir.reset(new QTemporaryDir);
+    }
+    if (!mScratchDir->isValid())
+    {
+        return false;
+    }
+
+    const QString scratchFile = mScratchDir->filePath(QString("%1.frame").arg(++mScratchFileCount));
+    if (key->swapOut(scratchFile))
     {
-        mTotalUsedMemory += key->memoryUsage();
+        mStats.swapOuts++;
+        return true;
     }
+    return false;
 }
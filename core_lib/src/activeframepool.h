@@ -19,43 +19,124 @@ GNU General Public License for more details.
 #define ACTIVEFRAMEPOOL_H
 
 #include <list>
+#include <memory>
 #include <unordered_map>
 #include "keyframe.h"
 
+class QTemporaryDir;
+
 
 /**
  * ActiveFramePool implemented a LRU cache to keep tracking the most recent accessed key frames
  * A key frame will be unloaded if it's not accessed for a while (at the end of cache list)
  * The ActiveFramePool will be updated whenever Editor::scrubTo() gets called.
  *
- * Note: ActiveFramePool does not handle file saving. It loads frames, but never writes frames to disks.
+ * Clean and modified frames are kept in separate lists. When the pool is over budget, the least
+ * recently used frame goes, but a modified frame has to be DIRTY_FRAME_WEIGHT times older than
+ * the oldest clean frame to go first, since it has to be written out and read back.
+ * Modified frames are swapped out to a scratch file (see KeyFrame::swapOut), they stay modified
+ * and are read back from it by the next loadFile().
+ *
+ * Between memory and the disk there is a compressed tier: the frames that go are first kept
+ * compressed (see FrameCompressor), within a budget of their own, and only the least recently
+ * used of those are unloaded or swapped out. Scrubbing over a long scene mostly decompresses
+ * frames instead of decoding them from their files.
+ *
+ * The memory of each frame is measured when it's put into the pool, so the accounting is O(1),
+ * and pinned frames, in use by a tool, are never unloaded.
+ *
+ * Note: ActiveFramePool does not handle file saving. It loads frames, but never writes frames to disks,
+ * other than to its scratch files.
  */
 class ActiveFramePool : public KeyFrameEventListener
 {
 public:
+    static const int DIRTY_FRAME_WEIGHT = 4;
+    static const int COMPRESSED_BUDGET_DIVISOR = 4; ///< resize() gives the compressed tier a quarter of the budget
+
+    struct Stats
+    {
+        quint64 hits = 0;            ///< frames put into the pool that were already loaded
+        quint64 compressedHits = 0;  ///< frames that were decompressed
+        quint64 misses = 0;          ///< frames that had to be loaded from a file
+        quint64 compressions = 0;    ///< frames moved to the compressed tier
+        quint64 evictions = 0;       ///< clean frames unloaded
+        quint64 swapOuts = 0;        ///< modified frames written to a scratch file and unloaded
+        quint64 swapOutFailures = 0; ///< modified frames that couldn't be swapped out and stayed loaded
+    };
+
     explicit ActiveFramePool();
     virtual ~ActiveFramePool();
 
     void put(KeyFrame* key);
+    void remove(KeyFrame* key);
     void clear();
     void resize(quint64 memoryBudget);
+    void setCompressedBudget(quint64 budget);
     bool isFrameInPool(KeyFrame*);
     void setMinFrameCount(size_t frameCount);
 
+    /** Keeps the frame loaded until it's unpinned as many times as it was pinned. */
+    void pin(KeyFrame* key);
+    void unpin(KeyFrame* key);
+    bool isPinned(KeyFrame* key) const;
+
+    quint64 usedMemory() const { return mCleanMemory + mDirtyMemory; }
+    quint64 cleanMemory() const { return mCleanMemory; }
+    quint64 dirtyMemory() const { return mDirtyMemory; }
+    quint64 compressedMemory() const { return mCompressedMemory; }
+    size_t frameCount() const { return mFrames.size() - mCompressedFramesList.size(); }
+    size_t compressedFrameCount() const { return mCompressedFramesList.size(); }
+
+    Stats stats() const { return mStats; }
+    void resetStats() { mStats = Stats(); }
+
     void onKeyFrameDestroy(KeyFrame*) override;
 
 private:
+    using list_iterator_t = std::list<KeyFrame*>::iterator;
+
+    struct Frame
+    {
+        list_iterator_t position;  ///< in the clean, modified or compressed list, unless pinned
+        quint64 memory = 0;        ///< as measured when last put, or compressed
+        quint64 lastUse = 0;
+        int pinCount = 0;
+        bool modified = false;
+        bool compressed = false;
+    };
+
+    Frame& touch(KeyFrame* key);
+    void takeOff(Frame& frame);
+    void putOn(KeyFrame* key, Frame& frame);
+    void pushFront(KeyFrame* key, Frame& frame);
+    KeyFrame* leastUsedFrame();
     void discardLeastUsedFrames();
+    void discardCompressedFrames();
+    bool evict(KeyFrame* key);
     void unloadFrame(KeyFrame* key);
-    void recalcuateTotalUsedMemory();
+    bool swapOutFrame(KeyFrame* key);
 
-    using list_iterator_t = std::list<KeyFrame*>::iterator;
+    std::list<KeyFrame*>& frameList(bool modified) { return modified ? mModifiedFramesList : mCleanFramesList; }
+    quint64& memoryUsage(bool modified) { return modified ? mDirtyMemory : mCleanMemory; }
+
+    std::list<KeyFrame*> mCleanFramesList;
+    std::list<KeyFrame*> mModifiedFramesList;
+    std::list<KeyFrame*> mCompressedFramesList;
+    std::unordered_map<KeyFrame*, Frame> mFrames;
 
-    std::list<KeyFrame*> mCacheFramesList;
-    std::unordered_map<KeyFrame*, list_iterator_t> mCacheFramesMap;
     quint64 mMemoryBudgetInBytes = 1024 * 1024 * 1024; // 1GB
-    quint64 mTotalUsedMemory = 0;
+    quint64 mCompressedBudgetInBytes = mMemoryBudgetInBytes / COMPRESSED_BUDGET_DIVISOR;
+    quint64 mCleanMemory = 0;
+    quint64 mDirtyMemory = 0;
+    quint64 mCompressedMemory = 0;
+    quint64 mClock = 0;
     size_t mMinFrameCount = 15;
+
+    std::unique_ptr<QTemporaryDir> mScratchDir;
+    quint64 mScratchFileCount = 0;
+
+    Stats mStats;
 };
 
 #endif // ACTIVEFRAMEPOOL_H
@@ -21,6 +21,7 @@ GNU General Public License for more details.
 #include "layerbitmap.h"
 #include "layervector.h"
 #include "bitmapimage.h"
+#include "bitmapshadow.h"
 #include "layercamera.h"
 #include "vectorimage.h"
 #include "util.h"
@@ -71,13 +72,17 @@ void CanvasPainter::ignoreTransformedSelection()
 
 void CanvasPainter::paintCached()
 {
-    QPixmap tempPixmap(mCanvas->size());
-    tempPixmap.fill(Qt::transparent);
-    mCanvas->fill(Qt::transparent);
-    QPainter tempPainter;
+    // the layer caches are rendered once for the whole canvas
+    if (!mPreLayersCache || !mPostLayersCache)
+    {
+        mDirtyRect = QRect();
+    }
+    const QRect dirty = dirtyRect();
+
+    paintBackground();
     QPainter painter;
-    initializePainter(tempPainter, tempPixmap);
     initializePainter(painter, *mCanvas);
+    clipToDirtyRect(painter);
 
     if (!mPreLayersCache)
     {
@@ -87,7 +92,7 @@ void CanvasPainter::paintCached()
     else
     {
         painter.setWorldMatrixEnabled(false);
-        painter.drawPixmap(0, 0, *(mPreLayersCache.get()));
+        painter.drawPixmap(dirty, *(mPreLayersCache.get()), dirty);
         painter.setWorldMatrixEnabled(true);
     }
 
@@ -95,18 +100,19 @@ void CanvasPainter::paintCached()
 
     if (!mPostLayersCache)
     {
+        QPixmap tempPixmap(mCanvas->size());
+        tempPixmap.fill(Qt::transparent);
+        QPainter tempPainter;
+        initializePainter(tempPainter, tempPixmap);
         renderPostLayers(tempPainter);
+        tempPainter.end();
+
         mPostLayersCache.reset(new QPixmap(tempPixmap));
-        painter.setWorldMatrixEnabled(false);
-        painter.drawPixmap(0, 0, tempPixmap);
-        painter.setWorldMatrixEnabled(true);
-    }
-    else
-    {
-        painter.setWorldMatrixEnabled(false);
-        painter.drawPixmap(0, 0, *(mPostLayersCache.get()));
-        painter.setWorldMatrixEnabled(true);
     }
+
+    painter.setWorldMatrixEnabled(false);
+    painter.drawPixmap(dirty, *(mPostLayersCache.get()), dirty);
+    painter.setWorldMatrixEnabled(true);
 }
 
 void CanvasPainter::resetLayerCache()
@@ -177,9 +183,9 @@ void CanvasPainter::renderPostLayers(QPainter& painter)
 
 void CanvasPainter::setPaintSettings(const Object* object, int currentLayer, int frame, QRect rect, BitmapImage* buffer)
 {
-    Q_UNUSED(rect);
     Q_ASSERT(object);
     mObject = object;
+    mDirtyRect = rect;
 
     CANVASPAINTER_LOG("Set CurrentLayerIndex = %d", currentLayer);
     mCurrentLayerIndex = currentLayer;
@@ -187,10 +193,18 @@ void CanvasPainter::setPaintSettings(const Object* object, int currentLayer, int
     mBuffer = buffer;
 }
 
+/**
+ * @brief CanvasPainter::paint
+ * Repaints the part of the canvas given to setPaintSettings(), every layer and onion skin in it.
+ * The rest of the canvas is left as it was.
+ */
 void CanvasPainter::paint()
 {
+    paintBackground();
+
     QPainter painter;
     initializePainter(painter, *mCanvas);
+    clipToDirtyRect(painter);
 
     renderPreLayers(painter);
     renderCurLayer(painter);
@@ -199,7 +213,43 @@ void CanvasPainter::paint()
 
 void CanvasPainter::paintBackground()
 {
-    mCanvas->fill(Qt::transparent);
+    if (!isPartialPaint())
+    {
+        mCanvas->fill(Qt::transparent);
+        return;
+    }
+
+    QPainter painter(mCanvas);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.fillRect(mDirtyRect, Qt::transparent);
+}
+
+void CanvasPainter::clipToDirtyRect(QPainter& painter)
+{
+    if (!isPartialPaint())
+        return;
+
+    // in screen coordinates, the clip doesn't follow the view transform
+    painter.setWorldMatrixEnabled(false);
+    painter.setClipRect(mDirtyRect);
+    painter.setWorldMatrixEnabled(true);
+}
+
+bool CanvasPainter::isPartialPaint() const
+{
+    return !mDirtyRect.isEmpty() && !mDirtyRect.contains(mCanvas->rect());
+}
+
+/// The part of the canvas to repaint, in screen coordinates
+QRect CanvasPainter::dirtyRect() const
+{
+    return isPartialPaint() ? (mDirtyRect & mCanvas->rect()) : mCanvas->rect();
+}
+
+/// The part of the drawing under the dirty rect, with a margin for smooth scaling at its edges
+QRect CanvasPainter::dirtyCanvasRect() const
+{
+    return mViewInverse.mapRect(dirtyRect()).adjusted(-2, -2, 2, 2);
 }
 
 void CanvasPainter::paintOnionSkin(QPainter& painter)
@@ -307,6 +357,7 @@ void CanvasPainter::paintBitmapFrame(QPainter& painter,
     CANVASPAINTER_LOG("        Paint Image Size: %dx%d", paintedImage->image()->width(), paintedImage->image()->height());
 
     const bool frameIsEmpty = (paintedImage == nullptr || paintedImage->bounds().isEmpty());
+    const bool isShadowed = isCurrentFrame && mShadow && mShadow->target() == paintedImage;
     const bool isDrawing = isCurrentFrame && mBuffer && !mBuffer->bounds().isEmpty();
     if (frameIsEmpty && !isDrawing)
     {
@@ -314,15 +365,48 @@ void CanvasPainter::paintBitmapFrame(QPainter& painter,
         return;
     }
 
+    // If the current frame on the current layer has a transformation, we apply it.
+    bool shouldPaintTransform = mRenderTransform && nFrame == mFrameNumber && layer == mObject->getLayer(mCurrentLayerIndex);
+
+    if (isShadowed && !isDrawing && !colorize && !shouldPaintTransform && mOptions.scaling >= 1.0f)
+    {
+        // an eraser stroke in progress, the frame and the shadow tiles are drawn as they are
+        painter.setOpacity(paintedImage->getOpacity() - (1.0-painter.opacity()));
+        painter.setWorldMatrixEnabled(true);
+        mShadow->paint(painter);
+        return;
+    }
+
     BitmapImage paintToImage;
-    paintToImage.paste(paintedImage);
+    if (isPartialPaint())
+    {
+        // only what is under the dirty rect, however big the frame is
+        const QRect area = dirtyCanvasRect();
+        paintToImage = paintedImage->copy(area);
+        if (isCurrentFrame && mBuffer)
+        {
+            BitmapImage bufferArea = mBuffer->copy(area);
+            paintToImage.paste(&bufferArea, mOptions.cmBufferBlendMode);
+        }
+        if (paintToImage.bounds().isEmpty())
+            return;
+    }
+    else
+    {
+        paintToImage.paste(paintedImage);
+        if (isCurrentFrame)
+        {
+            paintToImage.paste(mBuffer, mOptions.cmBufferBlendMode);
+        }
+    }
 
-    painter.setOpacity(paintedImage->getOpacity() - (1.0-painter.opacity()));
-    if (isCurrentFrame)
+    if (isShadowed)
     {
-        paintToImage.paste(mBuffer, mOptions.cmBufferBlendMode);
+        mShadow->paint(*paintToImage.image(), paintToImage.topLeft());
     }
 
+    painter.setOpacity(paintedImage->getOpacity() - (1.0-painter.opacity()));
+
     if (colorize)
     {
         QBrush colorBrush = QBrush(Qt::transparent); //no color for the current frame
@@ -336,15 +420,13 @@ void CanvasPainter::paintBitmapFrame(QPainter& painter,
             colorBrush = QBrush(Qt::blue);
         }
 
-        paintToImage.drawRect(paintedImage->bounds(),
+        paintToImage.drawRect(paintToImage.bounds(),
                               Qt::NoPen,
                               colorBrush,
                               QPainter::CompositionMode_SourceIn,
                               false);
     }
 
-    // If the current frame on the current layer has a transformation, we apply it.
-    bool shouldPaintTransform = mRenderTransform && nFrame == mFrameNumber && layer == mObject->getLayer(mCurrentLayerIndex);
     if (shouldPaintTransform)
     {
         paintToImage.clear(mSelection);
@@ -418,12 +500,14 @@ void CanvasPainter::paintVectorFrame(QPainter& painter,
         return;
     }
 
-    QImage* strokeImage = new QImage(mCanvas->size(), QImage::Format_ARGB32_Premultiplied);
-    vectorImage->outputImage(strokeImage, mViewTransform, mOptions.bOutlines, mOptions.bThinLines, mOptions.bAntiAlias);
+    // rasterize only the dirty part of the canvas
+    const QRect area = dirtyRect();
+    QImage strokeImage(area.size(), QImage::Format_ARGB32_Premultiplied);
+    vectorImage->outputImage(&strokeImage, mViewTransform * QTransform::fromTranslate(-area.left(), -area.top()),
+                             mOptions.bOutlines, mOptions.bThinLines, mOptions.bAntiAlias);
 
     // Go through a Bitmap image to paint the onion skin colour
-    BitmapImage rasterizedVectorImage;
-    rasterizedVectorImage.setImage(strokeImage);
+    BitmapImage rasterizedVectorImage(area.topLeft(), strokeImage);
 
     if (colorize)
     {
@@ -437,7 +521,7 @@ void CanvasPainter::paintVectorFrame(QPainter& painter,
         {
             colorBrush = QBrush(Qt::blue);
         }
-        rasterizedVectorImage.drawRect(strokeImage->rect(),
+        rasterizedVectorImage.drawRect(rasterizedVectorImage.bounds(),
                                  Qt::NoPen, colorBrush,
                                  QPainter::CompositionMode_SourceIn, false);
     }
@@ -29,6 +29,7 @@ GNU General Public License for more details.
 
 class Object;
 class BitmapImage;
+class BitmapShadow;
 class ViewManager;
 
 struct CanvasPainterOptions
@@ -81,6 +82,7 @@ public:
     QRect getCameraRect();
 
     void setPaintSettings(const Object* object, int currentLayer, int frame, QRect rect, BitmapImage* buffer);
+    void setBitmapShadow(const BitmapShadow* shadow) { mShadow = shadow; }
     void paint();
     void paintCached();
     void renderGrid(QPainter& painter);
@@ -102,6 +104,10 @@ private:
     void renderPostLayers(QPainter& painter);
 
     void paintBackground();
+    void clipToDirtyRect(QPainter& painter);
+    bool isPartialPaint() const;
+    QRect dirtyRect() const;
+    QRect dirtyCanvasRect() const;
     void paintOnionSkin(QPainter& painter);
 
     void renderPostLayers(QPixmap* pixmap);
@@ -140,6 +146,12 @@ private:
     int mFrameNumber = 0;
     BitmapImage* mBuffer = nullptr;
 
+    /// The stroke in progress on a bitmap frame, painted over that frame instead of mBuffer
+    const BitmapShadow* mShadow = nullptr;
+
+    /// The part of the canvas to repaint, in screen coordinates. Empty repaints all of it.
+    QRect mDirtyRect;
+
     QImage mScaledBitmap;
 
     bool bMultiLayerOnionSkin = false;
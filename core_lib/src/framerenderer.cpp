@@ -0,0 +1,82 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "framerenderer.h"
+
+#include "object.h"
+#include "layerbitmap.h"
+#include "layervector.h"
+#include "bitmapimage.h"
+#include "vectorimage.h"
+
+
+FrameRenderer::FrameRenderer(const Object* object, int frame, bool antialiasing) : mAntialiasing(antialiasing)
+{
+    object->updateActiveFrames(frame);
+
+    for (int i = 0; i < object->getLayerCount(); i++)
+    {
+        Layer* layer = object->getLayer(i);
+        if (!layer->visible())
+        {
+            continue;
+        }
+
+        if (layer->type() == Layer::BITMAP)
+        {
+            BitmapImage* bitmap = static_cast<LayerBitmap*>(layer)->getLastBitmapImageAtFrame(frame);
+            if (bitmap)
+            {
+                Image image;
+                image.bitmap = *bitmap->image();
+                image.topLeft = bitmap->bounds().topLeft();
+                image.opacity = bitmap->getOpacity();
+                mImages.push_back(image);
+            }
+        }
+        else if (layer->type() == Layer::VECTOR)
+        {
+            VectorImage* vector = static_cast<LayerVector*>(layer)->getLastVectorImageAtFrame(frame, 0);
+            if (vector)
+            {
+                Image image;
+                image.vector = vector;
+                image.opacity = vector->getOpacity();
+                mImages.push_back(image);
+            }
+        }
+    }
+}
+
+void FrameRenderer::paint(QPainter& painter) const
+{
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+
+    for (const Image& image : mImages)
+    {
+        painter.setOpacity(image.opacity);
+        if (image.vector != nullptr)
+        {
+            VectorImage vector(*image.vector);
+            vector.paintImage(painter, false, false, mAntialiasing);
+        }
+        else
+        {
+            painter.drawImage(image.topLeft, image.bitmap);
+        }
+    }
+}
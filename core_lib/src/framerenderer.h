@@ -0,0 +1,57 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#ifndef FRAMERENDERER_H
+#define FRAMERENDERER_H
+
+#include <vector>
+#include <QImage>
+#include <QPainter>
+
+class Object;
+class VectorImage;
+
+
+/**
+ * Paints one frame of an object, the way Object::paintImage does, from any thread.
+ *
+ * Everything that could change or load while painting is done when the renderer is
+ * created, on the thread that owns the object: the active frames are loaded and the
+ * images of the frame are taken. The bitmaps are shared read-only, the vector images
+ * are copied for each paint since painting them updates their areas.
+ *
+ * The object must not change while a renderer of it is in use.
+ */
+class FrameRenderer
+{
+public:
+    FrameRenderer(const Object* object, int frame, bool antialiasing = true);
+
+    void paint(QPainter& painter) const;
+
+private:
+    struct Image
+    {
+        QImage bitmap;
+        QPoint topLeft;
+        const VectorImage* vector = nullptr;
+        qreal opacity = 1.0;
+    };
+
+    std::vector<Image> mImages; // from the bottom layer to the top one
+    bool mAntialiasing = true;
+};
+
+#endif // FRAMERENDERER_H
@@ -0,0 +1,294 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "bitmapcompositor.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BITMAPCOMPOSITOR_USE_SSE2
+#endif
+
+
+namespace
+{
+    // x / 255 rounded, exact for the product of two 8 bit values
+    inline uint div255(uint x)
+    {
+        x += 128;
+        return (x + (x >> 8)) >> 8;
+    }
+
+    // every channel of p times a / 255
+    inline QRgb multiply(QRgb p, uint a)
+    {
+        return qRgba(int(div255(qRed(p) * a)), int(div255(qGreen(p) * a)),
+                     int(div255(qBlue(p) * a)), int(div255(qAlpha(p) * a)));
+    }
+
+    // channel wise sum, saturated like the packing of the SIMD kernels
+    inline QRgb add(QRgb a, QRgb b)
+    {
+        return qRgba(qMin(qRed(a) + qRed(b), 255), qMin(qGreen(a) + qGreen(b), 255),
+                     qMin(qBlue(a) + qBlue(b), 255), qMin(qAlpha(a) + qAlpha(b), 255));
+    }
+
+#ifdef BITMAPCOMPOSITOR_USE_SSE2
+    // four pixels per register, two per register once unpacked to 16 bit channels
+    struct Sse2
+    {
+        typedef __m128i V;
+        enum { Pixels = 4 };
+
+        static V load(const QRgb* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+        static void store(QRgb* p, V v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+        static V zero() { return _mm_setzero_si128(); }
+
+        static bool allZero(V v) { return _mm_movemask_epi8(_mm_cmpeq_epi32(v, zero())) == 0xffff; }
+        static bool allOpaque(V v)
+        {
+            const V alphaMask = _mm_set1_epi32(int(0xff000000));
+            return _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(v, alphaMask), alphaMask)) == 0xffff;
+        }
+
+        static V low(V v) { return _mm_unpacklo_epi8(v, zero()); }
+        static V high(V v) { return _mm_unpackhi_epi8(v, zero()); }
+        static V pack(V lo, V hi) { return _mm_packus_epi16(lo, hi); }
+
+        static V alpha(V p)
+        {
+            return _mm_shufflehi_epi16(_mm_shufflelo_epi16(p, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        }
+        static V inverse(V a) { return _mm_sub_epi16(_mm_set1_epi16(255), a); }
+        static V add(V a, V b) { return _mm_add_epi16(a, b); }
+        static V multiply(V a, V b)
+        {
+            V x = _mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(128));
+            return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+        }
+    };
+#endif
+
+#ifdef BITMAPCOMPOSITOR_USE_SSE2
+    /**
+     * Blends the pixels of a row by whole registers.
+     * Returns how many pixels were done, the caller finishes the row with the scalar version.
+     */
+    template <class S>
+    int compositeVectors(QRgb* dst, const QRgb* src, int count, QPainter::CompositionMode mode)
+    {
+        typedef typename S::V V;
+        int i = 0;
+        switch (mode)
+        {
+        case QPainter::CompositionMode_SourceOver:
+            // s + d * (1 - sa)
+            for (; i + S::Pixels <= count; i += S::Pixels)
+            {
+                const V s = S::load(src + i);
+                if (S::allZero(s))
+                    continue;
+                if (S::allOpaque(s))
+                {
+                    S::store(dst + i, s);
+                    continue;
+                }
+                const V d = S::load(dst + i);
+                const V sLo = S::low(s), sHi = S::high(s);
+                S::store(dst + i, S::pack(S::add(sLo, S::multiply(S::low(d), S::inverse(S::alpha(sLo)))),
+                                          S::add(sHi, S::multiply(S::high(d), S::inverse(S::alpha(sHi))))));
+            }
+            break;
+        case QPainter::CompositionMode_DestinationOut:
+            // d * (1 - sa)
+            for (; i + S::Pixels <= count; i += S::Pixels)
+            {
+                const V s = S::load(src + i);
+                if (S::allZero(s))
+                    continue;
+                if (S::allOpaque(s))
+                {
+                    S::store(dst + i, S::zero());
+                    continue;
+                }
+                const V d = S::load(dst + i);
+                S::store(dst + i, S::pack(S::multiply(S::low(d), S::inverse(S::alpha(S::low(s)))),
+                                          S::multiply(S::high(d), S::inverse(S::alpha(S::high(s))))));
+            }
+            break;
+        case QPainter::CompositionMode_SourceIn:
+            // s * da
+            for (; i + S::Pixels <= count; i += S::Pixels)
+            {
+                const V s = S::load(src + i);
+                const V d = S::load(dst + i);
+                if (S::allZero(s) || S::allOpaque(d))
+                {
+                    S::store(dst + i, s);
+                    continue;
+                }
+                S::store(dst + i, S::pack(S::multiply(S::low(s), S::alpha(S::low(d))),
+                                          S::multiply(S::high(s), S::alpha(S::high(d)))));
+            }
+            break;
+        case QPainter::CompositionMode_SourceAtop:
+            // s * da + d * (1 - sa)
+            for (; i + S::Pixels <= count; i += S::Pixels)
+            {
+                const V s = S::load(src + i);
+                if (S::allZero(s))
+                    continue;
+                const V d = S::load(dst + i);
+                const V sLo = S::low(s), sHi = S::high(s);
+                const V dLo = S::low(d), dHi = S::high(d);
+                S::store(dst + i, S::pack(S::add(S::multiply(sLo, S::alpha(dLo)), S::multiply(dLo, S::inverse(S::alpha(sLo)))),
+                                          S::add(S::multiply(sHi, S::alpha(dHi)), S::multiply(dHi, S::inverse(S::alpha(sHi))))));
+            }
+            break;
+        default:
+            break;
+        }
+        return i;
+    }
+#endif
+}
+
+bool BitmapCompositor::supports(QPainter::CompositionMode mode)
+{
+    switch (mode)
+    {
+    case QPainter::CompositionMode_Source:
+    case QPainter::CompositionMode_SourceOver:
+    case QPainter::CompositionMode_DestinationOut:
+    case QPainter::CompositionMode_SourceIn:
+    case QPainter::CompositionMode_SourceAtop:
+    case QPainter::CompositionMode_Clear:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief BitmapCompositor::composite
+ * @param target: the image painted on
+ * @param offset: where the top left pixel of the source lands on the target
+ * @param source: the image painted
+ * @param mode: how source and target pixels combine, only the area covered by the source changes
+ * @param clip: if valid, the only part of the target that may change
+ * @return false if the mode or the image formats are not supported, the target is then left
+ * untouched and the caller should paint with QPainter instead
+ *
+ * Does the same as QPainter::drawImage(offset, source) with the composition mode set to mode.
+ */
+bool BitmapCompositor::composite(QImage& target, QPoint offset, const QImage& source,
+                                 QPainter::CompositionMode mode, const QRect& clip)
+{
+    if (target.isNull() || source.isNull())
+        return true;
+
+    if (!supports(mode)
+        || target.format() != QImage::Format_ARGB32_Premultiplied
+        || source.format() != QImage::Format_ARGB32_Premultiplied)
+    {
+        return false;
+    }
+
+    QRect area = QRect(offset, source.size()) & target.rect();
+    if (clip.isValid())
+    {
+        area &= clip;
+    }
+    if (area.isEmpty())
+        return true;
+
+    const int sourceX = area.left() - offset.x();
+    for (int y = area.top(); y <= area.bottom(); y++)
+    {
+        QRgb* dst = reinterpret_cast<QRgb*>(target.scanLine(y)) + area.left();
+        const QRgb* src = reinterpret_cast<const QRgb*>(source.constScanLine(y - offset.y())) + sourceX;
+        compositeRow(dst, src, area.width(), mode);
+    }
+    return true;
+}
+
+/**
+ * @brief BitmapCompositor::compositeRow
+ * Composites count premultiplied pixels of src onto dst.
+ * Processes four pixels at a time with SSE2 where available.
+ */
+void BitmapCompositor::compositeRow(QRgb* dst, const QRgb* src, int count, QPainter::CompositionMode mode)
+{
+    int done = 0;
+#ifdef BITMAPCOMPOSITOR_USE_SSE2
+    done = compositeVectors<Sse2>(dst, src, count, mode);
+#endif
+    compositeRowScalar(dst + done, src + done, count - done, mode);
+}
+
+void BitmapCompositor::compositeRowScalar(QRgb* dst, const QRgb* src, int count, QPainter::CompositionMode mode)
+{
+    if (count <= 0)
+        return;
+
+    switch (mode)
+    {
+    case QPainter::CompositionMode_Source:
+        std::memcpy(dst, src, size_t(count) * sizeof(QRgb));
+        break;
+    case QPainter::CompositionMode_Clear:
+        std::memset(dst, 0, size_t(count) * sizeof(QRgb));
+        break;
+    case QPainter::CompositionMode_SourceOver:
+        for (int i = 0; i < count; i++)
+        {
+            const QRgb s = src[i];
+            const uint sa = qAlpha(s);
+            if (s == 0)
+                continue;
+            dst[i] = (sa == 255) ? s : add(s, multiply(dst[i], 255 - sa));
+        }
+        break;
+    case QPainter::CompositionMode_DestinationOut:
+        for (int i = 0; i < count; i++)
+        {
+            const QRgb s = src[i];
+            if (s == 0)
+                continue;
+            dst[i] = multiply(dst[i], 255 - qAlpha(s));
+        }
+        break;
+    case QPainter::CompositionMode_SourceIn:
+        for (int i = 0; i < count; i++)
+        {
+            dst[i] = multiply(src[i], qAlpha(dst[i]));
+        }
+        break;
+    case QPainter::CompositionMode_SourceAtop:
+        for (int i = 0; i < count; i++)
+        {
+            const QRgb s = src[i];
+            if (s == 0)
+                continue;
+            const QRgb d = dst[i];
+            dst[i] = add(multiply(s, qAlpha(d)), multiply(d, 255 - qAlpha(s)));
+        }
+        break;
+    default:
+        Q_ASSERT(false);
+        break;
+    }
+}
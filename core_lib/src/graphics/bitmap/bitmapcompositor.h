@@ -0,0 +1,46 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#ifndef BITMAPCOMPOSITOR_H
+#define BITMAPCOMPOSITOR_H
+
+#include <QImage>
+#include <QPainter>
+
+
+/**
+ * Composites an ARGB32 premultiplied image onto another, row by row.
+ *
+ * Covers the composition modes bitmap layers paste with, which are the ones QPainter
+ * would otherwise go through its generic raster pipeline for: Source, SourceOver,
+ * DestinationOut, SourceIn, SourceAtop and Clear. Rows are blended four pixels at a time
+ * with SSE2 where available, the scalar version gives the same result on the remaining
+ * pixels and on other CPUs.
+ *
+ * Channels are rounded to the nearest value, QPainter may differ by one.
+ */
+class BitmapCompositor
+{
+public:
+    static bool supports(QPainter::CompositionMode mode);
+
+    static bool composite(QImage& target, QPoint offset, const QImage& source,
+                          QPainter::CompositionMode mode, const QRect& clip = QRect());
+
+    static void compositeRow(QRgb* dst, const QRgb* src, int count, QPainter::CompositionMode mode);
+    static void compositeRowScalar(QRgb* dst, const QRgb* src, int count, QPainter::CompositionMode mode);
+};
+
+#endif // BITMAPCOMPOSITOR_H
@@ -21,7 +21,15 @@ GNU General Public License for more details.
 #include <QtMath>
 #include <QFile>
 #include <QPainterPath>
+#include <QtConcurrent>
 #include "util.h"
+#include "bitmapcompositor.h"
+#include "framecompressor.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BITMAPIMAGE_USE_SSE2
+#endif
 
 BitmapImage::BitmapImage()
 {
@@ -32,10 +40,10 @@ BitmapImage::BitmapImage()
 BitmapImage::BitmapImage(const BitmapImage& a) : KeyFrame(a)
 {
     mBounds = a.mBounds;
-    mMinBound = a.mMinBound;
+    mDirtyEdges = a.mDirtyEdges;
     mEnableAutoCrop = a.mEnableAutoCrop;
     mOpacity = a.mOpacity;
-    mImage.reset(new QImage(*a.mImage));
+    copyImage(a);
 }
 
 BitmapImage::BitmapImage(const QRect& rectangle, const QColor& color)
@@ -43,13 +51,13 @@ BitmapImage::BitmapImage(const QRect& rectangle, const QColor& color)
     mBounds = rectangle;
     mImage.reset(new QImage(mBounds.size(), QImage::Format_ARGB32_Premultiplied));
     mImage->fill(color.rgba());
-    mMinBound = false;
+    mDirtyEdges = AllEdges;
 }
 
 BitmapImage::BitmapImage(const QPoint& topLeft, const QImage& image)
 {
     mBounds = QRect(topLeft, image.size());
-    mMinBound = true;
+    mDirtyEdges = 0;
     mImage.reset(new QImage(image));
 }
 
@@ -59,19 +67,22 @@ BitmapImage::BitmapImage(const QPoint& topLeft, const QString& path)
     mImage.reset();
 
     mBounds = QRect(topLeft, QSize(0, 0));
-    mMinBound = true;
+    mDirtyEdges = 0;
     setModified(false);
 }
 
 BitmapImage::~BitmapImage()
 {
+    discardScratchFile();
 }
 
 void BitmapImage::setImage(QImage* img)
 {
     Q_CHECK_PTR(img);
+    discardScratchFile();
+    mCompressed.clear();
     mImage.reset(img);
-    mMinBound = false;
+    mDirtyEdges = AllEdges;
 
     modification();
 }
@@ -85,25 +96,89 @@ BitmapImage& BitmapImage::operator=(const BitmapImage& a)
 
     KeyFrame::operator=(a);
     mBounds = a.mBounds;
-    mMinBound = a.mMinBound;
+    mDirtyEdges = a.mDirtyEdges;
     mOpacity = a.mOpacity;
-    mImage.reset(new QImage(*a.mImage));
+    discardScratchFile();
+    copyImage(a);
     modification();
     return *this;
 }
 
 BitmapImage* BitmapImage::clone()
 {
+    loadFile(); // the frame may be compressed or swapped out
     return new BitmapImage(*this);
 }
 
+// The scratch files hold compressed frames, they only live while the program runs
+static bool writeScratchFile(const QByteArray& data, const QString& path)
+{
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly) && (file.write(data) == data.size());
+}
+
+static QByteArray readScratchFile(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
 void BitmapImage::loadFile()
 {
+    if (mImage == nullptr && !mCompressed.isEmpty())
+    {
+        mImage.reset(new QImage(FrameCompressor::decompress(mCompressed)));
+        mCompressed.clear();
+        Q_ASSERT(mImage->size() == mBounds.size());
+    }
+    if (mImage == nullptr && !mScratchFile.isEmpty())
+    {
+        // the image was swapped out, the result of the write is the compressed image only if it failed
+        QByteArray data = mScratchWrite.result();
+        if (data.isEmpty())
+        {
+            data = readScratchFile(mScratchFile);
+        }
+        discardScratchFile();
+        mImage.reset(new QImage(FrameCompressor::decompress(data)));
+        Q_ASSERT(mImage->size() == mBounds.size());
+    }
     if (mImage == nullptr)
     {
         mImage.reset(new QImage(fileName()));
         mBounds.setSize(mImage->size());
-        mMinBound = false;
+        mDirtyEdges = AllEdges;
+    }
+}
+
+/** @brief BitmapImage::copyImage
+ *  Copies the pixels of another image, which may be unloaded.
+ *  The other image stays as it is. A compressed or swapped out image is copied compressed,
+ *  an image that is only on disk is loaded by the copy when it's used.
+ */
+void BitmapImage::copyImage(const BitmapImage& a)
+{
+    mImage.reset();
+    mCompressed.clear();
+    if (a.mImage != nullptr)
+    {
+        mImage.reset(new QImage(*a.mImage));
+    }
+    else if (!a.mCompressed.isEmpty())
+    {
+        mCompressed = a.mCompressed;
+    }
+    else if (!a.mScratchFile.isEmpty())
+    {
+        mCompressed = a.mScratchWrite.result();
+        if (mCompressed.isEmpty())
+        {
+            mCompressed = readScratchFile(a.mScratchFile);
+        }
     }
 }
 
@@ -112,6 +187,7 @@ void BitmapImage::unloadFile()
     if (isModified() == false)
     {
         mImage.reset();
+        mCompressed.clear();
     }
 }
 
@@ -120,13 +196,70 @@ bool BitmapImage::isLoaded()
     return (mImage != nullptr);
 }
 
+/** @brief BitmapImage::compress
+ *  Keeps the image compressed in memory, when it's at least halved.
+ *  @return the size of the compressed image, 0 if the image stays loaded
+ */
+quint64 BitmapImage::compress()
+{
+    if (mImage == nullptr)
+    {
+        return 0;
+    }
+
+    QByteArray data = FrameCompressor::compress(*mImage);
+    if (quint64(data.size()) * 2 > imageSize(*mImage))
+    {
+        return 0;
+    }
+    mCompressed = data;
+    mImage.reset();
+    return quint64(mCompressed.size());
+}
+
+/** @brief BitmapImage::swapOut
+ *  Unloads a modified image, loaded or compressed. It's compressed and written to the scratch file
+ *  on a worker thread, loadFile() waits for the write if it's still going.
+ */
+bool BitmapImage::swapOut(const QString& scratchFile)
+{
+    if ((mImage == nullptr && mCompressed.isEmpty()) || !isModified())
+    {
+        return false;
+    }
+
+    discardScratchFile();
+    const QImage image = mImage ? *mImage : QImage();
+    const QByteArray compressed = mCompressed;
+    mScratchWrite = QtConcurrent::run([image, compressed, scratchFile]()
+    {
+        const QByteArray data = compressed.isEmpty() ? FrameCompressor::compress(image) : compressed;
+        return writeScratchFile(data, scratchFile) ? QByteArray() : data;
+    });
+    mScratchFile = scratchFile;
+    mImage.reset();
+    mCompressed.clear();
+    return true;
+}
+
+void BitmapImage::discardScratchFile()
+{
+    if (!mScratchFile.isEmpty())
+    {
+        mScratchWrite.waitForFinished();
+        QFile::remove(mScratchFile);
+        mScratchFile.clear();
+        mScratchWrite = QFuture<QByteArray>();
+    }
+}
+
 quint64 BitmapImage::memoryUsage()
 {
     if (mImage)
     {
         return imageSize(*mImage);
     }
-    return 0;
+    return quint64(mCompressed.size());
 }
 
 void BitmapImage::paintImage(QPainter& painter)
@@ -171,11 +304,15 @@ void BitmapImage::paste(BitmapImage* bitmapImage, QPainter::CompositionMode cm)
     setCompositionModeBounds(bitmapImage, cm);
 
     QImage* image2 = bitmapImage->image();
+    const QPoint offset = bitmapImage->mBounds.topLeft() - mBounds.topLeft();
 
-    QPainter painter(image());
-    painter.setCompositionMode(cm);
-    painter.drawImage(bitmapImage->mBounds.topLeft() - mBounds.topLeft(), *image2);
-    painter.end();
+    if (!BitmapCompositor::composite(*image(), offset, *image2, cm))
+    {
+        QPainter painter(image());
+        painter.setCompositionMode(cm);
+        painter.drawImage(offset, *image2);
+        painter.end();
+    }
 
     modification();
 }
@@ -201,6 +338,7 @@ void BitmapImage::transform(QRect newBoundaries, bool smoothTransform)
     painter.drawImage(newBoundaries, *image());
     painter.end();
     mImage.reset(newImage);
+    mDirtyEdges = AllEdges;
 
     modification();
 }
@@ -249,7 +387,8 @@ void BitmapImage::updateBounds(QRect newBoundaries)
 
     QImage* newImage = new QImage( newBoundaries.size(), QImage::Format_ARGB32_Premultiplied);
     newImage->fill(Qt::transparent);
-    if (!newImage->isNull())
+    if (!newImage->isNull()
+        && !BitmapCompositor::composite(*newImage, mBounds.topLeft() - newBoundaries.topLeft(), *mImage, QPainter::CompositionMode_Source))
     {
         QPainter painter(newImage);
         painter.drawImage(mBounds.topLeft() - newBoundaries.topLeft(), *mImage);
@@ -257,7 +396,6 @@ void BitmapImage::updateBounds(QRect newBoundaries)
     }
     mImage.reset( newImage );
     mBounds = newBoundaries;
-    mMinBound = false;
 
     modification();
 }
@@ -283,13 +421,17 @@ void BitmapImage::extend(QRect rectangle)
         QRect newBoundaries = mBounds.united(rectangle).normalized();
         QImage* newImage = new QImage(newBoundaries.size(), QImage::Format_ARGB32_Premultiplied);
         newImage->fill(Qt::transparent);
-        if (!newImage->isNull())
+        if (!newImage->isNull()
+            && !BitmapCompositor::composite(*newImage, mBounds.topLeft() - newBoundaries.topLeft(), *image(), QPainter::CompositionMode_Source))
         {
             QPainter painter(newImage);
             painter.drawImage(mBounds.topLeft() - newBoundaries.topLeft(), *image());
             painter.end();
         }
         mImage.reset(newImage);
+
+        // the edges that moved out are transparent for now
+        mDirtyEdges = unitedDirtyEdges(rectangle, AllEdges);
         mBounds = newBoundaries;
 
         modification();
@@ -307,7 +449,7 @@ void BitmapImage::setCompositionModeBounds(BitmapImage *source, QPainter::Compos
 {
     if (source)
     {
-        setCompositionModeBounds(source->mBounds, source->mMinBound, cm);
+        setCompositionModeBounds(source->mBounds, source->isMinimallyBounded(), cm);
     }
 }
 
@@ -325,6 +467,9 @@ void BitmapImage::setCompositionModeBounds(BitmapImage *source, QPainter::Compos
  * solely by the minimal bounds of this and source, depending on the value of cm.
  * Some composition modes only expand, or have no affect on the bounds.
  *
+ * The bounds are not cropped here, the edges that may have become transparent
+ * are only marked for the next autoCrop().
+ *
  * @warning The draw operation described by the arguments of this
  *          function needs to be called after this function is run,
  *          or the bounds will be out of sync. If mBounds is null,
@@ -332,34 +477,136 @@ void BitmapImage::setCompositionModeBounds(BitmapImage *source, QPainter::Compos
  */
 void BitmapImage::setCompositionModeBounds(QRect sourceBounds, bool isSourceMinBounds, QPainter::CompositionMode cm)
 {
-    QRect newBoundaries;
     switch(cm)
     {
     case QPainter::CompositionMode_Destination:
     case QPainter::CompositionMode_SourceAtop:
         // The Destination and SourceAtop modes
         // do not change the bounds from destination.
-        newBoundaries = mBounds;
-        // mMinBound remains the same
         break;
     case QPainter::CompositionMode_SourceIn:
     case QPainter::CompositionMode_DestinationIn:
+        // The SourceIn and DestinationIn modes can make
+        // any part of the destination transparent
+        if (!mBounds.isEmpty())
+        {
+            mDirtyEdges = AllEdges;
+        }
+        break;
+    case QPainter::CompositionMode_Source:
+        // The Source mode replaces the pixels under the source,
+        // transparent ones included, so the edges it reaches can shrink
+        if (!mBounds.contains(sourceBounds))
+        {
+            const quint8 dirtyEdges = unitedDirtyEdges(sourceBounds, isSourceMinBounds ? 0 : AllEdges) | edgesTouchedBy(sourceBounds);
+            updateBounds(mBounds.united(sourceBounds));
+            mDirtyEdges = dirtyEdges;
+        }
+        else
+        {
+            mDirtyEdges |= edgesTouchedBy(sourceBounds);
+        }
+        break;
     case QPainter::CompositionMode_Clear:
     case QPainter::CompositionMode_DestinationOut:
-        // The bounds of the result of SourceIn, DestinationIn, Clear, and DestinationOut
-        // modes are no larger than the destination bounds
-        newBoundaries = mBounds;
-        mMinBound = false;
+        // The Clear and DestinationOut modes only make the pixels
+        // under the source more transparent, so only the edges
+        // the source reaches can shrink
+        mDirtyEdges |= edgesTouchedBy(sourceBounds);
         break;
     default:
         // If it's not one of the above cases, create a union of the two bounds.
         // This contains the minimum bounds, if both the destination and source
         // use their respective minimum bounds.
-        newBoundaries = mBounds.united(sourceBounds);
-        mMinBound = mMinBound && isSourceMinBounds;
+        if (!mBounds.contains(sourceBounds))
+        {
+            const quint8 dirtyEdges = unitedDirtyEdges(sourceBounds, isSourceMinBounds ? 0 : AllEdges);
+            updateBounds(mBounds.united(sourceBounds));
+            mDirtyEdges = dirtyEdges;
+        }
+    }
+}
+
+/// The edges of the bounds that the rect reaches
+quint8 BitmapImage::edgesTouchedBy(const QRect& rect) const
+{
+    if (!rect.intersects(mBounds))
+        return 0;
+
+    quint8 edges = 0;
+    if (rect.top() <= mBounds.top()) edges |= TopEdge;
+    if (rect.bottom() >= mBounds.bottom()) edges |= BottomEdge;
+    if (rect.left() <= mBounds.left()) edges |= LeftEdge;
+    if (rect.right() >= mBounds.right()) edges |= RightEdge;
+    return edges;
+}
+
+/** Works out which edges of the union of mBounds and sourceBounds may be transparent.
+ *
+ *  An edge of the union comes from whichever bounds reach further on that side,
+ *  it can only be known to have visible pixels if that side does.
+ */
+quint8 BitmapImage::unitedDirtyEdges(const QRect& sourceBounds, quint8 sourceDirtyEdges) const
+{
+    if (sourceBounds.isEmpty())
+        return mDirtyEdges;
+
+    if (mBounds.isEmpty())
+        return sourceDirtyEdges;
+
+    auto unite = [this, sourceDirtyEdges](Edge edge, int destination, int source)
+    {
+        const bool dirty = (destination == source) ? ((mDirtyEdges & sourceDirtyEdges & edge) != 0)
+                         : (source > destination) ? ((sourceDirtyEdges & edge) != 0)
+                                                  : ((mDirtyEdges & edge) != 0);
+        return dirty ? quint8(edge) : quint8(0);
+    };
+
+    // measured outwards, the further out the larger
+    return unite(TopEdge, -mBounds.top(), -sourceBounds.top())
+         | unite(BottomEdge, mBounds.bottom(), sourceBounds.bottom())
+         | unite(LeftEdge, -mBounds.left(), -sourceBounds.left())
+         | unite(RightEdge, mBounds.right(), sourceBounds.right());
+}
+
+/** Tells whether a row of premultiplied pixels is fully transparent.
+ *  Checks four pixels at a time with SSE2 where available.
+ */
+bool BitmapImage::isRowTransparent(const QRgb* row, int count)
+{
+#ifdef BITMAPIMAGE_USE_SSE2
+    const __m128i alphaMask = _mm_set1_epi32(int(0xff000000));
+    const __m128i zero = _mm_setzero_si128();
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m128i* p = reinterpret_cast<const __m128i*>(row + i);
+        const __m128i any = _mm_or_si128(_mm_or_si128(_mm_loadu_si128(p), _mm_loadu_si128(p + 1)),
+                                         _mm_or_si128(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(any, alphaMask), zero)) != 0xffff)
+            return false;
+    }
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(pixels, alphaMask), zero)) != 0xffff)
+            return false;
     }
+    return isRowTransparentScalar(row + i, count - i);
+#else
+    return isRowTransparentScalar(row, count);
+#endif
+}
 
-    updateBounds(newBoundaries);
+bool BitmapImage::isRowTransparentScalar(const QRgb* row, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (qAlpha(row[i]) != 0)
+            return false;
+    }
+    return true;
 }
 
 /** Removes any transparent borders by reducing the boundaries.
@@ -370,6 +617,10 @@ void BitmapImage::setCompositionModeBounds(QRect sourceBounds, bool isSourceMinB
  *  (i.e. non-transparent pixel). Both mBounds and
  *  the size of #mImage are updated.
  *
+ *  Only the edges that may have become transparent since the last crop are scanned.
+ *  The bounds accessors don't call this, it is run when the image is saved
+ *  and when the canvas is idle after a change.
+ *
  *  @pre mBounds.size() == mImage->size()
  *  @post Either the first and last rows and columns all contain a
  *        pixel with alpha > 0 or mBounds.isEmpty() == true
@@ -384,141 +635,69 @@ void BitmapImage::autoCrop()
     Q_ASSERT(mBounds.size() == mImage->size());
 
     // Exit if already min bounded
-    if (mMinBound) return;
+    if (mDirtyEdges == 0) return;
 
     // Get image properties
     const int width = mImage->width();
+    auto row = [this](int y) { return reinterpret_cast<const QRgb*>(mImage->constScanLine(y)); };
 
     // Relative top and bottom row indices (inclusive)
     int relTop = 0;
-    int relBottom = mBounds.height()-1;
+    int relBottom = mBounds.height() - 1;
 
-    // Check top row
-    bool isEmpty = true; // Used to track if a non-transparent pixel has been found
-    while (isEmpty && relTop <= relBottom) // Loop through rows
+    // Remove empty rows from the top, then from the bottom
+    if (mDirtyEdges & TopEdge)
     {
-        // Point cursor to the first pixel in the current top row
-        const QRgb* cursor = reinterpret_cast<const QRgb*>(mImage->constScanLine(relTop));
-        for (int col = 0; col < width; col++) // Loop through pixels in row
-        {
-            // If the pixel is not transparent
-            // (i.e. alpha channel > 0)
-            if (qAlpha(*cursor) != 0)
-            {
-                // We've found a non-transparent pixel in row relTop,
-                // so we can stop looking for one
-                isEmpty = false;
-                break;
-            }
-            // Move cursor to point to the next pixel in the row
-            cursor++;
-        }
-        if (isEmpty)
+        while (relTop <= relBottom && isRowTransparent(row(relTop), width))
         {
-            // If the row we just checked was empty, increase relTop
-            // to remove the empty row from the top of the bounding box
             ++relTop;
         }
     }
-
-    // Check bottom row
-    isEmpty = true; // Reset isEmpty
-    while (isEmpty && relBottom >= relTop) // Loop through rows
+    if (mDirtyEdges & BottomEdge)
     {
-        // Point cursor to the first pixel in the current bottom row
-        const QRgb* cursor = reinterpret_cast<const QRgb*>(mImage->constScanLine(relBottom));
-        for (int col = 0; col < width; col++) // Loop through pixels in row
+        while (relBottom >= relTop && isRowTransparent(row(relBottom), width))
         {
-            // If the pixel is not transparent
-            // (i.e. alpha channel > 0)
-            if(qAlpha(*cursor) != 0)
-            {
-                // We've found a non-transparent pixel in row relBottom,
-                // so we can stop looking for one
-                isEmpty = false;
-                break;
-            }
-            // Move cursor to point to the next pixel in the row
-            ++cursor;
-        }
-        if (isEmpty)
-        {
-            // If the row we just checked was empty, decrease relBottom
-            // to remove the empty row from the bottom of the bounding box
             --relBottom;
         }
     }
 
     // Relative left and right column indices (inclusive)
     int relLeft = 0;
-    int relRight = mBounds.width()-1;
-
-    // Check left row
-    isEmpty = (relBottom >= relTop); // Check left only when
-    while (isEmpty && relBottom >= relTop && relLeft <= relRight) // Loop through columns
-    {
-        // Point cursor to the pixel at row relTop and column relLeft
-        const QRgb* cursor = reinterpret_cast<const QRgb*>(mImage->constScanLine(relTop)) + relLeft;
-        // Loop through pixels in column
-        // Note: we only need to loop from relTop to relBottom (inclusive)
-        //       not the full image height, because rows 0 to relTop-1 and
-        //       relBottom+1 to mBounds.height() have already been
-        //       confirmed to contain only transparent pixels
-        for (int row = relTop; row <= relBottom; row++)
-        {
-            // If the pixel is not transparent
-            // (i.e. alpha channel > 0)
-            if(qAlpha(*cursor) != 0)
-            {
-                // We've found a non-transparent pixel in column relLeft,
-                // so we can stop looking for one
-                isEmpty = false;
-                break;
-            }
-            // Move cursor to point to next pixel in the column
-            // Increment by width because the data is in row-major order
-            cursor += width;
-        }
-        if (isEmpty)
-        {
-            // If the column we just checked was empty, increase relLeft
-            // to remove the empty column from the left of the bounding box
-            ++relLeft;
-        }
-    }
+    int relRight = mBounds.width() - 1;
 
-    // Check right row
-    isEmpty = (relBottom >= relTop); // Reset isEmpty
-    while (isEmpty && relRight >= relLeft) // Loop through columns
+    // The columns are found a row at a time rather than a column at a time, which walks the memory
+    // in order. Each row only needs scanning up to the leftmost (and rightmost) pixel found so far.
+    // Note: we only need to look at rows relTop to relBottom (inclusive),
+    //       the others have already been confirmed to contain only transparent pixels
+    if (relBottom >= relTop && (mDirtyEdges & (LeftEdge | RightEdge)))
     {
-        // Point cursor to the pixel at row relTop and column relRight
-        const QRgb* cursor = reinterpret_cast<const QRgb*>(mImage->constScanLine(relTop)) + relRight;
-        // Loop through pixels in column
-        // Note: we only need to loop from relTop to relBottom (inclusive)
-        //       not the full image height, because rows 0 to relTop-1 and
-        //       relBottom+1 to mBounds.height()-1 have already been
-        //       confirmed to contain only transparent pixels
-        for (int row = relTop; row <= relBottom; row++)
+        int minX = (mDirtyEdges & LeftEdge) ? width : 0;
+        int maxX = (mDirtyEdges & RightEdge) ? -1 : width - 1;
+        for (int y = relTop; y <= relBottom && (minX > 0 || maxX < width - 1); y++)
         {
-            // If the pixel is not transparent
-            // (i.e. alpha channel > 0)
-            if(qAlpha(*cursor) != 0)
+            const QRgb* line = row(y);
+            if (isRowTransparent(line, width))
+                continue;
+
+            for (int x = 0; x < minX; x++)
             {
-                // We've found a non-transparent pixel in column relRight,
-                // so we can stop looking for one
-                isEmpty = false;
-                break;
+                if (qAlpha(line[x]) != 0)
+                {
+                    minX = x;
+                    break;
+                }
+            }
+            for (int x = width - 1; x > maxX; x--)
+            {
+                if (qAlpha(line[x]) != 0)
+                {
+                    maxX = x;
+                    break;
+                }
             }
-            // Move cursor to point to next pixel in the column
-            // Increment by width because the data is in row-major order
-            cursor += width;
-        }
-        if (isEmpty)
-        {
-            // If the column we just checked was empty, increase relRight
-            // to remove the empty column from the left of the bounding box
-            --relRight;
         }
+        relLeft = qMin(minX, relRight);
+        relRight = qMax(maxX, relLeft);
     }
 
     //qDebug() << "Original" << mBounds;
@@ -528,7 +707,7 @@ void BitmapImage::autoCrop()
 
     //qDebug() << "New bounds" << mBounds;
 
-    mMinBound = true;
+    mDirtyEdges = 0;
 }
 
 QRgb BitmapImage::pixel(int x, int y)
@@ -630,6 +809,43 @@ void BitmapImage::drawEllipse(QRectF rectangle, QPen pen, QBrush brush, QPainter
     modification();
 }
 
+/**
+ * @brief BitmapImage::drawDabs
+ * Draws brush dabs source-over, growing the image once for all of them.
+ */
+void BitmapImage::drawDabs(BrushDabEngine& engine, const QList<QPointF>& centers, const BrushDabEngine::Dab& dab)
+{
+    if (centers.isEmpty())
+        return;
+
+    setCompositionModeBounds(BrushDabEngine::dabsBounds(centers, dab.diameter), true, QPainter::CompositionMode_SourceOver);
+    if (!image()->isNull())
+    {
+        engine.drawDabs(*image(), mBounds.topLeft(), centers, dab);
+    }
+    modification();
+}
+
+/**
+ * @brief BitmapImage::drawSmudge
+ * Smudges or liquifies source along the points, the result is drawn source-over into this image.
+ * Only the pixels under the dabs are read from source, and this image grows once for all of them.
+ */
+void BitmapImage::drawSmudge(SmudgeEngine& engine, BitmapImage* source, QPointF from, const QList<QPointF>& points,
+                             const SmudgeEngine::Brush& brush, SmudgeEngine::Mode mode)
+{
+    if (points.isEmpty())
+        return;
+
+    setCompositionModeBounds(BrushDabEngine::dabsBounds(points, brush.diameter), true, QPainter::CompositionMode_SourceOver);
+    if (!image()->isNull())
+    {
+        // the bounds of the source as they are, cropping them would scan the whole frame
+        engine.drawStroke(*source->image(), source->mBounds.topLeft(), *image(), mBounds.topLeft(), from, points, brush, mode);
+    }
+    modification();
+}
+
 void BitmapImage::drawPath(QPainterPath path, QPen pen, QBrush brush,
                            QPainter::CompositionMode cm, bool antialiasing)
 {
@@ -679,6 +895,12 @@ void BitmapImage::drawPath(QPainterPath path, QPen pen, QBrush brush,
 
 Status BitmapImage::writeFile(const QString& filename)
 {
+    if (!mScratchFile.isEmpty() || !mCompressed.isEmpty())
+    {
+        loadFile();
+    }
+    autoCrop();
+
     if (mImage && !mImage->isNull())
     {
         bool b = mImage->save(filename);
@@ -702,7 +924,7 @@ void BitmapImage::clear()
 {
     mImage.reset(new QImage); // null image
     mBounds = QRect(0, 0, 0, 0);
-    mMinBound = true;
+    mDirtyEdges = 0;
     modification();
 }
 
@@ -734,10 +956,10 @@ void BitmapImage::scanLine(int x, int y, QRgb color)
 void BitmapImage::clear(QRect rectangle)
 {
     QRect clearRectangle = mBounds.intersected(rectangle);
-    clearRectangle.moveTopLeft(clearRectangle.topLeft() - mBounds.topLeft());
-
     setCompositionModeBounds(clearRectangle, true, QPainter::CompositionMode_Clear);
 
+    clearRectangle.moveTopLeft(clearRectangle.topLeft() - mBounds.topLeft());
+
     QPainter painter(image());
     painter.setCompositionMode(QPainter::CompositionMode_Clear);
     painter.fillRect(clearRectangle, QColor(0, 0, 0, 0));
@@ -18,8 +18,11 @@ GNU General Public License for more details.
 #define BITMAP_IMAGE_H
 
 #include <memory>
+#include <QFuture>
 #include <QPainter>
 #include "keyframe.h"
+#include "brushdabengine.h"
+#include "smudgeengine.h"
 
 
 class BitmapImage : public KeyFrame
@@ -38,6 +41,8 @@ public:
     void loadFile() override;
     void unloadFile() override;
     bool isLoaded() override;
+    quint64 compress() override;
+    bool swapOut(const QString& scratchFile) override;
     quint64 memoryUsage() override;
 
     void paintImage(QPainter& painter);
@@ -62,6 +67,9 @@ public:
     bool contains(QPointF P) { return contains(P.toPoint()); }
     void autoCrop();
 
+    static bool isRowTransparent(const QRgb* row, int count);
+    static bool isRowTransparentScalar(const QRgb* row, int count);
+
     QRgb pixel(int x, int y);
     QRgb pixel(QPoint p);
     void setPixel(int x, int y, QRgb color);
@@ -81,21 +89,26 @@ public:
     void drawRect(QRectF rectangle, QPen pen, QBrush brush, QPainter::CompositionMode cm, bool antialiasing);
     void drawEllipse(QRectF rectangle, QPen pen, QBrush brush, QPainter::CompositionMode cm, bool antialiasing);
     void drawPath(QPainterPath path, QPen pen, QBrush brush, QPainter::CompositionMode cm, bool antialiasing);
-
-    QPoint topLeft() { autoCrop(); return mBounds.topLeft(); }
-    QPoint topRight() { autoCrop(); return mBounds.topRight(); }
-    QPoint bottomLeft() { autoCrop(); return mBounds.bottomLeft(); }
-    QPoint bottomRight() { autoCrop(); return mBounds.bottomRight(); }
-    int left() { autoCrop(); return mBounds.left(); }
-    int right() { autoCrop(); return mBounds.right(); }
-    int top() { autoCrop(); return mBounds.top(); }
-    int bottom() { autoCrop(); return mBounds.bottom(); }
-    int width() { autoCrop(); return mBounds.width(); }
-    int height() { autoCrop(); return mBounds.height(); }
-    QSize size() { autoCrop(); return mBounds.size(); }
-
-
-    QRect& bounds() { autoCrop(); return mBounds; }
+    void drawDabs(BrushDabEngine& engine, const QList<QPointF>& centers, const BrushDabEngine::Dab& dab);
+    void drawSmudge(SmudgeEngine& engine, BitmapImage* source, QPointF from, const QList<QPointF>& points,
+                    const SmudgeEngine::Brush& brush, SmudgeEngine::Mode mode);
+
+    /* The bounds contain every visible pixel, but may have transparent edges
+     * until the next autoCrop(), which happens when the image is saved or the canvas is idle. */
+    QPoint topLeft() { return mBounds.topLeft(); }
+    QPoint topRight() { return mBounds.topRight(); }
+    QPoint bottomLeft() { return mBounds.bottomLeft(); }
+    QPoint bottomRight() { return mBounds.bottomRight(); }
+    int left() { return mBounds.left(); }
+    int right() { return mBounds.right(); }
+    int top() { return mBounds.top(); }
+    int bottom() { return mBounds.bottom(); }
+    int width() { return mBounds.width(); }
+    int height() { return mBounds.height(); }
+    QSize size() { return mBounds.size(); }
+
+
+    QRect& bounds() { return mBounds; }
 
     /** Determines if the BitmapImage is minimally bounded.
      *
@@ -107,7 +120,7 @@ public:
      *  @return True only if bounds() is the minimal bounding box
      *          for the contained image.
      */
-    bool isMinimallyBounded() const { return mMinBound; }
+    bool isMinimallyBounded() const { return mDirtyEdges == 0; }
     void enableAutoCrop(bool b) { mEnableAutoCrop = b; }
     void setOpacity(qreal opacity) { mOpacity = opacity; }
     qreal getOpacity() const { return mOpacity; }
@@ -123,11 +136,34 @@ protected:
     void setCompositionModeBounds(QRect sourceBounds, bool isSourceMinBounds, QPainter::CompositionMode cm);
 
 private:
+    /// The edges of the bounds that may have become transparent
+    enum Edge : quint8
+    {
+        TopEdge = 1,
+        BottomEdge = 2,
+        LeftEdge = 4,
+        RightEdge = 8,
+        AllEdges = TopEdge | BottomEdge | LeftEdge | RightEdge
+    };
+
+    quint8 edgesTouchedBy(const QRect& rect) const;
+    quint8 unitedDirtyEdges(const QRect& sourceBounds, quint8 sourceDirtyEdges) const;
+    void copyImage(const BitmapImage& a);
+    void discardScratchFile();
+
     std::unique_ptr<QImage> mImage;
     QRect mBounds;
 
-    /** @see isMinimallyBounded() */
-    bool mMinBound = true;
+    QByteArray mCompressed; ///< the image while it's compressed, see FrameCompressor
+
+    /** Where the modified image was swapped out to, and the write in progress.
+     *  The write gives the compressed image back if it could not be written. */
+    QString mScratchFile;
+    QFuture<QByteArray> mScratchWrite;
+
+    /** The Edge flags of the edges autoCrop() has to scan, none when minimally bounded.
+     *  @see isMinimallyBounded() */
+    quint8 mDirtyEdges = 0;
     bool mEnableAutoCrop = false;
     qreal mOpacity = 1.0;
 };
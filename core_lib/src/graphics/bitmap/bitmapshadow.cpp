@@ -0,0 +1,165 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "bitmapshadow.h"
+
+#include <QPainter>
+#include "bitmapimage.h"
+#include "bitmapcompositor.h"
+
+
+/**
+ * @brief BitmapShadow::begin
+ * Starts shadowing the target frame, dropping the tiles of the previous target if any.
+ */
+void BitmapShadow::begin(BitmapImage* target)
+{
+    mTiles.clear();
+    mTarget = target;
+    mTargetBounds = (target != nullptr) ? target->bounds() : QRect();
+}
+
+/**
+ * @brief BitmapShadow::changedRect
+ * @return the canvas area covered by the tiles, the only part of the frame the stroke can have changed
+ */
+QRect BitmapShadow::changedRect() const
+{
+    QRect rect;
+    for (const Tile& t : mTiles)
+    {
+        rect |= QRect(t.topLeft, t.image.size());
+    }
+    return rect;
+}
+
+/**
+ * @brief BitmapShadow::eraseDabs
+ * Takes the dabs out of the shadow tiles, see BrushDabEngine::eraseDabs().
+ * Erasing outside of the frame has nothing to erase, the frame is never extended.
+ */
+void BitmapShadow::eraseDabs(BrushDabEngine& engine, const QList<QPointF>& centers, const BrushDabEngine::Dab& dab)
+{
+    if (!isActive())
+        return;
+
+    const QRect area = BrushDabEngine::dabsBounds(centers, dab.diameter) & mTargetBounds;
+    if (area.isEmpty())
+        return;
+
+    const QPoint origin = mTargetBounds.topLeft();
+    for (int row = (area.top() - origin.y()) / TILE_SIZE; row <= (area.bottom() - origin.y()) / TILE_SIZE; row++)
+    {
+        for (int column = (area.left() - origin.x()) / TILE_SIZE; column <= (area.right() - origin.x()) / TILE_SIZE; column++)
+        {
+            Tile& t = tile(column, row);
+            engine.eraseDabs(t.image, t.topLeft, centers, dab);
+        }
+    }
+}
+
+/**
+ * @brief BitmapShadow::paint
+ * Replaces the pixels of image under the tiles with the shadowed ones.
+ * @param image: a picture of the target frame, or of part of it
+ * @param imageTopLeft: the canvas position of the top left pixel of image
+ */
+void BitmapShadow::paint(QImage& image, QPoint imageTopLeft) const
+{
+    const QRect imageRect(imageTopLeft, image.size());
+    for (const Tile& t : mTiles)
+    {
+        const QRect tileRect(t.topLeft, t.image.size());
+        if (!tileRect.intersects(imageRect))
+            continue;
+
+        if (!BitmapCompositor::composite(image, t.topLeft - imageTopLeft, t.image, QPainter::CompositionMode_Source))
+        {
+            QPainter painter(&image);
+            painter.setCompositionMode(QPainter::CompositionMode_Source);
+            painter.drawImage(t.topLeft - imageTopLeft, t.image);
+        }
+    }
+}
+
+/**
+ * @brief BitmapShadow::paint
+ * Draws the target frame with the tiles in place of the parts they cover, the frame isn't copied.
+ * @param painter: a painter set up for canvas coordinates
+ */
+void BitmapShadow::paint(QPainter& painter) const
+{
+    if (!isActive())
+        return;
+
+    QRegion covered;
+    for (const Tile& t : mTiles)
+    {
+        covered += QRect(t.topLeft, t.image.size());
+    }
+
+    // the erased pixels must not show the frame underneath, so it's clipped out of the tiles
+    painter.save();
+    painter.setClipRegion(QRegion(mTarget->bounds()) - covered, Qt::IntersectClip);
+    mTarget->paintImage(painter);
+    painter.restore();
+
+    for (const Tile& t : mTiles)
+    {
+        painter.drawImage(t.topLeft, t.image);
+    }
+}
+
+/**
+ * @brief BitmapShadow::commit
+ * Writes the tiles into the target frame and stops shadowing it.
+ */
+void BitmapShadow::commit()
+{
+    if (mTarget != nullptr)
+    {
+        for (const Tile& t : mTiles)
+        {
+            BitmapImage patch(t.topLeft, t.image);
+            mTarget->paste(&patch, QPainter::CompositionMode_Source);
+        }
+    }
+    begin(nullptr);
+}
+
+/**
+ * @brief BitmapShadow::rollback
+ * Stops shadowing the target frame, leaving it as it was before the stroke.
+ */
+void BitmapShadow::rollback()
+{
+    begin(nullptr);
+}
+
+BitmapShadow::Tile& BitmapShadow::tile(int column, int row)
+{
+    const quint64 key = (quint64(quint32(row)) << 32) | quint32(column);
+    auto it = mTiles.find(key);
+    if (it != mTiles.end())
+        return it.value();
+
+    const QPoint origin = mTargetBounds.topLeft();
+    const QRect rect = QRect(origin.x() + column * TILE_SIZE, origin.y() + row * TILE_SIZE, TILE_SIZE, TILE_SIZE) & mTargetBounds;
+
+    Tile& t = mTiles[key];
+    t.topLeft = rect.topLeft();
+    t.image = mTarget->image()->copy(rect.translated(-mTarget->bounds().topLeft())).convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    return t;
+}
@@ -0,0 +1,71 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#ifndef BITMAPSHADOW_H
+#define BITMAPSHADOW_H
+
+#include <QHash>
+#include <QImage>
+#include "brushdabengine.h"
+
+class BitmapImage;
+class QPainter;
+
+
+/**
+ * A shadow copy of the parts of a bitmap frame that a stroke changes.
+ *
+ * The frame is cut in tiles of TILE_SIZE pixels, aligned on its top left corner. The first
+ * time a stroke reaches a tile, the tile is copied from the frame and the stroke is applied
+ * to the copy from then on, so the frame itself is left as it was until commit(), and
+ * rollback() only has to drop the copies.
+ *
+ * paint() shows the stroke in progress by putting the tiles over a picture of the frame,
+ * or draws the frame and the tiles straight with a painter when there is nothing else to mix in.
+ */
+class BitmapShadow
+{
+public:
+    static const int TILE_SIZE = 64;
+
+    void begin(BitmapImage* target);
+    bool isActive() const { return mTarget != nullptr; }
+    BitmapImage* target() const { return mTarget; }
+
+    int tileCount() const { return mTiles.size(); }
+    QRect changedRect() const;
+
+    void eraseDabs(BrushDabEngine& engine, const QList<QPointF>& centers, const BrushDabEngine::Dab& dab);
+    void paint(QImage& image, QPoint imageTopLeft) const;
+    void paint(QPainter& painter) const;
+
+    void commit();
+    void rollback();
+
+private:
+    struct Tile
+    {
+        QPoint topLeft;   ///< canvas position of the top left pixel
+        QImage image;
+    };
+
+    Tile& tile(int column, int row);
+
+    BitmapImage* mTarget = nullptr;
+    QRect mTargetBounds;           ///< the bounds of the frame when the shadow began
+    QHash<quint64, Tile> mTiles;
+};
+
+#endif // BITMAPSHADOW_H
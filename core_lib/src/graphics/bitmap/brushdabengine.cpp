@@ -0,0 +1,325 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "brushdabengine.h"
+
+#include <cmath>
+#include <QtMath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BRUSHDAB_USE_SSE2
+#endif
+
+
+namespace
+{
+    // x / 255 rounded, exact for the product of two 8 bit values
+    inline uint div255(uint x)
+    {
+        x += 128;
+        return (x + (x >> 8)) >> 8;
+    }
+
+    inline int stampSize(qreal diameter)
+    {
+        return qMax(1, int(std::ceil(diameter)) + 1);
+    }
+
+    inline QPoint stampTopLeft(QPointF center, int size)
+    {
+        return QPoint(qFloor(center.x() - size / 2.0 + 0.5), qFloor(center.y() - size / 2.0 + 0.5));
+    }
+
+    // opacity of the dab at a distance d from its center, in radii
+    inline qreal profile(qreal d, qreal feather)
+    {
+        if (d >= 1.0)
+            return 0.0;
+
+        const qreal hardness = 1.0 - feather / 100.0;
+        if (d <= hardness)
+            return 1.0;
+
+        return (1.0 - d) / (1.0 - hardness);
+    }
+}
+
+BrushDabEngine::BrushDabEngine(int maxCachedStamps) : mMaxCachedStamps(maxCachedStamps)
+{
+}
+
+QRect BrushDabEngine::dabBounds(QPointF center, qreal diameter)
+{
+    const int size = stampSize(diameter);
+    return QRect(stampTopLeft(center, size), QSize(size, size));
+}
+
+QRect BrushDabEngine::dabsBounds(const QList<QPointF>& centers, qreal diameter)
+{
+    QRect bounds;
+    for (const QPointF& center : centers)
+    {
+        bounds |= dabBounds(center, diameter);
+    }
+    return bounds;
+}
+
+/**
+ * @brief BrushDabEngine::drawDabs
+ * @param target: an ARGB32 premultiplied image
+ * @param targetTopLeft: the canvas position of the top left pixel of the target
+ * @param centers: the dab centers, in canvas coordinates
+ * @param dab: the shape and color shared by all the dabs
+ *
+ * Dabs falling outside the target are clipped, grow the target beforehand with dabsBounds().
+ */
+void BrushDabEngine::drawDabs(QImage& target, QPoint targetTopLeft, const QList<QPointF>& centers, const Dab& dab)
+{
+    stampDabs(target, targetTopLeft, centers, dab, false);
+}
+
+/**
+ * @brief BrushDabEngine::eraseDabs
+ * Like drawDabs(), but the dabs take their opacity out of the target instead of painting over it,
+ * the way a destination-out composition of drawn dabs would. Only the alpha of the dab color counts.
+ */
+void BrushDabEngine::eraseDabs(QImage& target, QPoint targetTopLeft, const QList<QPointF>& centers, const Dab& dab)
+{
+    stampDabs(target, targetTopLeft, centers, dab, true);
+}
+
+void BrushDabEngine::stampDabs(QImage& target, QPoint targetTopLeft, const QList<QPointF>& centers, const Dab& dab, bool erase)
+{
+    Q_ASSERT(target.format() == QImage::Format_ARGB32_Premultiplied);
+    if (centers.isEmpty() || target.isNull())
+        return;
+
+    const Stamp& mask = stamp(dab);
+    const QRgb color = qPremultiply(dab.color.rgba());
+    if (qAlpha(color) == 0)
+        return;
+
+    const QRect targetRect(targetTopLeft, target.size());
+    uchar* bits = target.bits();
+    const int bytesPerLine = target.bytesPerLine();
+
+    for (const QPointF& center : centers)
+    {
+        const QRect dabRect(stampTopLeft(center, mask.size), QSize(mask.size, mask.size));
+        const QRect clipped = dabRect & targetRect;
+        if (clipped.isEmpty())
+            continue;
+
+        const int maskX = clipped.left() - dabRect.left();
+        const int targetX = clipped.left() - targetRect.left();
+        for (int y = clipped.top(); y <= clipped.bottom(); y++)
+        {
+            const quint8* maskRow = mask.alpha.constData() + (y - dabRect.top()) * mask.size + maskX;
+            QRgb* targetRow = reinterpret_cast<QRgb*>(bits + (y - targetRect.top()) * bytesPerLine) + targetX;
+            if (erase)
+            {
+                eraseRow(targetRow, maskRow, clipped.width(), qAlpha(color));
+            }
+            else
+            {
+                blendRow(targetRow, maskRow, clipped.width(), color);
+            }
+        }
+    }
+}
+
+/**
+ * @brief BrushDabEngine::blendRow
+ * Source-over of color, scaled by the mask, on count premultiplied pixels.
+ * Processes four pixels at a time with SSE2 where available.
+ */
+void BrushDabEngine::blendRow(QRgb* dst, const quint8* mask, int count, QRgb color)
+{
+#ifdef BRUSHDAB_USE_SSE2
+    const uint colorAlpha = qAlpha(color);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi16(128);
+    const __m128i color16 = _mm_unpacklo_epi8(_mm_set1_epi32(int(color)), zero);
+
+    // (x + 128 + ((x + 128) >> 8)) >> 8 on 8 lanes
+    auto div255x8 = [half](__m128i x)
+    {
+        x = _mm_add_epi16(x, half);
+        return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+    };
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint m0 = mask[i], m1 = mask[i + 1], m2 = mask[i + 2], m3 = mask[i + 3];
+        if ((m0 | m1 | m2 | m3) == 0)
+            continue;
+
+        const short k0 = short(255 - div255(colorAlpha * m0));
+        const short k1 = short(255 - div255(colorAlpha * m1));
+        const short k2 = short(255 - div255(colorAlpha * m2));
+        const short k3 = short(255 - div255(colorAlpha * m3));
+
+        __m128i* p = reinterpret_cast<__m128i*>(dst + i);
+        const __m128i d = _mm_loadu_si128(p);
+
+        const __m128i maskLo = _mm_set_epi16(short(m1), short(m1), short(m1), short(m1), short(m0), short(m0), short(m0), short(m0));
+        const __m128i maskHi = _mm_set_epi16(short(m3), short(m3), short(m3), short(m3), short(m2), short(m2), short(m2), short(m2));
+        const __m128i keepLo = _mm_set_epi16(k1, k1, k1, k1, k0, k0, k0, k0);
+        const __m128i keepHi = _mm_set_epi16(k3, k3, k3, k3, k2, k2, k2, k2);
+
+        const __m128i lo = _mm_add_epi16(div255x8(_mm_mullo_epi16(color16, maskLo)),
+                                         div255x8(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), keepLo)));
+        const __m128i hi = _mm_add_epi16(div255x8(_mm_mullo_epi16(color16, maskHi)),
+                                         div255x8(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), keepHi)));
+        _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+    }
+    blendRowScalar(dst + i, mask + i, count - i, color);
+#else
+    blendRowScalar(dst, mask, count, color);
+#endif
+}
+
+void BrushDabEngine::blendRowScalar(QRgb* dst, const quint8* mask, int count, QRgb color)
+{
+    const uint colorAlpha = qAlpha(color);
+    for (int i = 0; i < count; i++)
+    {
+        const uint m = mask[i];
+        if (m == 0)
+            continue;
+
+        const uint keep = 255 - div255(colorAlpha * m);
+        const QRgb d = dst[i];
+        dst[i] = qRgba(int(div255(qRed(color) * m) + div255(qRed(d) * keep)),
+                       int(div255(qGreen(color) * m) + div255(qGreen(d) * keep)),
+                       int(div255(qBlue(color) * m) + div255(qBlue(d) * keep)),
+                       int(div255(colorAlpha * m) + div255(qAlpha(d) * keep)));
+    }
+}
+
+/**
+ * @brief BrushDabEngine::eraseRow
+ * Destination-out of alpha, scaled by the mask, on count premultiplied pixels.
+ * Processes four pixels at a time with SSE2 where available.
+ */
+void BrushDabEngine::eraseRow(QRgb* dst, const quint8* mask, int count, int alpha)
+{
+#ifdef BRUSHDAB_USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi16(128);
+
+    auto div255x8 = [half](__m128i x)
+    {
+        x = _mm_add_epi16(x, half);
+        return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+    };
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint m0 = mask[i], m1 = mask[i + 1], m2 = mask[i + 2], m3 = mask[i + 3];
+        if ((m0 | m1 | m2 | m3) == 0)
+            continue;
+
+        const short k0 = short(255 - div255(uint(alpha) * m0));
+        const short k1 = short(255 - div255(uint(alpha) * m1));
+        const short k2 = short(255 - div255(uint(alpha) * m2));
+        const short k3 = short(255 - div255(uint(alpha) * m3));
+
+        __m128i* p = reinterpret_cast<__m128i*>(dst + i);
+        const __m128i d = _mm_loadu_si128(p);
+
+        const __m128i keepLo = _mm_set_epi16(k1, k1, k1, k1, k0, k0, k0, k0);
+        const __m128i keepHi = _mm_set_epi16(k3, k3, k3, k3, k2, k2, k2, k2);
+
+        const __m128i lo = div255x8(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), keepLo));
+        const __m128i hi = div255x8(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), keepHi));
+        _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+    }
+    eraseRowScalar(dst + i, mask + i, count - i, alpha);
+#else
+    eraseRowScalar(dst, mask, count, alpha);
+#endif
+}
+
+void BrushDabEngine::eraseRowScalar(QRgb* dst, const quint8* mask, int count, int alpha)
+{
+    for (int i = 0; i < count; i++)
+    {
+        const uint m = mask[i];
+        if (m == 0)
+            continue;
+
+        const uint keep = 255 - div255(uint(alpha) * m);
+        const QRgb d = dst[i];
+        dst[i] = qRgba(int(div255(qRed(d) * keep)), int(div255(qGreen(d) * keep)),
+                       int(div255(qBlue(d) * keep)), int(div255(qAlpha(d) * keep)));
+    }
+}
+
+const BrushDabEngine::Stamp& BrushDabEngine::stamp(const Dab& dab)
+{
+    // quarter pixel diameters and whole feather percents look the same
+    const quint32 key = (quint32(qRound(dab.diameter * 4.0)) << 8)
+                      | (quint32(qBound(0, qRound(dab.feather), 100)) << 1)
+                      | (dab.antialias ? 1u : 0u);
+
+    auto it = mStamps.constFind(key);
+    if (it != mStamps.constEnd())
+        return it.value();
+
+    mCacheMisses++;
+    if (mStamps.size() >= mMaxCachedStamps)
+    {
+        // pressure strokes go through many sizes, don't let them pile up
+        mStamps.clear();
+    }
+    return mStamps[key] = createStamp(qRound(dab.diameter * 4.0) / 4.0, qBound(0, qRound(dab.feather), 100), dab.antialias);
+}
+
+BrushDabEngine::Stamp BrushDabEngine::createStamp(qreal diameter, qreal feather, bool antialias)
+{
+    Stamp stamp;
+    stamp.size = stampSize(diameter);
+    stamp.alpha.resize(stamp.size * stamp.size);
+
+    const qreal radius = qMax(diameter, qreal(0.5)) / 2.0;
+    const qreal center = stamp.size / 2.0;
+
+    // 4x4 samples per pixel when antialiased, the pixel center otherwise
+    const int samples = antialias ? 4 : 1;
+    const qreal sampleWeight = 1.0 / (samples * samples);
+
+    for (int y = 0; y < stamp.size; y++)
+    {
+        for (int x = 0; x < stamp.size; x++)
+        {
+            qreal value = 0.0;
+            for (int sy = 0; sy < samples; sy++)
+            {
+                for (int sx = 0; sx < samples; sx++)
+                {
+                    const qreal dx = x + (sx + 0.5) / samples - center;
+                    const qreal dy = y + (sy + 0.5) / samples - center;
+                    value += profile(std::sqrt(dx * dx + dy * dy) / radius, feather);
+                }
+            }
+            stamp.alpha[y * stamp.size + x] = quint8(qRound(value * sampleWeight * 255.0));
+        }
+    }
+    return stamp;
+}
@@ -0,0 +1,82 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#ifndef BRUSHDABENGINE_H
+#define BRUSHDABENGINE_H
+
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QVector>
+#include <QColor>
+
+
+/**
+ * Stamps round brush dabs into an ARGB32 premultiplied image.
+ *
+ * The shape of a dab (an alpha mask for a given diameter, feather and antialiasing)
+ * is computed once and cached, every dab is then a source-over blend of the mask,
+ * tinted by the dab color, straight into the rows of the target image. Erasing dabs
+ * are a destination-out of the mask instead.
+ *
+ * The feathered profile matches the radial gradient of ScribbleArea::setGaussianGradient:
+ * flat up to (1 - feather / 100) of the radius, then fading linearly to the edge.
+ */
+class BrushDabEngine
+{
+public:
+    struct Dab
+    {
+        qreal diameter = 1.0;
+        qreal feather = 0.0;   ///< 0 to 100, see ScribbleArea::setGaussianGradient
+        bool antialias = false;
+        QColor color;          ///< the alpha of the color already includes the dab opacity
+    };
+
+    /// the alpha mask of a dab, size x size pixels placed at dabBounds()
+    struct Stamp
+    {
+        int size = 0;
+        QVector<quint8> alpha;
+    };
+
+    explicit BrushDabEngine(int maxCachedStamps = 64);
+
+    static QRect dabBounds(QPointF center, qreal diameter);
+    static QRect dabsBounds(const QList<QPointF>& centers, qreal diameter);
+
+    void drawDabs(QImage& target, QPoint targetTopLeft, const QList<QPointF>& centers, const Dab& dab);
+    void eraseDabs(QImage& target, QPoint targetTopLeft, const QList<QPointF>& centers, const Dab& dab);
+    const Stamp& stamp(const Dab& dab);
+
+    int cachedStampCount() const { return mStamps.size(); }
+    int stampCacheMisses() const { return mCacheMisses; }
+    void clearCache() { mStamps.clear(); }
+
+    static void blendRow(QRgb* dst, const quint8* mask, int count, QRgb color);
+    static void blendRowScalar(QRgb* dst, const quint8* mask, int count, QRgb color);
+    static void eraseRow(QRgb* dst, const quint8* mask, int count, int alpha);
+    static void eraseRowScalar(QRgb* dst, const quint8* mask, int count, int alpha);
+
+private:
+    void stampDabs(QImage& target, QPoint targetTopLeft, const QList<QPointF>& centers, const Dab& dab, bool erase);
+    static Stamp createStamp(qreal diameter, qreal feather, bool antialias);
+
+    QHash<quint32, Stamp> mStamps;
+    int mMaxCachedStamps = 64;
+    int mCacheMisses = 0;
+};
+
+#endif // BRUSHDABENGINE_H
@@ -0,0 +1,140 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "frameaccumulator.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRAMEACCUMULATOR_USE_SSE2
+#endif
+
+
+/** @brief FrameAccumulator::add
+ * Adds a sample. The first one sets the size, the next ones must have the same.
+ */
+void FrameAccumulator::add(const QImage& sample)
+{
+    Q_ASSERT(sample.format() == QImage::Format_ARGB32_Premultiplied);
+    Q_ASSERT(mSampleCount < MAX_SAMPLES);
+
+    if (mSampleCount == 0)
+    {
+        mSize = sample.size();
+        mSums.fill(0, mSize.width() * mSize.height() * 4);
+    }
+    Q_ASSERT(sample.size() == mSize);
+
+    const int width = mSize.width();
+    for (int y = 0; y < mSize.height(); y++)
+    {
+        const QRgb* line = reinterpret_cast<const QRgb*>(sample.constScanLine(y));
+        addRow(mSums.data() + y * width * 4, line, width);
+    }
+    mSampleCount++;
+}
+
+void FrameAccumulator::clear()
+{
+    mSize = QSize();
+    mSampleCount = 0;
+    mSums.clear();
+}
+
+QImage FrameAccumulator::average() const
+{
+    if (mSampleCount == 0)
+    {
+        return QImage();
+    }
+
+    QImage image(mSize, QImage::Format_ARGB32_Premultiplied);
+    const int width = mSize.width();
+    for (int y = 0; y < mSize.height(); y++)
+    {
+        averageRow(reinterpret_cast<QRgb*>(image.scanLine(y)), mSums.constData() + y * width * 4, width, mSampleCount);
+    }
+    return image;
+}
+
+void FrameAccumulator::addRow(quint16* sums, const QRgb* src, int count)
+{
+#ifdef FRAMEACCUMULATOR_USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i* s = reinterpret_cast<__m128i*>(sums + i * 4);
+        _mm_storeu_si128(s, _mm_add_epi16(_mm_loadu_si128(s), _mm_unpacklo_epi8(pixels, zero)));
+        _mm_storeu_si128(s + 1, _mm_add_epi16(_mm_loadu_si128(s + 1), _mm_unpackhi_epi8(pixels, zero)));
+    }
+    addRowScalar(sums + i * 4, src + i, count - i);
+#else
+    addRowScalar(sums, src, count);
+#endif
+}
+
+void FrameAccumulator::addRowScalar(quint16* sums, const QRgb* src, int count)
+{
+    const quint8* bytes = reinterpret_cast<const quint8*>(src);
+    for (int i = 0; i < count * 4; i++)
+    {
+        sums[i] = quint16(sums[i] + bytes[i]);
+    }
+}
+
+/** @brief FrameAccumulator::averageRow
+ * Divides the sums by the sample count, rounded to the nearest value.
+ * Premultiplied pixels stay valid: a channel never gets above its alpha.
+ */
+void FrameAccumulator::averageRow(QRgb* dst, const quint16* sums, int count, int sampleCount)
+{
+#ifdef FRAMEACCUMULATOR_USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 scale = _mm_set1_ps(1.0f / sampleCount);
+    const __m128 half = _mm_set1_ps(0.5f);
+
+    auto divide = [=](__m128i x)
+    {
+        return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(x), scale), half));
+    };
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i* s = reinterpret_cast<const __m128i*>(sums + i * 4);
+        const __m128i lo = _mm_loadu_si128(s);
+        const __m128i hi = _mm_loadu_si128(s + 1);
+
+        const __m128i lo16 = _mm_packs_epi32(divide(_mm_unpacklo_epi16(lo, zero)), divide(_mm_unpackhi_epi16(lo, zero)));
+        const __m128i hi16 = _mm_packs_epi32(divide(_mm_unpacklo_epi16(hi, zero)), divide(_mm_unpackhi_epi16(hi, zero)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo16, hi16));
+    }
+    averageRowScalar(dst + i, sums + i * 4, count - i, sampleCount);
+#else
+    averageRowScalar(dst, sums, count, sampleCount);
+#endif
+}
+
+void FrameAccumulator::averageRowScalar(QRgb* dst, const quint16* sums, int count, int sampleCount)
+{
+    const float scale = 1.0f / sampleCount;
+    quint8* bytes = reinterpret_cast<quint8*>(dst);
+    for (int i = 0; i < count * 4; i++)
+    {
+        bytes[i] = quint8(int(float(sums[i]) * scale + 0.5f));
+    }
+}
@@ -0,0 +1,56 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#ifndef FRAMEACCUMULATOR_H
+#define FRAMEACCUMULATOR_H
+
+#include <QImage>
+#include <QVector>
+
+
+/**
+ * Averages ARGB32 premultiplied images of the same size, e.g. the samples of a motion blurred frame.
+ *
+ * Each channel of each pixel is summed in 16 bits, which holds up to 257 samples.
+ * Rows are summed sixteen channels at a time with SSE2 where available, the scalar
+ * version gives the same result on the remaining pixels and on other CPUs.
+ */
+class FrameAccumulator
+{
+public:
+    static const int MAX_SAMPLES = 257;
+
+    FrameAccumulator() = default;
+
+    void add(const QImage& sample);
+    void clear();
+
+    int sampleCount() const { return mSampleCount; }
+    QSize size() const { return mSize; }
+
+    QImage average() const;
+
+    static void addRow(quint16* sums, const QRgb* src, int count);
+    static void addRowScalar(quint16* sums, const QRgb* src, int count);
+    static void averageRow(QRgb* dst, const quint16* sums, int count, int sampleCount);
+    static void averageRowScalar(QRgb* dst, const quint16* sums, int count, int sampleCount);
+
+private:
+    QSize mSize;
+    int mSampleCount = 0;
+    QVector<quint16> mSums; ///< four channels per pixel, in the byte order of the pixels
+};
+
+#endif // FRAMEACCUMULATOR_H
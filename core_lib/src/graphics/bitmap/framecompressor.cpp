@@ -0,0 +1,213 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "framecompressor.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+namespace
+{
+    struct Header
+    {
+        quint32 method;
+        qint32 width;
+        qint32 height;
+        qint32 format;
+    };
+
+    // runs shorter than this are cheaper to keep in the literal spans around them
+    const int MIN_RUN = 4;
+}
+
+/** @brief FrameCompressor::compress
+ *  Run-length encodes 32 bit images when that shrinks them to a quarter or less, otherwise uses zlib.
+ *  The runs are encoded into a buffer of that quarter, and given up on as soon as they overflow it.
+ */
+QByteArray FrameCompressor::compress(const QImage& image)
+{
+    Header header;
+    header.width = image.width();
+    header.height = image.height();
+    header.format = image.format();
+
+    const int bytes = image.bytesPerLine() * image.height();
+    const char* bits = reinterpret_cast<const char*>(image.constBits());
+
+    const int capacity = (bytes / 4 - int(sizeof(Header))) / 4;
+    if (image.depth() == 32 && capacity > 0)
+    {
+        header.method = RunLength;
+        QByteArray runs(int(sizeof(Header)) + capacity * 4, Qt::Uninitialized);
+        std::memcpy(runs.data(), &header, sizeof(Header));
+
+        const int count = image.width() * image.height();
+        quint32* words = reinterpret_cast<quint32*>(runs.data() + sizeof(Header));
+        const int size = encodeRunLength(reinterpret_cast<const quint32*>(bits), count, words, capacity);
+        if (size >= 0)
+        {
+            runs.resize(int(sizeof(Header)) + size * 4);
+            return runs;
+        }
+    }
+
+    header.method = Zlib;
+    QByteArray data(reinterpret_cast<const char*>(&header), sizeof(Header));
+    data.append(qCompress(reinterpret_cast<const uchar*>(bits), bytes, 1));
+    return data;
+}
+
+QImage FrameCompressor::decompress(const QByteArray& data)
+{
+    if (data.size() < int(sizeof(Header)))
+    {
+        return QImage();
+    }
+    Header header;
+    std::memcpy(&header, data.constData(), sizeof(Header));
+
+    QImage image(header.width, header.height, static_cast<QImage::Format>(header.format));
+    if (image.isNull())
+    {
+        return QImage();
+    }
+
+    const char* payload = data.constData() + sizeof(Header);
+    const int payloadSize = data.size() - int(sizeof(Header));
+    if (header.method == RunLength && image.depth() == 32)
+    {
+        const bool ok = decodeRunLength(reinterpret_cast<const quint32*>(payload), payloadSize / 4,
+                                        reinterpret_cast<quint32*>(image.bits()), image.width() * image.height());
+        return ok ? image : QImage();
+    }
+    if (header.method == Zlib)
+    {
+        const QByteArray bits = qUncompress(reinterpret_cast<const uchar*>(payload), payloadSize);
+        const int bytes = image.bytesPerLine() * image.height();
+        if (bits.size() != bytes)
+        {
+            return QImage();
+        }
+        std::memcpy(image.bits(), bits.constData(), size_t(bytes));
+        return image;
+    }
+    return QImage();
+}
+
+FrameCompressor::Method FrameCompressor::method(const QByteArray& data)
+{
+    Q_ASSERT(data.size() >= int(sizeof(Header)));
+    Header header;
+    std::memcpy(&header, data.constData(), sizeof(Header));
+    return static_cast<Method>(header.method);
+}
+
+/** @brief FrameCompressor::encodeRunLength
+ *  Each span starts with a word holding its length and whether it's a run. A run is followed
+ *  by its pixel, a literal span by its pixels.
+ */
+int FrameCompressor::encodeRunLength(const quint32* pixels, int count, quint32* out, int capacity)
+{
+    int size = 0;
+    int literalStart = 0;
+    int i = 0;
+
+    // the words taken once the literal span up to end is written
+    auto sizeWithLiteral = [&](int end)
+    {
+        return (end > literalStart) ? size + 1 + (end - literalStart) : size;
+    };
+
+    auto flushLiteral = [&](int end)
+    {
+        if (end > literalStart)
+        {
+            const int length = end - literalStart;
+            out[size++] = quint32(length) << 1;
+            std::memcpy(out + size, pixels + literalStart, size_t(length) * 4);
+            size += length;
+        }
+    };
+
+    while (i < count)
+    {
+        if (sizeWithLiteral(i) > capacity)
+        {
+            return -1;
+        }
+
+        const quint32 pixel = pixels[i];
+        int end = i + 1;
+        while (end < count && pixels[end] == pixel)
+        {
+            end++;
+        }
+
+        if (end - i >= MIN_RUN)
+        {
+            if (sizeWithLiteral(i) + 2 > capacity)
+            {
+                return -1;
+            }
+            flushLiteral(i);
+            out[size++] = (quint32(end - i) << 1) | 1u;
+            out[size++] = pixel;
+            literalStart = end;
+        }
+        i = end;
+    }
+    if (sizeWithLiteral(count) > capacity)
+    {
+        return -1;
+    }
+    flushLiteral(count);
+    return size;
+}
+
+bool FrameCompressor::decodeRunLength(const quint32* words, int size, quint32* pixels, int count)
+{
+    int w = 0;
+    int p = 0;
+    while (w < size)
+    {
+        const quint32 word = words[w++];
+        const int length = int(word >> 1);
+        if (length > count - p)
+        {
+            return false;
+        }
+
+        if (word & 1u)
+        {
+            if (w >= size)
+            {
+                return false;
+            }
+            std::fill(pixels + p, pixels + p + length, words[w++]);
+        }
+        else
+        {
+            if (length > size - w)
+            {
+                return false;
+            }
+            std::memcpy(pixels + p, words + w, size_t(length) * 4);
+            w += length;
+        }
+        p += length;
+    }
+    return p == count;
+}
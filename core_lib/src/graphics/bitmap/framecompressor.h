@@ -0,0 +1,54 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#ifndef FRAMECOMPRESSOR_H
+#define FRAMECOMPRESSOR_H
+
+#include <QByteArray>
+#include <QImage>
+
+
+/**
+ * Packs decoded frames into a small buffer that is much cheaper to unpack than a PNG is to decode.
+ *
+ * 32 bit images are run-length encoded, whole pixels at a time: the transparent background of
+ * line art and the flat colors of filled drawings become a few runs, and unpacking them is a fill
+ * or a copy per run. When runs don't pay off, as with painted frames, zlib is used at its fastest
+ * level instead.
+ *
+ * The buffers are only meant for the running program, they are in the byte order of the machine.
+ */
+class FrameCompressor
+{
+public:
+    enum Method : char
+    {
+        RunLength = 'R',
+        Zlib = 'Z'
+    };
+
+    static QByteArray compress(const QImage& image);
+    static QImage decompress(const QByteArray& data);
+    static Method method(const QByteArray& data);
+
+    /** Encodes count pixels into out, which has room for capacity words.
+     *  Returns the number of words written, or -1 as soon as they don't fit. encodedSizeBound(count) words always do. */
+    static int encodeRunLength(const quint32* pixels, int count, quint32* out, int capacity);
+    /** Decodes the words of size into exactly count pixels, returns false if they don't make count pixels */
+    static bool decodeRunLength(const quint32* words, int size, quint32* pixels, int count);
+    static int encodedSizeBound(int count) { return count + count / 2 + 1; }
+};
+
+#endif // FRAMECOMPRESSOR_H
@@ -0,0 +1,232 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "smudgeengine.h"
+
+#include <cstring>
+#include <QtMath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SMUDGE_USE_SSE2
+#endif
+
+
+namespace
+{
+    // x / 255 rounded, exact for the product of two 8 bit values
+    inline uint div255(uint x)
+    {
+        x += 128;
+        return (x + (x >> 8)) >> 8;
+    }
+}
+
+/**
+ * @brief SmudgeEngine::drawStroke
+ * @param source: the frame being smudged, ARGB32 premultiplied, it is only read
+ * @param sourceTopLeft: the canvas position of the top left pixel of the source
+ * @param target: the stroke buffer, ARGB32 premultiplied, the dabs are blended into it
+ * @param targetTopLeft: the canvas position of the top left pixel of the target
+ * @param from: where the brush was before the first point
+ * @param points: the dab centers, in canvas coordinates
+ * @param brush: the shape and strength shared by all the dabs
+ * @param mode: smudge or liquify
+ *
+ * Dabs falling outside the target are clipped, grow the target beforehand with BrushDabEngine::dabsBounds().
+ */
+void SmudgeEngine::drawStroke(const QImage& source, QPoint sourceTopLeft, QImage& target, QPoint targetTopLeft,
+                              QPointF from, const QList<QPointF>& points, const Brush& brush, Mode mode)
+{
+    Q_ASSERT(target.format() == QImage::Format_ARGB32_Premultiplied);
+    if (points.isEmpty() || target.isNull() || brush.strength <= 0)
+        return;
+
+    BrushDabEngine::Dab dab;
+    dab.diameter = brush.diameter;
+    dab.feather = brush.feather;
+    dab.antialias = brush.antialias;
+    const BrushDabEngine::Stamp& mask = mMasks.stamp(dab);
+
+    const int strength = qMin(brush.strength, 255);
+    const QRect targetRect(targetTopLeft, target.size());
+    uchar* bits = target.bits();
+    const int bytesPerLine = target.bytesPerLine();
+
+    QPointF previous = from;
+    for (const QPointF& point : points)
+    {
+        const QRect dabRect = BrushDabEngine::dabBounds(point, brush.diameter);
+        const QPointF delta = point - previous;
+        previous = point;
+
+        const QRect clipped = dabRect & targetRect;
+        if (clipped.isEmpty())
+            continue;
+
+        // every pixel under the dab reads at most delta away, the extra pixel covers the rounding
+        const QPoint shift(qRound(delta.x()), qRound(delta.y()));
+        gather(source, sourceTopLeft, target, targetTopLeft, (clipped | clipped.translated(-shift)).adjusted(-1, -1, 1, 1));
+
+        const int count = clipped.width();
+        const int maskX = clipped.left() - dabRect.left();
+        const int targetX = clipped.left() - targetRect.left();
+        if (mRow.size() < count)
+        {
+            mRow.resize(count);
+        }
+
+        for (int y = clipped.top(); y <= clipped.bottom(); y++)
+        {
+            const quint8* maskRow = mask.alpha.constData() + (y - dabRect.top()) * mask.size + maskX;
+            QRgb* targetRow = reinterpret_cast<QRgb*>(bits + (y - targetRect.top()) * bytesPerLine) + targetX;
+
+            if (mode == Smudge)
+            {
+                // the paint under the previous dab, as it is
+                blendRow(targetRow, workPixel(clipped.left() - shift.x(), y - shift.y()), maskRow, count, strength);
+                continue;
+            }
+
+            // the center of the dab moves the whole way, its edge stays in place
+            for (int i = 0; i < count; i++)
+            {
+                const qreal amount = div255(maskRow[i] * uint(strength)) / 255.0;
+                const int x = qBound(mWorkRect.left(), qRound(clipped.left() + i - amount * delta.x()), mWorkRect.right());
+                const int sy = qBound(mWorkRect.top(), qRound(y - amount * delta.y()), mWorkRect.bottom());
+                const QRgb pixel = *workPixel(x, sy);
+
+                // the pushed color is made opaque, the mask alone decides how much of it shows
+                mRow[i] = (qAlpha(pixel) == 0) ? 0 : (qUnpremultiply(pixel) | 0xff000000);
+            }
+            blendRow(targetRow, mRow.constData(), maskRow, count, strength);
+        }
+    }
+}
+
+/**
+ * @brief SmudgeEngine::blendRow
+ * Source-over of count premultiplied pixels, each scaled by its mask value times strength / 255.
+ * Processes four pixels at a time with SSE2 where available.
+ */
+void SmudgeEngine::blendRow(QRgb* dst, const QRgb* src, const quint8* mask, int count, int strength)
+{
+#ifdef SMUDGE_USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi16(128);
+    const __m128i full = _mm_set1_epi16(255);
+    const __m128i strength16 = _mm_set1_epi16(short(strength));
+
+    // (x + 128 + ((x + 128) >> 8)) >> 8 on 8 lanes
+    auto div255x8 = [half](__m128i x)
+    {
+        x = _mm_add_epi16(x, half);
+        return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+    };
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        quint32 mask4;
+        std::memcpy(&mask4, mask + i, sizeof(mask4));
+        if (mask4 == 0)
+            continue;
+
+        // each mask value on the four lanes of its pixel
+        __m128i m = _mm_cvtsi32_si128(int(mask4));
+        m = _mm_unpacklo_epi8(m, m);
+        m = _mm_unpacklo_epi8(m, m);
+        const __m128i maskLo = div255x8(_mm_mullo_epi16(_mm_unpacklo_epi8(m, zero), strength16));
+        const __m128i maskHi = div255x8(_mm_mullo_epi16(_mm_unpackhi_epi8(m, zero), strength16));
+
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i srcLo = div255x8(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), maskLo));
+        const __m128i srcHi = div255x8(_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), maskHi));
+
+        // 255 minus the alpha of each scaled source pixel, on the four lanes of its pixel
+        const __m128i keepLo = _mm_sub_epi16(full, _mm_shufflehi_epi16(_mm_shufflelo_epi16(srcLo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3)));
+        const __m128i keepHi = _mm_sub_epi16(full, _mm_shufflehi_epi16(_mm_shufflelo_epi16(srcHi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3)));
+
+        __m128i* p = reinterpret_cast<__m128i*>(dst + i);
+        const __m128i d = _mm_loadu_si128(p);
+        const __m128i lo = _mm_add_epi16(srcLo, div255x8(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), keepLo)));
+        const __m128i hi = _mm_add_epi16(srcHi, div255x8(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), keepHi)));
+        _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+    }
+    blendRowScalar(dst + i, src + i, mask + i, count - i, strength);
+#else
+    blendRowScalar(dst, src, mask, count, strength);
+#endif
+}
+
+void SmudgeEngine::blendRowScalar(QRgb* dst, const QRgb* src, const quint8* mask, int count, int strength)
+{
+    for (int i = 0; i < count; i++)
+    {
+        const uint m = div255(mask[i] * uint(strength));
+        if (m == 0)
+            continue;
+
+        const QRgb s = src[i];
+        const QRgb d = dst[i];
+        const uint srcAlpha = div255(qAlpha(s) * m);
+        const uint keep = 255 - srcAlpha;
+        dst[i] = qRgba(int(div255(qRed(s) * m) + div255(qRed(d) * keep)),
+                       int(div255(qGreen(s) * m) + div255(qGreen(d) * keep)),
+                       int(div255(qBlue(s) * m) + div255(qBlue(d) * keep)),
+                       int(srcAlpha + div255(qAlpha(d) * keep)));
+    }
+}
+
+/**
+ * @brief SmudgeEngine::gather
+ * Copies the source with the target composited over it, for the pixels in region only.
+ */
+void SmudgeEngine::gather(const QImage& source, QPoint sourceTopLeft, const QImage& target, QPoint targetTopLeft, const QRect& region)
+{
+    mWorkRect = region;
+    mWork.fill(0, region.width() * region.height());
+
+    const QRect fromSource = region & QRect(sourceTopLeft, source.size());
+    if (!fromSource.isEmpty())
+    {
+        Q_ASSERT(source.format() == QImage::Format_ARGB32_Premultiplied);
+        for (int y = fromSource.top(); y <= fromSource.bottom(); y++)
+        {
+            const QRgb* sourceRow = reinterpret_cast<const QRgb*>(source.constScanLine(y - sourceTopLeft.y())) + (fromSource.left() - sourceTopLeft.x());
+            std::memcpy(workPixel(fromSource.left(), y), sourceRow, fromSource.width() * sizeof(QRgb));
+        }
+    }
+
+    const QRect fromTarget = region & QRect(targetTopLeft, target.size());
+    if (!fromTarget.isEmpty())
+    {
+        if (mOpaque.size() < fromTarget.width())
+        {
+            mOpaque.fill(255, fromTarget.width());
+        }
+        for (int y = fromTarget.top(); y <= fromTarget.bottom(); y++)
+        {
+            const QRgb* targetRow = reinterpret_cast<const QRgb*>(target.constScanLine(y - targetTopLeft.y())) + (fromTarget.left() - targetTopLeft.x());
+            blendRow(workPixel(fromTarget.left(), y), targetRow, mOpaque.constData(), fromTarget.width(), 255);
+        }
+    }
+}
+
+QRgb* SmudgeEngine::workPixel(int x, int y)
+{
+    Q_ASSERT(mWorkRect.contains(x, y));
+    return mWork.data() + (y - mWorkRect.top()) * mWorkRect.width() + (x - mWorkRect.left());
+}
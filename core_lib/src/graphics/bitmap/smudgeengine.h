@@ -0,0 +1,72 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#ifndef SMUDGEENGINE_H
+#define SMUDGEENGINE_H
+
+#include <QImage>
+#include <QList>
+#include <QVector>
+#include "brushdabengine.h"
+
+
+/**
+ * Smudges and liquifies a bitmap along a stroke, one dab at a time.
+ *
+ * The paint under the previous dab is what the next dab drags along. It is read from
+ * the frame with the stroke buffer composited over it, but only for the pixels under
+ * the two dabs: they are gathered into a small working buffer, so the cost of a dab
+ * depends on the brush size and not on the size of the frame.
+ *
+ * The result is blended source-over into the stroke buffer, the frame itself is only read.
+ */
+class SmudgeEngine
+{
+public:
+    enum Mode
+    {
+        Smudge,   ///< drags the paint under the brush along
+        Liquify   ///< pushes the pixels, more at the center of the brush than at its edge
+    };
+
+    struct Brush
+    {
+        qreal diameter = 1.0;
+        qreal feather = 0.0;   ///< 0 to 100, see ScribbleArea::setGaussianGradient
+        bool antialias = false;
+        int strength = 255;    ///< 0 to 255, scales the brush mask
+    };
+
+    SmudgeEngine() = default;
+
+    void drawStroke(const QImage& source, QPoint sourceTopLeft, QImage& target, QPoint targetTopLeft,
+                    QPointF from, const QList<QPointF>& points, const Brush& brush, Mode mode);
+
+    static void blendRow(QRgb* dst, const QRgb* src, const quint8* mask, int count, int strength);
+    static void blendRowScalar(QRgb* dst, const QRgb* src, const quint8* mask, int count, int strength);
+
+private:
+    void gather(const QImage& source, QPoint sourceTopLeft, const QImage& target, QPoint targetTopLeft, const QRect& region);
+    QRgb* workPixel(int x, int y);
+
+    BrushDabEngine mMasks;
+
+    QVector<QRgb> mWork;      ///< the frame and the buffer composited, over mWorkRect
+    QRect mWorkRect;
+    QVector<QRgb> mRow;       ///< one row of displaced pixels
+    QVector<quint8> mOpaque;  ///< a mask row letting everything through
+};
+
+#endif // SMUDGEENGINE_H
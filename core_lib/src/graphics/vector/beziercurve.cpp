@@ -25,6 +25,7 @@ GNU General Public License for more details.
 #include <QPainterPath>
 #include "object.h"
 #include "pencilerror.h"
+#include "bezierintersector.h"
 
 
 BezierCurve::BezierCurve()
@@ -180,11 +181,13 @@ void BezierCurve::loadDomElement(const QDomElement& element)
 
 void BezierCurve::setOrigin(const QPointF& point)
 {
+    invalidateStrokedOutline();
     origin = point;
 }
 
 void BezierCurve::setOrigin(const QPointF& point, const qreal& pressureValue, const bool& trueOrFalse)
 {
+    invalidateStrokedOutline();
     origin = point;
     pressure[0] = pressureValue;
     selected[0] = trueOrFalse;
@@ -195,6 +198,7 @@ void BezierCurve::setC1(int i, const QPointF& point)
     if ( i >= 0 || i < c1.size() )
     {
         c1[i] = point;
+        invalidateStrokedOutline();
     }
     else
     {
@@ -207,6 +211,7 @@ void BezierCurve::setC2(int i, const QPointF& point)
     if ( i >= 0 || i < c2.size() )
     {
         c2[i] = point;
+        invalidateStrokedOutline();
     }
     else
     {
@@ -219,10 +224,12 @@ void BezierCurve::setVertex(int i, const QPointF& point)
     if (i == -1)
     {
         origin = point;
+        invalidateStrokedOutline();
     }
     else if (i >= 0 && i < vertex.size())
     {
         vertex[i] = point;
+        invalidateStrokedOutline();
     }
     else
     {
@@ -235,6 +242,7 @@ void BezierCurve::setLastVertex(const QPointF& point)
     if (vertex.size() > 0)
     {
         vertex[vertex.size()-1] = point;
+        invalidateStrokedOutline();
     }
     else
     {
@@ -245,6 +253,7 @@ void BezierCurve::setLastVertex(const QPointF& point)
 
 void BezierCurve::setWidth(qreal desiredWidth)
 {
+    invalidateStrokedOutline();
     width = desiredWidth;
 }
 
@@ -314,6 +323,7 @@ BezierCurve BezierCurve::transformed(QTransform transformation)
 
 void BezierCurve::transform(QTransform transformation)
 {
+    invalidateStrokedOutline();
     if (isSelected(-1)) setOrigin( transformation.map(origin) );
     for(int i=0; i< vertex.size(); i++)
     {
@@ -329,6 +339,7 @@ void BezierCurve::transform(QTransform transformation)
 
 void BezierCurve::appendCubic(const QPointF& c1Point, const QPointF& c2Point, const QPointF& vertexPoint, qreal pressureValue)
 {
+    invalidateStrokedOutline();
     c1.append(c1Point);
     c2.append(c2Point);
     vertex.append(vertexPoint);
@@ -354,6 +365,7 @@ void BezierCurve::addPoint(int position, const QPointF point)
         pressure.insert(position, getPressure(position));
         selected.insert(position, isSelected(position) && isSelected(position-1));
 
+        invalidateStrokedOutline();
         //smoothCurve();
     }
     else
@@ -389,6 +401,7 @@ void BezierCurve::addPoint(int position, const qreal fraction) // fraction is wh
         pressure.insert(position, getPressure(position));
         selected.insert(position, isSelected(position) && isSelected(position-1));
 
+        invalidateStrokedOutline();
         //smoothCurve();
     }
     else
@@ -399,6 +412,7 @@ void BezierCurve::addPoint(int position, const qreal fraction) // fraction is wh
 
 void BezierCurve::removeVertex(int i)
 {
+    invalidateStrokedOutline();
     int n = vertex.size();
     if (i>-2 && i< n)
     {
@@ -441,7 +455,15 @@ void BezierCurve::drawPath(QPainter& painter, Object* object, QTransform transfo
     {
         painter.setPen(QPen(QBrush(color), 1, Qt::NoPen, Qt::RoundCap,Qt::RoundJoin));
         painter.setBrush(color);
-        painter.drawPath(myCurve.getStrokedPath());
+        if (isPartlySelected() && !transformation.isIdentity())
+        {
+            // the selection is being transformed, the outline would be stale on the next paint anyway
+            painter.drawPath(myCurve.getStrokedPath());
+        }
+        else
+        {
+            painter.drawPolygon(getStrokedOutline(), Qt::WindingFill);
+        }
     }
     else
     {
@@ -619,6 +641,22 @@ QPainterPath BezierCurve::getStrokedPath(qreal width, bool usePressure)
     return path;
 }
 
+/**
+ * @brief BezierCurve::getStrokedOutline
+ * The variable width outline of getStrokedPath(), flattened once and kept until the curve is edited,
+ * so repainting a curve doesn't evaluate the offset cubics again.
+ * It's flattened at a quarter of a canvas pixel so it still looks smooth when zoomed in.
+ */
+const QPolygonF& BezierCurve::getStrokedOutline()
+{
+    if (mStrokedOutline.isEmpty() && !vertex.isEmpty())
+    {
+        const QTransform subPixel = QTransform::fromScale(4.0, 4.0);
+        mStrokedOutline = subPixel.inverted().map(getStrokedPath().toFillPolygon(subPixel));
+    }
+    return mStrokedOutline;
+}
+
 QRectF BezierCurve::getBoundingRect()
 {
     return getSimplePath().boundingRect();
@@ -635,6 +673,7 @@ void BezierCurve::createCurve(const QList<QPointF>& pointList, const QList<qreal
     while (vertex.size()>0) vertex.removeAt(0);
     while (selected.size()>0) selected.removeAt(0);
     while (pressure.size()>0) pressure.removeAt(0);
+    invalidateStrokedOutline();
 
     setOrigin( pointList.at(0) );
     selected.append(false);
@@ -660,6 +699,7 @@ void BezierCurve::createCurve(const QList<QPointF>& pointList, const QList<qreal
 
 void BezierCurve::smoothCurve()
 {
+    invalidateStrokedOutline();
     QPointF c1, c2, c2old, tangentVec, normalVec;
     int n = vertex.size();
     c2old = QPointF(-100,-100); // bogus point
@@ -776,7 +816,7 @@ void BezierCurve::normalise(QPointF& point)
     }
 }
 
-qreal BezierCurve::findDistance(BezierCurve curve, int i, QPointF P, QPointF& nearestPoint, qreal& t)   //finds the distance between a cubic section and a point
+qreal BezierCurve::findDistance(const BezierCurve& curve, int i, QPointF P, QPointF& nearestPoint, qreal& t)   //finds the distance between a cubic section and a point
 {
     //qDebug() << "---- INTER CUBIC SEGMENT";
     int nSteps = 24;
@@ -801,7 +841,7 @@ qreal BezierCurve::findDistance(BezierCurve curve, int i, QPointF P, QPointF& ne
     return distMin;
 }
 
-QPointF BezierCurve::getPointOnCubic(int i, qreal t)
+QPointF BezierCurve::getPointOnCubic(int i, qreal t) const
 {
     return (1.0-t)*(1.0-t)*(1.0-t)*getVertex(i-1)
            + 3*t*(1.0-t)*(1.0-t)*getC1(i)
@@ -834,78 +874,8 @@ bool BezierCurve::intersects(QRectF rectangle)
     return result;
 }
 
-bool BezierCurve::findIntersection(BezierCurve curve1, int i1, BezierCurve curve2, int i2, QList<Intersection>& intersections)   //finds the intersection between two cubic sections
+bool BezierCurve::findIntersection(const BezierCurve& curve1, int i1, const BezierCurve& curve2, int i2, QList<Intersection>& intersections)   //finds the intersection between two cubic sections
 {
-    bool result = false;
-    //qDebug() << "---- INTER CUBIC CUBIC"  << i1 << i2;
-    QPointF P1, Q1, P2, Q2;
-    QLineF L1, L2;
-    QRectF R1;
-    QRectF R2;
-
-    P1 = curve1.getVertex(i1-1);
-    Q1 = curve1.getVertex(i1);
-    P2 = curve2.getVertex(i2-1);
-    Q2 = curve2.getVertex(i2);
-    L1 = QLineF(P1, Q1);
-    L2 = QLineF(P2, Q2);
-
-    //qDebug() << "-------------------- ";
-
-    R1.setTopLeft(P1);
-    R1.setBottomRight(Q1);
-    R2.setTopLeft(P2);
-    R2.setBottomRight(Q2);
-
-    QPointF intersectionPoint = QPointF(50.0, 50.0); // bogus point
-    QPointF* cubicIntersection = &intersectionPoint;
-    if ( R1.intersects(R2) || L2.intersect(L1, cubicIntersection) == QLineF::BoundedIntersection )
-    {
-        //if (L2.intersect(L1, intersection) == QLineF::BoundedIntersection) {
-        //qDebug() << "                   FOUND rectangle intersection ";
-        //if (intersectionPoint != curve1.getVertex(i1-1) && intersectionPoint != curve1.getVertex(i1)) {
-        //	qDebug() << "                   it's not one of the points ";
-        // find the cubic intersection
-        int nSteps = 24;
-        P1 = curve1.getVertex(i1-1);
-        for(int i=1; i<=nSteps; i++)
-        {
-            qreal s = (i+0.0)/nSteps;
-            Q1 = curve1.getPointOnCubic(i1, s);
-            P2 = curve2.getVertex(i2-1);
-            for(int j=1; j<=nSteps; j++)
-            {
-                qreal t = (j+0.0)/nSteps;
-                Q2 = curve2.getPointOnCubic(i2, t);
-                L1 = QLineF(P1, Q1);
-                L2 = QLineF(P2, Q2);
-                if (L2.intersect(L1, cubicIntersection) == QLineF::BoundedIntersection)
-                {
-                    QPointF intersectionPoint = *cubicIntersection;
-                    if (intersectionPoint != curve1.getVertex(i1-1) && intersectionPoint != curve1.getVertex(i1))
-                    {
-                        qreal fraction1 = eLength(intersectionPoint-Q1)/(0.0+eLength(Q1-P1));
-                        qreal fraction2 = eLength(intersectionPoint-Q2)/(0.0+eLength(Q2-P2));
-                        qreal t1 = (i - fraction1)/nSteps;
-                        qreal t2 = (j - fraction2)/nSteps;
-                        Intersection intersection;
-                        intersection.point = intersectionPoint;
-                        intersection.t1 = t1;
-                        intersection.t2 = t2;
-                        intersections.append( intersection );
-                        result = true;
-                        //qDebug() << "FOUND cubic interesection " << intersectionPoint << i << j;
-                    }
-                }
-                P2 = Q2;
-            }
-            P1 = Q1;
-        }
-    }
-    else
-    {
-        //return false; // approximation to speed up the calculation
-    }
-    //qDebug() << "------";
-    return result;
+    static const BezierIntersector intersector;
+    return intersector.intersect(curve1, i1, curve2, i2, intersections);
 }
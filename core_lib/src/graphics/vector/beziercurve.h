@@ -17,6 +17,7 @@ GNU General Public License for more details.
 #define BEZIERCURVE_H
 
 #include <QPainter>
+#include <QPolygonF>
 
 class Object;
 class Status;
@@ -80,13 +81,14 @@ public:
     void appendCubic(const QPointF& c1Point, const QPointF& c2Point, const QPointF& vertexPoint, qreal pressureValue);
     void addPoint(int position, const QPointF point);
     void addPoint(int position, const qreal fraction);
-    QPointF getPointOnCubic(int i, qreal t);
+    QPointF getPointOnCubic(int i, qreal t) const;
     void removeVertex(int i);
     QPainterPath getStraightPath();
     QPainterPath getSimplePath();
     QPainterPath getStrokedPath();
     QPainterPath getStrokedPath(qreal width);
     QPainterPath getStrokedPath(qreal width, bool pressure);
+    const QPolygonF& getStrokedOutline();
     QRectF getBoundingRect();
 
     void drawPath(QPainter& painter, Object* object, QTransform transformation, bool simplified, bool showThinLines );
@@ -99,8 +101,8 @@ public:
     static qreal eLength(const QPointF point); // returns the Euclidean length of a point (seen as a vector)
     static qreal mLength(const QPointF point); // returns the Manhattan length of a point (seen as a vector)
     static void normalise(QPointF& point); // normalises a point (seen as a vector);
-    static qreal findDistance(BezierCurve curve, int i, QPointF P, QPointF& nearestPoint, qreal& t); //finds the distance between a cubic section and a point
-    static bool findIntersection(BezierCurve curve1, int i1, BezierCurve curve2, int i2, QList<Intersection>& intersections); //finds the intersection between two cubic sections
+    static qreal findDistance(const BezierCurve& curve, int i, QPointF P, QPointF& nearestPoint, qreal& t); //finds the distance between a cubic section and a point
+    static bool findIntersection(const BezierCurve& curve1, int i1, const BezierCurve& curve2, int i2, QList<Intersection>& intersections); //finds the intersection between two cubic sections
 
 private:
     QPointF origin;
@@ -115,6 +117,9 @@ private:
     bool invisible = false;
     bool mFilled = false;
     QList<bool> selected; // this list has one more element than the other list (the first element is for the origin)
+
+    void invalidateStrokedOutline() { mStrokedOutline.clear(); }
+    QPolygonF mStrokedOutline; // flattened getStrokedPath(), empty until it's first painted
 };
 
 #endif
@@ -0,0 +1,275 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "beziercurvefitter.h"
+
+#include <cmath>
+
+
+namespace
+{
+    inline qreal dot(const QPointF& a, const QPointF& b)
+    {
+        return a.x() * b.x() + a.y() * b.y();
+    }
+
+    const int maxReparameterizations = 4;
+}
+
+BezierCurveFitter::BezierCurveFitter(qreal maxError)
+{
+    mMaxError = qMax(maxError, qreal(0.01));
+}
+
+/**
+ * @brief BezierCurveFitter::fit
+ * @param points: the raw stroke samples
+ * @param pressures: one pressure per sample
+ * @return a curve going through the first and last samples,
+ *         with every sample closer than maxError to it
+ */
+BezierCurve BezierCurveFitter::fit(const QList<QPointF>& points, const QList<qreal>& pressures)
+{
+    mPoints.clear();
+    mPressures.clear();
+    mPoints.reserve(points.size());
+    mPressures.reserve(points.size());
+    mFitError = 0.0;
+
+    for (int i = 0; i < points.size(); i++)
+    {
+        // coincident samples have no tangent, keep the first one only
+        if (!mPoints.isEmpty() && BezierCurve::eLength(points.at(i) - mPoints.last()) < 1e-6)
+            continue;
+
+        // Make sure that the stroke point always has a pressure (and a width)
+        qreal pressure = (i < pressures.size()) ? qMax(pressures.at(i), qreal(0.1)) : 0.5;
+
+        mPoints.append(points.at(i));
+        mPressures.append(pressure);
+    }
+
+    BezierCurve curve;
+    if (mPoints.isEmpty())
+        return curve;
+
+    curve.createCurve(QList<QPointF>() << mPoints.first(), QList<qreal>() << mPressures.first(), false);
+
+    const int last = mPoints.size() - 1;
+    if (last < 1)
+        return curve;
+
+    QPointF tHat1 = unit(mPoints[1] - mPoints[0]);
+    QPointF tHat2 = unit(mPoints[last - 1] - mPoints[last]);
+    fitCubic(0, last, tHat1, tHat2, curve);
+
+    return curve;
+}
+
+void BezierCurveFitter::fitCubic(int first, int last, QPointF tHat1, QPointF tHat2, BezierCurve& curve)
+{
+    if (last - first == 1)
+    {
+        // two points only, use a heuristic
+        const qreal dist = BezierCurve::eLength(mPoints[last] - mPoints[first]) / 3.0;
+
+        Cubic cubic;
+        cubic.p0 = mPoints[first];
+        cubic.p3 = mPoints[last];
+        cubic.p1 = cubic.p0 + tHat1 * dist;
+        cubic.p2 = cubic.p3 + tHat2 * dist;
+        appendSection(cubic, last, curve);
+        return;
+    }
+
+    QVector<qreal> u = chordLengthParameterize(first, last);
+    Cubic cubic = generateBezier(first, last, u, tHat1, tHat2);
+
+    int splitPoint = (first + last) / 2;
+    qreal maxError = computeMaxError(first, last, cubic, u, splitPoint);
+    if (maxError < mMaxError)
+    {
+        appendSection(cubic, last, curve);
+        mFitError = qMax(mFitError, maxError);
+        return;
+    }
+
+    // If the error is not too large, try some reparameterization and iteration
+    if (maxError < 2.0 * mMaxError)
+    {
+        for (int i = 0; i < maxReparameterizations; i++)
+        {
+            u = reparameterize(first, last, u, cubic);
+            cubic = generateBezier(first, last, u, tHat1, tHat2);
+            maxError = computeMaxError(first, last, cubic, u, splitPoint);
+            if (maxError < mMaxError)
+            {
+                appendSection(cubic, last, curve);
+                mFitError = qMax(mFitError, maxError);
+                return;
+            }
+        }
+    }
+
+    // Fitting failed -- split at max error point and fit recursively
+    const QPointF tHatCenter = centerTangent(splitPoint);
+    fitCubic(first, splitPoint, tHat1, tHatCenter, curve);
+    fitCubic(splitPoint, last, -tHatCenter, tHat2, curve);
+}
+
+void BezierCurveFitter::appendSection(const Cubic& cubic, int last, BezierCurve& curve)
+{
+    curve.appendCubic(cubic.p1, cubic.p2, cubic.p3, mPressures[last]);
+}
+
+BezierCurveFitter::Cubic BezierCurveFitter::generateBezier(int first, int last, const QVector<qreal>& u, QPointF tHat1, QPointF tHat2) const
+{
+    Cubic cubic;
+    cubic.p0 = mPoints[first];
+    cubic.p3 = mPoints[last];
+
+    // least squares on the lengths of the two tangents
+    qreal c00 = 0.0, c01 = 0.0, c11 = 0.0;
+    qreal x0 = 0.0, x1 = 0.0;
+    for (int i = 0; i <= last - first; i++)
+    {
+        const qreal t = u[i];
+        const qreal mt = 1.0 - t;
+        const qreal b0 = mt * mt * mt;
+        const qreal b1 = 3.0 * t * mt * mt;
+        const qreal b2 = 3.0 * t * t * mt;
+        const qreal b3 = t * t * t;
+
+        const QPointF a1 = tHat1 * b1;
+        const QPointF a2 = tHat2 * b2;
+        c00 += dot(a1, a1);
+        c01 += dot(a1, a2);
+        c11 += dot(a2, a2);
+
+        const QPointF tmp = mPoints[first + i] - (cubic.p0 * (b0 + b1) + cubic.p3 * (b2 + b3));
+        x0 += dot(tmp, a1);
+        x1 += dot(tmp, a2);
+    }
+
+    const qreal detC0C1 = c00 * c11 - c01 * c01;
+    const qreal detC0X = c00 * x1 - c01 * x0;
+    const qreal detXC1 = x0 * c11 - x1 * c01;
+
+    qreal alphaL = qFuzzyIsNull(detC0C1) ? 0.0 : detXC1 / detC0C1;
+    qreal alphaR = qFuzzyIsNull(detC0C1) ? 0.0 : detC0X / detC0C1;
+
+    // If alpha is negative or too small, the least squares solution is unusable
+    // (the control points would cross or coincide), fall back to the Wu/Barsky heuristic
+    const qreal segLength = BezierCurve::eLength(cubic.p3 - cubic.p0);
+    const qreal epsilon = 1.0e-6 * segLength;
+    if (alphaL < epsilon || alphaR < epsilon)
+    {
+        alphaL = segLength / 3.0;
+        alphaR = segLength / 3.0;
+    }
+
+    cubic.p1 = cubic.p0 + tHat1 * alphaL;
+    cubic.p2 = cubic.p3 + tHat2 * alphaR;
+    return cubic;
+}
+
+QVector<qreal> BezierCurveFitter::chordLengthParameterize(int first, int last) const
+{
+    QVector<qreal> u(last - first + 1);
+    u[0] = 0.0;
+    for (int i = first + 1; i <= last; i++)
+    {
+        u[i - first] = u[i - first - 1] + BezierCurve::eLength(mPoints[i] - mPoints[i - 1]);
+    }
+
+    const qreal total = u[last - first];
+    for (int i = 1; i <= last - first; i++)
+    {
+        u[i] = u[i] / total;
+    }
+    return u;
+}
+
+QVector<qreal> BezierCurveFitter::reparameterize(int first, int last, const QVector<qreal>& u, const Cubic& cubic) const
+{
+    QVector<qreal> uPrime(u.size());
+    for (int i = first; i <= last; i++)
+    {
+        uPrime[i - first] = qBound(0.0, newtonRaphsonRootFind(cubic, mPoints[i], u[i - first]), 1.0);
+    }
+    return uPrime;
+}
+
+qreal BezierCurveFitter::computeMaxError(int first, int last, const Cubic& cubic, const QVector<qreal>& u, int& splitPoint) const
+{
+    qreal maxDist = 0.0;
+    for (int i = first + 1; i < last; i++)
+    {
+        const QPointF diff = pointAt(cubic, u[i - first]) - mPoints[i];
+        const qreal dist = dot(diff, diff);
+        if (dist >= maxDist)
+        {
+            maxDist = dist;
+            splitPoint = i;
+        }
+    }
+    return std::sqrt(maxDist);
+}
+
+QPointF BezierCurveFitter::centerTangent(int center) const
+{
+    QPointF tangent = mPoints[center - 1] - mPoints[center + 1];
+    if (BezierCurve::eLength(tangent) < 1e-6)
+    {
+        // the stroke turned back on itself
+        tangent = mPoints[center - 1] - mPoints[center];
+    }
+    return unit(tangent);
+}
+
+QPointF BezierCurveFitter::pointAt(const Cubic& cubic, qreal t)
+{
+    const qreal mt = 1.0 - t;
+    return mt * mt * mt * cubic.p0
+           + 3.0 * t * mt * mt * cubic.p1
+           + 3.0 * t * t * mt * cubic.p2
+           + t * t * t * cubic.p3;
+}
+
+qreal BezierCurveFitter::newtonRaphsonRootFind(const Cubic& cubic, QPointF point, qreal u)
+{
+    // control points of the first and second derivatives
+    const QPointF d1[3] = { 3.0 * (cubic.p1 - cubic.p0), 3.0 * (cubic.p2 - cubic.p1), 3.0 * (cubic.p3 - cubic.p2) };
+    const QPointF d2[2] = { 2.0 * (d1[1] - d1[0]), 2.0 * (d1[2] - d1[1]) };
+
+    const qreal mu = 1.0 - u;
+    const QPointF q = pointAt(cubic, u);
+    const QPointF q1 = mu * mu * d1[0] + 2.0 * u * mu * d1[1] + u * u * d1[2];
+    const QPointF q2 = mu * d2[0] + u * d2[1];
+
+    const QPointF diff = q - point;
+    const qreal numerator = dot(diff, q1);
+    const qreal denominator = dot(q1, q1) + dot(diff, q2);
+    if (qFuzzyIsNull(denominator))
+        return u;
+
+    return u - numerator / denominator;
+}
+
+QPointF BezierCurveFitter::unit(QPointF v)
+{
+    BezierCurve::normalise(v);
+    return v;
+}
@@ -0,0 +1,71 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#ifndef BEZIERCURVEFITTER_H
+#define BEZIERCURVEFITTER_H
+
+#include <QList>
+#include <QVector>
+#include <QPointF>
+#include "beziercurve.h"
+
+
+/**
+ * Fits cubic Bezier sections to raw stroke samples, within a maximum distance.
+ *
+ * This is Philip J. Schneider's algorithm from Graphics Gems (1990):
+ * least squares fit of a single cubic over chord-length parameters,
+ * refined by Newton-Raphson reparameterization, and split at the point
+ * of maximum error when the fit is still not good enough.
+ *
+ * The fitter doesn't touch any shared state, it's safe to run on a worker thread.
+ */
+class BezierCurveFitter
+{
+public:
+    explicit BezierCurveFitter(qreal maxError);
+
+    BezierCurve fit(const QList<QPointF>& points, const QList<qreal>& pressures);
+
+    /// The largest distance between a sample and the last fitted curve
+    qreal fitError() const { return mFitError; }
+
+private:
+    struct Cubic
+    {
+        QPointF p0, p1, p2, p3;
+    };
+
+    void fitCubic(int first, int last, QPointF tHat1, QPointF tHat2, BezierCurve& curve);
+    void appendSection(const Cubic& cubic, int last, BezierCurve& curve);
+
+    Cubic generateBezier(int first, int last, const QVector<qreal>& u, QPointF tHat1, QPointF tHat2) const;
+    QVector<qreal> chordLengthParameterize(int first, int last) const;
+    QVector<qreal> reparameterize(int first, int last, const QVector<qreal>& u, const Cubic& cubic) const;
+    qreal computeMaxError(int first, int last, const Cubic& cubic, const QVector<qreal>& u, int& splitPoint) const;
+    QPointF centerTangent(int center) const;
+
+    static QPointF pointAt(const Cubic& cubic, qreal t);
+    static qreal newtonRaphsonRootFind(const Cubic& cubic, QPointF point, qreal u);
+    static QPointF unit(QPointF v);
+
+    qreal mMaxError = 1.0;
+    qreal mFitError = 0.0;
+
+    QVector<QPointF> mPoints;
+    QVector<qreal> mPressures;
+};
+
+#endif // BEZIERCURVEFITTER_H
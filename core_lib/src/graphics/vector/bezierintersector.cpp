@@ -0,0 +1,210 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "bezierintersector.h"
+
+#include <algorithm>
+#include <QtMath>
+
+
+namespace
+{
+    // QRectF::intersects() ignores zero-width or zero-height rects,
+    // which is exactly what a horizontal or vertical section produces.
+    inline bool overlaps(const QRectF& a, const QRectF& b, qreal margin)
+    {
+        return a.left() <= b.right() + margin && b.left() <= a.right() + margin &&
+               a.top() <= b.bottom() + margin && b.top() <= a.bottom() + margin;
+    }
+}
+
+BezierIntersector::BezierIntersector(qreal tolerance)
+{
+    setTolerance(tolerance);
+}
+
+void BezierIntersector::setTolerance(qreal tolerance)
+{
+    mTolerance = qMax(tolerance, qreal(1e-4));
+}
+
+/**
+ * @brief BezierIntersector::intersect
+ * Finds all the intersections between the cubic section i1 of curve1 and the cubic section i2 of curve2.
+ * @param intersections: receives the intersections, sorted along curve1
+ * @return true if at least one intersection was found
+ */
+bool BezierIntersector::intersect(const BezierCurve& curve1, int i1, const BezierCurve& curve2, int i2, QList<Intersection>& intersections) const
+{
+    const Cubic a = section(curve1, i1);
+    const Cubic b = section(curve2, i2);
+
+    if (!overlaps(bounds(a), bounds(b), mTolerance))
+        return false;
+
+    QList<Intersection> found;
+    subdivide(a, b, 0, found);
+
+    std::sort(found.begin(), found.end(), [](const Intersection& x, const Intersection& y)
+    {
+        return x.t1 < y.t1;
+    });
+
+    bool result = false;
+    const qreal tolSquared = mTolerance * mTolerance;
+    for (const Intersection& candidate : found)
+    {
+        // the shared vertex of two consecutive sections is not an intersection
+        const QPointF d0 = candidate.point - a.p0;
+        const QPointF d3 = candidate.point - a.p3;
+        if (QPointF::dotProduct(d0, d0) <= tolSquared || QPointF::dotProduct(d3, d3) <= tolSquared)
+            continue;
+
+        // the same crossing can be found on both sides of a subdivision boundary
+        if (result)
+        {
+            const QPointF d = candidate.point - intersections.last().point;
+            if (QPointF::dotProduct(d, d) <= tolSquared)
+                continue;
+        }
+
+        intersections.append(candidate);
+        result = true;
+    }
+    return result;
+}
+
+QRectF BezierIntersector::sectionBounds(const BezierCurve& curve, int i)
+{
+    return bounds(section(curve, i));
+}
+
+void BezierIntersector::subdivide(const Cubic& a, const Cubic& b, int depth, QList<Intersection>& found) const
+{
+    if (!overlaps(bounds(a), bounds(b), mTolerance))
+        return;
+
+    // Roger Willcocks' flatness criterion compares against 16 * tol^2
+    const qreal flatEnough = 16.0 * mTolerance * mTolerance;
+    const bool aFlat = flatness(a) <= flatEnough;
+    const bool bFlat = flatness(b) <= flatEnough;
+
+    if ((aFlat && bFlat) || depth >= mMaxDepth)
+    {
+        qreal s = 0.0;
+        qreal u = 0.0;
+        if (segmentIntersection(a.p0, a.p3, b.p0, b.p3, s, u))
+        {
+            Intersection intersection;
+            intersection.point = a.p0 + s * (a.p3 - a.p0);
+            intersection.t1 = a.t0 + s * (a.t1 - a.t0);
+            intersection.t2 = b.t0 + u * (b.t1 - b.t0);
+            found.append(intersection);
+        }
+        return;
+    }
+
+    Cubic a1, a2, b1, b2;
+    if (aFlat)
+    {
+        split(b, b1, b2);
+        subdivide(a, b1, depth + 1, found);
+        subdivide(a, b2, depth + 1, found);
+    }
+    else if (bFlat)
+    {
+        split(a, a1, a2);
+        subdivide(a1, b, depth + 1, found);
+        subdivide(a2, b, depth + 1, found);
+    }
+    else
+    {
+        split(a, a1, a2);
+        split(b, b1, b2);
+        subdivide(a1, b1, depth + 1, found);
+        subdivide(a1, b2, depth + 1, found);
+        subdivide(a2, b1, depth + 1, found);
+        subdivide(a2, b2, depth + 1, found);
+    }
+}
+
+BezierIntersector::Cubic BezierIntersector::section(const BezierCurve& curve, int i)
+{
+    Cubic c;
+    c.p0 = curve.getVertex(i - 1);
+    c.p1 = curve.getC1(i);
+    c.p2 = curve.getC2(i);
+    c.p3 = curve.getVertex(i);
+    return c;
+}
+
+void BezierIntersector::split(const Cubic& c, Cubic& left, Cubic& right)
+{
+    // de Casteljau at t = 0.5
+    const QPointF p01 = 0.5 * (c.p0 + c.p1);
+    const QPointF p12 = 0.5 * (c.p1 + c.p2);
+    const QPointF p23 = 0.5 * (c.p2 + c.p3);
+    const QPointF p012 = 0.5 * (p01 + p12);
+    const QPointF p123 = 0.5 * (p12 + p23);
+    const QPointF mid = 0.5 * (p012 + p123);
+    const qreal tMid = 0.5 * (c.t0 + c.t1);
+
+    left.p0 = c.p0;
+    left.p1 = p01;
+    left.p2 = p012;
+    left.p3 = mid;
+    left.t0 = c.t0;
+    left.t1 = tMid;
+
+    right.p0 = mid;
+    right.p1 = p123;
+    right.p2 = p23;
+    right.p3 = c.p3;
+    right.t0 = tMid;
+    right.t1 = c.t1;
+}
+
+QRectF BezierIntersector::bounds(const Cubic& c)
+{
+    // the curve always lies inside the bounding box of its control points
+    const qreal minX = qMin(qMin(c.p0.x(), c.p1.x()), qMin(c.p2.x(), c.p3.x()));
+    const qreal maxX = qMax(qMax(c.p0.x(), c.p1.x()), qMax(c.p2.x(), c.p3.x()));
+    const qreal minY = qMin(qMin(c.p0.y(), c.p1.y()), qMin(c.p2.y(), c.p3.y()));
+    const qreal maxY = qMax(qMax(c.p0.y(), c.p1.y()), qMax(c.p2.y(), c.p3.y()));
+    return QRectF(QPointF(minX, minY), QPointF(maxX, maxY));
+}
+
+qreal BezierIntersector::flatness(const Cubic& c)
+{
+    qreal ux = 3.0 * c.p1.x() - 2.0 * c.p0.x() - c.p3.x();
+    qreal uy = 3.0 * c.p1.y() - 2.0 * c.p0.y() - c.p3.y();
+    qreal vx = 3.0 * c.p2.x() - 2.0 * c.p3.x() - c.p0.x();
+    qreal vy = 3.0 * c.p2.y() - 2.0 * c.p3.y() - c.p0.y();
+    return qMax(ux * ux, vx * vx) + qMax(uy * uy, vy * vy);
+}
+
+bool BezierIntersector::segmentIntersection(const QPointF& a0, const QPointF& a1, const QPointF& b0, const QPointF& b1, qreal& s, qreal& u)
+{
+    const QPointF da = a1 - a0;
+    const QPointF db = b1 - b0;
+    const qreal denom = da.x() * db.y() - da.y() * db.x();
+    if (qFuzzyIsNull(denom))
+        return false; // parallel or degenerated
+
+    const QPointF d = b0 - a0;
+    s = (d.x() * db.y() - d.y() * db.x()) / denom;
+    u = (d.x() * da.y() - d.y() * da.x()) / denom;
+    return s >= 0.0 && s <= 1.0 && u >= 0.0 && u <= 1.0;
+}
@@ -0,0 +1,66 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#ifndef BEZIERINTERSECTOR_H
+#define BEZIERINTERSECTOR_H
+
+#include <QList>
+#include <QPointF>
+#include <QRectF>
+#include "beziercurve.h"
+
+
+/**
+ * BezierIntersector finds every intersection between two cubic sections.
+ *
+ * Pairs whose control polygons don't overlap are rejected right away.
+ * The remaining pairs are subdivided (de Casteljau) until both pieces are flatter
+ * than the tolerance, at which point the pieces are intersected as line segments.
+ * Intersections landing on the end points of the first section are skipped,
+ * so two neighbouring sections of the same curve don't report their shared vertex.
+ */
+class BezierIntersector
+{
+public:
+    explicit BezierIntersector(qreal tolerance = 0.1);
+
+    void setTolerance(qreal tolerance);
+    qreal tolerance() const { return mTolerance; }
+
+    bool intersect(const BezierCurve& curve1, int i1, const BezierCurve& curve2, int i2, QList<Intersection>& intersections) const;
+
+    static QRectF sectionBounds(const BezierCurve& curve, int i);
+
+private:
+    struct Cubic
+    {
+        QPointF p0, p1, p2, p3;
+        qreal t0 = 0.0;
+        qreal t1 = 1.0;
+    };
+
+    void subdivide(const Cubic& a, const Cubic& b, int depth, QList<Intersection>& found) const;
+
+    static Cubic section(const BezierCurve& curve, int i);
+    static void split(const Cubic& c, Cubic& left, Cubic& right);
+    static QRectF bounds(const Cubic& c);
+    static qreal flatness(const Cubic& c);
+    static bool segmentIntersection(const QPointF& a0, const QPointF& a1, const QPointF& b0, const QPointF& b1, qreal& s, qreal& u);
+
+    qreal mTolerance = 0.1;
+    int mMaxDepth = 24;
+};
+
+#endif // BEZIERINTERSECTOR_H
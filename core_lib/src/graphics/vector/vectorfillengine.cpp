@@ -0,0 +1,367 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "vectorfillengine.h"
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+
+namespace
+{
+    // pixels left around the curves, so that a leaking fill reaches the border of the mask
+    const int rasterMargin = 3;
+
+    // the outline is sampled at most this many times when mapped back to the curves
+    const int maxOutlineSamples = 4096;
+
+    // fewer consecutive outline samples on one curve are a curve merely touching the area
+    const int minRunSamples = 3;
+
+    // the 8 neighbours of a pixel, clockwise on screen starting from the west
+    const int neighbourX[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+    const int neighbourY[8] = { 0, -1, -1, -1, 0, 1, 1, 1 };
+}
+
+VectorFillEngine::VectorFillEngine(const QList<BezierCurve>& curves, const VectorHitTester& hitTester)
+    : mCurves(curves), mHitTester(hitTester)
+{
+}
+
+/**
+ * @brief VectorFillEngine::findArea
+ * @param point: a point inside the area, in canvas coordinates
+ * @param scaling: the view scaling, the mask is never finer than a screen pixel
+ * @return the vertices around the area, or an empty list if the point is not enclosed by curves
+ */
+QList<VertexRef> VectorFillEngine::findArea(QPointF point, qreal scaling)
+{
+    if (!rasterize(point, scaling))
+        return QList<VertexRef>();
+
+    if (!spanFill(toRaster(point)))
+        return QList<VertexRef>();
+
+    // the outline runs through the filled pixels next to the curves
+    const qreal maxDistance = 3.0 * mPixelSize;
+    return vertexPathAlong(traceOutline(), maxDistance);
+}
+
+/**
+ * @brief VectorFillEngine::vertexPathAlong
+ * @param contour: points following the curves
+ * @param maxDistance: how far from a curve the points can be
+ * @param skipped: curves flagged here are ignored
+ * @return the vertices met along the contour, in order and without duplicates
+ */
+QList<VertexRef> VectorFillEngine::vertexPathAlong(const QList<QPointF>& contour, qreal maxDistance,
+                                                   const QVector<bool>& skipped) const
+{
+    struct Sample
+    {
+        QPointF point;
+        qreal position;  // section + t, the vertex n sits at n + 1
+    };
+    struct Run
+    {
+        int curve;
+        QVector<Sample> samples;
+    };
+
+    // consecutive samples on the same curve
+    QList<Run> runs;
+    const int stride = qMax(1, contour.size() / maxOutlineSamples);
+    for (int i = 0; i < contour.size(); i += stride)
+    {
+        const VectorHitTester::CurvePoint hit = mHitTester.closestPointTo(contour.at(i), maxDistance, skipped);
+        if (hit.curve == -1)
+            continue;
+
+        if (runs.isEmpty() || runs.last().curve != hit.curve)
+        {
+            runs.append(Run{ hit.curve, QVector<Sample>() });
+        }
+        runs.last().samples.append(Sample{ contour.at(i), hit.section + hit.t });
+    }
+
+    QList<Run> kept;
+    for (const Run& run : runs)
+    {
+        if (run.samples.size() >= minRunSamples)
+        {
+            kept.append(run);
+        }
+    }
+    if (kept.isEmpty())
+    {
+        kept = runs;
+    }
+
+    QList<VertexRef> result;
+    auto addVertex = [&](int curveNumber, int position)
+    {
+        const VertexRef vertex(curveNumber, position - 1);
+        if (result.contains(vertex))
+            return;
+
+        // the ends of a closed curve, or curves joined end to end, are the same point
+        if (!result.isEmpty())
+        {
+            const QPointF point = mCurves.at(curveNumber).getVertex(position - 1);
+            if (point == vertexPosition(result.last()) || point == vertexPosition(result.first()))
+                return;
+        }
+        result.append(vertex);
+    };
+
+    for (const Run& run : kept)
+    {
+        const BezierCurve& curve = mCurves.at(run.curve);
+        const int vertexCount = curve.getVertexSize();
+        const bool closed = curve.getVertex(-1) == curve.getVertex(vertexCount - 1);
+
+        // a run starts or ends on a vertex only if it really gets there
+        auto addIfReached = [&](const Sample& sample)
+        {
+            const int position = qRound(sample.position);
+            if (BezierCurve::eLength(curve.getVertex(position - 1) - sample.point) <= maxDistance)
+            {
+                addVertex(run.curve, position);
+            }
+        };
+
+        addIfReached(run.samples.first());
+        for (int i = 1; i < run.samples.size(); i++)
+        {
+            qreal from = run.samples.at(i - 1).position;
+            qreal to = run.samples.at(i).position;
+            if (closed && qAbs(to - from) > vertexCount / 2.0)
+            {
+                // crossing the point where a closed curve meets itself
+                if (from > to)
+                {
+                    to += vertexCount;
+                }
+                else
+                {
+                    from += vertexCount;
+                }
+            }
+
+            // the vertices passed between the two samples
+            if (to > from)
+            {
+                for (int p = int(std::floor(from)) + 1; p <= to; p++)
+                {
+                    addVertex(run.curve, (p > vertexCount) ? p - vertexCount : p);
+                }
+            }
+            else
+            {
+                for (int p = int(std::ceil(from)) - 1; p >= to; p--)
+                {
+                    addVertex(run.curve, (p > vertexCount) ? p - vertexCount : p);
+                }
+            }
+        }
+        addIfReached(run.samples.last());
+    }
+    return result;
+}
+
+bool VectorFillEngine::rasterize(QPointF point, qreal scaling)
+{
+    const QRectF bounds = mHitTester.boundingRect();
+    if (!bounds.contains(point))
+        return false;
+
+    // as fine as a screen pixel, as long as the mask stays within mMaxRasterSize
+    const qreal extent = qMax(bounds.width(), bounds.height());
+    const int usableSize = qMax(mMaxRasterSize - 2 * rasterMargin - 1, 1);
+    mPixelSize = qMax(1.0 / qMax(scaling, 0.001), extent / usableSize);
+
+    mOrigin = bounds.topLeft() - QPointF(rasterMargin, rasterMargin) * mPixelSize;
+    mWidth = int(std::ceil(bounds.width() / mPixelSize)) + 2 * rasterMargin + 1;
+    mHeight = int(std::ceil(bounds.height() / mPixelSize)) + 2 * rasterMargin + 1;
+    mMask.fill(Empty, mWidth * mHeight);
+
+    for (const VectorHitTester::Segment& segment : mHitTester.segments())
+    {
+        drawLine(toRaster(segment.p0), toRaster(segment.p1));
+    }
+    return true;
+}
+
+/**
+ * @brief VectorFillEngine::drawLine
+ * Bresenham line. Its pixels are 8-connected, which is enough to stop a 4-connected fill.
+ */
+void VectorFillEngine::drawLine(QPoint p0, QPoint p1)
+{
+    int x = p0.x();
+    int y = p0.y();
+    const int dx = qAbs(p1.x() - x);
+    const int dy = -qAbs(p1.y() - y);
+    const int sx = (x < p1.x()) ? 1 : -1;
+    const int sy = (y < p1.y()) ? 1 : -1;
+    int error = dx + dy;
+
+    while (true)
+    {
+        mMask[y * mWidth + x] = Wall;
+        if (x == p1.x() && y == p1.y())
+            break;
+
+        const int e2 = 2 * error;
+        if (e2 >= dy)
+        {
+            error += dy;
+            x += sx;
+        }
+        if (e2 <= dx)
+        {
+            error += dx;
+            y += sy;
+        }
+    }
+}
+
+/**
+ * @brief VectorFillEngine::spanFill
+ * 4-connected scanline fill of the empty pixels around the seed.
+ * @return false if the fill leaks out of the curves
+ */
+bool VectorFillEngine::spanFill(QPoint seed)
+{
+    if (pixel(seed.x(), seed.y()) != Empty)
+        return false;
+
+    std::vector<QPoint> stack;
+    stack.push_back(seed);
+    while (!stack.empty())
+    {
+        const QPoint p = stack.back();
+        stack.pop_back();
+
+        const int y = p.y();
+        if (pixel(p.x(), y) != Empty)
+            continue;
+
+        int left = p.x();
+        while (left > 0 && pixel(left - 1, y) == Empty)
+        {
+            left--;
+        }
+        int right = p.x();
+        while (right < mWidth - 1 && pixel(right + 1, y) == Empty)
+        {
+            right++;
+        }
+
+        // the curves are inside the margin, reaching the border means the area is open
+        if (left == 0 || right == mWidth - 1 || y == 0 || y == mHeight - 1)
+            return false;
+
+        quint8* line = mMask.data() + y * mWidth;
+        std::fill(line + left, line + right + 1, quint8(Filled));
+
+        for (int ny : { y - 1, y + 1 })
+        {
+            bool inSpan = false;
+            for (int x = left; x <= right; x++)
+            {
+                const bool empty = pixel(x, ny) == Empty;
+                if (empty && !inSpan)
+                {
+                    stack.push_back(QPoint(x, ny));
+                }
+                inSpan = empty;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief VectorFillEngine::traceOutline
+ * Moore neighbour tracing of the outer boundary of the filled pixels.
+ * @return the boundary pixels in canvas coordinates, going around the area
+ */
+QList<QPointF> VectorFillEngine::traceOutline() const
+{
+    QList<QPointF> outline;
+
+    // the first filled pixel in scan order is on the outer boundary, and its west neighbour is not filled
+    const int first = int(std::find(mMask.begin(), mMask.end(), quint8(Filled)) - mMask.begin());
+    if (first >= mMask.size())
+        return outline;
+
+    const QPoint start(first % mWidth, first / mWidth);
+    const QPoint startBacktrack(start.x() - 1, start.y());
+
+    QPoint current = start;
+    QPoint backtrack = startBacktrack;
+    outline.append(fromRaster(current));
+
+    // every pixel is entered from at most 8 directions
+    const int maxSteps = 8 * mWidth * mHeight;
+    for (int step = 0; step < maxSteps; step++)
+    {
+        int from = 0;
+        while (current.x() + neighbourX[from] != backtrack.x() || current.y() + neighbourY[from] != backtrack.y())
+        {
+            from++;
+        }
+
+        bool found = false;
+        for (int i = 1; i <= 8; i++)
+        {
+            const int d = (from + i) % 8;
+            const QPoint next(current.x() + neighbourX[d], current.y() + neighbourY[d]);
+            if (pixel(next.x(), next.y()) == Filled)
+            {
+                const int previous = (from + i - 1) % 8;
+                backtrack = QPoint(current.x() + neighbourX[previous], current.y() + neighbourY[previous]);
+                current = next;
+                found = true;
+                break;
+            }
+        }
+
+        // a single pixel, or back where we started in the same way (Jacob's stopping criterion)
+        if (!found || (current == start && backtrack == startBacktrack))
+            break;
+
+        outline.append(fromRaster(current));
+    }
+    return outline;
+}
+
+QPointF VectorFillEngine::vertexPosition(const VertexRef& vertex) const
+{
+    return mCurves.at(vertex.curveNumber).getVertex(vertex.vertexNumber);
+}
+
+QPoint VectorFillEngine::toRaster(QPointF p) const
+{
+    return QPoint(int(std::floor((p.x() - mOrigin.x()) / mPixelSize)),
+                  int(std::floor((p.y() - mOrigin.y()) / mPixelSize)));
+}
+
+QPointF VectorFillEngine::fromRaster(QPoint p) const
+{
+    return mOrigin + QPointF(p.x() + 0.5, p.y() + 0.5) * mPixelSize;
+}
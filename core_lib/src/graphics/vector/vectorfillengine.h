@@ -0,0 +1,73 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#ifndef VECTORFILLENGINE_H
+#define VECTORFILLENGINE_H
+
+#include <QList>
+#include <QPoint>
+#include <QPointF>
+#include <QVector>
+#include "beziercurve.h"
+#include "vertexref.h"
+#include "vectorhittester.h"
+
+
+/**
+ * Finds the area enclosed by the curves of a vector frame around a point.
+ *
+ * The flattened curves of the hit tester are rasterized once in a coarse mask,
+ * the mask is flood filled span by span from the point and the outline of the filled
+ * region is traced and mapped back to the vertices of the curves it runs along.
+ *
+ * The mask never exceeds maxRasterSize pixels a side, so the cost of a fill is bounded
+ * no matter how many curves the frame holds.
+ */
+class VectorFillEngine
+{
+public:
+    VectorFillEngine(const QList<BezierCurve>& curves, const VectorHitTester& hitTester);
+
+    void setMaxRasterSize(int size) { mMaxRasterSize = size; }
+
+    QList<VertexRef> findArea(QPointF point, qreal scaling);
+    QList<VertexRef> vertexPathAlong(const QList<QPointF>& contour, qreal maxDistance,
+                                     const QVector<bool>& skipped = QVector<bool>()) const;
+
+private:
+    enum Pixel : quint8 { Empty = 0, Wall, Filled };
+
+    bool rasterize(QPointF point, qreal scaling);
+    void drawLine(QPoint p0, QPoint p1);
+    bool spanFill(QPoint seed);
+    QList<QPointF> traceOutline() const;
+
+    QPoint toRaster(QPointF p) const;
+    QPointF fromRaster(QPoint p) const;
+    QPointF vertexPosition(const VertexRef& vertex) const;
+    quint8 pixel(int x, int y) const { return mMask[y * mWidth + x]; }
+
+    const QList<BezierCurve>& mCurves;
+    const VectorHitTester& mHitTester;
+    int mMaxRasterSize = 1024;
+
+    QPointF mOrigin;
+    qreal mPixelSize = 1.0;
+    int mWidth = 0;
+    int mHeight = 0;
+    QVector<quint8> mMask;
+};
+
+#endif // VECTORFILLENGINE_H
@@ -0,0 +1,273 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "vectorhittester.h"
+
+#include <cmath>
+#include <algorithm>
+
+
+namespace
+{
+    // length of the flattened segments, in canvas units
+    const qreal segmentLength = 4.0;
+    const int maxSegmentsPerSection = 64;
+}
+
+VectorHitTester::VectorHitTester(qreal cellSize) : mCellSize(cellSize)
+{
+}
+
+void VectorHitTester::build(const QList<BezierCurve>& curves)
+{
+    mSegments.clear();
+    mVertices.clear();
+    mSegmentGrid.clear();
+    mVertexGrid.clear();
+    mBoundingRect = QRectF();
+
+    for (int c = 0; c < curves.size(); c++)
+    {
+        const BezierCurve& curve = curves.at(c);
+
+        Vertex origin;
+        origin.p = curve.getVertex(-1);
+        origin.ref = VertexRef(c, -1);
+        addVertex(origin);
+
+        for (int i = 0; i < curve.getVertexSize(); i++)
+        {
+            const QPointF p0 = curve.getVertex(i - 1);
+            const QPointF p3 = curve.getVertex(i);
+
+            // the control polygon is never shorter than the curve
+            const qreal polygonLength = BezierCurve::eLength(curve.getC1(i) - p0)
+                                      + BezierCurve::eLength(curve.getC2(i) - curve.getC1(i))
+                                      + BezierCurve::eLength(p3 - curve.getC2(i));
+            const int steps = qBound(1, int(std::ceil(polygonLength / segmentLength)), maxSegmentsPerSection);
+
+            Segment segment;
+            segment.curve = c;
+            segment.section = i;
+            segment.p0 = p0;
+            for (int k = 1; k <= steps; k++)
+            {
+                segment.t1 = qreal(k) / steps;
+                segment.p1 = (k == steps) ? p3 : curve.getPointOnCubic(i, segment.t1);
+                addSegment(segment);
+                segment.p0 = segment.p1;
+                segment.t0 = segment.t1;
+            }
+
+            Vertex vertex;
+            vertex.p = p3;
+            vertex.ref = VertexRef(c, i);
+            addVertex(vertex);
+        }
+    }
+    mValid = true;
+}
+
+/**
+ * @brief VectorHitTester::curvesCloseTo
+ * @param skipped: curves flagged here are ignored
+ * @return the indices, in ascending order, of the curves closer than maxDistance to the point
+ */
+QList<int> VectorHitTester::curvesCloseTo(QPointF point, qreal maxDistance, const QVector<bool>& skipped) const
+{
+    std::vector<int> found;
+    visitCells(mSegmentGrid, point, maxDistance, [&](int index)
+    {
+        const Segment& segment = mSegments[index];
+        if (!isSkipped(skipped, segment.curve) && distanceToSegment(point, segment) < maxDistance)
+        {
+            found.push_back(segment.curve);
+        }
+    });
+
+    std::sort(found.begin(), found.end());
+    found.erase(std::unique(found.begin(), found.end()), found.end());
+
+    QList<int> result;
+    result.reserve(int(found.size()));
+    for (int curve : found)
+    {
+        result.append(curve);
+    }
+    return result;
+}
+
+/**
+ * @brief VectorHitTester::closestCurveTo
+ * @return the index of the nearest curve within maxDistance, or -1
+ */
+int VectorHitTester::closestCurveTo(QPointF point, qreal maxDistance, const QVector<bool>& skipped, qreal* distance) const
+{
+    const CurvePoint closest = closestPointTo(point, maxDistance, skipped);
+    if (distance != nullptr)
+    {
+        *distance = (closest.curve == -1) ? maxDistance : closest.distance;
+    }
+    return closest.curve;
+}
+
+/**
+ * @brief VectorHitTester::verticesCloseTo
+ * @return the vertices closer than maxDistance to the point, in curve then vertex order
+ */
+QList<VertexRef> VectorHitTester::verticesCloseTo(QPointF point, qreal maxDistance, const QVector<bool>& skipped) const
+{
+    const qreal maxDistanceSquared = maxDistance * maxDistance;
+
+    std::vector<int> found;
+    visitCells(mVertexGrid, point, maxDistance, [&](int index)
+    {
+        const QPointF d = mVertices[index].p - point;
+        if (!isSkipped(skipped, mVertices[index].ref.curveNumber) && QPointF::dotProduct(d, d) < maxDistanceSquared)
+        {
+            found.push_back(index);
+        }
+    });
+
+    // vertices are stored in curve then vertex order
+    std::sort(found.begin(), found.end());
+
+    QList<VertexRef> result;
+    result.reserve(int(found.size()));
+    for (int index : found)
+    {
+        result.append(mVertices[index].ref);
+    }
+    return result;
+}
+
+/**
+ * @brief VectorHitTester::closestVertexTo
+ * @return the nearest vertex within maxDistance, or VertexRef(-1, -1)
+ */
+VertexRef VectorHitTester::closestVertexTo(QPointF point, qreal maxDistance, const QVector<bool>& skipped) const
+{
+    VertexRef closest(-1, -1);
+    qreal closestDistance = maxDistance * maxDistance;
+    visitCells(mVertexGrid, point, maxDistance, [&](int index)
+    {
+        if (isSkipped(skipped, mVertices[index].ref.curveNumber))
+            return;
+
+        const QPointF d = mVertices[index].p - point;
+        const qreal distance = QPointF::dotProduct(d, d);
+        if (distance < closestDistance)
+        {
+            closestDistance = distance;
+            closest = mVertices[index].ref;
+        }
+    });
+    return closest;
+}
+
+/**
+ * @brief VectorHitTester::closestPointTo
+ * @return the nearest point on any curve within maxDistance, its curve is -1 if there is none
+ */
+VectorHitTester::CurvePoint VectorHitTester::closestPointTo(QPointF point, qreal maxDistance, const QVector<bool>& skipped) const
+{
+    CurvePoint closest;
+    closest.distance = maxDistance;
+    visitCells(mSegmentGrid, point, maxDistance, [&](int index)
+    {
+        const Segment& segment = mSegments[index];
+        if (isSkipped(skipped, segment.curve))
+            return;
+
+        qreal t = 0.0;
+        const qreal d = distanceToSegment(point, segment, &t);
+        if (d < maxDistance && (d < closest.distance || (d == closest.distance && segment.curve > closest.curve)))
+        {
+            // on a tie, the curve painted last (on top) wins
+            closest.curve = segment.curve;
+            closest.section = segment.section;
+            closest.t = segment.t0 + t * (segment.t1 - segment.t0);
+            closest.distance = d;
+        }
+    });
+    return closest;
+}
+
+void VectorHitTester::addSegment(const Segment& segment)
+{
+    const int index = mSegments.size();
+    mSegments.append(segment);
+    mBoundingRect |= QRectF(segment.p0, segment.p1).normalized();
+
+    const int x0 = cellCoord(qMin(segment.p0.x(), segment.p1.x()));
+    const int x1 = cellCoord(qMax(segment.p0.x(), segment.p1.x()));
+    const int y0 = cellCoord(qMin(segment.p0.y(), segment.p1.y()));
+    const int y1 = cellCoord(qMax(segment.p0.y(), segment.p1.y()));
+    for (int cx = x0; cx <= x1; cx++)
+    {
+        for (int cy = y0; cy <= y1; cy++)
+        {
+            mSegmentGrid[cellKey(cx, cy)].append(index);
+        }
+    }
+}
+
+void VectorHitTester::addVertex(const Vertex& vertex)
+{
+    const int index = mVertices.size();
+    mVertices.append(vertex);
+    mVertexGrid[cellKey(cellCoord(vertex.p.x()), cellCoord(vertex.p.y()))].append(index);
+}
+
+template<typename Visitor>
+void VectorHitTester::visitCells(const QHash<quint64, QVector<int>>& grid, QPointF point, qreal radius, Visitor visit) const
+{
+    const int x0 = cellCoord(point.x() - radius);
+    const int x1 = cellCoord(point.x() + radius);
+    const int y0 = cellCoord(point.y() - radius);
+    const int y1 = cellCoord(point.y() + radius);
+    for (int cx = x0; cx <= x1; cx++)
+    {
+        for (int cy = y0; cy <= y1; cy++)
+        {
+            auto it = grid.constFind(cellKey(cx, cy));
+            if (it == grid.constEnd())
+                continue;
+
+            // a segment spanning several cells can be visited more than once, that's harmless
+            for (int index : it.value())
+            {
+                visit(index);
+            }
+        }
+    }
+}
+
+qreal VectorHitTester::distanceToSegment(QPointF point, const Segment& segment, qreal* t)
+{
+    const QPointF d = segment.p1 - segment.p0;
+    const qreal lengthSquared = QPointF::dotProduct(d, d);
+
+    qreal u = 0.0;
+    if (lengthSquared > 0.0)
+    {
+        u = qBound(0.0, QPointF::dotProduct(point - segment.p0, d) / lengthSquared, 1.0);
+    }
+    if (t != nullptr)
+    {
+        *t = u;
+    }
+    return BezierCurve::eLength(point - (segment.p0 + u * d));
+}
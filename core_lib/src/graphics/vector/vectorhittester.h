@@ -0,0 +1,104 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#ifndef VECTORHITTESTER_H
+#define VECTORHITTESTER_H
+
+#include <cmath>
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include <QPointF>
+#include <QRectF>
+#include "beziercurve.h"
+#include "vertexref.h"
+
+
+/**
+ * Answers "which curve/vertex is under the pointer" for a VectorImage without walking every curve.
+ *
+ * Every cubic section is flattened once into short line segments,
+ * and the segments and vertices are bucketed in a uniform grid.
+ * A query only looks at the few cells around the pointer.
+ *
+ * The index must be rebuilt whenever the geometry of the curves changes.
+ * Queries can skip some curves (e.g. a selection being transformed), the caller tests those itself.
+ */
+class VectorHitTester
+{
+public:
+    struct Segment
+    {
+        QPointF p0, p1;
+        int curve = -1;
+        int section = 0;
+        qreal t0 = 0.0, t1 = 1.0;
+    };
+
+    /// A point on a curve: section i at parameter t, as in BezierCurve::getPointOnCubic(i, t)
+    struct CurvePoint
+    {
+        int curve = -1;
+        int section = 0;
+        qreal t = 0.0;
+        qreal distance = 0.0;
+    };
+
+    explicit VectorHitTester(qreal cellSize = 32.0);
+
+    void invalidate() { mValid = false; }
+    bool isValid() const { return mValid; }
+    void build(const QList<BezierCurve>& curves);
+
+    QList<int> curvesCloseTo(QPointF point, qreal maxDistance, const QVector<bool>& skipped = QVector<bool>()) const;
+    int closestCurveTo(QPointF point, qreal maxDistance, const QVector<bool>& skipped = QVector<bool>(), qreal* distance = nullptr) const;
+
+    QList<VertexRef> verticesCloseTo(QPointF point, qreal maxDistance, const QVector<bool>& skipped = QVector<bool>()) const;
+    VertexRef closestVertexTo(QPointF point, qreal maxDistance, const QVector<bool>& skipped = QVector<bool>()) const;
+    CurvePoint closestPointTo(QPointF point, qreal maxDistance, const QVector<bool>& skipped = QVector<bool>()) const;
+
+    const QVector<Segment>& segments() const { return mSegments; }
+    QRectF boundingRect() const { return mBoundingRect; }
+
+private:
+    struct Vertex
+    {
+        QPointF p;
+        VertexRef ref;
+    };
+
+    quint64 cellKey(int cx, int cy) const { return (quint64(quint32(cx)) << 32) | quint32(cy); }
+    int cellCoord(qreal v) const { return int(std::floor(v / mCellSize)); }
+
+    void addSegment(const Segment& segment);
+    void addVertex(const Vertex& vertex);
+
+    template<typename Visitor>
+    void visitCells(const QHash<quint64, QVector<int>>& grid, QPointF point, qreal radius, Visitor visit) const;
+
+    static bool isSkipped(const QVector<bool>& skipped, int curve) { return curve < skipped.size() && skipped[curve]; }
+    static qreal distanceToSegment(QPointF point, const Segment& segment, qreal* t = nullptr);
+
+    qreal mCellSize = 32.0;
+    bool mValid = false;
+    QRectF mBoundingRect;
+
+    QVector<Segment> mSegments;
+    QVector<Vertex> mVertices;
+    QHash<quint64, QVector<int>> mSegmentGrid;
+    QHash<quint64, QVector<int>> mVertexGrid;
+};
+
+#endif // VECTORHITTESTER_H
@@ -17,12 +17,14 @@ GNU General Public License for more details.
 #include "vectorimage.h"
 
 #include <cmath>
+#include <algorithm>
 #include <QImage>
 #include <QFile>
 #include <QFileInfo>
 #include <QDebug>
 #include <QXmlStreamWriter>
 #include "object.h"
+#include "vectorfillengine.h"
 
 
 VectorImage::VectorImage()
@@ -54,6 +56,7 @@ VectorImage& VectorImage::operator=(const VectorImage& a) {
     KeyFrame::operator=(a);
     mObject = a.mObject;
     mCurves = a.mCurves;
+    mHitTester.invalidate();
     mArea = a.mArea;
     mOpacity = a.mOpacity;
     modification();
@@ -212,14 +215,22 @@ void VectorImage::loadDomElement(QDomElement element)
         }
         atomTag = atomTag.nextSibling();
     }
+    mHitTester.invalidate();
     clean();
 }
 
 BezierCurve& VectorImage::curve(int i)
 {
+    // the caller may modify the curve
+    mHitTester.invalidate();
     return mCurves[i];
 }
 
+const BezierCurve& VectorImage::curve(int i) const
+{
+    return mCurves.at(i);
+}
+
 /**
  * @brief VectorImage::addPoint
  * @param curveNumber: int of the curve position
@@ -229,6 +240,7 @@ BezierCurve& VectorImage::curve(int i)
 void VectorImage::addPoint(int curveNumber, int vertexNumber, qreal fraction)
 {
     mCurves[curveNumber].addPoint(vertexNumber, fraction);
+    mHitTester.invalidate();
     // updates the bezierAreas
     for (int j = 0; j < mArea.size(); j++)
     {
@@ -281,6 +293,7 @@ void VectorImage::removeCurveAt(int i)
     }
     // then remove curve
     mCurves.removeAt(i);
+    mHitTester.invalidate();
     modification();
 }
 
@@ -327,6 +340,8 @@ void VectorImage::insertCurve(int position, BezierCurve& newCurve, qreal factor,
         }
         mCurves.insert(position, newCurve);
     }
+    // checkCurveExtremity/checkCurveIntersections may have moved vertices of other curves too
+    mHitTester.invalidate();
     updateImageSize(newCurve);
     modification();
 }
@@ -925,6 +940,7 @@ void VectorImage::deleteSelection()
             i--;
         }
     }
+    mHitTester.invalidate();
     modification();
 }
 
@@ -951,6 +967,7 @@ void VectorImage::removeVertex(int curve, int vertex)
         }
     }
     // then eliminates the point
+    mHitTester.invalidate();
     if (mCurves[curve].getVertexSize() > 1)
     {
         // second possibility: we split the curve into two parts:
@@ -1070,6 +1087,7 @@ void VectorImage::paste(VectorImage& vectorImage)
         }
         if (ok) mArea.append(newArea);
     }
+    mHitTester.invalidate();
     modification();
 }
 
@@ -1220,7 +1238,7 @@ void VectorImage::paintImage(QPainter& painter,
     }
 
     // ---- draw curves ----
-    for (BezierCurve curve : mCurves)
+    for (BezierCurve& curve : mCurves)
     {
         curve.drawPath(painter, mObject, mSelectionTransformation, simplified, showThinCurves);
         painter.setClipping(false);
@@ -1254,6 +1272,7 @@ void VectorImage::clear()
 {
     while (mCurves.size() > 0) { mCurves.removeAt(0); }
     while (mArea.size() > 0) { mArea.removeAt(0); }
+    mHitTester.invalidate();
     modification();
 }
 
@@ -1270,6 +1289,7 @@ void VectorImage::clean()
             i--;
         }
     }
+    mHitTester.invalidate();
 }
 
 /**
@@ -1295,6 +1315,7 @@ void VectorImage::applySelectionTransformation(QTransform transf)
     }
     calculateSelectionRect();
     mSelectionTransformation.reset();
+    mHitTester.invalidate();
     modification();
 }
 
@@ -1401,24 +1422,30 @@ void VectorImage::applyVariableWidthToSelection(bool YesOrNo)
  */
 QList<int> VectorImage::getCurvesCloseTo(QPointF P1, qreal maxDistance)
 {
-    QList<int> result;
-    for (int j = 0; j < mCurves.size(); j++)
+    // the curves being transformed are not where the index has them, test them one by one
+    const QVector<bool> transformedCurves = getTransformedCurves();
+
+    QList<int> result = hitTester().curvesCloseTo(P1, maxDistance, transformedCurves);
+    for (int j = 0; j < transformedCurves.size(); j++)
     {
-        BezierCurve myCurve;
-        if (mCurves[j].isPartlySelected())
+        if (transformedCurves[j] && mCurves[j].transformed(mSelectionTransformation).intersects(P1, maxDistance))
         {
-            myCurve = mCurves[j].transformed(mSelectionTransformation);
-        }
-        else
-        {
-            myCurve = mCurves[j];
+            result.append(j);
         }
-        if (myCurve.intersects(P1, maxDistance))
+    }
+
+    if (!result.isEmpty())
+    {
+        std::sort(result.begin(), result.end());
+
+        // store stroke for later use.
+        const int last = result.last();
+        BezierCurve myCurve = mCurves[last];
+        if (last < transformedCurves.size() && transformedCurves[last])
         {
-            result.append(j);
-            // store stroke for later use.
-            mGetStrokedPath = myCurve.getStrokedPath(1.0, true);
+            myCurve = myCurve.transformed(mSelectionTransformation);
         }
+        mGetStrokedPath = myCurve.getStrokedPath(1.0, true);
     }
     return result;
 }
@@ -1461,16 +1488,24 @@ VertexRef VectorImage::getClosestVertexTo(const BezierCurve& curve, int curveNum
  */
 QList<VertexRef> VectorImage::getVerticesCloseTo(QPointF P1, qreal maxDistance)
 {
-    QList<VertexRef> result;
+    const QVector<bool> transformedCurves = getTransformedCurves();
+
+    QList<VertexRef> result = hitTester().verticesCloseTo(P1, maxDistance, transformedCurves);
+    if (transformedCurves.isEmpty())
+        return result;
 
     // Square maxDistance rather than taking the square root for each distance
     maxDistance *= maxDistance;
 
-    for (int curve = 0; curve < mCurves.size(); curve++)
+    for (int curve = 0; curve < transformedCurves.size(); curve++)
     {
-        for (int vertex = -1; vertex < mCurves.at(curve).getVertexSize(); vertex++)
+        if (!transformedCurves[curve])
+            continue;
+
+        BezierCurve myCurve = mCurves[curve].transformed(mSelectionTransformation);
+        for (int vertex = -1; vertex < myCurve.getVertexSize(); vertex++)
         {
-            QPointF P2 = getVertex(curve, vertex);
+            QPointF P2 = myCurve.getVertex(vertex);
             qreal distance = P1.dotProduct(QPointF(P1 - P2), QPointF(P1 - P2));
             if (distance < maxDistance)
             {
@@ -1478,6 +1513,10 @@ QList<VertexRef> VectorImage::getVerticesCloseTo(QPointF P1, qreal maxDistance)
             }
         }
     }
+    std::sort(result.begin(), result.end(), [](const VertexRef& a, const VertexRef& b)
+    {
+        return a.curveNumber < b.curveNumber || (a.curveNumber == b.curveNumber && a.vertexNumber < b.vertexNumber);
+    });
     return result;
 }
 
@@ -1832,19 +1871,18 @@ void VectorImage::fillSelectedPath(int color)
  */
 void VectorImage::fillContour(QList<QPointF> contourPath, int color)
 {
-    QList<VertexRef> vertexPath;
-    VertexRef vertex;
-
-    BezierCurve lastCurve = getLastCurve();
-    int lastCurveNum = getLastCurveNumber();
+    const int lastCurveNum = getLastCurveNumber();
+    if (lastCurveNum < 0)
+        return;
 
-    for (QPointF point : contourPath) {
-        vertex = getClosestVertexTo(lastCurve, lastCurveNum, point);
+    // follow the last curve only
+    QVector<bool> skipped(mCurves.size(), true);
+    skipped[lastCurveNum] = false;
 
-        if (vertex.curveNumber != -1 && !vertexPath.contains(vertex)) {
-            vertexPath.append(vertex);
-        }
-    }
+    // the stroke points are within the smoothing tolerance of the fitted curve
+    const qreal maxDistance = qMax(mCurves.at(lastCurveNum).getWidth(), 16.0);
+    VectorFillEngine fillEngine(mCurves, hitTester());
+    QList<VertexRef> vertexPath = fillEngine.vertexPathAlong(contourPath, maxDistance, skipped);
 
     BezierArea bezierArea(vertexPath, color);
 
@@ -1852,6 +1890,35 @@ void VectorImage::fillContour(QList<QPointF> contourPath, int color)
     modification();
 }
 
+/**
+ * @brief VectorImage::fillAreaAt
+ * @param point: a point inside the area to fill
+ * @param color: the color number of the area
+ * @param scaling: the view scaling, which sets the precision of the fill
+ * @return true if the point is in an area, an existing one is recolored rather than filled again
+ */
+bool VectorImage::fillAreaAt(QPointF point, int color, qreal scaling)
+{
+    int areaNumber = getLastAreaNumber(point);
+    if (areaNumber != -1)
+    {
+        if (mArea[areaNumber].getColorNumber() != color)
+        {
+            mArea[areaNumber].setColorNumber(color);
+            modification();
+        }
+        return true;
+    }
+
+    VectorFillEngine fillEngine(mCurves, hitTester());
+    QList<VertexRef> vertexPath = fillEngine.findArea(point, scaling);
+    if (vertexPath.size() < 3)
+        return false;
+
+    addArea(BezierArea(vertexPath, color));
+    return true;
+}
+
 //QList<QPointF> VectorImage::getfillContourPoints(QPoint point)
 //{
 //    // We get the contour points from a bitmap version of the vector layer as it is much faster to process
@@ -2390,6 +2457,38 @@ qreal VectorImage::getDistance(VertexRef r1, VertexRef r2)
     return BezierCurve::eLength(getVertex(r1) - getVertex(r2));
 }
 
+/**
+ * @brief VectorImage::hitTester
+ * @return the spatial index of the curves, rebuilt if the curves changed since the last query
+ */
+const VectorHitTester& VectorImage::hitTester()
+{
+    if (!mHitTester.isValid())
+    {
+        mHitTester.build(mCurves);
+    }
+    return mHitTester;
+}
+
+/**
+ * @brief VectorImage::getTransformedCurves
+ * @return the curves moved by the pending selection transformation,
+ *         or an empty vector when there is no such transformation
+ */
+QVector<bool> VectorImage::getTransformedCurves() const
+{
+    QVector<bool> result;
+    if (mSelectionTransformation.isIdentity())
+        return result;
+
+    result.resize(mCurves.size());
+    for (int i = 0; i < mCurves.size(); i++)
+    {
+        result[i] = mCurves.at(i).isPartlySelected();
+    }
+    return result;
+}
+
 /**
  * @brief VectorImage::updateImageSize
  * @param updatedCurve: BezierCurve&
@@ -22,6 +22,7 @@ GNU General Public License for more details.
 #include "bezierarea.h"
 #include "beziercurve.h"
 #include "vertexref.h"
+#include "vectorhittester.h"
 #include "keyframe.h"
 
 class Object;
@@ -48,6 +49,7 @@ public:
     void loadDomElement(QDomElement element);
 
     BezierCurve& curve(int i);
+    const BezierCurve& curve(int i) const;
 
     void insertCurve(int position, BezierCurve& newCurve, qreal factor, bool interacts);
     void addCurve(BezierCurve& newCurve, qreal factor, bool interacts = true);
@@ -107,6 +109,7 @@ public:
     void applyVariableWidthToSelection(bool YesOrNo);
     void fillContour(QList<QPointF> contourPath, int color);
     void fillSelectedPath(int color);
+    bool fillAreaAt(QPointF point, int color, qreal scaling);
     //    void fill(QPointF point, int color, float tolerance);
     void addArea(BezierArea bezierArea);
     int  getFirstAreaNumber(QPointF point);
@@ -158,10 +161,13 @@ private:
     void checkCurveIntersections(BezierCurve& newCurve, qreal tolerance);
 
     void updateImageSize(BezierCurve& updatedCurve);
+    const VectorHitTester& hitTester();
+    QVector<bool> getTransformedCurves() const;
     QPainterPath mGetStrokedPath;
 
 private:
     QList<BezierCurve> mCurves;
+    VectorHitTester mHitTester;
 
     Object* mObject = nullptr;
     QRectF mSelectionRect;
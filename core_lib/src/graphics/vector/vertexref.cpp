@@ -37,7 +37,7 @@ VertexRef VertexRef::prevVertex()
     return VertexRef(curveNumber, vertexNumber-1);
 }
 
-bool VertexRef::operator==(VertexRef vertexRef1)
+bool VertexRef::operator==(VertexRef vertexRef1) const
 {
     if ( (curveNumber == vertexRef1.curveNumber) && (vertexNumber == vertexRef1.vertexNumber))
     {
@@ -49,7 +49,7 @@ bool VertexRef::operator==(VertexRef vertexRef1)
     }
 }
 
-bool VertexRef::operator!=(VertexRef vertexRef1)
+bool VertexRef::operator!=(VertexRef vertexRef1) const
 {
     if ( (curveNumber != vertexRef1.curveNumber) || (vertexNumber != vertexRef1.vertexNumber))
     {
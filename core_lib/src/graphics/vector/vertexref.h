@@ -25,8 +25,8 @@ public:
     VertexRef(int curveN, int vertexN);
     VertexRef nextVertex();
     VertexRef prevVertex();
-    bool operator==(VertexRef vertexRef1);
-    bool operator!=(VertexRef vertexRef1);
+    bool operator==(VertexRef vertexRef1) const;
+    bool operator!=(VertexRef vertexRef1) const;
 
     int curveNumber = -1;
     int vertexNumber = -1;
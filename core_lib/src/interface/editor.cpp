@@ -165,6 +165,10 @@ BackupElement* Editor::currentBackup()
 
 void Editor::backup(const QString& undoText)
 {
+    // a stroke still being fitted belongs to the state being backed up
+    if (mToolManager)
+        mToolManager->finishPendingStrokes();
+
     KeyFrame* frame = nullptr;
     if (mLastModifiedLayer > -1 && mLastModifiedFrame > 0)
     {
@@ -402,6 +406,9 @@ void Editor::restoreKey()
 
 void Editor::undo()
 {
+    if (mToolManager)
+        mToolManager->finishPendingStrokes();
+
     if (!mBackupList.empty() && mBackupIndex > -1)
     {
         if (mBackupIndex == mBackupList.size() - 1)
@@ -448,6 +455,9 @@ void Editor::undo()
 
 void Editor::redo()
 {
+    if (mToolManager)
+        mToolManager->finishPendingStrokes();
+
     if (!mBackupList.empty() && mBackupIndex < mBackupList.size() - 2)
     {
         mBackupIndex++;
@@ -915,6 +925,9 @@ void Editor::updateCurrentFrame()
 
 void Editor::setCurrentLayerIndex(int i)
 {
+    if (mToolManager)
+        mToolManager->finishPendingStrokes();
+
     mCurrentLayerIndex = i;
 
     Layer* layer = mObject->getLayer(i);
@@ -926,18 +939,15 @@ void Editor::setCurrentLayerIndex(int i)
 
 void Editor::scrubTo(int frame)
 {
+    if (mToolManager)
+        mToolManager->finishPendingStrokes();
+
     if (frame < 1) { frame = 1; }
     mFrame = frame;
 
+    // the timeline repaints the frames and the keys that changed on its own
     emit scrubbed(frame);
 
-    // FIXME: should not emit Timeline update here.
-    // Editor must be an individual class.
-    // Will remove all Timeline related code in Editor class.
-    if (mPlaybackManager && !mPlaybackManager->isPlaying())
-    {
-        emit updateTimeLine(); // needs to update the timeline to update onion skin positions
-    }
     mObject->updateActiveFrames(frame);
 }
 
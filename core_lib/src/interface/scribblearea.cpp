@@ -20,6 +20,7 @@ GNU General Public License for more details.
 #include <cmath>
 #include <QMessageBox>
 #include <QPixmapCache>
+#include <QtMath>
 
 #include "pointerevent.h"
 #include "beziercurve.h"
@@ -30,6 +31,7 @@ GNU General Public License for more details.
 #include "layercamera.h"
 #include "bitmapimage.h"
 #include "vectorimage.h"
+#include "activeframepool.h"
 
 #include "colormanager.h"
 #include "toolmanager.h"
@@ -59,9 +61,13 @@ bool ScribbleArea::init()
 {
     mPrefs = mEditor->preference();
     mDoubleClickTimer = new QTimer(this);
+    mAutoCropTimer = new QTimer(this);
+    mAutoCropTimer->setSingleShot(true);
+    mAutoCropTimer->setInterval(AUTO_CROP_IDLE_MILLIS);
 
     connect(mPrefs, &PreferenceManager::optionChanged, this, &ScribbleArea::settingUpdated);
     connect(mDoubleClickTimer, &QTimer::timeout, this, &ScribbleArea::handleDoubleClick);
+    connect(mAutoCropTimer, &QTimer::timeout, this, &ScribbleArea::autoCropModifiedFrame);
 
     connect(mEditor->select(), &SelectionManager::selectionChanged, this, &ScribbleArea::onSelectionChanged);
     connect(mEditor->select(), &SelectionManager::needPaintAndApply, this, &ScribbleArea::applySelectionChanges);
@@ -188,17 +194,17 @@ void ScribbleArea::updateFrame(int frame)
 void ScribbleArea::invalidateCacheForDirtyFrames()
 {
     Layer* currentLayer = mEditor->layers()->currentLayer();
-    for (int pos : currentLayer->dirtyFrames()) {
-
-        invalidateCacheForFrame(pos);
-        invalidateOnionSkinsCacheAround(pos);
+    for (const FrameRange& range : currentLayer->dirtyFrames().ranges())
+    {
+        invalidateCacheForFrames(range.from, range.to);
+        invalidateOnionSkinsCacheAround(range.from, range.to);
     }
     currentLayer->clearDirtyFrames();
 }
 
-void ScribbleArea::invalidateOnionSkinsCacheAround(int frameNumber)
+void ScribbleArea::invalidateOnionSkinsCacheAround(int from, int to)
 {
-    if (frameNumber < 0) { return; }
+    if (to < 0) { return; }
 
     bool isOnionAbsolute = mPrefs->getString(SETTING::ONION_TYPE) == "absolute";
     Layer *layer = mEditor->layers()->currentLayer(0);
@@ -206,9 +212,11 @@ void ScribbleArea::invalidateOnionSkinsCacheAround(int frameNumber)
     // The current layer can be null if updateFrame is triggered when creating a new project
     if (!layer) return;
 
-    if (mPrefs->isOn(SETTING::PREV_ONION))
+    // the frames inside the range are invalidated with it,
+    // only the onion skins reaching in from either side are left
+    if (mPrefs->isOn(SETTING::PREV_ONION) && from >= 0)
     {
-        int onionFrameNumber = frameNumber;
+        int onionFrameNumber = from;
         if (isOnionAbsolute)
         {
             onionFrameNumber = layer->getPreviousFrameNumber(onionFrameNumber + 1, true);
@@ -225,7 +233,7 @@ void ScribbleArea::invalidateOnionSkinsCacheAround(int frameNumber)
 
     if (mPrefs->isOn(SETTING::NEXT_ONION))
     {
-        int onionFrameNumber = frameNumber;
+        int onionFrameNumber = to;
 
         for(int i = 1; i <= mPrefs->getInt(SETTING::ONION_NEXT_FRAMES_NUM); i++)
         {
@@ -258,6 +266,16 @@ void ScribbleArea::invalidateCacheForFrame(int frameNumber)
     }
 }
 
+void ScribbleArea::invalidateCacheForFrames(int from, int to)
+{
+    auto cacheKeyIter = mPixmapCacheKeys.lowerBound(static_cast<unsigned int>(qMax(from, 0)));
+    while (cacheKeyIter != mPixmapCacheKeys.end() && cacheKeyIter.key() <= static_cast<unsigned int>(to))
+    {
+        QPixmapCache::remove(cacheKeyIter.value());
+        cacheKeyIter = mPixmapCacheKeys.erase(cacheKeyIter);
+    }
+}
+
 void ScribbleArea::invalidateLayerPixmapCache()
 {
     mCanvasPainter.resetLayerCache();
@@ -337,9 +355,42 @@ void ScribbleArea::setModified(int layerNumber, int frameNumber)
 
     layer->setModified(frameNumber, true);
 
+    if (layer->type() == Layer::BITMAP)
+    {
+        mAutoCropLayerId = layer->id();
+        mAutoCropFrame = frameNumber;
+        mAutoCropTimer->start();
+    }
+
     onFrameModified(frameNumber);
 }
 
+/**
+ * @brief ScribbleArea::autoCropModifiedFrame
+ * Trims the transparent edges off the last modified bitmap frame, once the canvas has been idle for a moment.
+ * BitmapImage doesn't crop as it draws, so that strokes don't pay for it.
+ */
+void ScribbleArea::autoCropModifiedFrame()
+{
+    if (currentTool()->isActive())
+    {
+        // not in the middle of a stroke
+        mAutoCropTimer->start();
+        return;
+    }
+
+    // the layers may have been moved or deleted since
+    Layer* layer = mEditor->object()->findLayerById(mAutoCropLayerId);
+    if (layer == nullptr || layer->type() != Layer::BITMAP)
+        return;
+
+    BitmapImage* bitmapImage = static_cast<LayerBitmap*>(layer)->getLastBitmapImageAtFrame(mAutoCropFrame, 0);
+    if (bitmapImage != nullptr)
+    {
+        bitmapImage->autoCrop();
+    }
+}
+
 bool ScribbleArea::event(QEvent *event)
 {
     if (event->type() == QEvent::WindowDeactivate) {
@@ -359,7 +410,12 @@ void ScribbleArea::keyPressEvent(QKeyEvent *event)
 
     mKeyboardInUse = true;
 
-    if (isPointerInUse()) { return; } // prevents shortcuts calls while drawing
+    if (isPointerInUse()) // prevents shortcuts calls while drawing
+    {
+        // but the stroke in progress can still be cancelled
+        if (event->key() == Qt::Key_Escape) { currentTool()->keyPressEvent(event); }
+        return;
+    }
     if (mInstantTool) { return; } // prevents shortcuts calls while using instant tool
 
     if (currentTool()->keyPressEvent(event))
@@ -630,6 +686,7 @@ void ScribbleArea::pointerPressEvent(PointerEvent* event)
     if (event->button() == Qt::LeftButton)
     {
         currentTool()->pointerPressEvent(event);
+        pinCurrentFrame();
     }
 }
 
@@ -676,6 +733,7 @@ void ScribbleArea::pointerReleaseEvent(PointerEvent* event)
 
     //qDebug() << "release event";
     currentTool()->pointerReleaseEvent(event);
+    unpinFrame();
 
     // ---- last check (at the very bottom of mouseRelease) ----
     if (mInstantTool && !mKeyboardInUse) // temp tool and released all keys ?
@@ -784,6 +842,13 @@ void ScribbleArea::paintBitmapBuffer()
         return;
     }
 
+    QRect changedRect = mBufferImg->bounds();
+    if (mEraserShadow.isActive())
+    {
+        changedRect |= mEraserShadow.changedRect();
+        mEraserShadow.commit();
+    }
+
     // Clear the temporary pixel path
     BitmapImage* targetImage = currentBitmapImage(layer);
     if (targetImage != nullptr)
@@ -808,10 +873,10 @@ void ScribbleArea::paintBitmapBuffer()
         targetImage->paste(mBufferImg, cm);
     }
 
-    QRect rect = mEditor->view()->mapCanvasToScreen(mBufferImg->bounds()).toRect();
+    QRect rect = mEditor->view()->mapCanvasToScreen(changedRect).toRect();
 
     drawCanvas(frameNumber, rect.adjusted(-1, -1, 1, 1));
-    update(rect);
+    updateCanvas(rect);
 
     // Update the cache for the last key-frame.
     updateFrame(frameNumber);
@@ -820,7 +885,7 @@ void ScribbleArea::paintBitmapBuffer()
     mBufferImg->clear();
 }
 
-void ScribbleArea::paintBitmapBufferRect(const QRect& rect)
+void ScribbleArea::paintBitmapBufferRect(const QRect& rect, int rad)
 {
     if (mEditor->playback()->isPlaying())
     {
@@ -829,6 +894,9 @@ void ScribbleArea::paintBitmapBufferRect(const QRect& rect)
 
         BitmapImage* targetImage = currentBitmapImage(layer);
 
+        // the frames go by, erased paint can't wait for the end of the stroke
+        mEraserShadow.commit();
+
         if (targetImage != nullptr)
         {
             QPainter::CompositionMode cm = QPainter::CompositionMode_SourceOver;
@@ -859,8 +927,10 @@ void ScribbleArea::paintBitmapBufferRect(const QRect& rect)
 
         updateFrame(frameNumber);
 
-        drawCanvas(frameNumber, rect.adjusted(-1, -1, 1, 1));
-        update(rect);
+        // the rect is in canvas space and doesn't include the brush
+        const QRect updatedRect = mEditor->view()->mapCanvasToScreen(QRectF(rect).normalized().adjusted(-rad, -rad, +rad, +rad)).toRect();
+        drawCanvas(frameNumber, updatedRect.adjusted(-1, -1, 1, 1));
+        updateCanvas(updatedRect);
     }
 }
 
@@ -869,6 +939,109 @@ void ScribbleArea::clearBitmapBuffer()
     mBufferImg->clear();
 }
 
+/**
+ * @brief ScribbleArea::setStrokePrediction
+ * Shows where the stroke is heading, ahead of the samples painted so far.
+ * The prediction is not part of the frame, each call replaces the previous one.
+ * @param path: the predicted stroke, in canvas coordinates, starting at the last painted sample
+ * @param width: the brush width, in canvas pixels
+ */
+void ScribbleArea::setStrokePrediction(const QPolygonF& path, qreal width, QColor color)
+{
+    const QRect oldRect = strokePredictionRect();
+
+    mPredictionPath = path;
+    mPredictionWidth = width;
+    mPredictionColor = color;
+
+    updateOverlay(oldRect | strokePredictionRect());
+}
+
+void ScribbleArea::clearStrokePrediction()
+{
+    if (mPredictionPath.isEmpty())
+        return;
+
+    updateOverlay(strokePredictionRect());
+    mPredictionPath.clear();
+}
+
+QRect ScribbleArea::strokePredictionRect() const
+{
+    if (mPredictionPath.size() < 2)
+        return QRect();
+
+    const int margin = qCeil(mPredictionWidth * mEditor->view()->scaling() / 2.0) + 2;
+    return mEditor->view()->mapPolygonToScreen(mPredictionPath).boundingRect().toAlignedRect()
+        .adjusted(-margin, -margin, margin, margin);
+}
+
+/**
+ * @brief ScribbleArea::setRubberBand
+ * Shows a segment over the canvas, like the one following the pointer from the last point of a polyline.
+ * The segment is not part of the frame, each call replaces the previous one.
+ * @param line: the segment, in canvas coordinates
+ * @param pen: the pen to draw it with, its width in screen pixels
+ */
+void ScribbleArea::setRubberBand(const QLineF& line, const QPen& pen, bool useAA)
+{
+    const QRect oldRect = rubberBandRect();
+
+    mRubberBand = line;
+    mRubberBandPen = pen;
+    mRubberBandAA = useAA;
+
+    updateOverlay(oldRect | rubberBandRect());
+}
+
+void ScribbleArea::clearRubberBand()
+{
+    if (mRubberBand.isNull())
+        return;
+
+    updateOverlay(rubberBandRect());
+    mRubberBand = QLineF();
+}
+
+QRect ScribbleArea::rubberBandRect() const
+{
+    if (mRubberBand.isNull())
+        return QRect();
+
+    const int margin = qCeil(mRubberBandPen.widthF() / 2.0) + 2;
+    const QLineF line = mEditor->view()->getView().map(mRubberBand);
+    return QRectF(line.p1(), line.p2()).normalized().toAlignedRect().adjusted(-margin, -margin, margin, margin);
+}
+
+void ScribbleArea::paintRubberBand(QPainter& painter)
+{
+    if (mRubberBand.isNull())
+        return;
+
+    painter.save();
+    painter.setWorldMatrixEnabled(false);
+    painter.setRenderHint(QPainter::Antialiasing, mRubberBandAA);
+    painter.setPen(mRubberBandPen);
+    painter.setBrush(Qt::NoBrush);
+    painter.drawLine(mEditor->view()->getView().map(mRubberBand));
+    painter.restore();
+}
+
+void ScribbleArea::paintStrokePrediction(QPainter& painter)
+{
+    if (mPredictionPath.size() < 2)
+        return;
+
+    painter.save();
+    painter.setWorldMatrixEnabled(false);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setPen(QPen(mPredictionColor, qMax(mPredictionWidth * mEditor->view()->scaling(), 1.0),
+                        Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
+    painter.setBrush(Qt::NoBrush);
+    painter.drawPolyline(mEditor->view()->mapPolygonToScreen(mPredictionPath));
+    painter.restore();
+}
+
 void ScribbleArea::drawLine(QPointF P1, QPointF P2, QPen pen, QPainter::CompositionMode cm)
 {
     mBufferImg->drawLine(P1, P2, pen, cm, mPrefs->isOn(SETTING::ANTIALIAS));
@@ -882,14 +1055,14 @@ void ScribbleArea::drawPath(QPainterPath path, QPen pen, QBrush brush, QPainter:
 void ScribbleArea::refreshBitmap(const QRectF& rect, int rad)
 {
     QRectF updatedRect = mEditor->view()->mapCanvasToScreen(rect.normalized().adjusted(-rad, -rad, +rad, +rad));
-    update(updatedRect.toRect());
+    updateCanvas(updatedRect.toRect());
 }
 
 void ScribbleArea::refreshVector(const QRectF& rect, int rad)
 {
     rad += 1;
     //QRectF updatedRect = mEditor->view()->mapCanvasToScreen( rect.normalized().adjusted( -rad, -rad, +rad, +rad ) );
-    update(rect.normalized().adjusted(-rad, -rad, +rad, +rad).toRect());
+    updateCanvas(rect.normalized().adjusted(-rad, -rad, +rad, +rad).toRect());
 
     //qDebug() << "Logical:  " << rect;
     //qDebug() << "Physical: " << mEditor->view()->mapCanvasToScreen( rect.normalized() );
@@ -898,56 +1071,84 @@ void ScribbleArea::refreshVector(const QRectF& rect, int rad)
 
 void ScribbleArea::paintCanvasCursor(QPainter& painter)
 {
-    QTransform view = mEditor->view()->getView();
-    QPointF mousePos = currentTool()->isAdjusting() ? currentTool()->getCurrentPressPoint() : currentTool()->getCurrentPoint();
-    int centerCal = mCursorImg.width() / 2;
-
-    mTransformedCursorPos = view.map(mousePos);
-
-    // reset matrix
-    view.reset();
-
-    painter.setTransform(view);
-    mCursorCenterPos.setX(centerCal);
-    mCursorCenterPos.setY(centerCal);
+    mCursorRect = canvasCursorRect();
+    if (mCursorRect.isEmpty())
+        return;
 
-    painter.drawPixmap(QPoint(static_cast<int>(mTransformedCursorPos.x() - mCursorCenterPos.x()),
-                              static_cast<int>(mTransformedCursorPos.y() - mCursorCenterPos.y())),
-                       mCursorImg);
+    painter.setTransform(QTransform());
+    painter.drawPixmap(mCursorRect.topLeft(), mCursorImg);
+}
 
-    // update center of transformed img for rect only
-    mTransCursImg = mCursorImg.transformed(view);
+QRect ScribbleArea::canvasCursorRect() const
+{
+    if (mCursorImg.isNull())
+        return QRect();
 
-    mCursorCenterPos.setX(centerCal);
-    mCursorCenterPos.setY(centerCal);
+    const QPointF mousePos = currentTool()->isAdjusting() ? currentTool()->getCurrentPressPoint() : currentTool()->getCurrentPoint();
+    const QPointF center = mEditor->view()->getView().map(mousePos);
+    const int half = mCursorImg.width() / 2;
+    return QRect(QPoint(static_cast<int>(center.x() - half), static_cast<int>(center.y() - half)), mCursorImg.size());
 }
 
+/**
+ * @brief ScribbleArea::updateCanvasCursor
+ * Picks the cursor for the current tool settings and zoom, drawing it only if it's not cached,
+ * and repaints it where it was and where it goes. The canvas under it is not repainted.
+ */
 void ScribbleArea::updateCanvasCursor()
 {
-    float scalingFac = mEditor->view()->scaling();
-    qreal brushWidth = currentTool()->properties.width;
-    qreal brushFeather = currentTool()->properties.feather;
-    if (currentTool()->isAdjusting())
+    BaseTool* tool = currentTool();
+
+    CursorCache::Key key;
+    key.tool = tool->type();
+    key.width = tool->properties.width;
+    key.feather = tool->properties.feather;
+    key.scaling = mEditor->view()->scaling();
+
+    if (tool->isAdjusting())
     {
-        mCursorImg = currentTool()->quickSizeCursor(scalingFac);
+        key.quickSize = true;
+        mCursorImg = mCursorCache.cursor(key, [tool, &key] { return tool->quickSizeCursor(key.scaling); });
     }
     else if (mEditor->preference()->isOn(SETTING::DOTTED_CURSOR))
     {
-        bool useFeather = currentTool()->properties.useFeather;
-        mCursorImg = currentTool()->canvasCursor(static_cast<float>(brushWidth), static_cast<float>(brushFeather), useFeather, scalingFac, width());
+        key.useFeather = tool->properties.useFeather;
+        key.windowWidth = width();
+        mCursorImg = mCursorCache.cursor(key, [&key]
+        {
+            return BaseTool::canvasCursor(static_cast<float>(key.width), static_cast<float>(key.feather),
+                                          key.useFeather, static_cast<float>(key.scaling), key.windowWidth);
+        });
     }
     else
     {
         mCursorImg = QPixmap(); // if above does not comply, deallocate image
     }
 
-    // update cursor rect
-    QPoint translatedPos = QPoint(static_cast<int>(mTransformedCursorPos.x() - mCursorCenterPos.x()),
-                                  static_cast<int>(mTransformedCursorPos.y() - mCursorCenterPos.y()));
+    updateOverlay(mCursorRect.adjusted(-1, -1, 1, 1) | canvasCursorRect().adjusted(-1, -1, 1, 1));
+}
 
-    update(mTransCursImg.rect().adjusted(-1, -1, 1, 1)
-           .translated(translatedPos));
+/**
+ * @brief ScribbleArea::updateOverlay
+ * Repaints the overlays in rect, the canvas pixmap there is still up to date.
+ */
+void ScribbleArea::updateOverlay(const QRect& rect)
+{
+    if (rect.isEmpty())
+        return;
 
+    mOverlayRegion += rect;
+    update(rect);
+}
+
+/**
+ * @brief ScribbleArea::updateCanvas
+ * Repaints the canvas in rect, and the overlays over it.
+ */
+void ScribbleArea::updateCanvas(const QRect& rect)
+{
+    mOverlayRegion -= rect;
+    update(rect);
 }
 
 void ScribbleArea::handleDrawingOnEmptyFrame()
@@ -1019,7 +1220,8 @@ void ScribbleArea::paintEvent(QPaintEvent* event)
 
             if (cacheKeyIter == mPixmapCacheKeys.end() || !QPixmapCache::find(cacheKeyIter.value(), &mCanvas))
             {
-                drawCanvas(mEditor->currentFrame(), event->rect());
+                // the cached canvas must be complete
+                drawCanvas(mEditor->currentFrame(), mCanvas.rect());
                 mPixmapCacheKeys[static_cast<unsigned>(currentFrame)] = QPixmapCache::insert(mCanvas);
                 //qDebug() << "Repaint canvas!";
             }
@@ -1031,8 +1233,17 @@ void ScribbleArea::paintEvent(QPaintEvent* event)
     }
     else
     {
-        prepCanvas(mEditor->currentFrame(), event->rect());
-        mCanvasPainter.paintCached();
+        // where only the overlays moved, the canvas pixmap is still up to date
+        QRegion canvasRegion = event->region();
+        if (event->rect() != rect())
+        {
+            canvasRegion -= mOverlayRegion;
+        }
+        if (!canvasRegion.isEmpty())
+        {
+            prepCanvas(mEditor->currentFrame(), canvasRegion.boundingRect());
+            mCanvasPainter.paintCached();
+        }
     }
 
     if (currentTool()->type() == MOVE)
@@ -1051,9 +1262,11 @@ void ScribbleArea::paintEvent(QPaintEvent* event)
 
     QPainter painter(this);
 
-    // paints the canvas
+    // paints the canvas, only the part that changed
     painter.setWorldMatrixEnabled(false);
-    painter.drawPixmap(QPoint(0, 0), mCanvas);
+    painter.drawPixmap(event->rect(), mCanvas, event->rect());
+    paintStrokePrediction(painter);
+    paintRubberBand(painter);
 
     Layer* layer = mEditor->layers()->currentLayer();
 
@@ -1151,6 +1364,10 @@ void ScribbleArea::paintEvent(QPaintEvent* event)
     painter.drawRect(QRect(0, 0, width(), height()));
 #endif
 
+    // as close to the screen as a widget gets to know
+    mStrokeManager->latencyMonitor().presented();
+    mOverlayRegion = QRegion();
+
     event->accept();
 }
 
@@ -1190,6 +1407,27 @@ VectorImage* ScribbleArea::currentVectorImage(Layer* layer) const
     return vectorLayer->getLastVectorImageAtFrame(mEditor->currentFrame(), 0);
 }
 
+void ScribbleArea::pinCurrentFrame()
+{
+    unpinFrame();
+
+    Layer* layer = mEditor->layers()->currentLayer();
+    if (layer != nullptr && layer->type() == Layer::BITMAP)
+    {
+        mPinnedFrame = currentBitmapImage(layer);
+        mEditor->object()->activeFramePool()->pin(mPinnedFrame);
+    }
+}
+
+void ScribbleArea::unpinFrame()
+{
+    if (mPinnedFrame)
+    {
+        mEditor->object()->activeFramePool()->unpin(mPinnedFrame);
+        mPinnedFrame = nullptr;
+    }
+}
+
 void ScribbleArea::prepCanvas(int frame, QRect rect)
 {
     Object* object = mEditor->object();
@@ -1234,11 +1472,16 @@ void ScribbleArea::prepCanvas(int frame, QRect rect)
     mCanvasPainter.setViewTransform(vm->getView(), vm->getViewInverse());
 
     mCanvasPainter.setPaintSettings(object, mEditor->layers()->currentLayerIndex(), frame, rect, mBufferImg);
+    mCanvasPainter.setBitmapShadow(&mEraserShadow);
 }
 
+/**
+ * @brief ScribbleArea::drawCanvas
+ * Repaints the canvas pixmap, every layer of the frame composited.
+ * @param rect: the part of the canvas to repaint, in screen coordinates, the rest is left as it was
+ */
 void ScribbleArea::drawCanvas(int frame, QRect rect)
 {
-    mCanvas.fill(Qt::transparent);
     prepCanvas(frame, rect);
     mCanvasPainter.paint();
 }
@@ -1278,21 +1521,76 @@ void ScribbleArea::drawPencil(QPointF thePoint, qreal brushWidth, qreal fixedBru
 
 void ScribbleArea::drawBrush(QPointF thePoint, qreal brushWidth, qreal mOffset, QColor fillColor, qreal opacity, bool usingFeather, bool useAA)
 {
-    QRectF rectangle(thePoint.x() - 0.5 * brushWidth, thePoint.y() - 0.5 * brushWidth, brushWidth, brushWidth);
+    drawBrushDabs(QList<QPointF>() << thePoint, brushWidth, mOffset, fillColor, opacity, usingFeather, useAA);
+}
+
+/**
+ * @brief ScribbleArea::drawBrushDabs
+ * Draws a run of identical dabs in the buffer, the dabs of one stroke segment.
+ * The shape follows setGaussianGradient when usingFeather is set, otherwise it's a solid disc.
+ */
+void ScribbleArea::drawBrushDabs(const QList<QPointF>& points, qreal brushWidth, qreal mOffset, QColor fillColor, qreal opacity, bool usingFeather, bool useAA)
+{
+    mBufferImg->drawDabs(mDabEngine, points, brushDab(brushWidth, mOffset, fillColor, opacity, usingFeather, useAA));
+}
+
+/**
+ * @brief ScribbleArea::eraseBrushDabs
+ * Erases a run of dabs, shaped like the ones drawBrushDabs() draws, from the current bitmap frame.
+ * The dabs are taken out of a shadow copy of the tiles they reach, the frame itself
+ * only changes when paintBitmapBuffer() commits the stroke, or not at all after cancelErasing().
+ */
+void ScribbleArea::eraseBrushDabs(const QList<QPointF>& points, qreal brushWidth, qreal mOffset, qreal opacity, bool usingFeather, bool useAA)
+{
+    BitmapImage* target = currentBitmapImage(mEditor->layers()->currentLayer());
+    if (target == nullptr)
+        return;
+
+    if (mEraserShadow.target() != target)
+    {
+        // the stroke moved on to another frame, during playback
+        mEraserShadow.commit();
+        mEraserShadow.begin(target);
+    }
+    mEraserShadow.eraseDabs(mDabEngine, points, brushDab(brushWidth, mOffset, Qt::white, opacity, usingFeather, useAA));
+}
+
+/**
+ * @brief ScribbleArea::cancelErasing
+ * Drops the erasing stroke in progress, the frame is left as it was before the stroke.
+ */
+void ScribbleArea::cancelErasing()
+{
+    if (!mEraserShadow.isActive())
+        return;
+
+    const QRect rect = mEditor->view()->mapCanvasToScreen(mEraserShadow.changedRect()).toRect();
+    mEraserShadow.rollback();
+
+    drawCanvas(mEditor->currentFrame(), rect.adjusted(-1, -1, 1, 1));
+    updateCanvas(rect);
+}
+
+BrushDabEngine::Dab ScribbleArea::brushDab(qreal brushWidth, qreal mOffset, QColor fillColor, qreal opacity, bool usingFeather, bool useAA)
+{
+    BrushDabEngine::Dab dab;
+    dab.diameter = brushWidth;
+    dab.color = fillColor;
 
     if (usingFeather)
     {
-        QRadialGradient radialGrad(thePoint, 0.5 * brushWidth);
-        setGaussianGradient(radialGrad, fillColor, opacity, mOffset);
+        const qreal offset = qBound(0.0, mOffset, 100.0);
+        const int mainColorAlpha = qRound(fillColor.alphaF() * 255 * opacity);
+        const int alphaAdded = qRound((mainColorAlpha * offset) / 100);
 
-        mBufferImg->drawEllipse(rectangle, Qt::NoPen, radialGrad,
-                                QPainter::CompositionMode_SourceOver, false);
+        dab.feather = offset;
+        dab.color.setAlpha(qBound(0, mainColorAlpha - alphaAdded, 255));
     }
     else
     {
-        mBufferImg->drawEllipse(rectangle, Qt::NoPen, QBrush(fillColor, Qt::SolidPattern),
-                                QPainter::CompositionMode_SourceOver, useAA);
+        dab.antialias = useAA;
     }
+    return dab;
 }
 
 void ScribbleArea::flipSelection(bool flipVertical)
@@ -1301,73 +1599,38 @@ void ScribbleArea::flipSelection(bool flipVertical)
     paintTransformedSelection();
 }
 
-void ScribbleArea::blurBrush(BitmapImage *bmiSource_, QPointF srcPoint_, QPointF thePoint_, qreal brushWidth_, qreal mOffset_, qreal opacity_)
+/**
+ * @brief ScribbleArea::blurBrush
+ * Drags the paint along the points, starting from srcPoint_, into the buffer.
+ */
+void ScribbleArea::blurBrush(BitmapImage *bmiSource_, QPointF srcPoint_, const QList<QPointF>& points, qreal brushWidth_, qreal mOffset_, qreal opacity_)
 {
-    QRadialGradient radialGrad(thePoint_, 0.5 * brushWidth_);
-    setGaussianGradient(radialGrad, QColor(255, 255, 255, 127), opacity_, mOffset_);
-
-    QRectF srcRect(srcPoint_.x() - 0.5 * brushWidth_, srcPoint_.y() - 0.5 * brushWidth_, brushWidth_, brushWidth_);
-    QRectF trgRect(thePoint_.x() - 0.5 * brushWidth_, thePoint_.y() - 0.5 * brushWidth_, brushWidth_, brushWidth_);
-
-    BitmapImage bmiSrcClip = bmiSource_->copy(srcRect.toAlignedRect());
-    BitmapImage bmiTmpClip = bmiSrcClip; // TODO: find a shorter way
-
-    bmiTmpClip.drawRect(srcRect, Qt::NoPen, radialGrad, QPainter::CompositionMode_Source, mPrefs->isOn(SETTING::ANTIALIAS));
-    bmiSrcClip.bounds().moveTo(trgRect.topLeft().toPoint());
-    bmiTmpClip.paste(&bmiSrcClip, QPainter::CompositionMode_SourceIn);
-    mBufferImg->paste(&bmiTmpClip);
+    smudgeBrush(bmiSource_, srcPoint_, points, brushWidth_, mOffset_, opacity_, SmudgeEngine::Smudge);
 }
 
-void ScribbleArea::liquifyBrush(BitmapImage *bmiSource_, QPointF srcPoint_, QPointF thePoint_, qreal brushWidth_, qreal mOffset_, qreal opacity_)
+/**
+ * @brief ScribbleArea::liquifyBrush
+ * Pushes the pixels along the points, starting from srcPoint_, into the buffer.
+ */
+void ScribbleArea::liquifyBrush(BitmapImage *bmiSource_, QPointF srcPoint_, const QList<QPointF>& points, qreal brushWidth_, qreal mOffset_, qreal opacity_)
 {
-    QPointF delta = (thePoint_ - srcPoint_); // increment vector
-    QRectF trgRect(thePoint_.x() - 0.5 * brushWidth_, thePoint_.y() - 0.5 * brushWidth_, brushWidth_, brushWidth_);
-
-    QRadialGradient radialGrad(thePoint_, 0.5 * brushWidth_);
-    setGaussianGradient(radialGrad, QColor(255, 255, 255, 255), opacity_, mOffset_);
-
-    // Create gradient brush
-    BitmapImage bmiTmpClip;
-    bmiTmpClip.drawRect(trgRect, Qt::NoPen, radialGrad, QPainter::CompositionMode_Source, mPrefs->isOn(SETTING::ANTIALIAS));
-
-    // Slide texture/pixels of the source image
-    qreal factor, factorGrad;
-
-    for (int yb = bmiTmpClip.top(); yb < bmiTmpClip.bottom(); yb++)
-    {
-        for (int xb = bmiTmpClip.left(); xb < bmiTmpClip.right(); xb++)
-        {
-            QColor color;
-            color.setRgba(bmiTmpClip.pixel(xb, yb));
-            factorGrad = color.alphaF(); // any from r g b a is ok
-
-            int xa = xb - factorGrad * delta.x();
-            int ya = yb - factorGrad * delta.y();
-
-            color.setRgba(bmiSource_->pixel(xa, ya));
-            factor = color.alphaF();
+    smudgeBrush(bmiSource_, srcPoint_, points, brushWidth_, mOffset_, opacity_, SmudgeEngine::Liquify);
+}
 
-            if (factor > 0.0)
-            {
-                color.setRed(color.red() / factor);
-                color.setGreen(color.green() / factor);
-                color.setBlue(color.blue() / factor);
-                color.setAlpha(255); // Premultiplied color
+void ScribbleArea::smudgeBrush(BitmapImage* source, QPointF from, const QList<QPointF>& points, qreal brushWidth, qreal mOffset, qreal opacity, SmudgeEngine::Mode mode)
+{
+    // the strength the gradient of setGaussianGradient used to have, smudging only goes half way
+    const qreal offset = qBound(0.0, mOffset, 100.0);
+    const int mainAlpha = qRound(((mode == SmudgeEngine::Smudge) ? 127 : 255) * opacity);
+    const int alphaAdded = qRound((mainAlpha * offset) / 100);
 
-                color.setRed(color.red()*factorGrad);
-                color.setGreen(color.green()*factorGrad);
-                color.setBlue(color.blue()*factorGrad);
-                color.setAlpha(255 * factorGrad); // Premultiplied color
+    SmudgeEngine::Brush brush;
+    brush.diameter = brushWidth;
+    brush.feather = offset;
+    brush.antialias = mPrefs->isOn(SETTING::ANTIALIAS);
+    brush.strength = qBound(0, mainAlpha - alphaAdded, 255);
 
-                bmiTmpClip.setPixel(xb, yb, color.rgba());
-            }
-            else
-            {
-                bmiTmpClip.setPixel(xb, yb, qRgba(255, 255, 255, 0));
-            }
-        }
-    }
-    mBufferImg->paste(&bmiTmpClip);
+    mBufferImg->drawSmudge(mSmudgeEngine, source, from, points, brush, mode);
 }
 
 void ScribbleArea::drawPolyline(QPainterPath path, QPen pen, bool useAA)
@@ -1378,7 +1641,7 @@ void ScribbleArea::drawPolyline(QPainterPath path, QPen pen, bool useAA)
     QRectF boundingRect = updateRect.adjusted(-width(), -height(), width(), height());
     mBufferImg->clear();
     mBufferImg->drawPath(path, pen, Qt::NoBrush, QPainter::CompositionMode_SourceOver, useAA);
-    update(boundingRect.toRect());
+    updateCanvas(boundingRect.toRect());
 
 }
 
@@ -1522,11 +1785,13 @@ void ScribbleArea::displaySelectionProperties()
             int selectedCurve = vectorImage->getFirstSelectedCurve();
             if (selectedCurve != -1)
             {
-                mEditor->tools()->setWidth(vectorImage->curve(selectedCurve).getWidth());
-                mEditor->tools()->setFeather(vectorImage->curve(selectedCurve).getFeather());
-                mEditor->tools()->setInvisibility(vectorImage->curve(selectedCurve).isInvisible());
-                mEditor->tools()->setPressure(vectorImage->curve(selectedCurve).getVariableWidth());
-                mEditor->color()->setColorNumber(vectorImage->curve(selectedCurve).getColorNumber());
+                // read through the const accessor, which keeps the hit-test grid
+                const BezierCurve& curve = static_cast<const VectorImage*>(vectorImage)->curve(selectedCurve);
+                mEditor->tools()->setWidth(curve.getWidth());
+                mEditor->tools()->setFeather(curve.getFeather());
+                mEditor->tools()->setInvisibility(curve.isInvisible());
+                mEditor->tools()->setPressure(curve.getVariableWidth());
+                mEditor->color()->setColorNumber(curve.getColorNumber());
             }
 
             int selectedArea = vectorImage->getFirstSelectedArea();
@@ -26,6 +26,7 @@ GNU General Public License for more details.
 
 #include <QColor>
 #include <QPoint>
+#include <QPolygonF>
 #include <QWidget>
 #include <QPixmapCache>
 
@@ -33,7 +34,9 @@ GNU General Public License for more details.
 #include "log.h"
 #include "pencildef.h"
 #include "bitmapimage.h"
+#include "bitmapshadow.h"
 #include "canvaspainter.h"
+#include "cursorcache.h"
 #include "preferencemanager.h"
 #include "strokemanager.h"
 #include "selectionpainter.h"
@@ -185,13 +188,20 @@ public:
     void drawPen(QPointF thePoint, qreal brushWidth, QColor fillColor, bool useAA = true);
     void drawPencil(QPointF thePoint, qreal brushWidth, qreal fixedBrushFeather, QColor fillColor, qreal opacity);
     void drawBrush(QPointF thePoint, qreal brushWidth, qreal offset, QColor fillColor, qreal opacity, bool usingFeather = true, bool useAA = false);
-    void blurBrush(BitmapImage *bmiSource_, QPointF srcPoint_, QPointF thePoint_, qreal brushWidth_, qreal offset_, qreal opacity_);
-    void liquifyBrush(BitmapImage *bmiSource_, QPointF srcPoint_, QPointF thePoint_, qreal brushWidth_, qreal offset_, qreal opacity_);
+    void drawBrushDabs(const QList<QPointF>& points, qreal brushWidth, qreal offset, QColor fillColor, qreal opacity, bool usingFeather = true, bool useAA = false);
+    void eraseBrushDabs(const QList<QPointF>& points, qreal brushWidth, qreal offset, qreal opacity, bool usingFeather = true, bool useAA = false);
+    void cancelErasing();
+    void blurBrush(BitmapImage *bmiSource_, QPointF srcPoint_, const QList<QPointF>& points, qreal brushWidth_, qreal offset_, qreal opacity_);
+    void liquifyBrush(BitmapImage *bmiSource_, QPointF srcPoint_, const QList<QPointF>& points, qreal brushWidth_, qreal offset_, qreal opacity_);
 
     void paintBitmapBuffer();
-    void paintBitmapBufferRect(const QRect& rect);
+    void paintBitmapBufferRect(const QRect& rect, int rad);
     void paintCanvasCursor(QPainter& painter);
     void clearBitmapBuffer();
+    void setStrokePrediction(const QPolygonF& path, qreal width, QColor color);
+    void clearStrokePrediction();
+    void setRubberBand(const QLineF& line, const QPen& pen, bool useAA);
+    void clearRubberBand();
     void refreshBitmap(const QRectF& rect, int rad);
     void refreshVector(const QRectF& rect, int rad);
     void setGaussianGradient(QGradient &gradient, QColor color, qreal opacity, qreal offset);
@@ -207,9 +217,10 @@ public:
     void handleDrawingOnEmptyFrame();
 
     BitmapImage* mBufferImg = nullptr; // used to pre-draw vector modifications
+    BrushDabEngine mDabEngine;
+    SmudgeEngine mSmudgeEngine;
 
     QPixmap mCursorImg;
-    QPixmap mTransCursImg;
 
 private:
 
@@ -222,6 +233,9 @@ private:
     /** Invalidate cache for the given frame */
     void invalidateCacheForFrame(int frameNumber);
 
+    /** Invalidate cache for every frame from one position to another, both included */
+    void invalidateCacheForFrames(int from, int to);
+
     /** Invalidate all cache.
      * call this if you're certain that the change you've made affects all frames */
     void invalidateAllCache();
@@ -230,21 +244,34 @@ private:
     void invalidateCacheForDirtyFrames();
 
     /** invalidate onion skin cache around frame */
-    void invalidateOnionSkinsCacheAround(int frame);
+    void invalidateOnionSkinsCacheAround(int frame) { invalidateOnionSkinsCacheAround(frame, frame); }
+
+    /** invalidate onion skin cache before the first frame and after the last frame of a range */
+    void invalidateOnionSkinsCacheAround(int from, int to);
 
     void prepCanvas(int frame, QRect rect);
     void drawCanvas(int frame, QRect rect);
+    void smudgeBrush(BitmapImage* source, QPointF from, const QList<QPointF>& points, qreal brushWidth, qreal offset, qreal opacity, SmudgeEngine::Mode mode);
+    static BrushDabEngine::Dab brushDab(qreal brushWidth, qreal offset, QColor fillColor, qreal opacity, bool usingFeather, bool useAA);
     void settingUpdated(SETTING setting);
     void paintSelectionVisuals(QPainter &painter);
+    void paintStrokePrediction(QPainter& painter);
+    void paintRubberBand(QPainter& painter);
+    QRect rubberBandRect() const;
+    QRect strokePredictionRect() const;
 
     BitmapImage* currentBitmapImage(Layer* layer) const;
     VectorImage* currentVectorImage(Layer* layer) const;
+    void pinCurrentFrame();
+    void unpinFrame();
 
     MoveMode mMoveMode = MoveMode::NONE;
     ToolType mPrevTemporalToolType = ERASER;
     ToolType mPrevToolType = PEN; // previous tool (except temporal)
 
     BitmapImage mBitmapSelection; // used to temporary store a transformed portion of a bitmap image
+    BitmapShadow mEraserShadow; // the erasing stroke in progress, the frame only changes on release
+    KeyFrame* mPinnedFrame = nullptr; // the frame the tool is working on, kept in memory until release
 
     std::unique_ptr<StrokeManager> mStrokeManager;
 
@@ -262,6 +289,16 @@ private:
     bool mMultiLayerOnionSkin = false; // future use. If required, just add a checkbox to updated it.
     QColor mOnionColor;
 
+    // where the stroke is heading, drawn over the canvas until the real samples replace it
+    QPolygonF mPredictionPath;
+    qreal mPredictionWidth = 0.0;
+    QColor mPredictionColor;
+
+    // the segment from the last polyline point to the pointer, drawn over the canvas
+    QLineF mRubberBand;
+    QPen mRubberBandPen;
+    bool mRubberBandAA = false;
+
 private:
     bool mKeyboardInUse = false;
     bool mMouseInUse = false;
@@ -276,8 +313,22 @@ private:
     const int DOUBLE_CLICK_THRESHOLD = 500;
     QTimer* mDoubleClickTimer = nullptr;
 
-    QPoint mCursorCenterPos;
-    QPointF mTransformedCursorPos;
+    // Cropping the bitmap frames once the canvas is idle
+    void autoCropModifiedFrame();
+    const int AUTO_CROP_IDLE_MILLIS = 300;
+    QTimer* mAutoCropTimer = nullptr;
+    int mAutoCropLayerId = 0;
+    int mAutoCropFrame = 1;
+
+    // The brush cursor, drawn over the canvas
+    QRect canvasCursorRect() const;
+    CursorCache mCursorCache;
+    QRect mCursorRect; ///< where the cursor was last painted, in screen coordinates
+
+    // The overlays are painted over the canvas pixmap, they can move without repainting it
+    void updateOverlay(const QRect& rect);
+    void updateCanvas(const QRect& rect);
+    QRegion mOverlayRegion; ///< invalidated for the overlays only since the last paint
 
     //instant tool (temporal eg. eraser)
     bool mInstantTool = false; //whether or not using temporal tool
@@ -159,11 +159,20 @@ void TimeLineCells::updateFrame(int frameNumber)
 {
     int x = getFrameX(frameNumber);
     update(x - mFrameSize, 0, mFrameSize + 1, height());
+
+    // the onion skin markers follow the current frame
+    update(0, 0, width(), mOffsetY);
+
+    // and keys may have been added or removed at the current frame
+    updateChangedTracks();
 }
 
 void TimeLineCells::updateContent()
 {
-    drawContent();
+    // layers may have been deleted, or the object replaced
+    pruneTrackStrips();
+
+    // painted again on the next paint event, from the cached tracks when they are still valid
     update();
 }
 
@@ -171,7 +180,7 @@ bool TimeLineCells::didDetachLayer() const {
     return abs(getMouseMoveY()) > mLayerDetachThreshold;
 }
 
-void TimeLineCells::drawContent()
+void TimeLineCells::drawContent(const QRegion& region)
 {
     const QPalette palette = QApplication::palette();
 
@@ -188,6 +197,8 @@ void TimeLineCells::drawContent()
     mCurrentFrame = mEditor->currentFrame();
 
     QPainter painter(mCache);
+    painter.setClipRegion(region);
+    const QRect dirtyRect = region.boundingRect();
 
     const Object* object = mEditor->object();
 
@@ -210,14 +221,18 @@ void TimeLineCells::drawContent()
         }
         Layer* layeri = object->getLayer(i);
 
+        const int layerY = getLayerY(i);
+        if (layerY + getLayerHeight() < dirtyRect.top() || layerY - 1 > dirtyRect.bottom())
+        {
+            continue;
+        }
+
         if (layeri != nullptr)
         {
             switch (mType)
             {
             case TIMELINE_CELL_TYPE::Tracks:
-                paintTrack(painter, layeri, mOffsetX,
-                           getLayerY(i), width() - mOffsetX,
-                           getLayerHeight(), false, mFrameSize);
+                paintTrackStrip(painter, layeri, layerY, false);
                 break;
 
             case TIMELINE_CELL_TYPE::Layers:
@@ -232,10 +247,9 @@ void TimeLineCells::drawContent()
     {
         if (mType == TIMELINE_CELL_TYPE::Tracks)
         {
-            paintTrack(painter, layer,
-                       mOffsetX, getLayerY(mEditor->layers()->currentLayerIndex()) + getMouseMoveY(),
-                       width() - mOffsetX, getLayerHeight(),
-                       true, mFrameSize);
+            paintTrackStrip(painter, layer,
+                            getLayerY(mEditor->layers()->currentLayerIndex()) + getMouseMoveY(),
+                            true);
         }
         else if (mType == TIMELINE_CELL_TYPE::Layers)
         {
@@ -250,14 +264,10 @@ void TimeLineCells::drawContent()
     {
         if (mType == TIMELINE_CELL_TYPE::Tracks)
         {
-            paintTrack(painter,
-                       layer,
-                       mOffsetX,
-                       getLayerY(mEditor->layers()->currentLayerIndex()),
-                       width() - mOffsetX,
-                       getLayerHeight(),
-                       true,
-                       mFrameSize);
+            paintTrackStrip(painter,
+                            layer,
+                            getLayerY(mEditor->layers()->currentLayerIndex()),
+                            true);
         }
         else if (mType == TIMELINE_CELL_TYPE::Layers)
         {
@@ -307,7 +317,10 @@ void TimeLineCells::drawContent()
         painter.setPen(palette.color(QPalette::Text));
         painter.setBrush(palette.brush(QPalette::Text));
         int fps = mEditor->playback()->fps();
-        for (int i = mFrameOffset; i < mFrameOffset + (width() - mOffsetX) / mFrameSize; i++)
+        // the frame numbers are wider than a frame, start a few frames before the dirty columns
+        int firstTick = qMax(mFrameOffset, getFrameNumber(qMax(mOffsetX, dirtyRect.left() - 40)) - 2);
+        int lastTick = qMin(mFrameOffset + (width() - mOffsetX) / mFrameSize, getFrameNumber(dirtyRect.right()) + 1);
+        for (int i = firstTick; i < lastTick; i++)
         {
             if (i + 1 >= mTimeLine->getRangeLower() && i < mTimeLine->getRangeUpper())
             {
@@ -337,11 +350,8 @@ void TimeLineCells::drawContent()
     }
 }
 
-void TimeLineCells::paintTrack(QPainter& painter, const Layer* layer,
-                       int x, int y, int width, int height,
-                       bool selected, int frameSize) const
+QColor TimeLineCells::trackColor(const Layer* layer) const
 {
-    const QPalette palette = QApplication::palette();
     QColor col;
     // Color each track according to the layer type
     if (layer->type() == Layer::BITMAP) col = QColor(51, 155, 252);
@@ -350,6 +360,84 @@ void TimeLineCells::paintTrack(QPainter& painter, const Layer* layer,
     if (layer->type() == Layer::CAMERA) col = QColor(253, 202, 92);
     // Dim invisible layers
     if (!layer->visible()) col.setAlpha(64);
+    return col;
+}
+
+/** @brief TimeLineCells::paintTrackStrip
+ * Paints the track of a layer from its cached strip.
+ * The strip is painted again only when the keys of the layer, its visibility,
+ * the selected layer or the scrolling, zoom and layer height of the timeline have changed.
+ */
+void TimeLineCells::paintTrackStrip(QPainter& painter, const Layer* layer, int y, bool selected)
+{
+    TrackStrip& strip = mTrackStrips[layer->id()];
+    if (strip.pixmap.isNull()
+        || strip.revision != layer->keyFrameRevision()
+        || strip.frameOffset != mFrameOffset
+        || strip.frameSize != mFrameSize
+        || strip.width != width()
+        || strip.height != getLayerHeight()
+        || strip.selected != selected
+        || strip.visible != layer->visible())
+    {
+        strip.revision = layer->keyFrameRevision();
+        strip.frameOffset = mFrameOffset;
+        strip.frameSize = mFrameSize;
+        strip.width = width();
+        strip.height = getLayerHeight();
+        strip.selected = selected;
+        strip.visible = layer->visible();
+
+        // one pixel more for the bottom edge of the track border
+        strip.pixmap = QPixmap(width(), getLayerHeight() + 1);
+        strip.pixmap.fill(Qt::transparent);
+        QPainter stripPainter(&strip.pixmap);
+        paintTrack(stripPainter, layer, mOffsetX, 1, width() - mOffsetX, getLayerHeight(), selected, mFrameSize);
+    }
+    painter.drawPixmap(0, y - 1, strip.pixmap);
+}
+
+/** @brief TimeLineCells::updateChangedTracks
+ * Schedules a repaint of the tracks whose keys changed since they were painted.
+ */
+void TimeLineCells::updateChangedTracks()
+{
+    const Object* object = mEditor->object();
+    for (int i = 0; i < object->getLayerCount(); i++)
+    {
+        const Layer* layer = object->getLayer(i);
+        auto it = mTrackStrips.constFind(layer->id());
+        if (it == mTrackStrips.cend() || it->revision != layer->keyFrameRevision())
+        {
+            update(0, getLayerY(i) - 1, width(), getLayerHeight() + 1);
+        }
+    }
+}
+
+/** @brief TimeLineCells::pruneTrackStrips
+ * Drops the strips of the layers that are no longer in the object.
+ */
+void TimeLineCells::pruneTrackStrips()
+{
+    const Object* object = mEditor->object();
+    if (mTrackStrips.size() <= object->getLayerCount())
+        return;
+
+    for (auto it = mTrackStrips.begin(); it != mTrackStrips.end();)
+    {
+        if (object->findLayerById(it.key()) == nullptr)
+            it = mTrackStrips.erase(it);
+        else
+            ++it;
+    }
+}
+
+void TimeLineCells::paintTrack(QPainter& painter, const Layer* layer,
+                       int x, int y, int width, int height,
+                       bool selected, int frameSize) const
+{
+    const QPalette palette = QApplication::palette();
+    QColor col = trackColor(layer);
 
     painter.save();
     painter.setBrush(col);
@@ -388,38 +476,70 @@ void TimeLineCells::paintFrames(QPainter& painter, const Layer* layer, QColor tr
 {
     painter.setPen(QPen(QBrush(QColor(40, 40, 40)), 1, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
 
-    layer->foreachKeyFrame([&](KeyFrame* key)
+    // only the keys scrolled into view
+    const int firstFrame = getFrameNumber(mOffsetX);
+    const int lastFrame = getFrameNumber(width() - 1);
+    layer->foreachKeyFrameInRange(firstFrame, lastFrame, [&](KeyFrame* key)
     {
-        int recLeft = getFrameX(key->pos()) - frameSize + 2;
-        int recTop = y + 1;
-        int recWidth = frameSize - 2;
-        int recHeight = height - 4;
+        paintKeyFrame(painter, key, trackCol, y, height, selected, frameSize);
+    });
+}
 
-        if (key->length() > 1)
-        {
-            // This is especially for sound clips.
-            // Sound clips are the only type of KeyFrame with variable frame length.
-            recWidth = frameSize * key->length() - 2;
-        }
+void TimeLineCells::paintKeyFrame(QPainter& painter, const KeyFrame* key, QColor trackCol, int y, int height, bool selected, int frameSize) const
+{
+    int recLeft = getFrameX(key->pos()) - frameSize + 2;
+    int recTop = y + 1;
+    int recWidth = frameSize - 2;
+    int recHeight = height - 4;
 
-        // Paint the frame border
-        if (selected && key->pos() == getCurrentFrame()) {
-            painter.setPen(Qt::white);
-        } else {
-            painter.setPen(QPen(QBrush(QColor(40, 40, 40)), 1, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
-        }
+    if (key->length() > 1)
+    {
+        // This is especially for sound clips.
+        // Sound clips are the only type of KeyFrame with variable frame length.
+        recWidth = frameSize * key->length() - 2;
+    }
 
-        // Paint the frame contents
-        if (key->isSelected())
-        {
-            painter.setBrush(QColor(60, 60, 60));
-        }
-        else if (selected)
-        {
-            painter.setBrush(QColor(trackCol.red(), trackCol.green(), trackCol.blue(), 150));
-        }
-        painter.drawRect(recLeft, recTop, recWidth, recHeight);
-    });
+    // Paint the frame contents
+    if (key->isSelected())
+    {
+        painter.setBrush(QColor(60, 60, 60));
+    }
+    else if (selected)
+    {
+        painter.setBrush(QColor(trackCol.red(), trackCol.green(), trackCol.blue(), 150));
+    }
+    else
+    {
+        painter.setBrush(trackCol);
+    }
+    painter.drawRect(recLeft, recTop, recWidth, recHeight);
+}
+
+/** @brief TimeLineCells::paintCurrentKeyFrame
+ * Outlines the key at the current frame of the current layer.
+ * It is painted over the cache, so that the cache doesn't change with the current frame.
+ */
+void TimeLineCells::paintCurrentKeyFrame(QPainter& painter)
+{
+    const Layer* layer = mEditor->layers()->currentLayer();
+    if (layer == nullptr || !layer->visible()) { return; }
+
+    const KeyFrame* key = layer->getKeyFrameAt(mEditor->currentFrame());
+    if (key == nullptr) { return; }
+
+    int y = getLayerY(mEditor->layers()->currentLayerIndex());
+    if (didDetachLayer())
+    {
+        y += getMouseMoveY();
+    }
+
+    painter.save();
+    painter.setClipRect(QRect(0, mOffsetY - 1, width(), height()));
+    painter.setPen(Qt::white);
+    painter.setBrush(Qt::NoBrush);
+    int recWidth = mFrameSize * qMax(key->length(), 1) - 2;
+    painter.drawRect(getFrameX(key->pos()) - mFrameSize + 2, y + 1, recWidth, getLayerHeight() - 4);
+    painter.restore();
 }
 
 void TimeLineCells::paintLabel(QPainter& painter, const Layer* layer,
@@ -572,7 +692,7 @@ void TimeLineCells::paintOnionSkin(QPainter& painter)
     }
 }
 
-void TimeLineCells::paintEvent(QPaintEvent*)
+void TimeLineCells::paintEvent(QPaintEvent* event)
 {
     Object* object = mEditor->object();
     Layer* layer = mEditor->layers()->currentLayer();
@@ -582,11 +702,8 @@ void TimeLineCells::paintEvent(QPaintEvent*)
     const QPalette palette = QApplication::palette();
     QPainter painter(this);
 
-    bool isPlaying = mEditor->playback()->isPlaying();
-    if ((!isPlaying && !mTimeLine->scrubbing) || mCache == nullptr)
-    {
-        drawContent();
-    }
+    // only the dirty part of the cache is painted again, mostly from the cached tracks
+    drawContent(event->region());
     if (mCache)
     {
         painter.drawPixmap(QPoint(0, 0), *mCache);
@@ -594,10 +711,12 @@ void TimeLineCells::paintEvent(QPaintEvent*)
 
     if (mType == TIMELINE_CELL_TYPE::Tracks)
     {
+        bool isPlaying = mEditor->playback()->isPlaying();
         if (!isPlaying)
         {
             paintOnionSkin(painter);
         }
+        paintCurrentKeyFrame(painter);
 
         if (mPrevFrame != mEditor->currentFrame()  || mEditor->playback()->isPlaying())
         {
@@ -18,11 +18,14 @@ GNU General Public License for more details.
 #ifndef TIMELINECELLS_H
 #define TIMELINECELLS_H
 
+#include <QHash>
+#include <QPixmap>
 #include <QString>
 #include <QWidget>
 #include "layercamera.h"
 
 class Layer;
+class KeyFrame;
 enum class LayerVisibility;
 class TimeLine;
 class QPaintEvent;
@@ -80,8 +83,9 @@ public slots:
 
 protected:
     void trackScrubber();
-    void drawContent();
+    void drawContent(const QRegion& region);
     void paintOnionSkin(QPainter& painter);
+    void paintCurrentKeyFrame(QPainter& painter);
     void paintEvent(QPaintEvent* event) override;
     void resizeEvent(QResizeEvent* event) override;
     void mousePressEvent(QMouseEvent* event) override;
@@ -94,7 +98,12 @@ private slots:
 
 private:
     void paintTrack(QPainter& painter, const Layer* layer, int x, int y, int width, int height, bool selected, int frameSize) const;
+    void paintTrackStrip(QPainter& painter, const Layer* layer, int y, bool selected);
     void paintFrames(QPainter& painter, const Layer* layer, QColor trackCol, int y, int height, bool selected, int frameSize) const;
+    void paintKeyFrame(QPainter& painter, const KeyFrame* key, QColor trackCol, int y, int height, bool selected, int frameSize) const;
+    QColor trackColor(const Layer* layer) const;
+    void updateChangedTracks();
+    void pruneTrackStrips();
     void paintLabel(QPainter& painter, const Layer* layer, int x, int y, int height, int width, bool selected, LayerVisibility layerVisibility) const;
     void paintSelection(QPainter& painter, int x, int y, int width, int height) const;
 
@@ -109,6 +118,21 @@ private:
     TIMELINE_CELL_TYPE mType;
 
     QPixmap* mCache = nullptr;
+
+    /** A track painted once, reused as long as its layer and the view don't change */
+    struct TrackStrip
+    {
+        QPixmap pixmap;
+        quint64 revision = 0;
+        int frameOffset = 0;
+        int frameSize = 0;
+        int width = 0;
+        int height = 0;
+        bool selected = false;
+        bool visible = true;
+    };
+    QHash<int, TrackStrip> mTrackStrips; // by layer id
+
     bool mDrawFrameNumber = true;
     bool mbShortScrub = false;
     int mFrameLength = 1;
@@ -17,8 +17,11 @@ GNU General Public License for more details.
 
 #include "layermanager.h"
 
+#include <algorithm>
+
 #include "object.h"
 #include "editor.h"
+#include "keyframe.h"
 
 #include "layersound.h"
 #include "layerbitmap.h"
@@ -220,19 +223,22 @@ LayerSound* LayerManager::createSoundLayer(const QString& strLayerName)
 
 int LayerManager::lastFrameAtFrame(int frameIndex)
 {
+    if (frameIndex < 1)
+    {
+        return -1;
+    }
+
+    int lastFrame = -1;
     Object* o = object();
-    for (int i = frameIndex; i >= 0; i -= 1)
+    for (int layerIndex = 0; layerIndex < o->getLayerCount(); ++layerIndex)
     {
-        for (int layerIndex = 0; layerIndex < o->getLayerCount(); ++layerIndex)
+        KeyFrame* key = o->getLayer(layerIndex)->getLastKeyFrameAtPosition(frameIndex);
+        if (key != nullptr)
         {
-            auto pLayer = o->getLayer(layerIndex);
-            if (pLayer->keyExists(i))
-            {
-                return i;
-            }
+            lastFrame = std::max(lastFrame, key->pos());
         }
     }
-    return -1;
+    return lastFrame;
 }
 
 int LayerManager::firstKeyFrameIndex()
@@ -325,41 +331,68 @@ void LayerManager::notifyLayerChanged(Layer* layer)
  */
 int LayerManager::animationLength(bool includeSounds)
 {
-    int maxFrame = -1;
+    updateAnimationLength();
+    return includeSounds ? mAnimationLength : mAnimationLengthWithoutSounds;
+}
 
-    Object* o = object();
+void LayerManager::notifyAnimationLengthChanged()
+{
+    if (mBatchDepth > 0)
+    {
+        mAnimationLengthChangePending = true;
+        return;
+    }
+    emit animationLengthChanged(animationLength(true));
+}
+
+void LayerManager::beginBatchUpdate()
+{
+    mBatchDepth++;
+}
+
+void LayerManager::endBatchUpdate()
+{
+    Q_ASSERT(mBatchDepth > 0);
+    if (--mBatchDepth == 0 && mAnimationLengthChangePending)
+    {
+        mAnimationLengthChangePending = false;
+        notifyAnimationLengthChanged();
+    }
+}
+
+/** @brief LayerManager::updateAnimationLength
+ * Every keyframe change gives its layer a new revision, so as long as the last revision
+ * and the layers are the same, so is the length. Otherwise it is found again from the
+ * last frame of each layer, which the layers keep up to date themselves.
+ */
+void LayerManager::updateAnimationLength()
+{
+    const Object* o = object();
+    if (o == mLengthObject && o->getLayerCount() == mLengthLayerCount && Layer::lastKeyFrameRevision() == mLengthRevision)
+    {
+        return;
+    }
+
+    int maxFrame = -1;
+    int maxFrameWithoutSounds = -1;
     for (int i = 0; i < o->getLayerCount(); i++)
     {
-        if (o->getLayer(i)->type() == Layer::SOUND)
+        const Layer* layer = o->getLayer(i);
+        if (layer->type() == Layer::SOUND)
         {
-            if (!includeSounds)
-                continue;
-
-            Layer* soundLayer = o->getLayer(i);
-            soundLayer->foreachKeyFrame([&maxFrame](KeyFrame* keyFrame)
-            {
-                int endPosition = keyFrame->pos() + (keyFrame->length() - 1);
-                if (endPosition > maxFrame)
-                {
-                    maxFrame = endPosition;
-                }
-            });
+            maxFrame = std::max(maxFrame, layer->getLastCoveredFrame());
         }
         else
         {
-            int lastFramePos = o->getLayer(i)->getMaxKeyFramePosition();
-            if (lastFramePos > maxFrame)
-            {
-                maxFrame = lastFramePos;
-            }
+            maxFrameWithoutSounds = std::max(maxFrameWithoutSounds, layer->getMaxKeyFramePosition());
         }
     }
-    return maxFrame;
-}
 
-void LayerManager::notifyAnimationLengthChanged()
-{
-    emit animationLengthChanged(animationLength(true));
+    mAnimationLength = std::max(maxFrame, maxFrameWithoutSounds);
+    mAnimationLengthWithoutSounds = maxFrameWithoutSounds;
+    mLengthObject = o;
+    mLengthLayerCount = o->getLayerCount();
+    mLengthRevision = Layer::lastKeyFrameRevision();
 }
 
 int LayerManager::getIndex(Layer* layer) const
@@ -71,6 +71,23 @@ public:
     /** This should be emitted whenever the animation length frames, eg. adding, removing, duplicating */
     void notifyAnimationLengthChanged();
 
+    /** Holds back animationLengthChanged() until the matching endBatchUpdate(),
+     *  so that it's emitted once for bulk operations such as imports */
+    void beginBatchUpdate();
+    void endBatchUpdate();
+
+    /** Begins a batch update for as long as it's in scope, so that every way out ends it */
+    class BatchUpdate
+    {
+    public:
+        explicit BatchUpdate(LayerManager* layers) : mLayers(layers) { mLayers->beginBatchUpdate(); }
+        ~BatchUpdate() { mLayers->endBatchUpdate(); }
+
+    private:
+        Q_DISABLE_COPY(BatchUpdate)
+        LayerManager* mLayers;
+    };
+
     QString nameSuggestLayer(const QString& name);
     int getLastLayerIndex() { return count() - 1; }
 
@@ -82,8 +99,19 @@ signals:
 
 private:
     int getIndex(Layer*) const;
+    void updateAnimationLength();
 
     int mLastCameraLayerIdx = 0;
+
+    // The animation length, found again only after a keyframe or a layer changed
+    const Object* mLengthObject = nullptr;
+    int mLengthLayerCount = -1;
+    quint64 mLengthRevision = 0;
+    int mAnimationLength = -1;
+    int mAnimationLengthWithoutSounds = -1;
+
+    int mBatchDepth = 0;
+    bool mAnimationLengthChangePending = false;
 };
 
 #endif
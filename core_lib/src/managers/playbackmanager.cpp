@@ -112,6 +112,12 @@ void PlaybackManager::play()
         frame = editor()->currentFrame();
     }
 
+    // the keys shown at each frame are looked up once for the whole range
+    for (int i = 0; i < object()->getLayerCount(); ++i)
+    {
+        object()->getLayer(i)->setCachedFrameRange(mStartFrame, mEndFrame);
+    }
+
     mListOfActiveSoundFrames.clear();
     // Check for any sounds we should start playing part-way through.
     mCheckForSoundsHalfway = true;
@@ -131,6 +137,11 @@ void PlaybackManager::stop()
 {
     mTimer->stop();
     stopSounds();
+
+    for (int i = 0; i < object()->getLayerCount(); ++i)
+    {
+        object()->getLayer(i)->clearCachedFrameRange();
+    }
     emit playStateChanged(false);
 }
 
@@ -73,6 +73,7 @@ void PreferenceManager::loadPrefs()
     set(SETTING::HIGH_RESOLUTION,          settings.value(SETTING_HIGH_RESOLUTION,        true).toBool());
     set(SETTING::SHADOW,                   settings.value(SETTING_SHADOW,                 false).toBool());
     set(SETTING::QUICK_SIZING,             settings.value(SETTING_QUICK_SIZING,           true).toBool());
+    set(SETTING::STROKE_PREDICTION,        settings.value(SETTING_STROKE_PREDICTION,      false).toBool());
 
     set(SETTING::ROTATION_INCREMENT,       settings.value(SETTING_ROTATION_INCREMENT,     15).toInt());
 
@@ -415,6 +416,9 @@ void PreferenceManager::set(SETTING option, bool value)
     case SETTING::QUICK_SIZING:
         settings.setValue(SETTING_QUICK_SIZING, value);
         break;
+    case SETTING::STROKE_PREDICTION:
+        settings.setValue(SETTING_STROKE_PREDICTION, value);
+        break;
     case SETTING::LAYOUT_LOCK:
         settings.setValue(SETTING_LAYOUT_LOCK, value);
         break;
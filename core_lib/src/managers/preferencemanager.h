@@ -77,6 +77,7 @@ enum class SETTING
     TITLE_SAFE_ON,
     TITLE_SAFE,
     QUICK_SIZING,
+    STROKE_PREDICTION,
     MULTILAYER_ONION,
     LANGUAGE,
     LAYOUT_LOCK,
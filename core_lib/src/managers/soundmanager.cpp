@@ -182,6 +182,16 @@ void SoundManager::onDurationChanged(SoundPlayer* player, int64_t duration)
     clip->setLength(static_cast<int>(frameLength));
     clip->setDuration(duration);
 
+    Object* obj = editor()->object();
+    for (int i = 0; i < obj->getLayerCount(); ++i)
+    {
+        Layer* layer = obj->getLayer(i);
+        if (layer->type() == Layer::SOUND && layer->getKeyFrameAt(clip->pos()) == clip)
+        {
+            layer->keyFramesChanged();
+        }
+    }
+
     editor()->layers()->notifyAnimationLengthChanged();
 
     emit soundClipDurationChanged();
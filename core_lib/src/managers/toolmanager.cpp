@@ -68,6 +68,7 @@ Status ToolManager::load(Object*)
 
 Status ToolManager::save(Object*)
 {
+    finishPendingStrokes();
     return Status::OK;
 }
 
@@ -110,6 +111,14 @@ void ToolManager::cleanupAllToolsData()
     }
 }
 
+void ToolManager::finishPendingStrokes()
+{
+    foreach(BaseTool* tool, mToolSetHash)
+    {
+        tool->finishPendingStroke();
+    }
+}
+
 void ToolManager::resetAllTools()
 {
     // Reset can be useful to solve some pencil settings problems.
@@ -40,6 +40,7 @@ public:
     void setDefaultTool();
     void setCurrentTool(ToolType eToolType);
     void cleanupAllToolsData();
+    void finishPendingStrokes();
     bool leavingThisTool();
 
     void tabletSwitchToEraser();
@@ -27,9 +27,12 @@ GNU General Public License for more details.
 #include <QThread>
 #include <QtMath>
 #include <QPainter>
+#include <QtConcurrent>
 
 #include "object.h"
 #include "layercamera.h"
+#include "framerenderer.h"
+#include "frameaccumulator.h"
 #include "layersound.h"
 #include "soundclip.h"
 #include "util.h"
@@ -340,7 +343,9 @@ Status MovieExporter::generateMovie(
 
     // Run FFmpeg command
 
-    STATUS_CHECK(executeFFMpegPipe(ffmpegPath, args, progress, [&](QProcess& ffmpeg, int framesProcessed)
+    // the camera path is computed once for all the exported frames
+    cameraLayer->setCachedFrameRange(frameStart, frameEnd);
+    Status status = executeFFMpegPipe(ffmpegPath, args, progress, [&](QProcess& ffmpeg, int framesProcessed)
     {
         if(framesProcessed < 0)
         {
@@ -355,15 +360,7 @@ Status MovieExporter::generateMovie(
 
         if((currentFrame - frameStart <= framesProcessed + frameWindow || failCounter > 10) && currentFrame <= frameEnd)
         {
-            QImage imageToExport = imageToExportBase.copy();
-            QPainter painter(&imageToExport);
-
-            QTransform view = cameraLayer->getViewAtFrame(currentFrame);
-            painter.setWorldTransform(view * centralizeCamera);
-            painter.setWindow(QRect(0, 0, camSize.width(), camSize.height()));
-
-            obj->paintImage(painter, currentFrame, false, true);
-            painter.end();
+            QImage imageToExport = renderFrame(obj, cameraLayer, currentFrame, imageToExportBase, centralizeCamera);
 
             // Should use sizeInBytes instead of byteCount to support large images,
             // but this is only supported in QT 5.10+
@@ -376,9 +373,10 @@ Status MovieExporter::generateMovie(
         }
 
         return false;
-    }));
+    });
+    cameraLayer->clearCachedFrameRange();
 
-    return Status::OK;
+    return status;
 }
 
 /** Exports obj to a gif image at strOut using FFmpeg.
@@ -456,7 +454,9 @@ Status MovieExporter::generateGif(
 
     // Run FFmpeg command
 
-    STATUS_CHECK(executeFFMpegPipe(ffmpegPath, args, progress, [&](QProcess& ffmpeg, int framesProcessed)
+    // the camera path is computed once for all the exported frames
+    cameraLayer->setCachedFrameRange(frameStart, frameEnd);
+    Status status = executeFFMpegPipe(ffmpegPath, args, progress, [&](QProcess& ffmpeg, int framesProcessed)
     {
         /* The GIF FFmpeg command requires the entires stream to be
          * written before FFmpeg can encode the GIF. This is because
@@ -473,14 +473,7 @@ Status MovieExporter::generateGif(
             return false;
         }
 
-        QImage imageToExport = imageToExportBase.copy();
-        QPainter painter(&imageToExport);
-
-        QTransform view = cameraLayer->getViewAtFrame(currentFrame);
-        painter.setWorldTransform(view * centralizeCamera);
-        painter.setWindow(QRect(0, 0, camSize.width(), camSize.height()));
-
-        obj->paintImage(painter, currentFrame, false, true);
+        QImage imageToExport = renderFrame(obj, cameraLayer, currentFrame, imageToExportBase, centralizeCamera);
 
         bytesWritten = ffmpeg.write(reinterpret_cast<const char*>(imageToExport.constBits()), imageToExport.byteCount());
         Q_ASSERT(bytesWritten == imageToExport.byteCount());
@@ -488,9 +481,61 @@ Status MovieExporter::generateGif(
         currentFrame++;
 
         return true;
-    }));
+    });
+    cameraLayer->clearCachedFrameRange();
 
-    return Status::OK;
+    return status;
+}
+
+/** Renders one frame of the export as seen by the camera.
+ *
+ *  With motion blur, the frame is rendered from several points of the camera path
+ *  around it, in parallel, and the renderings are averaged. The samples are spread
+ *  evenly over the time of one frame, centered on it.
+ *
+ *  @param[in]  base The background of the frame, its size is the export size.
+ *  @param[in]  centralizeCamera Moves the center of the camera to the center of the frame.
+ */
+QImage MovieExporter::renderFrame(const Object* obj, const LayerCamera* cameraLayer, int frame,
+                                  const QImage& base, const QTransform& centralizeCamera) const
+{
+    const QSize camSize = cameraLayer->getViewSize();
+    const int sampleCount = qBound(1, mDesc.motionBlurSamples, int(FrameAccumulator::MAX_SAMPLES));
+
+    if (sampleCount == 1)
+    {
+        QImage image = base.copy();
+        QPainter painter(&image);
+        painter.setWorldTransform(cameraLayer->getViewAtFrame(frame) * centralizeCamera);
+        painter.setWindow(QRect(0, 0, camSize.width(), camSize.height()));
+        obj->paintImage(painter, frame, false, true);
+        painter.end();
+        return image;
+    }
+
+    // the camera path and the object are only read on this thread
+    std::vector<QTransform> views;
+    views.reserve(static_cast<size_t>(sampleCount));
+    for (int i = 0; i < sampleCount; i++)
+    {
+        const qreal time = frame + (i + 0.5) / sampleCount - 0.5;
+        views.push_back(cameraLayer->getViewAtSubFrame(time) * centralizeCamera);
+    }
+    const FrameRenderer renderer(obj, frame);
+
+    std::function<QImage(const QTransform&)> renderSample = [&](const QTransform& view)
+    {
+        QImage image = base.copy();
+        QPainter painter(&image);
+        painter.setWorldTransform(view);
+        painter.setWindow(QRect(0, 0, camSize.width(), camSize.height()));
+        renderer.paint(painter);
+        painter.end();
+        return image;
+    };
+    const FrameAccumulator accumulator = QtConcurrent::blockingMappedReduced<FrameAccumulator>(
+        views, renderSample, &FrameAccumulator::add, QtConcurrent::UnorderedReduce);
+    return accumulator.average();
 }
 
 /** Runs the specified command (should be ffmpeg) and allows for progress feedback.
@@ -25,7 +25,10 @@ GNU General Public License for more details.
 #include "pencilerror.h"
 
 class Object;
+class LayerCamera;
 class QProcess;
+class QImage;
+class QTransform;
 
 struct ExportMovieDesc
 {
@@ -38,6 +41,7 @@ struct ExportMovieDesc
     QString strCameraName;
     bool loop = false;
     bool alpha = false;
+    int motionBlurSamples = 1; // camera positions averaged into each frame, 1 for no motion blur
 };
 
 class MovieExporter
@@ -61,6 +65,8 @@ private:
     Status assembleAudio(const Object* obj, QString ffmpegPath, std::function<void(float)> progress);
     Status generateMovie(const Object *obj, QString ffmpegPath, QString strOutputFile, std::function<void(float)> progress);
     Status generateGif(const Object *obj, QString ffmpeg, QString strOut, std::function<void(float)>  progress);
+    QImage renderFrame(const Object* obj, const LayerCamera* cameraLayer, int frame,
+                       const QImage& base, const QTransform& centralizeCamera) const;
 
     Status executeFFMpegPipe(const QString& cmd, const QStringList& args, std::function<void(float)> progress, std::function<bool(QProcess&,int)> writeFrame);
     Status checkInputParameters(const ExportMovieDesc&);
@@ -279,6 +279,8 @@ Status MovieImporter::generateFrames(std::function<bool(int)> progress)
 
     ViewManager* viewMan = mEditor->view();
 
+    // the timeline is extended once, when all the frames are in
+    LayerManager::BatchUpdate batchUpdate(mEditor->layers());
     while (QFileInfo::exists(currentFile))
     {
         int currentFrame = mEditor->currentFrame();
@@ -296,7 +298,10 @@ Status MovieImporter::generateFrames(std::function<bool(int)> progress)
             mEditor->layers()->notifyAnimationLengthChanged();
             mEditor->scrubTo(currentFrame + 1);
         }
-        if (mCanceled) return Status::CANCELED;
+        if (mCanceled)
+        {
+            return Status::CANCELED;
+        }
         progress(qFloor(50 + i / static_cast<qreal>(amountOfFrames) * 50));
         i++;
         currentFile = tempDir.filePath(QString("%1.png").arg(i, 5, 10, QChar('0')));
@@ -16,6 +16,10 @@ GNU General Public License for more details.
 
 #include "camera.h"
 
+#include <atomic>
+
+static std::atomic<quint64> gLastCameraChange(0);
+
 Camera::Camera()
 {
 }
@@ -34,6 +38,7 @@ Camera::Camera(const Camera& c2) : KeyFrame(c2)
     mTranslate = c2.mTranslate;
     mRotate = c2.mRotate;
     mScale = c2.mScale;
+    mEasing = c2.mEasing;
     mNeedUpdateView = true;
 }
 
@@ -51,8 +56,11 @@ void Camera::assign(const Camera& rhs)
     mTranslate = rhs.mTranslate;
     mRotate = rhs.mRotate;
     mScale = rhs.mScale;
+    mEasing = rhs.mEasing;
+    mNeedUpdateView = true;
     updateViewTransform();
     modification();
+    ++gLastCameraChange;
 }
 
 QTransform Camera::getView()
@@ -69,24 +77,35 @@ void Camera::reset()
     mScale = 1.;
     mNeedUpdateView = true;
     modification();
+    ++gLastCameraChange;
 }
 
 void Camera::updateViewTransform()
 {
     if (mNeedUpdateView)
     {
-        QTransform t;
-        t.translate(mTranslate.x(), mTranslate.y());
+        view = viewTransform(mTranslate, mRotate, mScale);
+    }
+    mNeedUpdateView = false;
+}
 
-        QTransform r;
-        r.rotate(mRotate);
+QTransform Camera::viewTransform(QPointF translation, qreal rotation, qreal scaling)
+{
+    QTransform t;
+    t.translate(translation.x(), translation.y());
 
-        QTransform s;
-        s.scale(mScale, mScale);
+    QTransform r;
+    r.rotate(rotation);
 
-        view = t * r * s;
-    }
-    mNeedUpdateView = false;
+    QTransform s;
+    s.scale(scaling, scaling);
+
+    return t * r * s;
+}
+
+quint64 Camera::lastChange()
+{
+    return gLastCameraChange;
 }
 
 void Camera::translate(qreal dx, qreal dy)
@@ -96,6 +115,7 @@ void Camera::translate(qreal dx, qreal dy)
 
     mNeedUpdateView = true;
     modification();
+    ++gLastCameraChange;
 }
 
 void Camera::translate(const QPointF pt)
@@ -118,6 +138,7 @@ void Camera::rotate(qreal degree)
 
     mNeedUpdateView = true;
     modification();
+    ++gLastCameraChange;
 }
 
 void Camera::scale(qreal scaleValue)
@@ -126,6 +147,14 @@ void Camera::scale(qreal scaleValue)
 
     mNeedUpdateView = true;
     modification();
+    ++gLastCameraChange;
+}
+
+void Camera::setEasing(QEasingCurve::Type easing)
+{
+    mEasing = easing;
+    modification();
+    ++gLastCameraChange;
 }
 
 void Camera::scaleWithOffset(qreal scaleValue, QPointF offset)
@@ -18,6 +18,7 @@ GNU General Public License for more details.
 #define CAMERA_H
 
 #include <QTransform>
+#include <QEasingCurve>
 #include "keyframe.h"
 
 
@@ -47,14 +48,24 @@ public:
     void scaleWithOffset(qreal scaleValue, QPointF offset); // for zooming at the mouse position
     qreal scaling() { return mScale; }
 
+    /** How the camera moves from this key to the next one */
+    QEasingCurve::Type easing() const { return mEasing; }
+    void setEasing(QEasingCurve::Type easing);
+
     QTransform view;
 
+    static QTransform viewTransform(QPointF translation, qreal rotation, qreal scaling);
+
+    /** Changes whenever any camera is moved, rotated, zoomed or eased differently */
+    static quint64 lastChange();
+
     bool operator==(const Camera& rhs) const;
 
 private:
     QPointF mTranslate;
     qreal mRotate = 0.;
     qreal mScale = 1.;
+    QEasingCurve::Type mEasing = QEasingCurve::Linear;
     bool mNeedUpdateView = true;
 };
 
@@ -0,0 +1,167 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "camerapath.h"
+
+#include <QEasingCurve>
+#include <QtMath>
+#include "camera.h"
+#include "layercamera.h"
+
+
+QTransform CameraPath::State::view() const
+{
+    return Camera::viewTransform(translation, rotation, scaling);
+}
+
+CameraPath::CameraPath(const LayerCamera* layer) : mLayer(layer)
+{
+}
+
+/** @brief CameraPath::viewAt
+ * @return the view at frame: looked up in the table inside the frame range, evaluated otherwise
+ */
+QTransform CameraPath::viewAt(int frame) const
+{
+    if (isCached(frame))
+    {
+        if (!isUpToDate())
+        {
+            update();
+        }
+        return mViews[static_cast<size_t>(frame - mFrom)];
+    }
+    return evaluate(frame).view();
+}
+
+/** @brief CameraPath::viewAtSubFrame
+ * @return the view at a time between two frames, e.g. frame 4.5 is halfway from frame 4 to frame 5
+ */
+QTransform CameraPath::viewAtSubFrame(qreal frame) const
+{
+    return evaluate(frame).view();
+}
+
+CameraPath::State CameraPath::evaluate(qreal frame) const
+{
+    const int wholeFrame = qFloor(frame);
+    Camera* camera1 = static_cast<Camera*>(mLayer->getLastKeyFrameAtPosition(wholeFrame));
+    Camera* camera2 = nullptr;
+    if (camera1 == nullptr || camera1->pos() < frame)
+    {
+        camera2 = static_cast<Camera*>(mLayer->getKeyFrameAt(mLayer->getNextKeyFramePosition(wholeFrame)));
+    }
+    return interpolate(camera1, camera2, frame);
+}
+
+void CameraPath::setFrameRange(int from, int to)
+{
+    if (from == mFrom && to == mTo)
+    {
+        return;
+    }
+    mFrom = from;
+    mTo = to;
+    mViews.clear();
+    mLayerRevision = 0;
+}
+
+void CameraPath::clearFrameRange()
+{
+    setFrameRange(0, -1);
+    mViews.shrink_to_fit();
+}
+
+/** @brief CameraPath::interpolate
+ * @param from the last key at or before frame, or nullptr
+ * @param to the next key after frame, or nullptr
+ * @return the camera at frame. Before the first key and after the last one, the camera doesn't move.
+ */
+CameraPath::State CameraPath::interpolate(Camera* from, Camera* to, qreal frame)
+{
+    State state;
+    if (from == nullptr && to == nullptr)
+    {
+        return state;
+    }
+    if (from == nullptr || to == nullptr || from == to)
+    {
+        Camera* camera = (from != nullptr) ? from : to;
+        state.translation = camera->translation();
+        state.rotation = camera->rotation();
+        state.scaling = camera->scaling();
+        return state;
+    }
+
+    const qreal progress = (frame - from->pos()) / qreal(to->pos() - from->pos());
+    const qreal ratio = QEasingCurve(from->easing()).valueForProgress(progress);
+
+    auto lerp = [ratio](qreal f1, qreal f2) -> qreal
+    {
+        return f1 * (1.0 - ratio) + f2 * ratio;
+    };
+
+    state.translation = QPointF(lerp(from->translation().x(), to->translation().x()),
+                                lerp(from->translation().y(), to->translation().y()));
+    state.rotation = lerp(from->rotation(), to->rotation());
+    state.scaling = lerp(from->scaling(), to->scaling());
+    return state;
+}
+
+bool CameraPath::isUpToDate() const
+{
+    return mViews.size() == static_cast<size_t>(mTo - mFrom + 1)
+        && mLayerRevision == mLayer->keyFrameRevision()
+        && mCameraChange == Camera::lastChange();
+}
+
+/** @brief CameraPath::update
+ * Walks the frames of the range and the keys around them together,
+ * so each key is looked up once rather than twice per frame.
+ */
+void CameraPath::update() const
+{
+    mViews.resize(static_cast<size_t>(mTo - mFrom + 1));
+
+    Camera* camera1 = static_cast<Camera*>(mLayer->getLastKeyFrameAtPosition(mFrom));
+    if (camera1 != nullptr && camera1->pos() > mFrom)
+    {
+        // only when the range starts before frame 1
+        camera1 = nullptr;
+    }
+    const int firstNext = (camera1 != nullptr) ? camera1->pos() : mFrom;
+    Camera* camera2 = static_cast<Camera*>(mLayer->getKeyFrameAt(mLayer->getNextKeyFramePosition(firstNext)));
+    if (camera2 == camera1)
+    {
+        camera2 = nullptr;
+    }
+
+    for (int frame = mFrom; frame <= mTo; frame++)
+    {
+        while (camera2 != nullptr && camera2->pos() <= frame)
+        {
+            camera1 = camera2;
+            camera2 = static_cast<Camera*>(mLayer->getKeyFrameAt(mLayer->getNextKeyFramePosition(camera1->pos())));
+            if (camera2 == camera1)
+            {
+                camera2 = nullptr;
+            }
+        }
+        mViews[static_cast<size_t>(frame - mFrom)] = interpolate(camera1, camera2, frame).view();
+    }
+
+    mLayerRevision = mLayer->keyFrameRevision();
+    mCameraChange = Camera::lastChange();
+}
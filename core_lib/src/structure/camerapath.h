@@ -0,0 +1,75 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#ifndef CAMERAPATH_H
+#define CAMERAPATH_H
+
+#include <vector>
+#include <QPointF>
+#include <QTransform>
+
+class Camera;
+class LayerCamera;
+
+
+/**
+ * Evaluates the view of a camera layer at any frame.
+ *
+ * Between two keys the translation, rotation and scale of the cameras are interpolated
+ * separately, following the easing of the first key, and the view is built from them
+ * again. Interpolating the matrices directly would shear the view while it rotates.
+ *
+ * For a range of frames, e.g. the frames being played back or exported, the views are
+ * computed once into a table. The table is computed again when the keys of the layer
+ * or any camera changed.
+ */
+class CameraPath
+{
+public:
+    struct State
+    {
+        QPointF translation;
+        qreal rotation = 0.;
+        qreal scaling = 1.;
+
+        QTransform view() const;
+    };
+
+    explicit CameraPath(const LayerCamera* layer);
+
+    QTransform viewAt(int frame) const;
+    QTransform viewAtSubFrame(qreal frame) const;
+
+    void setFrameRange(int from, int to);
+    void clearFrameRange();
+    bool isCached(int frame) const { return frame >= mFrom && frame <= mTo; }
+
+    static State interpolate(Camera* from, Camera* to, qreal frame);
+
+private:
+    State evaluate(qreal frame) const;
+    bool isUpToDate() const;
+    void update() const;
+
+    const LayerCamera* mLayer = nullptr;
+
+    int mFrom = 0;
+    int mTo = -1;
+    mutable std::vector<QTransform> mViews; // the view at each frame of the range
+    mutable quint64 mLayerRevision = 0;
+    mutable quint64 mCameraChange = 0;
+};
+
+#endif // CAMERAPATH_H
@@ -0,0 +1,68 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "framerangeset.h"
+
+#include <algorithm>
+
+
+void FrameRangeSet::add(int from, int to)
+{
+    if (from > to)
+    {
+        std::swap(from, to);
+    }
+
+    // the first range which could touch [from, to]: the one starting at or before it
+    auto it = mRanges.upper_bound(from);
+    if (it != mRanges.begin())
+    {
+        auto previous = std::prev(it);
+        if (previous->second >= from - 1)
+        {
+            it = previous;
+        }
+    }
+
+    // swallow every range overlapping or adjacent to the new one
+    while (it != mRanges.end() && it->first <= to + 1)
+    {
+        from = std::min(from, it->first);
+        to = std::max(to, it->second);
+        it = mRanges.erase(it);
+    }
+    mRanges.emplace_hint(it, from, to);
+}
+
+bool FrameRangeSet::contains(int frame) const
+{
+    auto it = mRanges.upper_bound(frame);
+    if (it == mRanges.begin())
+    {
+        return false;
+    }
+    return std::prev(it)->second >= frame;
+}
+
+QList<FrameRange> FrameRangeSet::ranges() const
+{
+    QList<FrameRange> list;
+    list.reserve(rangeCount());
+    for (const auto& range : mRanges)
+    {
+        list.append(FrameRange(range.first, range.second));
+    }
+    return list;
+}
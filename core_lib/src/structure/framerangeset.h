@@ -0,0 +1,61 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#ifndef FRAMERANGESET_H
+#define FRAMERANGESET_H
+
+#include <map>
+#include <QList>
+
+
+/** A range of frames, both ends included */
+struct FrameRange
+{
+    int from = 0;
+    int to = 0;
+
+    FrameRange() = default;
+    FrameRange(int f, int t) : from(f), to(t) {}
+
+    bool contains(int frame) const { return frame >= from && frame <= to; }
+    bool operator==(const FrameRange& other) const { return from == other.from && to == other.to; }
+};
+
+/**
+ * A set of frames kept as disjoint ranges.
+ *
+ * Adding a range merges it with the ranges it overlaps or touches, so a bulk edit
+ * marking thousands of frames ends up as a few ranges. Adding is O(log n) plus the
+ * ranges merged.
+ */
+class FrameRangeSet
+{
+public:
+    void add(int frame) { add(frame, frame); }
+    void add(int from, int to);
+    void clear() { mRanges.clear(); }
+
+    bool isEmpty() const { return mRanges.empty(); }
+    int rangeCount() const { return static_cast<int>(mRanges.size()); }
+    bool contains(int frame) const;
+
+    /** The ranges in ascending order */
+    QList<FrameRange> ranges() const;
+
+private:
+    std::map<int, int> mRanges; // first frame -> last frame
+};
+
+#endif // FRAMERANGESET_H
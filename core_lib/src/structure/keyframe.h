@@ -57,6 +57,14 @@ public:
     virtual void unloadFile() {}
     virtual bool isLoaded() { return true; }
 
+    /** Keeps the frame in memory in a compressed form, which loadFile() decompresses.
+     *  @return the memory the compressed frame takes, 0 if the frame stays as it is */
+    virtual quint64 compress() { return 0; }
+
+    /** Unloads a modified frame by writing it to the given scratch file, which loadFile() reads back.
+     *  @return false if the frame can't be swapped out and stays loaded */
+    virtual bool swapOut(const QString& /*scratchFile*/) { return false; }
+
     virtual quint64 memoryUsage() { return 0; }
 
 private:
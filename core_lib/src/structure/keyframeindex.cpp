@@ -0,0 +1,112 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "keyframeindex.h"
+
+#include <algorithm>
+#include "keyframe.h"
+
+
+void KeyFrameIndex::rebuild(const KeyMap& keys)
+{
+    mPositions.clear();
+    mKeys.clear();
+    mPositions.reserve(keys.size());
+    mKeys.reserve(keys.size());
+
+    // the map is sorted from the last position to the first one
+    for (auto it = keys.rbegin(); it != keys.rend(); ++it)
+    {
+        mPositions.push_back(it->first);
+        mKeys.push_back(it->second);
+    }
+    mValid = true;
+
+    fillCachedRange();
+}
+
+/** @brief KeyFrameIndex::lastKeyFrameAt
+ * @return the key at frame, or the last one before it, nullptr if there is none
+ */
+KeyFrame* KeyFrameIndex::lastKeyFrameAt(int frame) const
+{
+    if (isCached(frame))
+    {
+        return mLastKeyInRange[static_cast<size_t>(frame - mRangeFrom)];
+    }
+
+    const int index = lastIndexAt(frame);
+    return (index >= 0) ? mKeys[static_cast<size_t>(index)] : nullptr;
+}
+
+/** @brief KeyFrameIndex::keyFrameWhichCovers
+ * @return the key shown at frame, taking the length of the keys into account
+ */
+KeyFrame* KeyFrameIndex::keyFrameWhichCovers(int frame) const
+{
+    KeyFrame* key = lastKeyFrameAt(frame);
+    if (key != nullptr && key->pos() + key->length() > frame)
+    {
+        return key;
+    }
+    return nullptr;
+}
+
+void KeyFrameIndex::setCachedRange(int from, int to)
+{
+    mRangeFrom = from;
+    mRangeTo = to;
+    fillCachedRange();
+}
+
+void KeyFrameIndex::clearCachedRange()
+{
+    mRangeFrom = 0;
+    mRangeTo = -1;
+    mLastKeyInRange.clear();
+    mLastKeyInRange.shrink_to_fit();
+}
+
+int KeyFrameIndex::lastIndexAt(int frame) const
+{
+    auto it = std::upper_bound(mPositions.begin(), mPositions.end(), frame);
+    return static_cast<int>(it - mPositions.begin()) - 1;
+}
+
+void KeyFrameIndex::fillCachedRange()
+{
+    if (mRangeTo < mRangeFrom)
+    {
+        return;
+    }
+
+    mLastKeyInRange.resize(static_cast<size_t>(mRangeTo - mRangeFrom + 1));
+    if (!mValid)
+    {
+        // filled again when rebuilt
+        return;
+    }
+
+    // one pass over the frames and the keys of the range
+    int index = lastIndexAt(mRangeFrom);
+    for (int frame = mRangeFrom; frame <= mRangeTo; frame++)
+    {
+        while (index + 1 < count() && mPositions[static_cast<size_t>(index + 1)] <= frame)
+        {
+            index++;
+        }
+        mLastKeyInRange[static_cast<size_t>(frame - mRangeFrom)] = (index >= 0) ? mKeys[static_cast<size_t>(index)] : nullptr;
+    }
+}
@@ -0,0 +1,67 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#ifndef KEYFRAMEINDEX_H
+#define KEYFRAMEINDEX_H
+
+#include <functional>
+#include <map>
+#include <vector>
+
+class KeyFrame;
+
+
+/**
+ * A flat copy of the key map of a layer, for the lookups done on every frame.
+ *
+ * The key positions are kept in one sorted array and searched with a binary search,
+ * instead of following the nodes of the map. For a range of frames, e.g. the playback
+ * range, the key shown at each frame can also be cached, so that looking it up is a
+ * single array read.
+ *
+ * The index doesn't follow the map: it is rebuilt when the keys are added, removed or moved.
+ */
+class KeyFrameIndex
+{
+public:
+    using KeyMap = std::map<int, KeyFrame*, std::greater<int>>;
+
+    bool isValid() const { return mValid; }
+    void invalidate() { mValid = false; }
+    void rebuild(const KeyMap& keys);
+
+    int count() const { return static_cast<int>(mPositions.size()); }
+
+    KeyFrame* lastKeyFrameAt(int frame) const;
+    KeyFrame* keyFrameWhichCovers(int frame) const;
+
+    void setCachedRange(int from, int to);
+    void clearCachedRange();
+    bool isCached(int frame) const { return frame >= mRangeFrom && frame <= mRangeTo; }
+
+private:
+    int lastIndexAt(int frame) const;
+    void fillCachedRange();
+
+    bool mValid = false;
+    std::vector<int> mPositions;  // in ascending order
+    std::vector<KeyFrame*> mKeys; // the key at each position
+
+    int mRangeFrom = 0;
+    int mRangeTo = -1;
+    std::vector<KeyFrame*> mLastKeyInRange; // the last key at or before each frame of the range
+};
+
+#endif // KEYFRAMEINDEX_H
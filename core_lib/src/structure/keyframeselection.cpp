@@ -0,0 +1,117 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "keyframeselection.h"
+
+
+bool KeyFrameSelection::insert(int position)
+{
+    if (position < 0 || contains(position))
+    {
+        return false;
+    }
+
+    if (position >= mBits.size())
+    {
+        mBits.resize(qMax(position + 1, 2 * mBits.size()));
+    }
+    mBits.setBit(position);
+    mPositions.insert(position);
+
+    const quint64 selection = ++mSelectionCount;
+    mSelectionOf.insert(position, selection);
+    mBySelection.emplace(selection, position);
+    return true;
+}
+
+/** @brief KeyFrameSelection::insert
+ * Selects several positions at once, one after the other in the order of the list.
+ * @return how many of them were not selected yet
+ */
+int KeyFrameSelection::insert(const QList<int>& positions)
+{
+    int inserted = 0;
+    for (int position : positions)
+    {
+        if (insert(position))
+        {
+            inserted++;
+        }
+    }
+    return inserted;
+}
+
+bool KeyFrameSelection::remove(int position)
+{
+    if (!contains(position))
+    {
+        return false;
+    }
+
+    mBits.clearBit(position);
+    mPositions.erase(position);
+    mBySelection.erase(mSelectionOf.take(position));
+    return true;
+}
+
+void KeyFrameSelection::clear()
+{
+    mBits.clear();
+    mPositions.clear();
+    mSelectionOf.clear();
+    mBySelection.clear();
+}
+
+/** @brief KeyFrameSelection::shift
+ * Moves the selected positions from 'from' onwards by offset,
+ * keeping the order they were selected in.
+ */
+void KeyFrameSelection::shift(int offset, int from)
+{
+    if (offset == 0 || mPositions.empty() || last() < from)
+    {
+        return;
+    }
+
+    const int highest = qMax(last() + offset, last());
+    std::map<quint64, int> bySelection;
+    bySelection.swap(mBySelection);
+    clear();
+
+    mBits.resize(qMax(highest + 1, 0));
+    for (const auto& pair : bySelection)
+    {
+        const int position = (pair.second >= from) ? pair.second + offset : pair.second;
+        if (position < 0 || mBits.testBit(position))
+        {
+            continue;
+        }
+        mBits.setBit(position);
+        mPositions.insert(position);
+        mSelectionOf.insert(position, pair.first);
+        mBySelection.emplace_hint(mBySelection.end(), pair.first, position);
+    }
+}
+
+QList<int> KeyFrameSelection::positions() const
+{
+    QList<int> list;
+    list.reserve(count());
+    for (int position : mPositions)
+    {
+        list.append(position);
+    }
+    return list;
+}
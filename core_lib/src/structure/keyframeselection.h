@@ -0,0 +1,66 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#ifndef KEYFRAMESELECTION_H
+#define KEYFRAMESELECTION_H
+
+#include <map>
+#include <set>
+#include <QBitArray>
+#include <QHash>
+#include <QList>
+
+
+/**
+ * The positions of the selected keyframes of a layer.
+ *
+ * Membership is a bit test, inserting and removing a position are O(log n), and the
+ * positions are kept in order, so that moving the selection doesn't need sorting.
+ * The order in which the positions were selected is tracked too: lastSelected() is
+ * where a shift-click range selection starts from.
+ */
+class KeyFrameSelection
+{
+public:
+    bool contains(int position) const
+    {
+        return position >= 0 && position < mBits.size() && mBits.testBit(position);
+    }
+    bool isEmpty() const { return mPositions.empty(); }
+    int count() const { return static_cast<int>(mPositions.size()); }
+
+    int first() const { return mPositions.empty() ? 0 : *mPositions.begin(); }
+    int last() const { return mPositions.empty() ? 0 : *mPositions.rbegin(); }
+    int lastSelected() const { return mBySelection.empty() ? 0 : mBySelection.rbegin()->second; }
+
+    bool insert(int position);
+    int insert(const QList<int>& positions);
+    bool remove(int position);
+    void clear();
+    void shift(int offset, int from = 0);
+
+    /** The selected positions in ascending order */
+    QList<int> positions() const;
+
+private:
+    QBitArray mBits;
+    std::set<int> mPositions;
+
+    quint64 mSelectionCount = 0;
+    QHash<int, quint64> mSelectionOf;            // position -> when it was selected
+    std::map<quint64, int> mBySelection;         // when it was selected -> position
+};
+
+#endif // KEYFRAMESELECTION_H
@@ -16,6 +16,10 @@ GNU General Public License for more details.
 */
 #include "layer.h"
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <vector>
 #include <QApplication>
 #include <QDebug>
 #include <QSettings>
@@ -26,12 +30,6 @@ GNU General Public License for more details.
 #include "timelinecells.h"
 
 
-// Used to sort the selected frames list
-bool sortAsc(int left, int right)
-{
-    return left < right;
-}
-
 Layer::Layer(Object* object, LAYER_TYPE eType) : QObject(object)
 {
     Q_ASSERT(eType != UNDEFINED);
@@ -41,6 +39,7 @@ Layer::Layer(Object* object, LAYER_TYPE eType) : QObject(object)
     mName = QString(tr("Undefined Layer"));
 
     mId = object->getUniqueLayerID();
+    keyFramesChanged();
 }
 
 Layer::~Layer()
@@ -69,6 +68,59 @@ void Layer::foreachKeyFrame(std::function<void(KeyFrame*)> action) const
     }
 }
 
+/** @brief Layer::foreachKeyFrameInRange
+ * Calls action for every keyframe covering a frame between from and to, both included,
+ * from the last one to the first one like foreachKeyFrame.
+ * Only the keyframes in the range are visited.
+ */
+void Layer::foreachKeyFrameInRange(int from, int to, std::function<void(KeyFrame*)> action) const
+{
+    // the map is sorted in descending order: lower_bound is the last key at or before 'to'
+    auto it = mKeyFrames.lower_bound(to);
+    for (; it != mKeyFrames.end() && it->first >= from; ++it)
+    {
+        action(it->second);
+    }
+
+    // a key starting before the range may still reach into it, e.g. a sound clip
+    if (it != mKeyFrames.end() && it->first + it->second->length() - 1 >= from)
+    {
+        action(it->second);
+    }
+}
+
+// shared by all the layers so that two layers never have the same revision
+static std::atomic<quint64> gLastKeyFrameRevision(0);
+
+void Layer::keyFramesChanged()
+{
+    mKeyFrameRevision = ++gLastKeyFrameRevision;
+}
+
+quint64 Layer::lastKeyFrameRevision()
+{
+    return gLastKeyFrameRevision;
+}
+
+/** @brief Layer::getLastCoveredFrame
+ * Found again only after the keyframes changed. When keys are only added,
+ * e.g. while importing, it is extended by addKeyFrame instead.
+ */
+int Layer::getLastCoveredFrame() const
+{
+    if (mLastCoveredFrameRevision != mKeyFrameRevision)
+    {
+        int lastFrame = -1;
+        for (const auto& pair : mKeyFrames)
+        {
+            lastFrame = std::max(lastFrame, pair.first + pair.second->length() - 1);
+        }
+        mLastCoveredFrame = lastFrame;
+        mLastCoveredFrameRevision = mKeyFrameRevision;
+    }
+    return mLastCoveredFrame;
+}
+
 bool Layer::keyExists(int position) const
 {
     return (mKeyFrames.find(position) != mKeyFrames.end());
@@ -90,12 +142,16 @@ KeyFrame* Layer::getLastKeyFrameAtPosition(int position) const
     {
         position = 1;
     }
-    auto it = mKeyFrames.lower_bound(position);
-    if (it == mKeyFrames.end())
+    return keyFrameIndex().lastKeyFrameAt(position);
+}
+
+const KeyFrameIndex& Layer::keyFrameIndex() const
+{
+    if (!mKeyFrameIndex.isValid())
     {
-        return nullptr;
+        mKeyFrameIndex.rebuild(mKeyFrames);
     }
-    return it->second;
+    return mKeyFrameIndex;
 }
 
 int Layer::getPreviousKeyFramePosition(int position) const
@@ -198,8 +254,17 @@ bool Layer::addKeyFrame(int position, KeyFrame* pKeyFrame)
 
     pKeyFrame->setPos(position);
     mKeyFrames.insert(std::make_pair(position, pKeyFrame));
+    mKeyFrameIndex.invalidate();
 
+    const bool lastCoveredFrameKnown = (mLastCoveredFrameRevision == mKeyFrameRevision);
     markFrameAsDirty(position);
+    keyFramesChanged();
+
+    if (lastCoveredFrameKnown)
+    {
+        mLastCoveredFrame = std::max(mLastCoveredFrame, position + pKeyFrame->length() - 1);
+        mLastCoveredFrameRevision = mKeyFrameRevision;
+    }
 
     return true;
 }
@@ -210,7 +275,9 @@ bool Layer::removeKeyFrame(int position)
     if (frame)
     {
         mKeyFrames.erase(frame->pos());
+        mKeyFrameIndex.invalidate();
         markFrameAsDirty(position);
+        keyFramesChanged();
         delete frame;
     }
     return true;
@@ -221,10 +288,8 @@ bool Layer::moveKeyFrame(int position, int offset)
     int newPos = position + offset;
     if (newPos < 1) { return false; }
 
-    auto listOfFramesLast = mSelectedFrames_byLast;
-    auto listOfFramesPos = mSelectedFrames_byPosition;
-    mSelectedFrames_byLast.clear();
-    mSelectedFrames_byPosition.clear();
+    KeyFrameSelection selectedFrames = mSelectedFrames;
+    mSelectedFrames.clear();
 
     if (swapKeyFrames(position, newPos)) {
         return true;
@@ -237,8 +302,7 @@ bool Layer::moveKeyFrame(int position, int offset)
     }
     setFrameSelected(newPos, false);
 
-    mSelectedFrames_byLast = listOfFramesLast;
-    mSelectedFrames_byPosition = listOfFramesPos;
+    mSelectedFrames = selectedFrames;
 
     return moved;
 }
@@ -260,6 +324,7 @@ bool Layer::swapKeyFrames(int position1, int position2)
 
     mKeyFrames[position1] = pSecondFrame;
     mKeyFrames[position2] = pFirstFrame;
+    mKeyFrameIndex.invalidate();
 
     pSecondFrame->setPos(position1);
     pFirstFrame->setPos(position2);
@@ -269,6 +334,7 @@ bool Layer::swapKeyFrames(int position1, int position2)
 
     markFrameAsDirty(position1);
     markFrameAsDirty(position2);
+    keyFramesChanged();
 
     return true;
 }
@@ -282,6 +348,8 @@ bool Layer::loadKey(KeyFrame* pKey)
         mKeyFrames.erase(it);
     }
     mKeyFrames.emplace(pKey->pos(), pKey);
+    mKeyFrameIndex.invalidate();
+    keyFramesChanged();
     return true;
 }
 
@@ -331,7 +399,7 @@ bool Layer::isFrameSelected(int position) const
     KeyFrame* keyFrame = getKeyFrameWhichCovers(position);
     if (keyFrame)
     {
-        return mSelectedFrames_byLast.contains(keyFrame->pos());
+        return mSelectedFrames.contains(keyFrame->pos());
     }
     return false;
 }
@@ -341,28 +409,16 @@ void Layer::setFrameSelected(int position, bool isSelected)
     KeyFrame* keyFrame = getKeyFrameWhichCovers(position);
     if (keyFrame != nullptr)
     {
-        int startPosition = keyFrame->pos();
-
-        if (isSelected && !mSelectedFrames_byLast.contains(startPosition))
+        if (isSelected)
         {
-            // Add the selected frame to the lists
-            mSelectedFrames_byLast.insert(0, startPosition);
-            mSelectedFrames_byPosition.append(startPosition);
-
-            // We need to keep the list of selected frames sorted
-            // in order to easily handle their movement
-            std::sort(mSelectedFrames_byPosition.begin(), mSelectedFrames_byPosition.end(), sortAsc);
+            mSelectedFrames.insert(keyFrame->pos());
         }
-        else if (!isSelected)
+        else
         {
-            // Remove the selected frame from the lists
-            int iLast = mSelectedFrames_byLast.indexOf(startPosition);
-            mSelectedFrames_byLast.removeAt(iLast);
-
-            int iPos = mSelectedFrames_byPosition.indexOf(startPosition);
-            mSelectedFrames_byPosition.removeAt(iPos);
+            mSelectedFrames.remove(keyFrame->pos());
         }
         keyFrame->setSelected(isSelected);
+        keyFramesChanged();
         emit selectedFramesChanged();
     }
 }
@@ -381,28 +437,27 @@ void Layer::toggleFrameSelected(int position, bool allowMultiple)
 
 void Layer::extendSelectionTo(int position)
 {
-    if (mSelectedFrames_byLast.count() > 0)
+    if (!mSelectedFrames.isEmpty())
     {
-        int lastSelected = mSelectedFrames_byLast[0];
-        int startPos;
-        int endPos;
+        int lastSelected = mSelectedFrames.lastSelected();
+        int startPos = qMin(lastSelected, position);
+        int endPos = qMax(lastSelected, position);
 
-        if (lastSelected < position)
+        // the keys of the range, selected from the first one to the last one
+        QList<int> positions;
+        foreachKeyFrameInRange(startPos, endPos, [&positions](KeyFrame* key)
         {
-            startPos = lastSelected;
-            endPos = position;
-        }
-        else
+            positions.prepend(key->pos());
+        });
+        for (int pos : positions)
         {
-            startPos = position;
-            endPos = lastSelected;
+            getKeyFrameAt(pos)->setSelected(true);
         }
 
-        int i = startPos;
-        while (i <= endPos)
+        if (mSelectedFrames.insert(positions) > 0)
         {
-            setFrameSelected(i, true);
-            i++;
+            keyFramesChanged();
+            emit selectedFramesChanged();
         }
     }
 }
@@ -427,97 +482,141 @@ void Layer::selectAllFramesAfter(int position)
 
 void Layer::deselectAll()
 {
-    mSelectedFrames_byLast.clear();
-    mSelectedFrames_byPosition.clear();
+    mSelectedFrames.clear();
     emit selectedFramesChanged();
 
     for (auto pair : mKeyFrames)
     {
         pair.second->setSelected(false);
     }
+    keyFramesChanged();
 }
 
 bool Layer::moveSelectedFrames(int offset)
 {
-    if (offset != 0 && mSelectedFrames_byPosition.count() > 0)
-    {
-        // If we are moving to the right we start moving selected frames from the highest (right) to the lowest (left)
-        int indexInSelection = mSelectedFrames_byPosition.count() - 1;
-        int step = -1;
+    if (offset == 0 || mSelectedFrames.isEmpty()) { return false; }
 
-        if (offset < 0)
-        {
-            // If we are moving to the left we start moving selected frames from the lowest (left) to the highest (right)
-            indexInSelection = 0;
-            step = 1;
+    // Check if we are not moving out of the timeline
+    if (mSelectedFrames.first() + offset < 1) { return false; }
 
-            // Check if we are not moving out of the timeline
-            if (mSelectedFrames_byPosition[0] + offset < 1) return false;
+    // Each selected key moves by offset. The frames it passes over, keys or empty frames,
+    // slide back one frame to make room for it: the frames which are not selected keep
+    // their order and fill the frames left free by the selected keys.
+    std::vector<int> targets;
+    targets.reserve(mSelectedFrames.count());
+    for (int position : mSelectedFrames.positions())
+    {
+        if (keyExists(position))
+        {
+            targets.push_back(position + offset);
         }
+    }
 
-        while (indexInSelection > -1 && indexInSelection < mSelectedFrames_byPosition.count())
+    if (!targets.empty())
+    {
+        const int lowest = qMin(targets.front() - offset, targets.front());
+        const int highest = qMax(targets.back() - offset, targets.back());
+
+        // the new positions of the keys between lowest and highest, in ascending order
+        std::vector<std::pair<int, KeyFrame*>> movedKeys;
+        std::vector<std::pair<int, KeyFrame*>> slidKeys;
+        size_t targetsBefore = 0;
+        int selectedBefore = 0;
+        for (auto it = mKeyFrames.rbegin(); it != mKeyFrames.rend(); ++it)
         {
-            int fromPos = mSelectedFrames_byPosition[indexInSelection];
-            int toPos = fromPos + offset;
+            const int position = it->first;
+            if (position < lowest || position > highest)
+            {
+                continue;
+            }
 
-            // Get the frame to move
-            KeyFrame* selectedFrame = getKeyFrameAt(fromPos);
+            if (mSelectedFrames.contains(position))
+            {
+                movedKeys.emplace_back(position + offset, it->second);
+                selectedBefore++;
+                continue;
+            }
 
-            if (selectedFrame != nullptr)
+            // the free frame with the same rank as this frame among the frames not selected
+            const int rank = position - lowest - selectedBefore;
+            int newPosition = lowest + rank + static_cast<int>(targetsBefore);
+            while (targetsBefore < targets.size() && targets[targetsBefore] <= newPosition)
             {
-                mKeyFrames.erase(fromPos);
-                markFrameAsDirty(fromPos);
-
-                // Slide back every frame between fromPos to toPos
-                // to avoid having 2 frames in the same position
-                bool isBetween = true;
-                int targetPosition = fromPos;
-
-                while (isBetween)
-                {
-                    int framePosition = targetPosition - step;
-
-                    KeyFrame* frame = getKeyFrameAt(framePosition);
-
-                    if (frame != nullptr)
-                    {
-                        mKeyFrames.erase(framePosition);
-                        markFrameAsDirty(framePosition);
-
-                        frame->setPos(targetPosition);
-                        mKeyFrames.insert(std::make_pair(targetPosition, frame));
-                        markFrameAsDirty(targetPosition);
-                    }
-
-                    targetPosition = targetPosition - step;
-                    if (fromPos < toPos && (targetPosition < fromPos || targetPosition >= toPos))
-                        isBetween = false;
-                    if (fromPos > toPos && (targetPosition > fromPos || targetPosition <= toPos))
-                        isBetween = false;
-                }
-
-                // Update the position of the selected frame
-                selectedFrame->setPos(toPos);
-                mKeyFrames.insert(std::make_pair(toPos, selectedFrame));
-                markFrameAsDirty(toPos);
+                targetsBefore++;
+                newPosition = lowest + rank + static_cast<int>(targetsBefore);
             }
-            indexInSelection = indexInSelection + step;
+            slidKeys.emplace_back(newPosition, it->second);
         }
-        emit selectedFramesChanged();
 
-        // Update selection lists
-        for (int i = 0; i < mSelectedFrames_byPosition.count(); i++)
+        // merge everything from the last position to the first one and rebuild the map at once
+        std::vector<std::pair<int, KeyFrame*>> layout;
+        layout.reserve(mKeyFrames.size());
+        auto it = mKeyFrames.begin();
+        for (; it != mKeyFrames.end() && it->first > highest; ++it)
+        {
+            layout.emplace_back(it->first, it->second);
+        }
+        auto moved = movedKeys.rbegin();
+        auto slid = slidKeys.rbegin();
+        while (moved != movedKeys.rend() || slid != slidKeys.rend())
         {
-            mSelectedFrames_byPosition[i] = mSelectedFrames_byPosition[i] + offset;
+            if (moved == movedKeys.rend() || (slid != slidKeys.rend() && slid->first > moved->first))
+            {
+                layout.push_back(*slid++);
+            }
+            else
+            {
+                layout.push_back(*moved++);
+            }
         }
-        for (int i = 0; i < mSelectedFrames_byLast.count(); i++)
+        for (; it != mKeyFrames.end(); ++it)
         {
-            mSelectedFrames_byLast[i] = mSelectedFrames_byLast[i] + offset;
+            if (it->first < lowest)
+            {
+                layout.emplace_back(it->first, it->second);
+            }
         }
+        setKeyFrameLayout(layout);
+    }
 
-        return true;
+    // Update the selection
+    mSelectedFrames.shift(offset);
+
+    keyFramesChanged();
+    emit selectedFramesChanged();
+    return true;
+}
+
+/** @brief Layer::setKeyFrameLayout
+ * Replaces the key map with the given keys, sorted from the last position to the first one.
+ * The keys which moved are updated, and the frames from the first to the last position
+ * they moved from or to are marked as dirty, as one range.
+ */
+void Layer::setKeyFrameLayout(const std::vector<std::pair<int, KeyFrame*>>& layout)
+{
+    Q_ASSERT(layout.size() == mKeyFrames.size());
+
+    int firstChanged = std::numeric_limits<int>::max();
+    int lastChanged = std::numeric_limits<int>::min();
+    for (const auto& pair : layout)
+    {
+        KeyFrame* key = pair.second;
+        if (key->pos() != pair.first)
+        {
+            firstChanged = std::min({ firstChanged, key->pos(), pair.first });
+            lastChanged = std::max({ lastChanged, key->pos(), pair.first });
+            key->setPos(pair.first);
+        }
     }
-    return false;
+    if (firstChanged <= lastChanged)
+    {
+        markFrameRangeAsDirty(firstChanged, lastChanged);
+    }
+
+    // sorted input, built in linear time
+    std::map<int, KeyFrame*, std::greater<int>> keyFrames(layout.begin(), layout.end());
+    mKeyFrames.swap(keyFrames);
+    mKeyFrameIndex.invalidate();
 }
 
 bool Layer::isPaintable() const
@@ -532,15 +631,7 @@ bool Layer::keyExistsWhichCovers(int frameNumber)
 
 KeyFrame* Layer::getKeyFrameWhichCovers(int frameNumber) const
 {
-    auto keyFrame = getLastKeyFrameAtPosition(frameNumber);
-    if (keyFrame != nullptr)
-    {
-        if (keyFrame->pos() + keyFrame->length() > frameNumber)
-        {
-            return keyFrame;
-        }
-    }
-    return nullptr;
+    return keyFrameIndex().keyFrameWhichCovers(std::max(frameNumber, 1));
 }
 
 QDomElement Layer::createBaseDomElement(QDomDocument& doc) const
@@ -18,12 +18,16 @@ GNU General Public License for more details.
 #define LAYER_H
 
 #include <map>
+#include <vector>
 #include <functional>
 #include <QObject>
 #include <QString>
 #include <QDomElement>
 #include "pencilerror.h"
 #include "pencildef.h"
+#include "keyframeselection.h"
+#include "framerangeset.h"
+#include "keyframeindex.h"
 
 class QMouseEvent;
 class QPainter;
@@ -99,6 +103,21 @@ public:
     bool getVisibility() const { return mVisible; }
 
     void foreachKeyFrame(std::function<void(KeyFrame*)>) const;
+    void foreachKeyFrameInRange(int from, int to, std::function<void(KeyFrame*)>) const;
+
+    /** Changes whenever a keyframe is added, removed, moved, resized or (de)selected.
+     *  Never the same for two layers, so it also tells views of different layers apart. */
+    quint64 keyFrameRevision() const { return mKeyFrameRevision; }
+    void keyFramesChanged();
+    /** The last revision given to any layer: unchanged as long as no keyframe changed anywhere */
+    static quint64 lastKeyFrameRevision();
+
+    /** The last frame covered by a keyframe, its length included, -1 without keyframes */
+    int getLastCoveredFrame() const;
+
+    /** Caches the key shown at each frame of the range, e.g. while playing it back */
+    virtual void setCachedFrameRange(int from, int to) { mKeyFrameIndex.setCachedRange(from, to); }
+    virtual void clearCachedFrameRange() { mKeyFrameIndex.clearCachedRange(); }
 
     void setModified(int position, bool isModified);
 
@@ -117,23 +136,27 @@ public:
 
     bool isPaintable() const;
 
-    /** Returns a list of dirty frame positions */
-    QList<int> dirtyFrames() const { return mDirtyFrames; }
+    /** Returns the dirty frame positions, merged into ranges */
+    const FrameRangeSet& dirtyFrames() const { return mDirtyFrames; }
 
     /** Mark the frame position as dirty.
      *  Any operation causing the frame to be modified, added, updated or removed, should call this. */
-    void markFrameAsDirty(const int frameNumber) { mDirtyFrames << frameNumber; }
+    void markFrameAsDirty(const int frameNumber) { mDirtyFrames.add(frameNumber); }
+
+    /** Mark every frame from one position to another as dirty, e.g. after moving keys around */
+    void markFrameRangeAsDirty(const int from, const int to) { mDirtyFrames.add(from, to); }
 
     /** Clear the list of dirty keyframes */
     void clearDirtyFrames() { mDirtyFrames.clear(); }
 
-    QList<int> getSelectedFrameList() { return mSelectedFrames_byPosition; }
+    QList<int> getSelectedFrameList() const { return mSelectedFrames.positions(); }
 
 signals:
     void selectedFramesChanged();
 
 protected:
     void setId(int LayerId) { mId = LayerId; }
+    void setKeyFrameLayout(const std::vector<std::pair<int, KeyFrame*>>& layout);
     virtual KeyFrame* createKeyFrame(int position, Object*) = 0;
 
 private:
@@ -142,18 +165,23 @@ private:
     int        mId = 0;
     bool       mVisible = true;
     QString    mName;
+    quint64    mKeyFrameRevision = 0;
+
+    mutable int     mLastCoveredFrame = -1;
+    mutable quint64 mLastCoveredFrameRevision = 0;
 
     std::map<int, KeyFrame*, std::greater<int>> mKeyFrames;
 
-    // We need to keep track of selected frames ordered by last selected
-    // and by position.
-    // Both should be pre-sorted on each selection for optimization purpose when moving frames.
-    //
-    QList<int> mSelectedFrames_byLast; // Used to handle selection range (based on last selected
-    QList<int> mSelectedFrames_byPosition; // Used to handle frames movements on the timeline
+    // A flat copy of mKeyFrames for the lookups by frame, rebuilt when first needed after the keys changed
+    const KeyFrameIndex& keyFrameIndex() const;
+    mutable KeyFrameIndex mKeyFrameIndex;
+
+    // The selected frames, ordered by position to handle their movements on the timeline,
+    // and by last selected to handle selection ranges
+    KeyFrameSelection mSelectedFrames;
 
     // Used for clearing cache for modified frames.
-    QList<int> mDirtyFrames;
+    FrameRangeSet mDirtyFrames;
 };
 
 #endif
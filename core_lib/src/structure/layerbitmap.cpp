@@ -21,6 +21,8 @@ GNU General Public License for more details.
 #include <QFile>
 #include "keyframe.h"
 #include "bitmapimage.h"
+#include "object.h"
+#include "activeframepool.h"
 
 
 
@@ -69,6 +71,8 @@ Status LayerBitmap::saveKeyFrameFile(KeyFrame* keyframe, QString path)
 
     bitmapImage->setFileName(strFilePath);
 
+    // a swapped out frame is read back to be saved, and unloaded again once it's on disk
+    const bool wasLoaded = bitmapImage->isLoaded();
     Status st = bitmapImage->writeFile(strFilePath);
     if (!st.ok())
     {
@@ -84,6 +88,15 @@ Status LayerBitmap::saveKeyFrameFile(KeyFrame* keyframe, QString path)
     }
 
     bitmapImage->setModified(false);
+    if (!wasLoaded)
+    {
+        // a compressed frame is still in the pool, which would go on counting its compressed memory
+        if (object() != nullptr)
+        {
+            object()->activeFramePool()->remove(bitmapImage);
+        }
+        bitmapImage->unloadFile();
+    }
     return Status::OK;
 }
 
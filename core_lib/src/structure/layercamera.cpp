@@ -20,7 +20,7 @@ GNU General Public License for more details.
 #include "camera.h"
 #include "pencildef.h"
 
-LayerCamera::LayerCamera(Object* object) : Layer(object, Layer::CAMERA)
+LayerCamera::LayerCamera(Object* object) : Layer(object, Layer::CAMERA), mPath(this)
 {
     setName(tr("Camera Layer"));
 
@@ -51,53 +51,24 @@ Camera* LayerCamera::getLastCameraAtFrame(int frameNumber, int increment)
 
 QTransform LayerCamera::getViewAtFrame(int frameNumber) const
 {
-    if (keyFrameCount() == 0)
-    {
-        return QTransform();
-    }
-
-    Camera* camera1 = static_cast<Camera*>(getLastKeyFrameAtPosition(frameNumber));
-
-    int nextFrame = getNextKeyFramePosition(frameNumber);
-    Camera* camera2 = static_cast<Camera*>(getLastKeyFrameAtPosition(nextFrame));
-
-    if (camera1 == nullptr && camera2 == nullptr)
-    {
-        return QTransform();
-    }
-    else if (camera1 == nullptr && camera2 != nullptr)
-    {
-        return camera2->view;
-    }
-    else if (camera2 == nullptr && camera1 != nullptr)
-    {
-        return camera1->view;
-    }
-
-    if (camera1 == camera2)
-    {
-        return camera1->view;
-    }
-
-    double frame1 = camera1->pos();
-    double frame2 = camera2->pos();
-
-    // linear interpolation
-    qreal c2 = (frameNumber - frame1) / (frame2 - frame1);
-    qreal c1 = 1.0 - c2;
+    return mPath.viewAt(frameNumber);
+}
 
-    auto interpolation = [=](double f1, double f2) -> double
-    {
-        return f1 * c1 + f2 * c2;
-    };
+QTransform LayerCamera::getViewAtSubFrame(qreal frame) const
+{
+    return mPath.viewAtSubFrame(frame);
+}
 
-    return QTransform(interpolation(camera1->view.m11(), camera2->view.m11()),
-                      interpolation(camera1->view.m12(), camera2->view.m12()),
-                      interpolation(camera1->view.m21(), camera2->view.m21()),
-                      interpolation(camera1->view.m22(), camera2->view.m22()),
-                      interpolation(camera1->view.dx(), camera2->view.dx()),
-                      interpolation(camera1->view.dy(), camera2->view.dy()));
+void LayerCamera::setCachedFrameRange(int from, int to)
+{
+    Layer::setCachedFrameRange(from, to);
+    mPath.setFrameRange(from, to);
+}
 
+void LayerCamera::clearCachedFrameRange()
+{
+    Layer::clearCachedFrameRange();
+    mPath.clearFrameRange();
 }
 
 void LayerCamera::linearInterpolateTransform(Camera* cam)
@@ -129,25 +100,12 @@ void LayerCamera::linearInterpolateTransform(Camera* cam)
         return cam->assign(*camera1);
     }
 
-    double frame1 = camera1->pos();
-    double frame2 = camera2->pos();
-
-    // linear interpolation
-    double c2 = (frameNumber - frame1) / (frame2 - frame1);
-
-    auto lerp = [](double f1, double f2, double ratio) -> double
-    {
-        return f1 * (1.0 - ratio) + f2 * ratio;
-    };
-
-    double dx = lerp(camera1->translation().x(), camera2->translation().x(), c2);
-    double dy = lerp(camera1->translation().y(), camera2->translation().y(), c2);
-    double r = lerp(camera1->rotation(), camera2->rotation(), c2);
-    double s = lerp(camera1->scaling(), camera2->scaling(), c2);
-
-    cam->translate(dx, dy);
-    cam->rotate(r);
-    cam->scale(s);
+    // the new key is where the camera already was
+    CameraPath::State state = CameraPath::interpolate(camera1, camera2, frameNumber);
+    cam->translate(state.translation);
+    cam->rotate(state.rotation);
+    cam->scale(state.scaling);
+    cam->setEasing(camera1->easing());
 }
 
 QRect LayerCamera::getViewRect()
@@ -206,6 +164,10 @@ QDomElement LayerCamera::createDomElement(QDomDocument& doc) const
                         keyTag.setAttribute("s", camera->scaling());
                         keyTag.setAttribute("dx", camera->translation().x());
                         keyTag.setAttribute("dy", camera->translation().y());
+                        if (camera->easing() != QEasingCurve::Linear)
+                        {
+                            keyTag.setAttribute("easing", static_cast<int>(camera->easing()));
+                        }
                         layerElem.appendChild(keyTag);
                     });
 
@@ -239,6 +201,12 @@ void LayerCamera::loadDomElement(const QDomElement& element, QString dataDirPath
                 qreal dy = imageElement.attribute("dy", "0").toDouble();
 
                 loadImageAtFrame(frame, dx, dy, rotate, scale);
+
+                int easing = imageElement.attribute("easing", "0").toInt();
+                if (easing > QEasingCurve::Linear && easing < QEasingCurve::Custom)
+                {
+                    getCameraAtFrame(frame)->setEasing(static_cast<QEasingCurve::Type>(easing));
+                }
             }
         }
         imageTag = imageTag.nextSibling();
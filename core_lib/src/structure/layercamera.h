@@ -19,6 +19,7 @@ GNU General Public License for more details.
 
 #include <QRect>
 #include "layer.h"
+#include "camerapath.h"
 
 class Camera;
 
@@ -38,6 +39,10 @@ public:
     Camera* getCameraAtFrame(int frameNumber);
     Camera* getLastCameraAtFrame(int frameNumber, int increment);
     QTransform getViewAtFrame(int frameNumber) const;
+    QTransform getViewAtSubFrame(qreal frame) const;
+
+    void setCachedFrameRange(int from, int to) override;
+    void clearCachedFrameRange() override;
 
     QRect getViewRect();
     QSize getViewSize() const;
@@ -56,6 +61,7 @@ private:
     int mFieldW = 800;
     int mFieldH = 600;
     QRect viewRect;
+    CameraPath mPath;
 };
 
 #endif
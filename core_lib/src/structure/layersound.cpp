@@ -63,6 +63,7 @@ void LayerSound::updateFrameLengths(int fps)
         auto soundClip = dynamic_cast<SoundClip *>(pKeyFrame);
         soundClip->updateLength(fps);
     });
+    keyFramesChanged();
 }
 
 QDomElement LayerSound::createDomElement(QDomDocument& doc) const
@@ -263,6 +263,23 @@ Layer* Object::findLayerByName(const QString& strName, Layer::LAYER_TYPE type) c
     return nullptr;
 }
 
+Layer* Object::findLayerById(int layerId) const
+{
+    for (Layer* layer : mLayers)
+    {
+        if (layer->id() == layerId)
+        {
+            return layer;
+        }
+    }
+    return nullptr;
+}
+
+int Object::getLayerIndex(Layer* layer) const
+{
+    return mLayers.indexOf(layer);
+}
+
 Layer* Object::takeLayer(int layerId)
 {
     // Removes the layer from this Object and returns it
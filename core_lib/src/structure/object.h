@@ -102,6 +102,8 @@ public:
     int  getLayerCount() const;
     Layer* getLayer(int i) const;
     Layer* findLayerByName(const QString& strName, Layer::LAYER_TYPE type = Layer::UNDEFINED) const;
+    Layer* findLayerById(int layerId) const;
+    int  getLayerIndex(Layer* layer) const;
     Layer* takeLayer(int layerId); // Note: transfer ownership of the layer
 
     bool swapLayers(int i, int j);
@@ -140,6 +142,7 @@ public:
     int totalKeyFrameCount() const;
     void updateActiveFrames(int frame) const;
     void setActiveFramePoolSize(int sizeInMB);
+    ActiveFramePool* activeFramePool() const { return mActiveFramePool.get(); }
 
 signals:
     void layerViewChanged();
@@ -120,6 +120,9 @@ public:
     virtual bool leavingThisTool() { return true; }
     virtual bool switchingLayer() { return true; } // default state should be true
 
+    /// Applies the work a tool still has in flight, so that the frames can be backed up, saved or left
+    virtual void finishPendingStroke() {}
+
     Properties properties;
 
     QPointF getCurrentPressPixel();
@@ -163,7 +163,10 @@ void BrushTool::pointerReleaseEvent(PointerEvent *event)
     if (event->inputType() != mCurrentInputType) return;
 
     Layer* layer = mEditor->layers()->currentLayer();
-    mEditor->backup(typeName());
+
+    // vector strokes are backed up once their curve is fitted
+    if (layer->type() != Layer::VECTOR)
+        mEditor->backup(typeName());
 
     qreal distance = QLineF(getCurrentPoint(), mMouseDownPoint).length();
     if (distance < 1)
@@ -211,55 +214,54 @@ void BrushTool::paintAt(QPointF point)
 void BrushTool::drawStroke()
 {
     StrokeTool::drawStroke();
-    QList<QPointF> p = strokeManager()->interpolateStroke();
 
     Layer* layer = mEditor->layers()->currentLayer();
 
     if (layer->type() == Layer::BITMAP)
     {
-        for (int i = 0; i < p.size(); i++)
-        {
-            p[i] = mEditor->view()->mapScreenToCanvas(p[i]);
-        }
-
-        qreal pressure = (properties.pressure) ? mCurrentPressure : 1.0;
-        qreal opacity = (properties.pressure) ? (mCurrentPressure * 0.5) : 1.0;
-        qreal brushWidth = properties.width * pressure;
-        mCurrentWidth = brushWidth;
-
-        qreal brushStep = (0.5 * brushWidth);
-        brushStep = qMax(1.0, brushStep);
-
         BlitRect rect;
+        qreal maxWidth = 0;
 
-        QPointF a = mLastBrushPoint;
-        QPointF b = getCurrentPoint();
-
-        qreal distance = 4 * QLineF(b, a).length();
-        int steps = qRound(distance / brushStep);
-
-        for (int i = 0; i < steps; i++)
+        // every sample gets its own pressure
+        for (const StrokeSample& sample : mSamples)
         {
-            QPointF point = mLastBrushPoint + (i + 1) * brushStep * (getCurrentPoint() - mLastBrushPoint) / distance;
-
-            rect.extend(point.toPoint());
-            mScribbleArea->drawBrush(point,
-                                     brushWidth,
-                                     properties.feather,
-                                     mEditor->color()->frontColor(),
-                                     opacity,
-                                     true);
-            if (i == (steps - 1))
+            mCurrentPressure = sample.pressure;
+            qreal pressure = (properties.pressure) ? mCurrentPressure : 1.0;
+            qreal opacity = (properties.pressure) ? (mCurrentPressure * 0.5) : 1.0;
+            qreal brushWidth = properties.width * pressure;
+            mCurrentWidth = brushWidth;
+            maxWidth = qMax(maxWidth, brushWidth);
+
+            qreal brushStep = (0.5 * brushWidth);
+            brushStep = qMax(1.0, brushStep);
+
+            QPointF point = mEditor->view()->mapScreenToCanvas(sample.pos);
+            QList<QPointF> dabs = dabsAlong(mLastBrushPoint, point, brushStep);
+            if (dabs.isEmpty())
+                continue;
+
+            for (const QPointF& dab : dabs)
             {
-                mLastBrushPoint = getCurrentPoint();
+                rect.extend(dab.toPoint());
             }
+            mLastBrushPoint = point;
+            mScribbleArea->drawBrushDabs(dabs,
+                                         brushWidth,
+                                         properties.feather,
+                                         mEditor->color()->frontColor(),
+                                         opacity,
+                                         true);
         }
 
-        int rad = qRound(brushWidth / 2 + 2);
+        int rad = qRound(maxWidth / 2 + 2);
 
-        mScribbleArea->paintBitmapBufferRect(rect);
+        mScribbleArea->paintBitmapBufferRect(rect, rad);
         mScribbleArea->refreshBitmap(rect, rad);
 
+        QColor predictionColor = mEditor->color()->frontColor();
+        predictionColor.setAlphaF(predictionColor.alphaF() * ((properties.pressure) ? (mCurrentPressure * 0.5) : 1.0));
+        drawStrokePrediction(mLastBrushPoint, properties.width, properties.pressure, predictionColor);
+
         // Line visualizer
         // for debugging
 //        QPainterPath tempPath;
@@ -278,6 +280,8 @@ void BrushTool::drawStroke()
     }
     else if (layer->type() == Layer::VECTOR)
     {
+        QList<QPointF> p = strokeManager()->interpolateStroke();
+
         qreal pressure = (properties.pressure) ? mCurrentPressure : 1;
         qreal brushWidth = properties.width * pressure;
 
@@ -317,28 +321,18 @@ void BrushTool::paintVectorStroke()
 
     if (layer->type() == Layer::VECTOR && mStrokePoints.size() > -1)
     {
-        // Clear the temporary pixel path
-        mScribbleArea->clearBitmapBuffer();
+        // The temporary pixel path is cleared once the curve is fitted
         qreal tol = mScribbleArea->getCurveSmoothing() / mEditor->view()->scaling();
+        fitVectorStroke(tol);
+    }
+}
 
-        BezierCurve curve(mStrokePoints, mStrokePressures, tol);
-        curve.setWidth(properties.width);
-        curve.setFeather(properties.feather);
-        curve.setFilled(false);
-        curve.setInvisibility(properties.invisibility);
-        curve.setVariableWidth(properties.pressure);
-        curve.setColorNumber(mEditor->color()->frontColorNumber());
-
-        VectorImage* vectorImage = static_cast<VectorImage*>(layer->getLastKeyFrameAtPosition(mEditor->currentFrame()));
-        vectorImage->addCurve(curve, mEditor->view()->scaling(), false);
-
-        if (vectorImage->isAnyCurveSelected() || mEditor->select()->somethingSelected())
-        {
-            mEditor->deselectAll();
-        }
-
-        vectorImage->setSelected(vectorImage->getLastCurveNumber(), true);
+void BrushTool::addFittedVectorStroke(BezierCurve& curve, VectorImage* vectorImage, const QList<QPointF>& strokePoints)
+{
+    curve.setWidth(properties.width);
+    curve.setFeather(properties.feather);
+    curve.setInvisibility(properties.invisibility);
+    curve.setVariableWidth(properties.pressure);
 
-        mScribbleArea->setModified(mEditor->layers()->currentLayerIndex(), mEditor->currentFrame());
-    }
+    StrokeTool::addFittedVectorStroke(curve, vectorImage, strokePoints);
 }
@@ -49,6 +49,8 @@ public:
     void setStabilizerLevel(const int level) override;
 
 protected:
+    void addFittedVectorStroke(BezierCurve& curve, VectorImage* vectorImage, const QList<QPointF>& strokePoints) override;
+
     QPointF mLastBrushPoint;
     QPointF mMouseDownPoint;
 
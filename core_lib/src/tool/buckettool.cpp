@@ -185,7 +185,14 @@ void BucketTool::paintVector(Layer* layer)
     VectorImage* vectorImage = static_cast<LayerVector*>(layer)->getLastVectorImageAtFrame(mEditor->currentFrame(), 0);
     if (vectorImage == nullptr) { return; } // Can happen if the first frame is deleted while drawing
 
-    if (!vectorImage->isPathFilled())
+    if (!vectorImage->isAnyCurveSelected())
+    {
+        // fill the area enclosed by the curves around the pointer
+        vectorImage->fillAreaAt(getLastPoint(),
+                                mEditor->color()->frontColorNumber(),
+                                qAbs(mEditor->view()->scaling()));
+    }
+    else if (!vectorImage->isPathFilled())
     {
         vectorImage->fillSelectedPath(mEditor->color()->frontColorNumber());
     }
@@ -0,0 +1,61 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "cursorcache.h"
+
+
+bool CursorCache::Key::operator==(const Key& other) const
+{
+    return tool == other.tool
+        && quickSize == other.quickSize
+        && qFuzzyCompare(width + 1.0, other.width + 1.0)
+        && qFuzzyCompare(feather + 1.0, other.feather + 1.0)
+        && useFeather == other.useFeather
+        && qFuzzyCompare(scaling, other.scaling)
+        && windowWidth == other.windowWidth;
+}
+
+CursorCache::CursorCache(int capacity) : mCapacity(qMax(1, capacity))
+{
+}
+
+/**
+ * @brief CursorCache::cursor
+ * @param key: the tool settings and zoom the cursor is for
+ * @param draw: draws the cursor, only called when it is not cached
+ * @return the cursor pixmap
+ */
+QPixmap CursorCache::cursor(const Key& key, const std::function<QPixmap()>& draw)
+{
+    for (int i = 0; i < mEntries.size(); i++)
+    {
+        if (mEntries[i].first == key)
+        {
+            if (i > 0)
+            {
+                mEntries.move(i, 0);
+            }
+            return mEntries.first().second;
+        }
+    }
+
+    mMisses++;
+    if (mEntries.size() >= mCapacity)
+    {
+        mEntries.removeLast();
+    }
+    mEntries.prepend(qMakePair(key, draw()));
+    return mEntries.first().second;
+}
@@ -0,0 +1,61 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#ifndef CURSORCACHE_H
+#define CURSORCACHE_H
+
+#include <functional>
+#include <QList>
+#include <QPixmap>
+#include "pencildef.h"
+
+
+/**
+ * Keeps the last few canvas cursors drawn, so hovering and zooming back and forth
+ * with the same brushes doesn't draw the same circles over and over.
+ * The least recently used cursor goes when the cache is full.
+ */
+class CursorCache
+{
+public:
+    /// Everything the look of a canvas cursor depends on
+    struct Key
+    {
+        ToolType tool = INVALID_TOOL;
+        bool quickSize = false;   ///< the cursor shown while adjusting the width or feather
+        qreal width = 0.0;
+        qreal feather = 0.0;
+        bool useFeather = false;
+        qreal scaling = 1.0;
+        int windowWidth = 0;
+
+        bool operator==(const Key& other) const;
+    };
+
+    explicit CursorCache(int capacity = 8);
+
+    QPixmap cursor(const Key& key, const std::function<QPixmap()>& draw);
+
+    int size() const { return mEntries.size(); }
+    int misses() const { return mMisses; }
+    void clear() { mEntries.clear(); }
+
+private:
+    QList<QPair<Key, QPixmap>> mEntries;   ///< the most recently used first
+    int mCapacity = 8;
+    int mMisses = 0;
+};
+
+#endif // CURSORCACHE_H
@@ -19,6 +19,7 @@ GNU General Public License for more details.
 #include <QSettings>
 #include <QPixmap>
 #include <QPainter>
+#include <QKeyEvent>
 
 #include "editor.h"
 #include "blitrect.h"
@@ -149,6 +150,7 @@ QCursor EraserTool::cursor()
 
 void EraserTool::pointerPressEvent(PointerEvent *event)
 {
+    mStrokeCancelled = false;
     startStroke(event->inputType());
     mLastBrushPoint = getCurrentPoint();
     mMouseDownPoint = getCurrentPoint();
@@ -156,7 +158,7 @@ void EraserTool::pointerPressEvent(PointerEvent *event)
 
 void EraserTool::pointerMoveEvent(PointerEvent* event)
 {
-    if (event->buttons() & Qt::LeftButton && event->inputType() == mCurrentInputType)
+    if (event->buttons() & Qt::LeftButton && event->inputType() == mCurrentInputType && !mStrokeCancelled)
     {
         mCurrentPressure = strokeManager()->getPressure();
         updateStrokes();
@@ -168,6 +170,7 @@ void EraserTool::pointerMoveEvent(PointerEvent* event)
 void EraserTool::pointerReleaseEvent(PointerEvent *event)
 {
     if (event->inputType() != mCurrentInputType) return;
+    if (mStrokeCancelled) return;
 
     mEditor->backup(typeName());
 
@@ -184,6 +187,21 @@ void EraserTool::pointerReleaseEvent(PointerEvent *event)
     endStroke();
 }
 
+bool EraserTool::keyPressEvent(QKeyEvent* event)
+{
+    if (event->key() == Qt::Key_Escape && strokeManager()->isActive() && !mStrokeCancelled
+        && mEditor->layers()->currentLayer()->type() == Layer::BITMAP)
+    {
+        // drop the stroke, the frame has not been touched yet
+        mScribbleArea->cancelErasing();
+        mScribbleArea->clearBitmapBuffer();
+        endStroke();
+        mStrokeCancelled = true;
+        return true;
+    }
+    return StrokeTool::keyPressEvent(event);
+}
+
 // draw a single paint dab at the given location
 void EraserTool::paintAt(QPointF point)
 {
@@ -196,18 +214,17 @@ void EraserTool::paintAt(QPointF point)
         mCurrentWidth = brushWidth;
 
         BlitRect rect(point.toPoint());
-        mScribbleArea->drawBrush(point,
-                                 brushWidth,
-                                 properties.feather,
-                                 QColor(255, 255, 255, 255),
-                                 opacity,
-                                 properties.useFeather,
-                                 properties.useAA == ON);
+        mScribbleArea->eraseBrushDabs(QList<QPointF>() << point,
+                                      brushWidth,
+                                      properties.feather,
+                                      opacity,
+                                      properties.useFeather,
+                                      properties.useAA == ON);
 
         int rad = qRound(brushWidth / 2 + 2);
 
         //continuously update buffer to update stroke behind grid.
-        mScribbleArea->paintBitmapBufferRect(rect);
+        mScribbleArea->paintBitmapBufferRect(rect, rad);
 
         mScribbleArea->refreshBitmap(rect, rad);
     }
@@ -216,58 +233,54 @@ void EraserTool::paintAt(QPointF point)
 void EraserTool::drawStroke()
 {
     StrokeTool::drawStroke();
-    QList<QPointF> p = strokeManager()->interpolateStroke();
 
     Layer* layer = mEditor->layers()->currentLayer();
 
     if (layer->type() == Layer::BITMAP)
     {
-        for (int i = 0; i < p.size(); i++)
-        {
-            p[i] = mEditor->view()->mapScreenToCanvas(p[i]);
-        }
-
-        qreal pressure = (properties.pressure) ? mCurrentPressure : 1.0;
-        qreal opacity = (properties.pressure) ? (mCurrentPressure * 0.5) : 1.0;
-        qreal brushWidth = properties.width * pressure;
-        mCurrentWidth = brushWidth;
-
-        qreal brushStep = (0.5 * brushWidth);
-        brushStep = qMax(1.0, brushStep);
-
         BlitRect rect;
+        qreal maxWidth = 0;
 
-        QPointF a = mLastBrushPoint;
-        QPointF b = getCurrentPoint();
-
-        qreal distance = 4 * QLineF(b, a).length();
-        int steps = qRound(distance / brushStep);
-
-        for (int i = 0; i < steps; i++)
+        // every sample gets its own pressure
+        for (const StrokeSample& sample : mSamples)
         {
-            QPointF point = mLastBrushPoint + (i + 1) * brushStep * (getCurrentPoint() - mLastBrushPoint) / distance;
-
-            rect.extend(point.toPoint());
-            mScribbleArea->drawBrush(point,
-                                     brushWidth,
-                                     properties.feather,
-                                     Qt::white,
-                                     opacity,
-                                     properties.useFeather,
-                                     properties.useAA == ON);
-            if (i == (steps - 1))
+            mCurrentPressure = sample.pressure;
+            qreal pressure = (properties.pressure) ? mCurrentPressure : 1.0;
+            qreal opacity = (properties.pressure) ? (mCurrentPressure * 0.5) : 1.0;
+            qreal brushWidth = properties.width * pressure;
+            mCurrentWidth = brushWidth;
+            maxWidth = qMax(maxWidth, brushWidth);
+
+            qreal brushStep = (0.5 * brushWidth);
+            brushStep = qMax(1.0, brushStep);
+
+            QPointF point = mEditor->view()->mapScreenToCanvas(sample.pos);
+            QList<QPointF> dabs = dabsAlong(mLastBrushPoint, point, brushStep);
+            if (dabs.isEmpty())
+                continue;
+
+            for (const QPointF& dab : dabs)
             {
-                mLastBrushPoint = getCurrentPoint();
+                rect.extend(dab.toPoint());
             }
+            mLastBrushPoint = point;
+            mScribbleArea->eraseBrushDabs(dabs,
+                                          brushWidth,
+                                          properties.feather,
+                                          opacity,
+                                          properties.useFeather,
+                                          properties.useAA == ON);
         }
 
-        int rad = qRound(brushWidth / 2 + 2);
+        int rad = qRound(maxWidth / 2 + 2);
 
-        mScribbleArea->paintBitmapBufferRect(rect);
+        mScribbleArea->paintBitmapBufferRect(rect, rad);
         mScribbleArea->refreshBitmap(rect, rad);
     }
     else if (layer->type() == Layer::VECTOR)
     {
+        QList<QPointF> p = strokeManager()->interpolateStroke();
+
         mCurrentWidth = properties.width;
         if (properties.pressure)
         {
@@ -34,6 +34,7 @@ public:
     void pointerMoveEvent(PointerEvent*) override;
     void pointerPressEvent(PointerEvent*) override;
     void pointerReleaseEvent(PointerEvent*) override;
+    bool keyPressEvent(QKeyEvent*) override;
 
     void drawStroke();
     void paintAt(QPointF point);
@@ -50,6 +51,7 @@ public:
 protected:
     QPointF mLastBrushPoint;
     QPointF mMouseDownPoint;
+    bool mStrokeCancelled = false;
 };
 
 #endif // ERASERTOOL_H
@@ -175,7 +175,12 @@ void PencilTool::pointerReleaseEvent(PointerEvent *event)
 {
     if (event->inputType() != mCurrentInputType) return;
 
-    mEditor->backup(typeName());
+    Layer* layer = mEditor->layers()->currentLayer();
+
+    // vector strokes are backed up once their curve is fitted
+    if (layer->type() != Layer::VECTOR)
+        mEditor->backup(typeName());
+
     qreal distance = QLineF(getCurrentPoint(), mMouseDownPoint).length();
     if (distance < 1)
     {
@@ -186,7 +191,6 @@ void PencilTool::pointerReleaseEvent(PointerEvent *event)
         drawStroke();
     }
 
-    Layer* layer = mEditor->layers()->currentLayer();
     if (layer->type() == Layer::BITMAP)
         paintBitmapStroke();
     else if (layer->type() == Layer::VECTOR)
@@ -224,51 +228,59 @@ void PencilTool::paintAt(QPointF point)
 void PencilTool::drawStroke()
 {
     StrokeTool::drawStroke();
-    QList<QPointF> p = strokeManager()->interpolateStroke();
 
     Layer* layer = mEditor->layers()->currentLayer();
 
     if (layer->type() == Layer::BITMAP)
     {
-        qreal pressure = (properties.pressure) ? mCurrentPressure : 1.0;
-        qreal opacity = (properties.pressure) ? (mCurrentPressure * 0.5) : 1.0;
-        qreal brushWidth = properties.width * pressure;
-        mCurrentWidth = brushWidth;
-
         qreal fixedBrushFeather = properties.feather;
-        qreal brushStep = qMax(1.0, (0.5 * brushWidth));
 
         BlitRect rect;
+        qreal maxWidth = 0;
+
+        // every sample gets its own pressure
+        for (const StrokeSample& sample : mSamples)
+        {
+            mCurrentPressure = sample.pressure;
+            qreal pressure = (properties.pressure) ? mCurrentPressure : 1.0;
+            qreal opacity = (properties.pressure) ? (mCurrentPressure * 0.5) : 1.0;
+            qreal brushWidth = properties.width * pressure;
+            mCurrentWidth = brushWidth;
+            maxWidth = qMax(maxWidth, brushWidth);
 
-        QPointF a = mLastBrushPoint;
-        QPointF b = getCurrentPoint();
+            qreal brushStep = qMax(1.0, (0.5 * brushWidth));
 
-        qreal distance = 4 * QLineF(b, a).length();
-        int steps = qRound(distance / brushStep);
+            QPointF point = mEditor->view()->mapScreenToCanvas(sample.pos);
+            QList<QPointF> dabs = dabsAlong(mLastBrushPoint, point, brushStep);
+            if (dabs.isEmpty())
+                continue;
 
-        for (int i = 0; i < steps; i++)
-        {
-            QPointF point = mLastBrushPoint + (i + 1) * brushStep * (getCurrentPoint() - mLastBrushPoint) / distance;
-            rect.extend(point.toPoint());
-            mScribbleArea->drawPencil(point,
-                                      brushWidth,
-                                      fixedBrushFeather,
-                                      mEditor->color()->frontColor(),
-                                      opacity);
-
-            if (i == (steps - 1))
+            for (const QPointF& dab : dabs)
             {
-                mLastBrushPoint = getCurrentPoint();
+                rect.extend(dab.toPoint());
             }
+            mLastBrushPoint = point;
+            mScribbleArea->drawBrushDabs(dabs,
+                                         brushWidth,
+                                         fixedBrushFeather,
+                                         mEditor->color()->frontColor(),
+                                         opacity,
+                                         true);
         }
 
-        int rad = qRound(brushWidth) / 2 + 2;
+        int rad = qRound(maxWidth) / 2 + 2;
 
-        mScribbleArea->paintBitmapBufferRect(rect);
+        mScribbleArea->paintBitmapBufferRect(rect, rad);
         mScribbleArea->refreshBitmap(rect, rad);
+
+        QColor predictionColor = mEditor->color()->frontColor();
+        predictionColor.setAlphaF(predictionColor.alphaF() * ((properties.pressure) ? (mCurrentPressure * 0.5) : 1.0));
+        drawStrokePrediction(mLastBrushPoint, properties.width, properties.pressure, predictionColor);
     }
     else if (layer->type() == Layer::VECTOR)
     {
+        QList<QPointF> p = strokeManager()->interpolateStroke();
+
         properties.useFeather = false;
         mCurrentWidth = 0; // FIXME: WTF?
         QPen pen(mEditor->color()->frontColor(),
@@ -303,36 +315,27 @@ void PencilTool::paintVectorStroke(Layer* layer)
     if (mStrokePoints.empty())
         return;
 
-    // Clear the temporary pixel path
-    mScribbleArea->clearBitmapBuffer();
+    Q_UNUSED(layer);
+
+    // The temporary pixel path is cleared once the curve is fitted
     qreal tol = mScribbleArea->getCurveSmoothing() / mEditor->view()->scaling();
+    fitVectorStroke(tol);
+}
 
-    BezierCurve curve(mStrokePoints, mStrokePressures, tol);
+void PencilTool::addFittedVectorStroke(BezierCurve& curve, VectorImage* vectorImage, const QList<QPointF>& strokePoints)
+{
     curve.setWidth(0);
     curve.setFeather(0);
-    curve.setFilled(false);
     curve.setInvisibility(true);
     curve.setVariableWidth(false);
-    curve.setColorNumber(mEditor->color()->frontColorNumber());
-    VectorImage* vectorImage = static_cast<LayerVector*>(layer)->getLastVectorImageAtFrame(mEditor->currentFrame(), 0);
-    if (vectorImage == nullptr) { return; } // Can happen if the first frame is deleted while drawing
-    vectorImage->addCurve(curve, qAbs(mEditor->view()->scaling()), properties.vectorMergeEnabled);
+
+    StrokeTool::addFittedVectorStroke(curve, vectorImage, strokePoints);
 
     if (properties.useFillContour)
     {
-        vectorImage->fillContour(mStrokePoints,
+        vectorImage->fillContour(strokePoints,
                                  mEditor->color()->frontColorNumber());
     }
 
-    if (vectorImage->isAnyCurveSelected() || mEditor->select()->somethingSelected())
-    {
-        mEditor->deselectAll();
-    }
-
-    // select last/newest curve
-    vectorImage->setSelected(vectorImage->getLastCurveNumber(), true);
-
     // TODO: selection doesn't apply on enter
-
-    mScribbleArea->setModified(mEditor->layers()->currentLayerIndex(), mEditor->currentFrame());
 }
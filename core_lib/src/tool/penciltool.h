@@ -51,6 +51,9 @@ public:
     void setStabilizerLevel(const int level) override;
     void setUseFillContour(const bool useFillContour) override;
 
+protected:
+    void addFittedVectorStroke(BezierCurve& curve, VectorImage* vectorImage, const QList<QPointF>& strokePoints) override;
+
 private:
     QColor mCurrentPressuredColor{ 0, 0, 0, 255 };
     QPointF mLastBrushPoint{ 0, 0 };
@@ -139,10 +139,12 @@ void PenTool::pointerReleaseEvent(PointerEvent *event)
 {
     if (event->inputType() != mCurrentInputType) return;
 
-    mEditor->backup(typeName());
-
     Layer* layer = mEditor->layers()->currentLayer();
 
+    // vector strokes are backed up once their curve is fitted
+    if (layer->type() != Layer::VECTOR)
+        mEditor->backup(typeName());
+
     qreal distance = QLineF(getCurrentPoint(), mMouseDownPoint).length();
     if (distance < 1)
     {
@@ -187,56 +189,55 @@ void PenTool::paintAt(QPointF point)
 void PenTool::drawStroke()
 {
     StrokeTool::drawStroke();
-    QList<QPointF> p = strokeManager()->interpolateStroke();
 
     Layer* layer = mEditor->layers()->currentLayer();
 
     if (layer->type() == Layer::BITMAP)
     {
-        for (int i = 0; i < p.size(); i++)
-        {
-            p[i] = mEditor->view()->mapScreenToCanvas(p[i]);
-        }
-
-        qreal pressure = (properties.pressure) ? mCurrentPressure : 1.0;
-        qreal brushWidth = properties.width * pressure;
-        mCurrentWidth = brushWidth;
-
-        // TODO: Make popup widget for less important properties,
-        // Eg. stepsize should be a slider.. will have fixed (0.3) value for now.
-        qreal brushStep = (0.5 * brushWidth);
-        brushStep = qMax(1.0, brushStep);
-
         BlitRect rect;
+        qreal maxWidth = 0;
 
-        QPointF a = mLastBrushPoint;
-        QPointF b = getCurrentPoint();
-
-        qreal distance = 4 * QLineF(b, a).length();
-        int steps = qRound(distance / brushStep);
-
-        for (int i = 0; i < steps; i++)
+        // every sample gets its own pressure
+        for (const StrokeSample& sample : mSamples)
         {
-            QPointF point = mLastBrushPoint + (i + 1) * brushStep * (getCurrentPoint() - mLastBrushPoint) / distance;
-            rect.extend(point.toPoint());
-            mScribbleArea->drawPen(point,
-                                   brushWidth,
-                                   mEditor->color()->frontColor(),
-                                   properties.useAA);
-
-            if (i == (steps - 1))
+            mCurrentPressure = sample.pressure;
+            qreal pressure = (properties.pressure) ? mCurrentPressure : 1.0;
+            qreal brushWidth = properties.width * pressure;
+            mCurrentWidth = brushWidth;
+            maxWidth = qMax(maxWidth, brushWidth);
+
+            // TODO: Make popup widget for less important properties,
+            // Eg. stepsize should be a slider.. will have fixed (0.3) value for now.
+            qreal brushStep = (0.5 * brushWidth);
+            brushStep = qMax(1.0, brushStep);
+
+            QPointF point = mEditor->view()->mapScreenToCanvas(sample.pos);
+            QList<QPointF> dabs = dabsAlong(mLastBrushPoint, point, brushStep);
+            if (dabs.isEmpty())
+                continue;
+
+            for (const QPointF& dab : dabs)
             {
-                mLastBrushPoint = getCurrentPoint();
+                rect.extend(dab.toPoint());
+                mScribbleArea->drawPen(dab,
+                                       brushWidth,
+                                       mEditor->color()->frontColor(),
+                                       properties.useAA);
             }
+            mLastBrushPoint = point;
         }
 
-        int rad = qRound(brushWidth) / 2 + 2;
+        int rad = qRound(maxWidth) / 2 + 2;
 
-        mScribbleArea->paintBitmapBufferRect(rect);
+        mScribbleArea->paintBitmapBufferRect(rect, rad);
         mScribbleArea->refreshBitmap(rect, rad);
+
+        drawStrokePrediction(mLastBrushPoint, properties.width, properties.pressure, mEditor->color()->frontColor());
     }
     else if (layer->type() == Layer::VECTOR)
     {
+        QList<QPointF> p = strokeManager()->interpolateStroke();
+
         qreal pressure = (properties.pressure) ? mCurrentPressure : 1.0;
         qreal brushWidth = properties.width * pressure;
 
@@ -269,29 +270,19 @@ void PenTool::paintVectorStroke(Layer* layer)
     if (mStrokePoints.empty())
         return;
 
-    // Clear the temporary pixel path
-    mScribbleArea->clearBitmapBuffer();
+    Q_UNUSED(layer);
+
+    // The temporary pixel path is cleared once the curve is fitted
     qreal tol = mScribbleArea->getCurveSmoothing() / mEditor->view()->scaling();
+    fitVectorStroke(tol);
+}
 
-    BezierCurve curve(mStrokePoints, mStrokePressures, tol);
+void PenTool::addFittedVectorStroke(BezierCurve& curve, VectorImage* vectorImage, const QList<QPointF>& strokePoints)
+{
     curve.setWidth(properties.width);
     curve.setFeather(properties.feather);
-    curve.setFilled(false);
     curve.setInvisibility(properties.invisibility);
     curve.setVariableWidth(properties.pressure);
-    curve.setColorNumber(mEditor->color()->frontColorNumber());
-
-    auto pLayerVector = static_cast<LayerVector*>(layer);
-    VectorImage* vectorImage = pLayerVector->getLastVectorImageAtFrame(mEditor->currentFrame(), 0);
-    if (vectorImage == nullptr) { return; } // Can happen if the first frame is deleted while drawing
-    vectorImage->addCurve(curve, mEditor->view()->scaling(), false);
-
-    if (vectorImage->isAnyCurveSelected() || mEditor->select()->somethingSelected())
-    {
-        mEditor->deselectAll();
-    }
-
-    vectorImage->setSelected(vectorImage->getLastCurveNumber(), true);
 
-    mScribbleArea->setModified(mEditor->layers()->currentLayerIndex(), mEditor->currentFrame());
+    StrokeTool::addFittedVectorStroke(curve, vectorImage, strokePoints);
 }
@@ -46,6 +46,9 @@ public:
     void setAA(const int AA) override;
     void setStabilizerLevel(const int level) override;
 
+protected:
+    void addFittedVectorStroke(BezierCurve& curve, VectorImage* vectorImage, const QList<QPointF>& strokePoints) override;
+
 private:
     QPointF mLastBrushPoint;
     QPointF mMouseDownPoint;
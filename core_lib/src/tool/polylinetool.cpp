@@ -104,6 +104,10 @@ QCursor PolylineTool::cursor()
 void PolylineTool::clearToolData()
 {
     mPoints.clear();
+    if (mScribbleArea)
+    {
+        mScribbleArea->clearRubberBand();
+    }
 }
 
 void PolylineTool::pointerPressEvent(PointerEvent* event)
@@ -127,6 +131,10 @@ void PolylineTool::pointerPressEvent(PointerEvent* event)
                 }
             }
             mPoints << getCurrentPoint();
+
+            // the committed segments only change on a click
+            drawPolyline(mPoints, mPoints.last());
+            drawRubberBand(getCurrentPoint());
         }
     }
 }
@@ -134,9 +142,17 @@ void PolylineTool::pointerPressEvent(PointerEvent* event)
 void PolylineTool::pointerMoveEvent(PointerEvent*)
 {
     Layer* layer = mEditor->layers()->currentLayer();
+    if (mPoints.isEmpty())
+        return;
+
     if (layer->type() == Layer::BITMAP || layer->type() == Layer::VECTOR)
     {
-        drawPolyline(mPoints, getCurrentPoint());
+        // the vector preview is drawn in screen coordinates, it has to follow the view
+        if (layer->type() == Layer::VECTOR && mEditor->view()->getView() != mPreviewView)
+        {
+            drawPolyline(mPoints, mPoints.last());
+        }
+        drawRubberBand(getCurrentPoint());
     }
 }
 
@@ -184,6 +200,12 @@ bool PolylineTool::keyPressEvent(QKeyEvent* event)
     return false;
 }
 
+/**
+ * @brief PolylineTool::drawPolyline
+ * Draws the polyline through points, then on to endPoint, into the bitmap buffer.
+ * It is redrawn as a whole, so this is done once per point, the segment following
+ * the pointer is drawn by drawRubberBand().
+ */
 void PolylineTool::drawPolyline(QList<QPointF> points, QPointF endPoint)
 {
     if (points.size() > 0)
@@ -226,14 +248,38 @@ void PolylineTool::drawPolyline(QList<QPointF> points, QPointF endPoint)
         }
 
         mScribbleArea->drawPolyline(tempPath, pen, properties.useAA);
+        mPreviewView = mEditor->view()->getView();
     }
 }
 
+/**
+ * @brief PolylineTool::drawRubberBand
+ * Shows the segment from the last point to endPoint over the canvas, the cost doesn't
+ * depend on how many points the polyline has.
+ */
+void PolylineTool::drawRubberBand(QPointF endPoint)
+{
+    QPen pen(mEditor->color()->frontColor(),
+             properties.width * mEditor->view()->scaling(),
+             Qt::SolidLine,
+             Qt::RoundCap,
+             Qt::RoundJoin);
+
+    if (mEditor->layers()->currentLayer()->type() == Layer::VECTOR && mScribbleArea->makeInvisible())
+    {
+        pen.setWidth(0);
+        pen.setStyle(Qt::DotLine);
+    }
+
+    mScribbleArea->setRubberBand(QLineF(mPoints.last(), endPoint), pen, properties.useAA);
+}
+
 
 void PolylineTool::cancelPolyline()
 {
     // Clear the in-progress polyline from the bitmap buffer.
     mScribbleArea->clearBitmapBuffer();
+    mScribbleArea->clearRubberBand();
     mScribbleArea->updateCurrentFrame();
 }
 
@@ -241,6 +287,7 @@ void PolylineTool::endPolyline(QList<QPointF> points)
 {
     Layer* layer = mEditor->layers()->currentLayer();
     mScribbleArea->clearBitmapBuffer();
+    mScribbleArea->clearRubberBand();
 
     if (layer->type() == Layer::VECTOR)
     {
@@ -19,6 +19,7 @@ GNU General Public License for more details.
 #define POLYLINETOOL_H
 
 #include <QPointF>
+#include <QTransform>
 
 #include "basetool.h"
 
@@ -49,8 +50,10 @@ public:
 
 private:
     QList<QPointF> mPoints;
+    QTransform mPreviewView; ///< the view the buffer preview was drawn with
 
     void drawPolyline(QList<QPointF> points, QPointF endPoint);
+    void drawRubberBand(QPointF endPoint);
     void cancelPolyline();
     void endPolyline(QList<QPointF> points);
 };
@@ -277,14 +277,7 @@ void SmudgeTool::drawStroke()
 
     BitmapImage *sourceImage = static_cast<LayerBitmap*>(layer)->getLastBitmapImageAtFrame(mEditor->currentFrame(), 0);
     if (sourceImage == nullptr) { return; } // Can happen if the first frame is deleted while drawing
-    BitmapImage targetImage = sourceImage->copy();
     StrokeTool::drawStroke();
-    QList<QPointF> p = strokeManager()->interpolateStroke();
-
-    for (int i = 0; i < p.size(); i++)
-    {
-        p[i] = mEditor->view()->mapScreenToCanvas(p[i]);
-    }
 
     qreal opacity = 1.0;
     mCurrentWidth = properties.width;
@@ -293,69 +286,42 @@ void SmudgeTool::drawStroke()
     //opacity = currentPressure; // todo: Probably not interesting?!
     //brushWidth = brushWidth * opacity;
 
-    BlitRect rect;
     QPointF a = mLastBrushPoint;
     QPointF b = getCurrentPoint();
 
+    // liquify hard takes steps twice as long
+    qreal brushStep = 2.0;
+    qreal distance = QLineF(b, a).length();
+    if (toolMode == 1)
+    {
+        distance /= 2.0;
+    }
+    int steps = qRound(distance / brushStep);
+    int rad = qRound(brushWidth / 2.0) + 2;
+    if (steps == 0) { return; }
 
-    if (toolMode == 1) // liquify hard
+    BlitRect rect;
+    QList<QPointF> targetPoints;
+    for (int i = 0; i < steps; i++)
     {
-        qreal brushStep = 2;
-        qreal distance = QLineF(b, a).length() / 2.0;
-        int steps = qRound(distance / brushStep);
-        int rad = qRound(brushWidth / 2.0) + 2;
+        QPointF targetPoint = mLastBrushPoint + (i + 1) * (brushStep) * (b - mLastBrushPoint) / distance;
+        rect.extend(targetPoint.toPoint());
+        targetPoints.append(targetPoint);
+    }
 
-        QPointF sourcePoint = mLastBrushPoint;
-        for (int i = 0; i < steps; i++)
-        {
-            targetImage.paste(mScribbleArea->mBufferImg);
-            QPointF targetPoint = mLastBrushPoint + (i + 1) * (brushStep) * (b - mLastBrushPoint) / distance;
-            rect.extend(targetPoint.toPoint());
-            mScribbleArea->liquifyBrush(&targetImage,
-                                        sourcePoint,
-                                        targetPoint,
-                                        brushWidth,
-                                        offset,
-                                        opacity);
-
-            if (i == (steps - 1))
-            {
-                mLastBrushPoint = targetPoint;
-            }
-            sourcePoint = targetPoint;
-            mScribbleArea->paintBitmapBufferRect(rect);
-            mScribbleArea->refreshBitmap(rect, rad);
-        }
+    // each dab reads what the frame looks like with the previous dabs on it
+    if (toolMode == 1) // liquify hard
+    {
+        mScribbleArea->liquifyBrush(sourceImage, mLastBrushPoint, targetPoints, brushWidth, offset, opacity);
     }
     else // liquify smooth
     {
-        qreal brushStep = 2.0;
-        qreal distance = QLineF(b, a).length();
-        int steps = qRound(distance / brushStep);
-        int rad = qRound(brushWidth / 2.0) + 2;
-
-        QPointF sourcePoint = mLastBrushPoint;
-        for (int i = 0; i < steps; i++)
-        {
-            targetImage.paste(mScribbleArea->mBufferImg);
-            QPointF targetPoint = mLastBrushPoint + (i + 1) * (brushStep) * (b - mLastBrushPoint) / distance;
-            rect.extend(targetPoint.toPoint());
-            mScribbleArea->blurBrush(&targetImage,
-                                     sourcePoint,
-                                     targetPoint,
-                                     brushWidth,
-                                     offset,
-                                     opacity);
-
-            if (i == (steps - 1))
-            {
-                mLastBrushPoint = targetPoint;
-            }
-            sourcePoint = targetPoint;
-            mScribbleArea->paintBitmapBufferRect(rect);
-            mScribbleArea->refreshBitmap(rect, rad);
-        }
+        mScribbleArea->blurBrush(sourceImage, mLastBrushPoint, targetPoints, brushWidth, offset, opacity);
     }
+
+    mLastBrushPoint = targetPoints.last();
+    mScribbleArea->paintBitmapBufferRect(rect, rad);
+    mScribbleArea->refreshBitmap(rect, rad);
 }
 
 QPointF SmudgeTool::offsetFromPressPos()
@@ -0,0 +1,79 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "strokeinputbuffer.h"
+
+
+StrokeInputBuffer::StrokeInputBuffer(int capacity)
+{
+    // a power of two, with one slot kept free to tell a full buffer from an empty one
+    int size = 2;
+    while (size < capacity + 1)
+    {
+        size *= 2;
+    }
+    mSlots.resize(size);
+    mIndexMask = size - 1;
+}
+
+/**
+ * @brief StrokeInputBuffer::push
+ * Called by the producer only.
+ * @return false if the buffer is full, the sample is then dropped and counted in droppedCount()
+ */
+bool StrokeInputBuffer::push(const StrokeSample& sample)
+{
+    const int head = mHead.loadAcquire();
+    const int next = (head + 1) & mIndexMask;
+    if (next == mTail.loadAcquire())
+    {
+        mDropped.fetchAndAddRelaxed(1);
+        return false;
+    }
+
+    mSlots[head] = sample;
+    mHead.storeRelease(next);
+    return true;
+}
+
+/**
+ * @brief StrokeInputBuffer::read
+ * Called by the consumer only. Appends every sample pushed since the last read, oldest first.
+ * @return the number of samples appended
+ */
+int StrokeInputBuffer::read(QVector<StrokeSample>& samples)
+{
+    int tail = mTail.loadAcquire();
+    const int head = mHead.loadAcquire();
+
+    int count = 0;
+    while (tail != head)
+    {
+        samples.append(mSlots.at(tail));
+        tail = (tail + 1) & mIndexMask;
+        count++;
+    }
+    mTail.storeRelease(tail);
+    return count;
+}
+
+/**
+ * @brief StrokeInputBuffer::discard
+ * Called by the consumer only. Drops the samples not read yet.
+ */
+void StrokeInputBuffer::discard()
+{
+    mTail.storeRelease(mHead.loadAcquire());
+}
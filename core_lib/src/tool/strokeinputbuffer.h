@@ -0,0 +1,64 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#ifndef STROKEINPUTBUFFER_H
+#define STROKEINPUTBUFFER_H
+
+#include <QAtomicInt>
+#include <QPointF>
+#include <QVector>
+
+
+/// One pointer sample of a stroke, as the device reported it
+struct StrokeSample
+{
+    QPointF pos;            ///< widget coordinates
+    qreal pressure = 1.0;   ///< 0 to 1, always 1 for the mouse
+    qreal xTilt = 0.0;      ///< degrees
+    qreal yTilt = 0.0;      ///< degrees
+    qreal rotation = 0.0;   ///< degrees
+    quint64 timestamp = 0;  ///< milliseconds
+    qint64 received = 0;    ///< nanoseconds, when the event arrived, see StrokeLatencyMonitor::now()
+};
+
+/**
+ * A fixed size, lock-free ring buffer of stroke samples.
+ *
+ * Every pointer event of a stroke is pushed as it arrives, however fast the device reports them,
+ * and the tools read everything that arrived since their last read in one batch when they paint.
+ * There must be a single producer and a single consumer, which may live on different threads.
+ */
+class StrokeInputBuffer
+{
+public:
+    explicit StrokeInputBuffer(int capacity = 1024);
+
+    bool push(const StrokeSample& sample);
+    int read(QVector<StrokeSample>& samples);
+    void discard();
+
+    int capacity() const { return mSlots.size() - 1; }
+    int droppedCount() const { return mDropped.loadAcquire(); }
+
+private:
+    QVector<StrokeSample> mSlots;
+    int mIndexMask = 0;
+
+    QAtomicInt mHead;  ///< the next slot to write, only the producer moves it
+    QAtomicInt mTail;  ///< the next slot to read, only the consumer moves it
+    QAtomicInt mDropped;
+};
+
+#endif // STROKEINPUTBUFFER_H
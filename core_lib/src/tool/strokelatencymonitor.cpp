@@ -0,0 +1,118 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "strokelatencymonitor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <QElapsedTimer>
+
+
+qint64 StrokeLatencyMonitor::now()
+{
+    static QElapsedTimer clock;
+    if (!clock.isValid())
+    {
+        clock.start();
+    }
+    return clock.nsecsElapsed();
+}
+
+void StrokeLatencyMonitor::reset()
+{
+    mPending.clear();
+    mRecent.clear();
+    mNextRecent = 0;
+    mCount = 0;
+    mSumNs = 0;
+    mMaxNs = 0;
+}
+
+/**
+ * @brief StrokeLatencyMonitor::sampleRead
+ * @param receivedNs: when the pointer event of the sample arrived, see now()
+ */
+void StrokeLatencyMonitor::sampleRead(qint64 receivedNs)
+{
+    if (receivedNs > 0)
+    {
+        mPending.append(receivedNs);
+    }
+}
+
+/**
+ * @brief StrokeLatencyMonitor::presented
+ * Records the latency of every sample read since the last call.
+ * @param presentedNs: when the canvas finished painting, see now()
+ */
+void StrokeLatencyMonitor::presented(qint64 presentedNs)
+{
+    for (qint64 received : mPending)
+    {
+        const qint64 latency = qMax(qint64(0), presentedNs - received);
+        mCount++;
+        mSumNs += latency;
+        mMaxNs = qMax(mMaxNs, latency);
+
+        if (mRecent.size() < RECENT_COUNT)
+        {
+            mRecent.append(latency);
+        }
+        else
+        {
+            mRecent[mNextRecent] = latency;
+            mNextRecent = (mNextRecent + 1) % RECENT_COUNT;
+        }
+    }
+    mPending.clear();
+}
+
+double StrokeLatencyMonitor::meanMs() const
+{
+    if (mCount == 0)
+        return 0.0;
+
+    return double(mSumNs) / mCount / 1e6;
+}
+
+double StrokeLatencyMonitor::maxMs() const
+{
+    return mMaxNs / 1e6;
+}
+
+/**
+ * @brief StrokeLatencyMonitor::percentileMs
+ * @param percentile: 0 to 100
+ * @return the smallest latency that percentile of the last RECENT_COUNT samples did not exceed
+ */
+double StrokeLatencyMonitor::percentileMs(double percentile) const
+{
+    if (mRecent.isEmpty())
+        return 0.0;
+
+    QVector<qint64> sorted = mRecent;
+    const int rank = qBound(1, int(std::ceil(percentile / 100.0 * sorted.size())), sorted.size());
+    std::nth_element(sorted.begin(), sorted.begin() + (rank - 1), sorted.end());
+    return sorted[rank - 1] / 1e6;
+}
+
+QString StrokeLatencyMonitor::summary() const
+{
+    return QString("%1 samples, input to paint latency: mean %2 ms, p95 %3 ms, max %4 ms")
+        .arg(count())
+        .arg(meanMs(), 0, 'f', 2)
+        .arg(percentileMs(95.0), 0, 'f', 2)
+        .arg(maxMs(), 0, 'f', 2);
+}
@@ -0,0 +1,57 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#ifndef STROKELATENCYMONITOR_H
+#define STROKELATENCYMONITOR_H
+
+#include <QString>
+#include <QVector>
+
+
+/**
+ * Measures how long the samples of a stroke take to reach the screen.
+ *
+ * Every sample is stamped with now() when its pointer event arrives. Once a tool has read it,
+ * the sample waits for the next paint of the canvas, where the time between the two is recorded.
+ * The mean and the maximum cover every sample since reset(), the percentiles the last RECENT_COUNT.
+ */
+class StrokeLatencyMonitor
+{
+public:
+    static const int RECENT_COUNT = 1024;
+
+    /// Nanoseconds on a monotonic clock shared by the whole application
+    static qint64 now();
+
+    void reset();
+    void sampleRead(qint64 receivedNs);
+    void presented(qint64 presentedNs = now());
+
+    int count() const { return mCount; }
+    double meanMs() const;
+    double maxMs() const;
+    double percentileMs(double percentile) const;
+    QString summary() const;
+
+private:
+    QVector<qint64> mPending;    ///< when the samples read since the last paint arrived
+    QVector<qint64> mRecent;     ///< nanoseconds, a ring of the latest presented samples
+    int mNextRecent = 0;
+    int mCount = 0;
+    qint64 mSumNs = 0;
+    qint64 mMaxNs = 0;
+};
+
+#endif // STROKELATENCYMONITOR_H
@@ -37,17 +37,16 @@ StrokeManager::StrokeManager()
     mTabletPressure = 0;
 
     reset();
-    connect(&timer, &QTimer::timeout, this, &StrokeManager::interpolatePollAndPaint);
 }
 
 void StrokeManager::reset()
 {
     mStrokeStarted = false;
-    pressureQueue.clear();
-    strokeQueue.clear();
+    mInput.discard();
+    mRecent.clear();
+    mLatency.reset();
     pressure = 0.0f;
     mHasTangent = false;
-    timer.stop();
     mStabilizerLevel = -1;
 }
 
@@ -67,6 +66,8 @@ void StrokeManager::pointerPressEvent(PointerEvent* event)
     }
 
     mLastPixel = mCurrentPixel = event->posF();
+    mLastInterpolated = mCurrentPixel;
+    mStabilizer.reset(mStabilizerLevel, mCurrentPixel);
 
     mStrokeStarted = true;
     setPressure(event->pressure());
@@ -74,22 +75,37 @@ void StrokeManager::pointerPressEvent(PointerEvent* event)
 
 void StrokeManager::pointerMoveEvent(PointerEvent* event)
 {
-    // only applied to drawing tools.
-    if (mStabilizerLevel != -1)
+    mousePos = event->posF();
+
+    if (mStrokeStarted)
     {
-        smoothMousePos(event->posF());
+        StrokeSample sample;
+        sample.pos = event->posF();
+        sample.pressure = event->pressure();
+        sample.xTilt = event->xTilt();
+        sample.yTilt = event->yTilt();
+        sample.rotation = event->rotation();
+        sample.timestamp = event->timestamp();
+        sample.received = StrokeLatencyMonitor::now();
+        mInput.push(sample);
     }
-    else
+
+    // only drawing tools stabilize the stroke, and only once they read it, see readSamples()
+    if (mStabilizerLevel == -1 || !mStrokeStarted)
     {
-        // No smoothing
         mLastPixel = mCurrentPixel;
         mCurrentPixel = event->posF();
         mLastInterpolated = mCurrentPixel;
     }
-    if(event->isTabletEvent())
+
+    if (event->isTabletEvent())
     {
         setPressure(event->pressure());
     }
+    else if (mStrokeStarted && !mTabletInUse)
+    {
+        setPressure(1.0);
+    }
 }
 
 void StrokeManager::pointerReleaseEvent(PointerEvent* event)
@@ -105,127 +121,133 @@ void StrokeManager::pointerReleaseEvent(PointerEvent* event)
 
 void StrokeManager::setStabilizerLevel(int level)
 {
+    if (level == mStabilizerLevel)
+        return;
+
     mStabilizerLevel = level;
+    mStabilizer.reset(level, mCurrentPixel);
 }
 
-void StrokeManager::smoothMousePos(QPointF pos)
+/**
+ * @brief StrokeManager::readSamples
+ * Reads every sample of the stroke that arrived since the last call, in one batch.
+ * The samples are stabilized, and the current pixel moves to the last of them.
+ * Once the stroke is released, the batch also brings the stabilized stroke to where the pen was lifted.
+ * @param samples: cleared, then filled with the samples in the order they arrived
+ */
+void StrokeManager::readSamples(QVector<StrokeSample>& samples)
 {
-    // Smooth mouse position before drawing
-    QPointF smoothPos;
+    samples.clear();
+    mRawSamples.clear();
+    mInput.read(mRawSamples);
 
-    if (mStabilizerLevel == StabilizationLevel::NONE)
+    for (const StrokeSample& sample : mRawSamples)
     {
-        mLastPixel = mCurrentPixel;
-        mCurrentPixel = pos;
-        mLastInterpolated = mCurrentPixel;
+        mLatency.sampleRead(sample.received);
     }
-    else if (mStabilizerLevel == StabilizationLevel::SIMPLE)
-    {
-        // simple interpolation
-        smoothPos = QPointF((pos.x() + mCurrentPixel.x()) / 2.0, (pos.y() + mCurrentPixel.y()) / 2.0);
-        mLastPixel = mCurrentPixel;
-        mCurrentPixel = smoothPos;
-        mLastInterpolated = mCurrentPixel;
 
-        // shift queue
-        while (strokeQueue.size() >= STROKE_QUEUE_LENGTH)
+    if (mStabilizerLevel == -1)
+    {
+        // the current pixel already follows the pointer, see pointerMoveEvent()
+        samples.swap(mRawSamples);
+    }
+    else
+    {
+        for (const StrokeSample& sample : mRawSamples)
+        {
+            samples.append(mStabilizer.filter(sample));
+        }
+        if (!mStrokeStarted)
         {
-            strokeQueue.pop_front();
+            samples += mStabilizer.flush();
         }
 
-        strokeQueue.push_back(smoothPos);
+        if (!samples.isEmpty())
+        {
+            mLastPixel = mCurrentPixel;
+            mCurrentPixel = samples.last().pos;
+            mLastInterpolated = mCurrentPixel;
+        }
     }
-    else if (mStabilizerLevel == StabilizationLevel::STRONG)
-    {
-        smoothPos = QPointF((pos.x() + mLastInterpolated.x()) / 2.0, (pos.y() + mLastInterpolated.y()) / 2.0);
 
-        mLastInterpolated = mCurrentPixel;
-        mCurrentPixel = smoothPos;
-        mLastPixel = mLastInterpolated;
+    const int PREDICTION_WINDOW = 4;
+    for (const StrokeSample& sample : samples)
+    {
+        if (mRecent.size() == PREDICTION_WINDOW)
+        {
+            mRecent.removeFirst();
+        }
+        mRecent.append(sample);
     }
+}
 
-    mousePos = pos;
+/**
+ * @brief StrokeManager::predictSamples
+ * Where the stroke is heading, from the samples read last. Nothing once the pen is lifted or stops moving.
+ * @param horizonMs: how far ahead to predict
+ */
+QVector<StrokeSample> StrokeManager::predictSamples(qreal horizonMs) const
+{
+    // the pen has not moved for a while, it is no longer heading anywhere
+    const qint64 STALE_NS = 50 * 1000000;
+    if (!mStrokeStarted || mRecent.isEmpty() || StrokeLatencyMonitor::now() - mRecent.last().received > STALE_NS)
+        return QVector<StrokeSample>();
 
-    if (!mStrokeStarted)
-    {
-        return;
-    }
+    return extrapolate(mRecent, horizonMs);
+}
 
-    if (!mTabletInUse)   // a mouse is used instead of a tablet
+/**
+ * @brief StrokeManager::extrapolate
+ * Continues the stroke in a straight line, at the velocity and pressure change
+ * between the first and the last of the recent samples.
+ * @param recent: the last few samples, oldest first, with their device timestamps
+ * @param horizonMs: how far ahead to extrapolate, a sample is added every few milliseconds
+ * @return the predicted samples, not including the last recent sample
+ */
+QVector<StrokeSample> StrokeManager::extrapolate(const QVector<StrokeSample>& recent, qreal horizonMs)
+{
+    QVector<StrokeSample> predicted;
+    if (recent.size() < 2 || horizonMs <= 0)
+        return predicted;
+
+    const StrokeSample& first = recent.first();
+    const StrokeSample& last = recent.last();
+    if (last.timestamp <= first.timestamp)
+        return predicted;
+
+    const qreal elapsedMs = last.timestamp - first.timestamp;
+    const QPointF velocity = (last.pos - first.pos) / elapsedMs;
+    const qreal pressureRate = (last.pressure - first.pressure) / elapsedMs;
+
+    const qreal STEP_MS = 4.0;
+    const int steps = qMax(1, qRound(horizonMs / STEP_MS));
+    for (int i = 1; i <= steps; i++)
     {
-        setPressure(1.0);
+        const qreal t = horizonMs * i / steps;
+        StrokeSample sample = last;
+        sample.pos = last.pos + velocity * t;
+        sample.pressure = qBound(0.0, last.pressure + pressureRate * t, 1.0);
+        sample.timestamp = last.timestamp + quint64(qRound(t));
+        sample.received = 0;
+        predicted.append(sample);
     }
+    return predicted;
 }
 
-
 QPointF StrokeManager::interpolateStart(QPointF firstPoint)
 {
     if (mStabilizerLevel == StabilizationLevel::SIMPLE)
-    {
-        // Clear queue
-        strokeQueue.clear();
-        pressureQueue.clear();
-
-        mSingleshotTime.start();
-        previousTime = mSingleshotTime.elapsed();
-
-        mLastPixel = firstPoint;
-    }
-    else if (mStabilizerLevel == StabilizationLevel::STRONG)
     {
         mSingleshotTime.start();
         previousTime = mSingleshotTime.elapsed();
-
-        // Clear queue
-        strokeQueue.clear();
-        pressureQueue.clear();
-    
-        const int sampleSize = 5;
-        Q_ASSERT(sampleSize > 0);
-
-        // fill strokeQueue with firstPoint x times
-        for (int i = sampleSize; i > 0; i--)
-        {
-            strokeQueue.enqueue(firstPoint);
-        }
-
-        // last interpolated stroke should always be firstPoint
-        mLastInterpolated = firstPoint;
-
-        // draw and poll each millisecond
-        timer.setInterval(sampleSize);
-        timer.start();
     }
-    else if (mStabilizerLevel == StabilizationLevel::NONE)
-    {
-        // Clear queue
-        strokeQueue.clear();
-        pressureQueue.clear();
 
-        mLastPixel = firstPoint;
-    }
+    mStabilizer.reset(mStabilizerLevel, firstPoint);
+    mLastPixel = firstPoint;
+    mLastInterpolated = firstPoint;
     return firstPoint;
 }
 
-void StrokeManager::interpolatePoll()
-{
-    // remove oldest stroke
-    strokeQueue.dequeue();
-
-    // add new stroke with the last interpolated pixel position
-    strokeQueue.enqueue(mLastInterpolated);
-}
-
-void StrokeManager::interpolatePollAndPaint()
-{
-    //qDebug() <<"inpol:" << mStabilizerLevel << "strokes"<< strokeQueue;
-    if (!strokeQueue.isEmpty())
-    {
-        interpolatePoll();
-        interpolateStroke();
-    }
-}
-
 QList<QPointF> StrokeManager::interpolateStroke()
 {
     // is nan initially
@@ -234,18 +256,10 @@ QList<QPointF> StrokeManager::interpolateStroke()
     if (mStabilizerLevel == StabilizationLevel::SIMPLE)
     {
         result = tangentInpolOp(result);
-
     }
-    else if (mStabilizerLevel == StabilizationLevel::STRONG)
-    {
-        qreal x = 0;
-        qreal y = 0;
-        qreal pressure = 0;
-        result = meanInpolOp(result, x, y, pressure);
-
-    }
-    else if (mStabilizerLevel == StabilizationLevel::NONE)
+    else if (mStabilizerLevel == StabilizationLevel::STRONG || mStabilizerLevel == StabilizationLevel::NONE)
     {
+        // the samples are already averaged by the stabilizer
         result = noInpolOp(result);
     }
     return result;
@@ -318,52 +332,8 @@ QList<QPointF> StrokeManager::tangentInpolOp(QList<QPointF> points)
     return points;
 }
 
-// Mean sampling interpolation operation
-QList<QPointF> StrokeManager::meanInpolOp(QList<QPointF> points, qreal x, qreal y, qreal pressure)
-{
-    for (int i = 0; i < strokeQueue.size(); i++)
-    {
-        x += strokeQueue[i].x();
-        y += strokeQueue[i].y();
-        pressure += getPressure();
-    }
-
-    // get arithmetic mean of x, y and pressure
-    x /= strokeQueue.size();
-    y /= strokeQueue.size();
-    pressure /= strokeQueue.size();
-
-    // Use our interpolated points
-    QPointF mNewInterpolated = mLastInterpolated;
-    mNewInterpolated = QPointF(x, y);
-
-    points << mLastPixel << mLastInterpolated << mNewInterpolated << mCurrentPixel;
-
-    // Set lastPixel non interpolated pixel to our
-    // new interpolated pixel
-    mLastPixel = mNewInterpolated;
-
-    return points;
-}
-
 void StrokeManager::interpolateEnd()
 {
-    // Stop timer
-    timer.stop();
-    if (mStabilizerLevel == StabilizationLevel::STRONG)
-    {
-        if (!strokeQueue.isEmpty())
-        {
-            // How many samples should we get point from?
-            // TODO: Qt slider.
-            int sampleSize = 5;
-
-            Q_ASSERT(sampleSize > 0);
-            for (int i = sampleSize; i > 0; i--)
-            {
-                interpolatePoll();
-                interpolateStroke();
-            }
-        }
-    }
+    // whatever was not read is after the end of the stroke
+    mInput.discard();
 }
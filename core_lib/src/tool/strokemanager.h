@@ -19,12 +19,14 @@ GNU General Public License for more details.
 #define STROKEMANAGER_H
 
 #include <ctime>
-#include <QQueue>
 #include <QPointF>
 #include <QList>
-#include <QTimer>
+#include <QVector>
 #include <QElapsedTimer>
 #include "object.h"
+#include "strokeinputbuffer.h"
+#include "strokestabilizer.h"
+#include "strokelatencymonitor.h"
 
 
 class PointerEvent;
@@ -46,13 +48,16 @@ public:
     void setTabletInUse(bool inUse) { mTabletInUse = inUse; }
     bool isActive() { return mStrokeStarted; }
 
+    void readSamples(QVector<StrokeSample>& samples);
+    int droppedSampleCount() const { return mInput.droppedCount(); }
+
+    QVector<StrokeSample> predictSamples(qreal horizonMs) const;
+    static QVector<StrokeSample> extrapolate(const QVector<StrokeSample>& recent, qreal horizonMs);
+    StrokeLatencyMonitor& latencyMonitor() { return mLatency; }
+
     QList<QPointF> interpolateStroke();
-    void interpolatePoll();
     QPointF interpolateStart(QPointF firstPoint);
-    void interpolatePollAndPaint();
     void interpolateEnd();
-    void smoothMousePos(QPointF pos);
-    QList<QPointF> meanInpolOp(QList<QPointF> points, qreal x, qreal y, qreal pressure);
     QList<QPointF> noInpolOp(QList<QPointF> points);
     QList<QPointF> tangentInpolOp(QList<QPointF> points);
 
@@ -64,15 +69,15 @@ public:
     QPointF getCurrentPressPixel() const { return mCurrentPressPixel; }
 
 private:
-    static const int STROKE_QUEUE_LENGTH = 3; // 4 points for cubic bezier
-
     void reset();
 
     float pressure = 1.0f; // last pressure
-    QQueue<QPointF> strokeQueue;
-    QQueue<qreal> pressureQueue;
 
-    QTimer timer;
+    StrokeInputBuffer mInput;
+    StrokeStabilizer mStabilizer;
+    QVector<StrokeSample> mRawSamples;
+    QVector<StrokeSample> mRecent;  ///< the last samples read, the prediction follows them
+    StrokeLatencyMonitor mLatency;
 
     QElapsedTimer mSingleshotTime;
     QPointF mCurrentPressPixel = { 0, 0 };
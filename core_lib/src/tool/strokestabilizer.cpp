@@ -0,0 +1,91 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "strokestabilizer.h"
+
+#include <QLineF>
+#include "pencildef.h"
+
+
+namespace
+{
+    // flush() stops once the output is this close to the pen, or after that many samples
+    const qreal flushDistance = 0.5;
+    const int maxFlushSamples = 32;
+}
+
+void StrokeStabilizer::reset(int level, QPointF start)
+{
+    mLevel = level;
+    mOutput = start;
+    mHalfway = start;
+    for (QPointF& point : mWindow)
+    {
+        point = start;
+    }
+    mWindowNext = 0;
+    mHasInput = false;
+}
+
+StrokeSample StrokeStabilizer::filter(const StrokeSample& sample)
+{
+    mLastInput = sample;
+    mHasInput = true;
+
+    StrokeSample result = sample;
+    if (mLevel == StabilizationLevel::SIMPLE)
+    {
+        mOutput = (sample.pos + mOutput) / 2.0;
+        result.pos = mOutput;
+    }
+    else if (mLevel == StabilizationLevel::STRONG)
+    {
+        mHalfway = (sample.pos + mHalfway) / 2.0;
+        mWindow[mWindowNext] = mHalfway;
+        mWindowNext = (mWindowNext + 1) % STRONG_WINDOW;
+
+        QPointF sum(0, 0);
+        for (const QPointF& point : mWindow)
+        {
+            sum += point;
+        }
+        mOutput = sum / STRONG_WINDOW;
+        result.pos = mOutput;
+    }
+    else
+    {
+        mOutput = sample.pos;
+    }
+    return result;
+}
+
+/**
+ * @brief StrokeStabilizer::flush
+ * The stabilized stroke lags behind the pen, this brings it to where the pen was lifted.
+ * @return the extra samples, empty if there is no lag
+ */
+QVector<StrokeSample> StrokeStabilizer::flush()
+{
+    QVector<StrokeSample> samples;
+    if (!mHasInput || mLevel < StabilizationLevel::SIMPLE)
+        return samples;
+
+    const StrokeSample last = mLastInput;
+    while (samples.size() < maxFlushSamples && QLineF(mOutput, last.pos).length() > flushDistance)
+    {
+        samples.append(filter(last));
+    }
+    return samples;
+}
@@ -0,0 +1,54 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#ifndef STROKESTABILIZER_H
+#define STROKESTABILIZER_H
+
+#include <QVector>
+#include "strokeinputbuffer.h"
+
+
+/**
+ * Smooths the positions of stroke samples one at a time, as they are read.
+ *
+ * SIMPLE moves halfway from the last output towards each sample.
+ * STRONG does the same and then averages the last few halfway points, which lags more but
+ * irons out the shakes. Nothing but the position is changed.
+ *
+ * See StabilizationLevel, levels below SIMPLE let the samples through.
+ */
+class StrokeStabilizer
+{
+public:
+    void reset(int level, QPointF start);
+    int level() const { return mLevel; }
+
+    StrokeSample filter(const StrokeSample& sample);
+    QVector<StrokeSample> flush();
+
+private:
+    static const int STRONG_WINDOW = 5;
+
+    int mLevel = -1;
+    QPointF mOutput;
+    QPointF mHalfway;
+    QPointF mWindow[STRONG_WINDOW];
+    int mWindowNext = 0;
+
+    StrokeSample mLastInput;
+    bool mHasInput = false;
+};
+
+#endif // STROKESTABILIZER_H
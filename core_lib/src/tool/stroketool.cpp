@@ -18,10 +18,20 @@ GNU General Public License for more details.
 #include "stroketool.h"
 
 #include <QKeyEvent>
+#include <QLineF>
+#include <QtConcurrent>
+#include "object.h"
+#include "layervector.h"
+#include "vectorimage.h"
+#include "beziercurvefitter.h"
 #include "scribblearea.h"
 #include "strokemanager.h"
 #include "viewmanager.h"
 #include "editor.h"
+#include "layermanager.h"
+#include "preferencemanager.h"
+#include "colormanager.h"
+#include "selectionmanager.h"
 
 #ifdef Q_OS_MAC
 extern "C" {
@@ -40,22 +50,24 @@ extern "C" {
 StrokeTool::StrokeTool(QObject* parent) : BaseTool(parent)
 {
     detectWhichOSX();
+
+    connect(&mStrokeFitWatcher, &QFutureWatcher<BezierCurve>::finished, this, &StrokeTool::onVectorStrokeFitted);
 }
 
 void StrokeTool::startStroke(PointerEvent::InputType inputType)
 {
+    // strokes must land in the order they were drawn
+    finishPendingStroke();
+
     if (emptyFrameActionEnabled())
     {
         mScribbleArea->handleDrawingOnEmptyFrame();
     }
 
-    mFirstDraw = true;
-    mLastPixel = getCurrentPixel();
-
+    mSamples.clear();
     mStrokePoints.clear();
 
-    //Experimental
-    QPointF startStrokes = strokeManager()->interpolateStart(mLastPixel);
+    QPointF startStrokes = strokeManager()->interpolateStart(getCurrentPixel());
     mStrokePoints << mEditor->view()->mapScreenToCanvas(startStrokes);
 
     mStrokePressures.clear();
@@ -85,6 +97,18 @@ bool StrokeTool::keyReleaseEvent(QKeyEvent *event)
     return true;
 }
 
+bool StrokeTool::leavingThisTool()
+{
+    finishPendingStroke();
+    return BaseTool::leavingThisTool();
+}
+
+bool StrokeTool::switchingLayer()
+{
+    finishPendingStroke();
+    return BaseTool::switchingLayer();
+}
+
 bool StrokeTool::emptyFrameActionEnabled()
 {
     return true;
@@ -93,6 +117,9 @@ bool StrokeTool::emptyFrameActionEnabled()
 void StrokeTool::endStroke()
 {
     strokeManager()->interpolateEnd();
+    mScribbleArea->clearStrokePrediction();
+    STROKELATENCY_LOG("%s", qPrintable(strokeManager()->latencyMonitor().summary()));
+
     mStrokePressures << strokeManager()->getPressure();
     mStrokePoints.clear();
     mStrokePressures.clear();
@@ -102,18 +129,140 @@ void StrokeTool::endStroke()
     mScribbleArea->setModified(mEditor->currentLayerIndex(), mEditor->currentFrame());
 }
 
+/**
+ * @brief StrokeTool::drawStroke
+ * Reads the samples that arrived since the last call into mSamples, and records them for the vector fit.
+ * The tools then paint the whole batch at once.
+ */
 void StrokeTool::drawStroke()
 {
-    QPointF pixel = getCurrentPixel();
-    if (pixel != mLastPixel || !mFirstDraw)
+    strokeManager()->readSamples(mSamples);
+    for (const StrokeSample& sample : mSamples)
+    {
+        const QPointF point = mEditor->view()->mapScreenToCanvas(sample.pos);
+        if (!mStrokePoints.isEmpty() && mStrokePoints.last() == point)
+            continue;
+
+        mStrokePoints << point;
+        mStrokePressures << sample.pressure;
+    }
+}
+
+/**
+ * @brief StrokeTool::drawStrokePrediction
+ * Predicts the stroke as far ahead as the samples currently take to reach the screen,
+ * so that the prediction ends about where the pen is.
+ * @param from: the last painted point, in canvas coordinates
+ * @param width: the brush width at full pressure, in canvas pixels
+ */
+void StrokeTool::drawStrokePrediction(QPointF from, qreal width, bool usePressure, QColor color)
+{
+    if (!mEditor->preference()->isOn(SETTING::STROKE_PREDICTION))
+        return;
+
+    const qreal horizonMs = qBound(8.0, strokeManager()->latencyMonitor().meanMs(), 32.0);
+    const QVector<StrokeSample> predicted = strokeManager()->predictSamples(horizonMs);
+    if (predicted.isEmpty())
+    {
+        mScribbleArea->clearStrokePrediction();
+        return;
+    }
+
+    QPolygonF path;
+    path << from;
+    for (const StrokeSample& sample : predicted)
+    {
+        path << mEditor->view()->mapScreenToCanvas(sample.pos);
+    }
+
+    const qreal pressure = usePressure ? predicted.last().pressure : 1.0;
+    mScribbleArea->setStrokePrediction(path, width * pressure, color);
+}
+
+QList<QPointF> StrokeTool::dabsAlong(QPointF from, QPointF to, qreal brushStep)
+{
+    QList<QPointF> dabs;
+    const qreal distance = 4 * QLineF(to, from).length();
+    const int steps = qRound(distance / brushStep);
+    for (int i = 0; i < steps; i++)
+    {
+        dabs.append(from + (i + 1) * brushStep * (to - from) / distance);
+    }
+    return dabs;
+}
+
+void StrokeTool::fitVectorStroke(qreal tolerance)
+{
+    finishPendingStroke();
+
+    mHasPendingStroke = true;
+    mPendingStrokeLayerId = mEditor->layers()->currentLayer()->id();
+    mPendingStrokeFrame = mEditor->currentFrame();
+    mPendingStrokePoints = mStrokePoints;
+
+    const QList<QPointF> points = mStrokePoints;
+    const QList<qreal> pressures = mStrokePressures;
+    mStrokeFitWatcher.setFuture(QtConcurrent::run([points, pressures, tolerance]()
     {
-        // get last pixel before interpolation initializes
-        QPointF startStrokes = strokeManager()->interpolateStart(getLastPixel());
-        mStrokePoints << mEditor->view()->mapScreenToCanvas(startStrokes);
-        mStrokePressures << strokeManager()->getPressure();
+        BezierCurveFitter fitter(tolerance);
+        return fitter.fit(points, pressures);
+    }));
+}
+
+void StrokeTool::finishPendingStroke()
+{
+    if (!mHasPendingStroke)
+        return;
+
+    mStrokeFitWatcher.waitForFinished();
+    onVectorStrokeFitted();
+}
+
+void StrokeTool::onVectorStrokeFitted()
+{
+    if (!mHasPendingStroke)
+        return; // already applied by finishPendingStroke()
+
+    mHasPendingStroke = false;
+
+    // Clear the provisional pixel path
+    mScribbleArea->clearBitmapBuffer();
+
+    BezierCurve curve = mStrokeFitWatcher.result();
+    Layer* layer = mEditor->object()->findLayerById(mPendingStrokeLayerId);
+    if (layer == nullptr) // The layer was deleted while the curve was fitted
+    {
+        mPendingStrokePoints.clear();
+        return;
     }
-    else
+
+    if (layer->type() == Layer::VECTOR)
     {
-        mFirstDraw = false;
+        VectorImage* vectorImage = static_cast<LayerVector*>(layer)->getLastVectorImageAtFrame(mPendingStrokeFrame, 0);
+        if (vectorImage != nullptr) // Can happen if the first frame is deleted while drawing
+        {
+            mEditor->backup(typeName());
+            addFittedVectorStroke(curve, vectorImage, mPendingStrokePoints);
+        }
     }
+    mPendingStrokePoints.clear();
+
+    mScribbleArea->setModified(mEditor->object()->getLayerIndex(layer), mPendingStrokeFrame);
+}
+
+void StrokeTool::addFittedVectorStroke(BezierCurve& curve, VectorImage* vectorImage, const QList<QPointF>& strokePoints)
+{
+    Q_UNUSED(strokePoints);
+
+    curve.setFilled(false);
+    curve.setColorNumber(mEditor->color()->frontColorNumber());
+    vectorImage->addCurve(curve, qAbs(mEditor->view()->scaling()), properties.vectorMergeEnabled);
+
+    if (vectorImage->isAnyCurveSelected() || mEditor->select()->somethingSelected())
+    {
+        mEditor->deselectAll();
+    }
+
+    // select last/newest curve
+    vectorImage->setSelected(vectorImage->getLastCurveNumber(), true);
 }
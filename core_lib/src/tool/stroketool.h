@@ -20,9 +20,16 @@ GNU General Public License for more details.
 
 #include "basetool.h"
 #include "pointerevent.h"
+#include "beziercurve.h"
+#include "strokeinputbuffer.h"
 
+#include <QColor>
 #include <QList>
 #include <QPointF>
+#include <QVector>
+#include <QFutureWatcher>
+
+class VectorImage;
 
 
 class StrokeTool : public BaseTool
@@ -39,8 +46,28 @@ public:
     bool keyPressEvent(QKeyEvent* event) override;
     bool keyReleaseEvent(QKeyEvent* event) override;
 
+    bool leavingThisTool() override;
+    bool switchingLayer() override;
+    void finishPendingStroke() override;
+
 protected:
-    bool mFirstDraw = false;
+    /// Fits the recorded stroke to cubic curves on a worker thread.
+    /// The stroke stays in the bitmap buffer as a provisional path until the fit is done.
+    void fitVectorStroke(qreal tolerance);
+
+    /// Called on the GUI thread with the fitted curve of the stroke passed to fitVectorStroke(),
+    /// once the frame has been backed up. The tools style the curve, then call this to add it to the frame and select it.
+    virtual void addFittedVectorStroke(BezierCurve& curve, VectorImage* vectorImage, const QList<QPointF>& strokePoints);
+
+    /// Shows where the stroke is heading past the last painted point, when the stroke prediction preference is on.
+    /// The prediction is replaced on the next call and removed when the stroke ends.
+    void drawStrokePrediction(QPointF from, qreal width, bool usePressure, QColor color);
+
+    /// Dab centers from one point to the next, a quarter of brushStep apart, excluding the first point
+    static QList<QPointF> dabsAlong(QPointF from, QPointF to, qreal brushStep);
+
+    /// The samples read by the last drawStroke(), stabilized, in widget coordinates
+    QVector<StrokeSample> mSamples;
 
     QList<QPointF> mStrokePoints;
     QList<qreal> mStrokePressures;
@@ -58,7 +85,13 @@ protected:
     virtual bool emptyFrameActionEnabled();
 
 private:
-	QPointF mLastPixel { 0, 0 };
+    void onVectorStrokeFitted();
+
+    QFutureWatcher<BezierCurve> mStrokeFitWatcher;
+    bool mHasPendingStroke = false;
+    int mPendingStrokeLayerId = 0;
+    int mPendingStrokeFrame = 0;
+    QList<QPointF> mPendingStrokePoints;
 };
 
 #endif // STROKETOOL_H
@@ -3,6 +3,7 @@
 
 Q_LOGGING_CATEGORY(logCanvasPainter, "core.canvasPainter");
 Q_LOGGING_CATEGORY(logFileManager, "core.FileManager");
+Q_LOGGING_CATEGORY(logStrokeLatency, "core.strokeLatency");
 
 void initCategoryLogging()
 {
@@ -10,7 +11,8 @@ void initCategoryLogging()
         "*.debug=false\n"
         "default.debug=true\n"
         "core.canvasPainter.debug=false\n"
-        "core.fileManager.debug=false";
+        "core.fileManager.debug=false\n"
+        "core.strokeLatency.debug=false";
 
     QLoggingCategory::setFilterRules(logRules);
 }
\ No newline at end of file
@@ -26,6 +26,7 @@ GNU General Public License for more details.
 
 //#define DEBUG_LOG_CANVASPAINTER
 //#define DEBUG_LOG_FILEMANAGER
+//#define DEBUG_LOG_STROKELATENCY
 
 #ifdef DEBUG_LOG_CANVASPAINTER
   Q_DECLARE_LOGGING_CATEGORY(logCanvasPainter);
@@ -41,4 +42,11 @@ GNU General Public License for more details.
   #define FILEMANAGER_LOG(...) ((void)0)
 #endif
 
+#ifdef DEBUG_LOG_STROKELATENCY
+  Q_DECLARE_LOGGING_CATEGORY(logStrokeLatency);
+  #define STROKELATENCY_LOG(...) qCDebug(logStrokeLatency, __VA_ARGS__)
+#else
+  #define STROKELATENCY_LOG(...) ((void)0)
+#endif
+
 void initCategoryLogging();
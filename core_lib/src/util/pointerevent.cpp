@@ -101,6 +101,38 @@ qreal PointerEvent::tangentialPressure() const
     return 0.0;
 }
 
+qreal PointerEvent::xTilt() const
+{
+    if (mTabletEvent)
+    {
+        return mTabletEvent->xTilt();
+    }
+    return 0.0;
+}
+
+qreal PointerEvent::yTilt() const
+{
+    if (mTabletEvent)
+    {
+        return mTabletEvent->yTilt();
+    }
+    return 0.0;
+}
+
+ulong PointerEvent::timestamp() const
+{
+    if (mMouseEvent)
+    {
+        return mMouseEvent->timestamp();
+    }
+    else if (mTabletEvent)
+    {
+        return mTabletEvent->timestamp();
+    }
+    Q_ASSERT(false);
+    return 0;
+}
+
 int PointerEvent::x() const
 {
     if (mMouseEvent)
@@ -47,6 +47,15 @@ public:
      */
     qreal tangentialPressure() const;
 
+    /**
+     * Returns the tilt of the pen along the x and y axis, in degrees between -60 and 60,
+     * or 0 if the device does not report it */
+    qreal xTilt() const;
+    qreal yTilt() const;
+
+    /** Returns the time the event was generated at, in milliseconds */
+    ulong timestamp() const;
+
     /** Returns the x position of the input device in the widget */
     int x() const;
 
@@ -0,0 +1,332 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "catch.hpp"
+
+#include <memory>
+#include <QPainter>
+#include <QTemporaryDir>
+#include "activeframepool.h"
+#include "bitmapimage.h"
+
+
+static const quint64 MB = 1024 * 1024;
+
+// 4MB once loaded
+static QImage frameImage(int seed)
+{
+    QImage image(1024, 1024, QImage::Format_ARGB32_Premultiplied);
+    for (int y = 0; y < image.height(); y++)
+    {
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < image.width(); x++)
+        {
+            line[x] = qRgba((x + seed) & 0xff, (y * seed) & 0xff, seed & 0xff, 255);
+        }
+    }
+    return image;
+}
+
+// a few lines on a transparent background, 4MB once loaded
+static QImage lineArtImage()
+{
+    QImage image(1024, 1024, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    painter.setPen(QPen(Qt::black, 3));
+    for (int i = 0; i < 10; i++)
+    {
+        painter.drawLine(QPointF(100 + i * 80, 50), QPointF(900 - i * 60, 980));
+    }
+    painter.end();
+    return image;
+}
+
+// clean frames, loaded from a file the first time they are put into the pool
+static std::vector<std::unique_ptr<BitmapImage>> cleanFrames(const QString& path, int count)
+{
+    std::vector<std::unique_ptr<BitmapImage>> frames;
+    for (int i = 1; i <= count; i++)
+    {
+        frames.emplace_back(new BitmapImage(QPoint(0, 0), path));
+        frames.back()->setPos(i);
+    }
+    return frames;
+}
+
+// a modified frame that can't be swapped out, 4MB as far as the pool knows
+class StuckFrame : public KeyFrame
+{
+public:
+    quint64 memoryUsage() override { return 4 * MB; }
+};
+
+TEST_CASE("ActiveFramePool", "[ActiveFramePool]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString path = dir.filePath("frame.png");
+    REQUIRE(frameImage(1).save(path));
+
+    ActiveFramePool pool;
+    pool.resize(100 * MB);
+    pool.setMinFrameCount(0);
+    pool.setCompressedBudget(0);
+
+    SECTION("Least recently used frames are unloaded")
+    {
+        auto frames = cleanFrames(path, 40);
+        for (auto& frame : frames)
+        {
+            pool.put(frame.get());
+        }
+        REQUIRE(pool.usedMemory() <= 100 * MB);
+        REQUIRE(pool.frameCount() == 25);
+        REQUIRE_FALSE(frames.front()->isLoaded());
+        REQUIRE(frames.back()->isLoaded());
+
+        REQUIRE(pool.stats().misses == 40);
+        REQUIRE(pool.stats().evictions == 15);
+        pool.put(frames.back().get());
+        REQUIRE(pool.stats().hits == 1);
+    }
+
+    SECTION("Pinned frames stay loaded")
+    {
+        auto frames = cleanFrames(path, 40);
+        pool.pin(frames[0].get());
+        pool.pin(frames[0].get());
+        for (auto& frame : frames)
+        {
+            pool.put(frame.get());
+        }
+        REQUIRE(pool.isPinned(frames[0].get()));
+        REQUIRE(frames[0]->isLoaded());
+
+        pool.unpin(frames[0].get());
+        REQUIRE(pool.isPinned(frames[0].get()));
+        pool.unpin(frames[0].get());
+        REQUIRE_FALSE(pool.isPinned(frames[0].get()));
+
+        // it's now the most recently used frame
+        pool.put(frames[1].get());
+        REQUIRE(frames[0]->isLoaded());
+    }
+
+    SECTION("Destroyed frames are taken off")
+    {
+        auto frames = cleanFrames(path, 10);
+        for (auto& frame : frames)
+        {
+            pool.put(frame.get());
+        }
+        REQUIRE(pool.usedMemory() == 40 * MB);
+        frames.pop_back();
+        REQUIRE(pool.usedMemory() == 36 * MB);
+        REQUIRE(pool.frameCount() == 9);
+    }
+
+    SECTION("Modified frames are swapped out, later than clean ones")
+    {
+        std::vector<std::unique_ptr<BitmapImage>> modified;
+        for (int i = 1; i <= 5; i++)
+        {
+            modified.emplace_back(new BitmapImage(QPoint(0, 0), frameImage(i)));
+            modified.back()->setPos(i);
+            pool.put(modified.back().get());
+        }
+        REQUIRE(pool.dirtyMemory() == 20 * MB);
+
+        auto frames = cleanFrames(path, 30);
+        for (auto& frame : frames)
+        {
+            pool.put(frame.get());
+        }
+        REQUIRE(pool.stats().swapOuts == 0);
+        REQUIRE(pool.stats().evictions == 10);
+
+        for (int round = 0; round < 3; round++)
+        {
+            for (auto& frame : frames)
+            {
+                pool.put(frame.get());
+            }
+        }
+        REQUIRE(pool.stats().swapOuts == 5);
+        REQUIRE(pool.dirtyMemory() == 0);
+
+        for (int i = 0; i < 5; i++)
+        {
+            BitmapImage* frame = modified[i].get();
+            REQUIRE_FALSE(frame->isLoaded());
+            REQUIRE(frame->isModified());
+
+            pool.put(frame);
+            REQUIRE(*frame->image() == frameImage(i + 1));
+        }
+    }
+
+    SECTION("Modified frames that can't be swapped out stay in the pool")
+    {
+        StuckFrame stuck;
+        stuck.setPos(1);
+        pool.put(&stuck);
+
+        auto frames = cleanFrames(path, 30);
+        for (int round = 0; round < 4; round++)
+        {
+            for (auto& frame : frames)
+            {
+                pool.put(frame.get());
+            }
+        }
+        REQUIRE(pool.stats().swapOutFailures > 0);
+        REQUIRE(pool.isFrameInPool(&stuck));
+        REQUIRE(pool.dirtyMemory() == 4 * MB);
+        REQUIRE(pool.usedMemory() <= 100 * MB);
+    }
+}
+
+TEST_CASE("ActiveFramePool compressed tier", "[ActiveFramePool]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString path = dir.filePath("lines.png");
+    REQUIRE(lineArtImage().save(path));
+
+    // 25 frames in memory and up to 25MB of compressed ones
+    ActiveFramePool pool;
+    pool.resize(100 * MB);
+    pool.setMinFrameCount(0);
+
+    auto frames = cleanFrames(path, 40);
+    for (auto& frame : frames)
+    {
+        pool.put(frame.get());
+    }
+    REQUIRE(pool.frameCount() == 25);
+    REQUIRE(pool.compressedFrameCount() == 15);
+    REQUIRE(pool.stats().compressions == 15);
+    REQUIRE(pool.stats().evictions == 0);
+    REQUIRE(pool.compressedMemory() <= 15 * MB); // a quarter or less of each frame
+
+    SECTION("Compressed frames are decompressed, not loaded again")
+    {
+        pool.put(frames[0].get());
+        REQUIRE(pool.stats().compressedHits == 1);
+        REQUIRE(pool.stats().misses == 40);
+        REQUIRE(*frames[0]->image() == QImage(path));
+        REQUIRE(pool.compressedFrameCount() == 15);
+    }
+
+    SECTION("The compressed tier has a budget of its own")
+    {
+        pool.setCompressedBudget(1);
+        REQUIRE(pool.compressedFrameCount() == 0);
+        REQUIRE(pool.compressedMemory() == 0);
+        REQUIRE(pool.stats().evictions == 15);
+        REQUIRE_FALSE(frames[0]->isLoaded());
+        REQUIRE(frames[0]->memoryUsage() == 0);
+    }
+
+    SECTION("Modified frames go from the compressed tier to a scratch file")
+    {
+        for (auto& frame : frames)
+        {
+            frame->modification();
+        }
+        pool.setCompressedBudget(0);
+        REQUIRE(pool.stats().swapOuts == 15);
+
+        pool.put(frames[0].get());
+        REQUIRE(frames[0]->isModified());
+        REQUIRE(*frames[0]->image() == QImage(path));
+    }
+
+    SECTION("Destroyed compressed frames are taken off")
+    {
+        frames.erase(frames.begin());
+        REQUIRE(pool.compressedFrameCount() == 14);
+    }
+
+    SECTION("Removed compressed frames are taken off")
+    {
+        // as saving does before it unloads a frame that wasn't loaded
+        const quint64 compressedMemory = pool.compressedMemory();
+        const quint64 frameMemory = frames[0]->memoryUsage();
+        pool.remove(frames[0].get());
+        frames[0]->unloadFile();
+        REQUIRE(pool.compressedFrameCount() == 14);
+        REQUIRE(pool.compressedMemory() == compressedMemory - frameMemory);
+        REQUIRE_FALSE(pool.isFrameInPool(frames[0].get()));
+
+        pool.put(frames[0].get());
+        REQUIRE(pool.stats().misses == 41);
+    }
+}
+
+TEST_CASE("BitmapImage::swapOut()", "[ActiveFramePool]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+
+    BitmapImage frame(QPoint(10, 20), frameImage(3));
+    REQUIRE(frame.swapOut(dir.filePath("scratch")));
+    REQUIRE_FALSE(frame.isLoaded());
+    REQUIRE(frame.memoryUsage() == 0);
+
+    SECTION("Read back when needed")
+    {
+        REQUIRE(frame.pixel(10, 20) == frameImage(3).pixel(0, 0));
+        REQUIRE(*frame.image() == frameImage(3));
+        REQUIRE(frame.bounds() == QRect(QPoint(10, 20), QSize(1024, 1024)));
+        REQUIRE_FALSE(QFile::exists(dir.filePath("scratch")));
+    }
+
+    SECTION("Saved from the scratch file")
+    {
+        const QString path = dir.filePath("saved.png");
+        REQUIRE(frame.writeFile(path).ok());
+        REQUIRE(QImage(path).convertToFormat(QImage::Format_ARGB32_Premultiplied) == frameImage(3));
+    }
+
+    SECTION("Clean frames aren't swapped out")
+    {
+        BitmapImage clean(QPoint(0, 0), frameImage(4));
+        clean.setModified(false);
+        REQUIRE_FALSE(clean.swapOut(dir.filePath("clean")));
+        REQUIRE(clean.isLoaded());
+    }
+
+    SECTION("Copied without loading it")
+    {
+        BitmapImage copy(frame);
+        REQUIRE_FALSE(frame.isLoaded());
+        REQUIRE(*copy.image() == frameImage(3));
+
+        BitmapImage assigned;
+        assigned = frame;
+        REQUIRE(*assigned.image() == frameImage(3));
+
+        std::unique_ptr<BitmapImage> clone(frame.clone());
+        REQUIRE(*clone->image() == frameImage(3));
+
+        BitmapImage lineArt(QPoint(0, 0), lineArtImage());
+        REQUIRE(lineArt.compress() > 0);
+        BitmapImage compressedCopy(lineArt);
+        REQUIRE_FALSE(lineArt.isLoaded());
+        REQUIRE(*compressedCopy.image() == lineArtImage());
+    }
+}
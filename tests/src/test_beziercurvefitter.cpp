@@ -0,0 +1,102 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "catch.hpp"
+
+#include <random>
+#include <QtMath>
+#include "beziercurve.h"
+#include "beziercurvefitter.h"
+
+
+// distance from a sample to the closest point of a densely sampled curve
+static qreal distanceToCurve(const BezierCurve& curve, QPointF point)
+{
+    qreal best = BezierCurve::eLength(curve.getVertex(-1) - point);
+    for (int i = 0; i < curve.getVertexSize(); i++)
+    {
+        for (int k = 1; k <= 1000; k++)
+        {
+            best = qMin(best, BezierCurve::eLength(curve.getPointOnCubic(i, k / 1000.0) - point));
+        }
+    }
+    return best;
+}
+
+TEST_CASE("BezierCurveFitter::fit()", "[BezierCurveFitter]")
+{
+    SECTION("Empty and single point strokes")
+    {
+        BezierCurveFitter fitter(1.0);
+        REQUIRE(fitter.fit(QList<QPointF>(), QList<qreal>()).getVertexSize() == 0);
+
+        BezierCurve dot = fitter.fit(QList<QPointF>() << QPointF(3, 4), QList<qreal>() << 0.5);
+        REQUIRE(dot.getVertexSize() == 0);
+        REQUIRE(dot.getOrigin() == QPointF(3, 4));
+    }
+
+    SECTION("Duplicated samples are ignored")
+    {
+        BezierCurveFitter fitter(1.0);
+        QList<QPointF> points = { QPointF(0, 0), QPointF(0, 0), QPointF(10, 0), QPointF(10, 0) };
+        QList<qreal> pressures = { 0.5, 0.5, 0.5, 0.5 };
+
+        BezierCurve curve = fitter.fit(points, pressures);
+        REQUIRE(curve.getVertexSize() == 1);
+        REQUIRE(curve.getVertex(0) == QPointF(10, 0));
+    }
+
+    SECTION("Dense tablet stroke")
+    {
+        // two periods of a sine wave sampled like a 200Hz tablet, with a bit of jitter
+        std::mt19937 rng(7);
+        std::normal_distribution<qreal> jitter(0.0, 0.1);
+
+        QList<QPointF> points;
+        QList<qreal> pressures;
+        const int sampleCount = 2000;
+        for (int i = 0; i < sampleCount; i++)
+        {
+            qreal angle = 4.0 * M_PI * i / (sampleCount - 1);
+            points << QPointF(0.5 * i + jitter(rng), 50.0 * qSin(angle) + jitter(rng));
+            pressures << 0.3 + 0.4 * i / sampleCount;
+        }
+
+        const qreal maxError = 1.0;
+        BezierCurveFitter fitter(maxError);
+        BezierCurve curve = fitter.fit(points, pressures);
+
+        REQUIRE(curve.getVertex(-1) == points.first());
+        REQUIRE(curve.getVertex(curve.getVertexSize() - 1) == points.last());
+        REQUIRE(fitter.fitError() < maxError);
+
+        qreal measuredError = 0.0;
+        for (const QPointF& p : points)
+        {
+            measuredError = qMax(measuredError, distanceToCurve(curve, p));
+        }
+        REQUIRE(measuredError < maxError);
+
+        // the simplify + smoothCurve pipeline, for comparison
+        BezierCurve simplified(points, pressures, maxError);
+
+        REQUIRE(curve.getVertexSize() * 20 < sampleCount);
+        REQUIRE(curve.getVertexSize() <= simplified.getVertexSize());
+
+        WARN(QString("%1 samples -> %2 vertices (simplify: %3), fit error %4 px")
+             .arg(sampleCount).arg(curve.getVertexSize() + 1).arg(simplified.getVertexSize() + 1)
+             .arg(measuredError, 0, 'f', 3).toStdString());
+    }
+}
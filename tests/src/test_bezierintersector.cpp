@@ -0,0 +1,81 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "catch.hpp"
+
+#include "beziercurve.h"
+#include "bezierintersector.h"
+
+
+TEST_CASE("BezierIntersector::intersect()", "[BezierIntersector]")
+{
+    BezierIntersector intersector(0.05);
+
+    SECTION("Two crossing sections")
+    {
+        BezierCurve curve1(QList<QPointF>({ QPointF(0, 0), QPointF(10, 10) }), false);
+        BezierCurve curve2(QList<QPointF>({ QPointF(0, 10), QPointF(10, 0) }), false);
+
+        QList<Intersection> intersections;
+        REQUIRE(intersector.intersect(curve1, 0, curve2, 0, intersections));
+        REQUIRE(intersections.size() == 1);
+
+        Intersection i = intersections.first();
+        REQUIRE(QLineF(i.point, QPointF(5, 5)).length() < 0.1);
+        REQUIRE(QLineF(curve1.getPointOnCubic(0, i.t1), i.point).length() < 0.1);
+        REQUIRE(QLineF(curve2.getPointOnCubic(0, i.t2), i.point).length() < 0.1);
+    }
+
+    SECTION("Far apart sections are rejected")
+    {
+        BezierCurve curve1(QList<QPointF>({ QPointF(0, 0), QPointF(10, 10) }), false);
+        BezierCurve curve2(QList<QPointF>({ QPointF(100, 100), QPointF(110, 90) }), false);
+
+        QList<Intersection> intersections;
+        REQUIRE_FALSE(intersector.intersect(curve1, 0, curve2, 0, intersections));
+        REQUIRE(intersections.isEmpty());
+    }
+
+    SECTION("Horizontal and vertical sections")
+    {
+        BezierCurve curve1(QList<QPointF>({ QPointF(0, 5), QPointF(10, 5) }), false);
+        BezierCurve curve2(QList<QPointF>({ QPointF(3, 0), QPointF(3, 10) }), false);
+
+        QList<Intersection> intersections;
+        REQUIRE(intersector.intersect(curve1, 0, curve2, 0, intersections));
+        REQUIRE(QLineF(intersections.first().point, QPointF(3, 5)).length() < 0.1);
+    }
+
+    SECTION("A cubic crossing a line several times")
+    {
+        BezierCurve wave;
+        wave.setOrigin(QPointF(0, 0));
+        wave.appendCubic(QPointF(10, 40), QPointF(20, -40), QPointF(30, 0), 0.5);
+
+        BezierCurve line(QList<QPointF>({ QPointF(-5, 0), QPointF(35, 0) }), false);
+
+        QList<Intersection> intersections;
+        REQUIRE(intersector.intersect(line, 0, wave, 0, intersections));
+        REQUIRE(intersections.size() == 3); // 0, 15 and 30 on the line; none of them is a vertex of the line
+    }
+
+    SECTION("Consecutive sections don't report their shared vertex")
+    {
+        BezierCurve curve(QList<QPointF>({ QPointF(0, 0), QPointF(10, 0), QPointF(10, 10) }), false);
+
+        QList<Intersection> intersections;
+        REQUIRE_FALSE(intersector.intersect(curve, 0, curve, 1, intersections));
+    }
+}
@@ -0,0 +1,170 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "catch.hpp"
+
+#include <random>
+#include <QPainter>
+#include "bitmapcompositor.h"
+#include "bitmapimage.h"
+
+
+static const QPainter::CompositionMode compositedModes[] = {
+    QPainter::CompositionMode_Source,
+    QPainter::CompositionMode_SourceOver,
+    QPainter::CompositionMode_DestinationOut,
+    QPainter::CompositionMode_SourceIn,
+    QPainter::CompositionMode_SourceAtop,
+    QPainter::CompositionMode_Clear
+};
+
+static QImage randomImage(int width, int height, std::mt19937& rng)
+{
+    std::uniform_int_distribution<int> byte(0, 255);
+    QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+    for (int y = 0; y < height; y++)
+    {
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < width; x++)
+        {
+            // plenty of fully transparent and fully opaque pixels, like real strokes
+            const int choice = byte(rng);
+            const int alpha = (choice < 64) ? 0 : (choice < 128) ? 255 : byte(rng);
+            line[x] = qPremultiply(qRgba(byte(rng), byte(rng), byte(rng), alpha));
+        }
+    }
+    return image;
+}
+
+static int maxChannelDifference(const QImage& a, const QImage& b)
+{
+    int difference = 0;
+    for (int y = 0; y < a.height(); y++)
+    {
+        for (int x = 0; x < a.width(); x++)
+        {
+            const QRgb p = a.pixel(x, y);
+            const QRgb q = b.pixel(x, y);
+            difference = qMax(difference, qAbs(qRed(p) - qRed(q)));
+            difference = qMax(difference, qAbs(qGreen(p) - qGreen(q)));
+            difference = qMax(difference, qAbs(qBlue(p) - qBlue(q)));
+            difference = qMax(difference, qAbs(qAlpha(p) - qAlpha(q)));
+        }
+    }
+    return difference;
+}
+
+static void paintWithQPainter(QImage& target, QPoint offset, const QImage& source, QPainter::CompositionMode mode)
+{
+    QPainter painter(&target);
+    painter.setCompositionMode(mode);
+    painter.drawImage(offset, source);
+}
+
+TEST_CASE("BitmapCompositor", "[BitmapCompositor]")
+{
+    std::mt19937 rng(13);
+
+    SECTION("Only some modes are composited")
+    {
+        for (QPainter::CompositionMode mode : compositedModes)
+        {
+            REQUIRE(BitmapCompositor::supports(mode));
+        }
+        REQUIRE_FALSE(BitmapCompositor::supports(QPainter::CompositionMode_Multiply));
+
+        QImage target(4, 4, QImage::Format_ARGB32_Premultiplied);
+        target.fill(Qt::transparent);
+        REQUIRE_FALSE(BitmapCompositor::composite(target, QPoint(0, 0), target, QPainter::CompositionMode_Multiply));
+
+        const QImage straight(4, 4, QImage::Format_ARGB32);
+        REQUIRE_FALSE(BitmapCompositor::composite(target, QPoint(0, 0), straight, QPainter::CompositionMode_SourceOver));
+    }
+
+    SECTION("Same pixels as QPainter")
+    {
+        const QImage target = randomImage(61, 37, rng);
+        const QImage source = randomImage(45, 29, rng);
+        for (QPainter::CompositionMode mode : compositedModes)
+        {
+            for (QPoint offset : { QPoint(0, 0), QPoint(9, 5), QPoint(-13, 20), QPoint(30, -7) })
+            {
+                QImage expected = target;
+                paintWithQPainter(expected, offset, source, mode);
+
+                QImage result = target;
+                REQUIRE(BitmapCompositor::composite(result, offset, source, mode));
+                REQUIRE(maxChannelDifference(result, expected) <= 2);
+            }
+        }
+    }
+
+    SECTION("Only the clip rect changes")
+    {
+        QImage target(40, 40, QImage::Format_ARGB32_Premultiplied);
+        target.fill(Qt::transparent);
+        QImage source(40, 40, QImage::Format_ARGB32_Premultiplied);
+        source.fill(Qt::red);
+
+        REQUIRE(BitmapCompositor::composite(target, QPoint(0, 0), source, QPainter::CompositionMode_SourceOver, QRect(10, 10, 5, 5)));
+        REQUIRE(target.pixel(10, 10) == qRgba(255, 0, 0, 255));
+        REQUIRE(target.pixel(14, 14) == qRgba(255, 0, 0, 255));
+        REQUIRE(target.pixel(9, 10) == qRgba(0, 0, 0, 0));
+        REQUIRE(target.pixel(15, 14) == qRgba(0, 0, 0, 0));
+    }
+
+    SECTION("SIMD and scalar compositing agree")
+    {
+        std::uniform_int_distribution<int> byte(0, 255);
+        for (int run = 0; run < 3000; run++)
+        {
+            const int count = run % 37;
+            const QPainter::CompositionMode mode = compositedModes[run % 6];
+            const QImage pixels = randomImage(count, 2, rng);
+
+            QVector<QRgb> a(count), b(count), src(count);
+            for (int i = 0; i < count; i++)
+            {
+                a[i] = b[i] = pixels.pixel(i, 0);
+                src[i] = pixels.pixel(i, 1);
+            }
+            BitmapCompositor::compositeRow(a.data(), src.constData(), count, mode);
+            BitmapCompositor::compositeRowScalar(b.data(), src.constData(), count, mode);
+            REQUIRE(a == b);
+        }
+    }
+}
+
+TEST_CASE("BitmapImage::paste() with the compositor", "[BitmapCompositor]")
+{
+    std::mt19937 rng(17);
+    for (QPainter::CompositionMode mode : compositedModes)
+    {
+        BitmapImage target(QPoint(0, 0), randomImage(50, 50, rng));
+        BitmapImage source(QPoint(20, 30), randomImage(40, 10, rng));
+
+        QImage expected(60, 50, QImage::Format_ARGB32_Premultiplied);
+        expected.fill(Qt::transparent);
+        paintWithQPainter(expected, QPoint(0, 0), *target.image(), QPainter::CompositionMode_Source);
+        paintWithQPainter(expected, QPoint(20, 30), *source.image(), mode);
+
+        target.paste(&source, mode);
+        QImage result(60, 50, QImage::Format_ARGB32_Premultiplied);
+        result.fill(Qt::transparent);
+        paintWithQPainter(result, target.topLeft(), *target.image(), QPainter::CompositionMode_Source);
+
+        REQUIRE(maxChannelDifference(result, expected) <= 2);
+    }
+}
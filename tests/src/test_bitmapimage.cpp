@@ -15,6 +15,7 @@ GNU General Public License for more details.
 */
 #include "catch.hpp"
 
+#include <random>
 #include "bitmapimage.h"
 
 TEST_CASE("BitmapImage constructors")
@@ -92,3 +93,76 @@ TEST_CASE("BitmapImage functions")
         REQUIRE(b->height() == 50);
     }
 }
+
+TEST_CASE("BitmapImage::autoCrop()")
+{
+    SECTION("Transparent borders are cropped")
+    {
+        BitmapImage b(QRect(0, 0, 50, 50), Qt::transparent);
+        b.enableAutoCrop(true);
+        b.drawRect(QRectF(10, 20, 5, 5), Qt::NoPen, QBrush(Qt::blue), QPainter::CompositionMode_SourceOver, false);
+        REQUIRE_FALSE(b.isMinimallyBounded());
+
+        b.autoCrop();
+        REQUIRE(b.isMinimallyBounded());
+        REQUIRE(b.bounds() == QRect(10, 20, 5, 5));
+        REQUIRE(b.pixel(12, 22) == qRgba(0, 0, 255, 255));
+    }
+
+    SECTION("Crops lazily, only the erased edges")
+    {
+        BitmapImage b(QRect(0, 0, 100, 100), Qt::red);
+        b.enableAutoCrop(true);
+        b.autoCrop();
+        REQUIRE(b.bounds() == QRect(0, 0, 100, 100));
+
+        // erasing inside the image can't make an edge transparent
+        b.clear(QRect(40, 40, 10, 10));
+        REQUIRE(b.isMinimallyBounded());
+
+        b.clear(QRect(-5, -5, 110, 15));
+        REQUIRE_FALSE(b.isMinimallyBounded());
+        REQUIRE(b.bounds() == QRect(0, 0, 100, 100));
+
+        b.autoCrop();
+        REQUIRE(b.bounds() == QRect(0, 10, 100, 90));
+    }
+
+    SECTION("Drawing keeps the bounds minimal")
+    {
+        BitmapImage b(QRect(0, 0, 20, 20), Qt::red);
+        b.enableAutoCrop(true);
+        b.autoCrop();
+
+        b.drawRect(QRectF(5, 5, 5, 5), Qt::NoPen, QBrush(Qt::blue), QPainter::CompositionMode_SourceOver, false);
+        b.setPixel(40, 30, qRgba(0, 255, 0, 255));
+        REQUIRE(b.isMinimallyBounded());
+        REQUIRE(b.bounds() == QRect(0, 0, 41, 31));
+    }
+
+    SECTION("Erasing everything")
+    {
+        BitmapImage b(QRect(0, 0, 20, 20), Qt::red);
+        b.enableAutoCrop(true);
+        b.clear(QRect(0, 0, 20, 20));
+        b.autoCrop();
+        REQUIRE(b.bounds().isEmpty());
+    }
+
+    SECTION("SIMD and scalar transparency checks agree")
+    {
+        std::mt19937 rng(3);
+        std::uniform_int_distribution<int> index(0, 63);
+        for (int run = 0; run < 1000; run++)
+        {
+            const int count = run % 64;
+            QVector<QRgb> row(count, qRgba(0, 0, 0, 0));
+            if (count > 0 && run % 3 != 0)
+            {
+                row[index(rng) % count] = qRgba(0, 0, 0, 1 + index(rng));
+            }
+            REQUIRE(BitmapImage::isRowTransparent(row.constData(), count)
+                    == BitmapImage::isRowTransparentScalar(row.constData(), count));
+        }
+    }
+}
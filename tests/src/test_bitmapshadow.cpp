@@ -0,0 +1,127 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "catch.hpp"
+
+#include <QPainter>
+#include "bitmapshadow.h"
+#include "bitmapimage.h"
+
+
+// a 200x100 frame at (-50, 10), opaque green
+static BitmapImage greenFrame()
+{
+    QImage image(200, 100, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::green);
+    return BitmapImage(QPoint(-50, 10), image);
+}
+
+static BrushDabEngine::Dab eraserDab()
+{
+    BrushDabEngine::Dab dab;
+    dab.diameter = 10.0;
+    dab.color = Qt::white;
+    return dab;
+}
+
+TEST_CASE("BitmapShadow", "[BitmapShadow]")
+{
+    BrushDabEngine engine;
+    BitmapImage frame = greenFrame();
+    const QRgb green = qRgba(0, 255, 0, 255);
+
+    BitmapShadow shadow;
+    REQUIRE_FALSE(shadow.isActive());
+    shadow.begin(&frame);
+    REQUIRE(shadow.isActive());
+    REQUIRE(shadow.target() == &frame);
+
+    SECTION("Only the tiles under the dabs are copied")
+    {
+        shadow.eraseDabs(engine, QList<QPointF>() << QPointF(0, 40), eraserDab());
+        REQUIRE(shadow.tileCount() == 1);
+        REQUIRE(shadow.changedRect() == QRect(-50, 10, 64, 64));
+
+        // across the corner of four tiles
+        shadow.eraseDabs(engine, QList<QPointF>() << QPointF(14, 74), eraserDab());
+        REQUIRE(shadow.tileCount() == 4);
+
+        // the tiles on the right and bottom edges are cut to the frame
+        shadow.eraseDabs(engine, QList<QPointF>() << QPointF(145, 105), eraserDab());
+        REQUIRE(shadow.changedRect() == QRect(-50, 10, 200, 100));
+    }
+
+    SECTION("Nothing to erase outside the frame")
+    {
+        shadow.eraseDabs(engine, QList<QPointF>() << QPointF(500, 500), eraserDab());
+        REQUIRE(shadow.tileCount() == 0);
+        REQUIRE(frame.bounds() == QRect(-50, 10, 200, 100));
+    }
+
+    SECTION("The frame is untouched until commit")
+    {
+        shadow.eraseDabs(engine, QList<QPointF>() << QPointF(0, 40), eraserDab());
+        REQUIRE(frame.pixel(0, 40) == green);
+
+        // the preview shows the erased pixels
+        QImage preview = frame.image()->copy();
+        shadow.paint(preview, frame.topLeft());
+        REQUIRE(qAlpha(preview.pixel(50, 30)) == 0);
+        REQUIRE(preview.pixel(80, 30) == green);
+
+        // or drawn straight over what is underneath
+        QImage canvas(frame.image()->size(), QImage::Format_ARGB32_Premultiplied);
+        canvas.fill(Qt::red);
+        QPainter painter(&canvas);
+        painter.translate(-frame.topLeft());
+        shadow.paint(painter);
+        painter.end();
+        REQUIRE(canvas.pixel(50, 30) == qRgba(255, 0, 0, 255));
+        REQUIRE(canvas.pixel(40, 30) == green);
+        REQUIRE(canvas.pixel(80, 30) == green);
+
+        shadow.commit();
+        REQUIRE_FALSE(shadow.isActive());
+        REQUIRE(qAlpha(frame.pixel(0, 40)) == 0);
+        REQUIRE(frame.pixel(30, 40) == green);
+        REQUIRE(frame.bounds() == QRect(-50, 10, 200, 100));
+    }
+
+    SECTION("Rolling back leaves the frame as it was")
+    {
+        shadow.eraseDabs(engine, QList<QPointF>() << QPointF(0, 40) << QPointF(100, 90), eraserDab());
+        shadow.rollback();
+        REQUIRE_FALSE(shadow.isActive());
+        REQUIRE(shadow.tileCount() == 0);
+        REQUIRE(frame.pixel(0, 40) == green);
+        REQUIRE(frame.pixel(100, 90) == green);
+    }
+
+    SECTION("Erasing the edge of the frame lets it crop")
+    {
+        QList<QPointF> leftEdge;
+        for (int y = 10; y < 110; y += 4)
+        {
+            leftEdge << QPointF(-50, y);
+        }
+        frame.enableAutoCrop(true);
+        shadow.eraseDabs(engine, leftEdge, eraserDab());
+        shadow.commit();
+
+        REQUIRE_FALSE(frame.isMinimallyBounded());
+        frame.autoCrop();
+        REQUIRE(frame.left() > -50);
+    }
+}
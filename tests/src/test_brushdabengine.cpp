@@ -0,0 +1,218 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "catch.hpp"
+
+#include <random>
+#include <QPainter>
+#include <QRadialGradient>
+#include "brushdabengine.h"
+#include "bitmapimage.h"
+
+
+static qint64 alphaSum(const QImage& image)
+{
+    qint64 sum = 0;
+    for (int y = 0; y < image.height(); y++)
+    {
+        const QRgb* line = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+        for (int x = 0; x < image.width(); x++)
+        {
+            sum += qAlpha(line[x]);
+        }
+    }
+    return sum;
+}
+
+// the dab as ScribbleArea::drawBrush used to paint it
+static void paintGradientDab(QImage& image, QPointF center, qreal diameter, qreal feather, QColor color)
+{
+    QRadialGradient gradient(center, 0.5 * diameter);
+    gradient.setColorAt(0.0, color);
+    gradient.setColorAt(1.0, QColor(color.red(), color.green(), color.blue(), 0));
+    gradient.setColorAt(1.0 - (feather / 100.0), color);
+
+    QPainter painter(&image);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(gradient);
+    painter.drawEllipse(QRectF(center.x() - 0.5 * diameter, center.y() - 0.5 * diameter, diameter, diameter));
+}
+
+TEST_CASE("BrushDabEngine", "[BrushDabEngine]")
+{
+    BrushDabEngine engine;
+
+    SECTION("Stamps are cached per shape")
+    {
+        QImage image(64, 64, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+
+        BrushDabEngine::Dab dab;
+        dab.diameter = 20.0;
+        dab.feather = 50.0;
+        dab.color = QColor(255, 0, 0, 128);
+
+        engine.drawDabs(image, QPoint(0, 0), QList<QPointF>() << QPointF(20, 20) << QPointF(30, 30), dab);
+        dab.color = QColor(0, 0, 255, 40);
+        engine.drawDabs(image, QPoint(0, 0), QList<QPointF>() << QPointF(40, 40), dab);
+        REQUIRE(engine.stampCacheMisses() == 1);
+
+        dab.feather = 10.0;
+        engine.drawDabs(image, QPoint(0, 0), QList<QPointF>() << QPointF(40, 40), dab);
+        REQUIRE(engine.stampCacheMisses() == 2);
+        REQUIRE(engine.cachedStampCount() == 2);
+    }
+
+    SECTION("Solid dab")
+    {
+        QImage image(40, 40, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+
+        BrushDabEngine::Dab dab;
+        dab.diameter = 10.0;
+        dab.color = QColor(0, 255, 0, 255);
+
+        // the target starts at (100, 100) on the canvas
+        engine.drawDabs(image, QPoint(100, 100), QList<QPointF>() << QPointF(120, 120), dab);
+        REQUIRE(image.pixel(20, 20) == qRgba(0, 255, 0, 255));
+        REQUIRE(image.pixel(14, 14) == qRgba(0, 0, 0, 0));
+        REQUIRE(image.pixel(0, 0) == qRgba(0, 0, 0, 0));
+    }
+
+    SECTION("Dabs are clipped to the target")
+    {
+        QImage image(16, 16, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+
+        BrushDabEngine::Dab dab;
+        dab.diameter = 30.0;
+        dab.color = Qt::black;
+        engine.drawDabs(image, QPoint(0, 0), QList<QPointF>() << QPointF(0, 0) << QPointF(-100, 50), dab);
+        REQUIRE(qAlpha(image.pixel(0, 0)) == 255);
+        REQUIRE(qAlpha(image.pixel(15, 15)) == 0);
+    }
+
+    SECTION("Feathered dab is close to the radial gradient it replaces")
+    {
+        const QColor color(40, 80, 200, 150);
+        for (qreal feather : { 0.0, 30.0, 70.0, 100.0 })
+        {
+            QImage reference(80, 80, QImage::Format_ARGB32_Premultiplied);
+            reference.fill(Qt::transparent);
+            paintGradientDab(reference, QPointF(40, 40), 50.0, feather, color);
+
+            QImage image(80, 80, QImage::Format_ARGB32_Premultiplied);
+            image.fill(Qt::transparent);
+            BrushDabEngine::Dab dab;
+            dab.diameter = 50.0;
+            dab.feather = feather;
+            dab.color = color;
+            engine.drawDabs(image, QPoint(0, 0), QList<QPointF>() << QPointF(40, 40), dab);
+
+            const qint64 expected = alphaSum(reference);
+            REQUIRE(qAbs(alphaSum(image) - expected) < expected / 20);
+        }
+    }
+
+    SECTION("SIMD and scalar blending agree")
+    {
+        std::mt19937 rng(5);
+        std::uniform_int_distribution<int> byte(0, 255);
+        for (int run = 0; run < 1000; run++)
+        {
+            const int count = run % 37;
+            QVector<QRgb> a(count), b(count);
+            QVector<quint8> mask(count);
+            const int colorAlpha = byte(rng);
+            const QRgb color = qPremultiply(qRgba(byte(rng), byte(rng), byte(rng), colorAlpha));
+            for (int i = 0; i < count; i++)
+            {
+                a[i] = b[i] = qPremultiply(qRgba(byte(rng), byte(rng), byte(rng), byte(rng)));
+                mask[i] = (byte(rng) < 64) ? 0 : quint8(byte(rng));
+            }
+            BrushDabEngine::blendRow(a.data(), mask.constData(), count, color);
+            BrushDabEngine::blendRowScalar(b.data(), mask.constData(), count, color);
+            REQUIRE(a == b);
+        }
+    }
+
+    SECTION("SIMD and scalar erasing agree")
+    {
+        std::mt19937 rng(9);
+        std::uniform_int_distribution<int> byte(0, 255);
+        for (int run = 0; run < 1000; run++)
+        {
+            const int count = run % 37;
+            const int alpha = byte(rng);
+            QVector<QRgb> a(count), b(count);
+            QVector<quint8> mask(count);
+            for (int i = 0; i < count; i++)
+            {
+                a[i] = b[i] = qPremultiply(qRgba(byte(rng), byte(rng), byte(rng), byte(rng)));
+                mask[i] = (byte(rng) < 64) ? 0 : quint8(byte(rng));
+            }
+            BrushDabEngine::eraseRow(a.data(), mask.constData(), count, alpha);
+            BrushDabEngine::eraseRowScalar(b.data(), mask.constData(), count, alpha);
+            REQUIRE(a == b);
+        }
+    }
+
+    SECTION("Erasing dabs is a destination-out of drawn dabs")
+    {
+        QImage painted(40, 40, QImage::Format_ARGB32_Premultiplied);
+        painted.fill(QColor(20, 120, 220, 200));
+        QImage expected = painted;
+
+        BrushDabEngine::Dab dab;
+        dab.diameter = 16.0;
+        dab.feather = 40.0;
+        dab.color = QColor(255, 255, 255, 180);
+
+        QImage dabs(40, 40, QImage::Format_ARGB32_Premultiplied);
+        dabs.fill(Qt::transparent);
+        engine.drawDabs(dabs, QPoint(0, 0), QList<QPointF>() << QPointF(20, 20), dab);
+        QPainter painter(&expected);
+        painter.setCompositionMode(QPainter::CompositionMode_DestinationOut);
+        painter.drawImage(0, 0, dabs);
+        painter.end();
+
+        engine.eraseDabs(painted, QPoint(0, 0), QList<QPointF>() << QPointF(20, 20), dab);
+        for (int y = 0; y < 40; y++)
+        {
+            for (int x = 0; x < 40; x++)
+            {
+                REQUIRE(qAbs(qAlpha(painted.pixel(x, y)) - qAlpha(expected.pixel(x, y))) <= 2);
+            }
+        }
+        REQUIRE(qAlpha(painted.pixel(20, 20)) < 200);
+        REQUIRE(qAlpha(painted.pixel(0, 0)) == 200);
+    }
+}
+
+TEST_CASE("BitmapImage::drawDabs()", "[BrushDabEngine]")
+{
+    BrushDabEngine engine;
+    BitmapImage image;
+
+    BrushDabEngine::Dab dab;
+    dab.diameter = 8.0;
+    dab.color = Qt::red;
+    image.drawDabs(engine, QList<QPointF>() << QPointF(10, 10) << QPointF(50, 30), dab);
+
+    REQUIRE(image.bounds().contains(QPoint(10, 10)));
+    REQUIRE(image.bounds().contains(QPoint(50, 30)));
+    REQUIRE(image.pixel(10, 10) == qRgba(255, 0, 0, 255));
+    REQUIRE(image.pixel(50, 30) == qRgba(255, 0, 0, 255));
+}
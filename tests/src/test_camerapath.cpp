@@ -0,0 +1,140 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "catch.hpp"
+
+#include <QDomDocument>
+#include "camera.h"
+#include "camerapath.h"
+#include "layercamera.h"
+#include "object.h"
+
+
+// a rotation and a uniform scale, without shearing
+static bool isSimilarity(const QTransform& t)
+{
+    return qAbs(t.m11() - t.m22()) < 1e-9 && qAbs(t.m12() + t.m21()) < 1e-9;
+}
+
+TEST_CASE("CameraPath", "[CameraPath]")
+{
+    Object* object = new Object;
+    LayerCamera* layer = object->addNewCameraLayer();
+    Camera* first = layer->getCameraAtFrame(1);
+
+    SECTION("Translation between two keys")
+    {
+        layer->addKeyFrame(11, new Camera(QPointF(100, 0), 0, 1));
+        REQUIRE(layer->getViewAtFrame(1).dx() == 0);
+        REQUIRE(layer->getViewAtFrame(6).dx() == Approx(50));
+        REQUIRE(layer->getViewAtFrame(11).dx() == 100);
+
+        // the camera stays at the last key
+        REQUIRE(layer->getViewAtFrame(50).dx() == 100);
+        REQUIRE(layer->getViewAtFrame(0).dx() == 0);
+    }
+
+    SECTION("Rotating doesn't shear the view")
+    {
+        layer->addKeyFrame(11, new Camera(QPointF(0, 0), 90, 2));
+        for (int frame = 1; frame <= 11; frame++)
+        {
+            REQUIRE(isSimilarity(layer->getViewAtFrame(frame)));
+        }
+
+        const QTransform expected = Camera::viewTransform(QPointF(0, 0), 45, 1.5);
+        const QTransform view = layer->getViewAtFrame(6);
+        REQUIRE(view.m11() == Approx(expected.m11()));
+        REQUIRE(view.m12() == Approx(expected.m12()));
+    }
+
+    SECTION("Easing")
+    {
+        layer->addKeyFrame(11, new Camera(QPointF(100, 0), 0, 1));
+        first->setEasing(QEasingCurve::InQuad);
+        REQUIRE(layer->getViewAtFrame(6).dx() == Approx(25));
+    }
+
+    SECTION("Sub-frames")
+    {
+        layer->addKeyFrame(11, new Camera(QPointF(100, 0), 0, 1));
+        REQUIRE(layer->getViewAtSubFrame(5.5).dx() == Approx(45));
+        REQUIRE(layer->getViewAtSubFrame(10.75).dx() == Approx(97.5));
+        REQUIRE(layer->getViewAtSubFrame(6.0) == layer->getViewAtFrame(6));
+        REQUIRE(layer->getViewAtSubFrame(0.5).dx() == 0);
+        REQUIRE(layer->getViewAtSubFrame(11.5).dx() == 100);
+    }
+
+    SECTION("The table follows the edits")
+    {
+        layer->addKeyFrame(11, new Camera(QPointF(100, 0), 0, 1));
+        layer->setCachedFrameRange(1, 20);
+        REQUIRE(layer->getViewAtFrame(6).dx() == Approx(50));
+
+        layer->getCameraAtFrame(11)->translate(200, 0);
+        REQUIRE(layer->getViewAtFrame(6).dx() == Approx(100));
+        REQUIRE(layer->getViewAtFrame(15).dx() == 200);
+
+        layer->addKeyFrame(16, new Camera(QPointF(0, 0), 0, 1));
+        REQUIRE(layer->getViewAtFrame(15).dx() == Approx(40));
+
+        layer->removeKeyFrame(11);
+        REQUIRE(layer->getViewAtFrame(6).dx() == 0);
+        layer->clearCachedFrameRange();
+    }
+
+    SECTION("The table and the evaluation agree")
+    {
+        layer->addKeyFrame(5, new Camera(QPointF(30, -20), 10, 1.5));
+        layer->addKeyFrame(9, new Camera(QPointF(-40, 60), 200, 0.5));
+        layer->addKeyFrame(30, new Camera(QPointF(10, 10), 0, 1));
+        layer->getCameraAtFrame(9)->setEasing(QEasingCurve::InOutSine);
+
+        QList<QTransform> evaluated;
+        for (int frame = -2; frame <= 40; frame++)
+        {
+            evaluated.append(layer->getViewAtFrame(frame));
+        }
+        layer->setCachedFrameRange(-2, 40);
+        for (int frame = -2; frame <= 40; frame++)
+        {
+            REQUIRE(layer->getViewAtFrame(frame) == evaluated[frame + 2]);
+        }
+        layer->clearCachedFrameRange();
+    }
+
+    SECTION("New keys are put on the path")
+    {
+        layer->addKeyFrame(11, new Camera(QPointF(100, 0), 40, 1));
+        const QTransform before = layer->getViewAtFrame(4);
+        layer->addNewKeyFrameAt(4);
+        REQUIRE(layer->getCameraAtFrame(4)->translation().x() == Approx(30));
+        REQUIRE(layer->getViewAtFrame(4).dx() == Approx(before.dx()));
+    }
+
+    SECTION("Easing is saved")
+    {
+        first->setEasing(QEasingCurve::OutBack);
+
+        QDomDocument doc;
+        QDomElement element = layer->createDomElement(doc);
+        LayerCamera* loaded = new LayerCamera(object);
+        loaded->loadDomElement(element, QString(), []() {});
+        REQUIRE(loaded->getCameraAtFrame(1)->easing() == QEasingCurve::OutBack);
+        delete loaded;
+    }
+
+    delete object;
+}
@@ -0,0 +1,117 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "catch.hpp"
+
+#include "cursorcache.h"
+
+
+static CursorCache::Key penKey(qreal width)
+{
+    CursorCache::Key key;
+    key.tool = PEN;
+    key.width = width;
+    key.feather = 2.0;
+    key.scaling = 1.0;
+    key.windowWidth = 800;
+    return key;
+}
+
+TEST_CASE("CursorCache", "[CursorCache]")
+{
+    CursorCache cache;
+    int draws = 0;
+    auto draw = [&draws](const CursorCache::Key& key)
+    {
+        return [&draws, key]
+        {
+            draws++;
+            return QPixmap(qRound(key.width) + 1, 1);
+        };
+    };
+    auto cursor = [&](const CursorCache::Key& key) { return cache.cursor(key, draw(key)); };
+
+    SECTION("A cursor is drawn once")
+    {
+        const QPixmap first = cursor(penKey(10));
+        const QPixmap second = cursor(penKey(10));
+        REQUIRE(draws == 1);
+        REQUIRE(cache.misses() == 1);
+        REQUIRE(cache.size() == 1);
+        REQUIRE(second.cacheKey() == first.cacheKey());
+    }
+
+    SECTION("Another width is another cursor")
+    {
+        cursor(penKey(10));
+        REQUIRE(cursor(penKey(10.5)).width() == 12);
+        REQUIRE(draws == 2);
+
+        cursor(penKey(10));
+        REQUIRE(draws == 2);
+    }
+
+    SECTION("So are another tool, feather or zoom")
+    {
+        cursor(penKey(10));
+
+        CursorCache::Key key = penKey(10);
+        key.tool = PENCIL;
+        cursor(key);
+
+        key = penKey(10);
+        key.feather = 4.0;
+        cursor(key);
+
+        key = penKey(10);
+        key.scaling = 2.0;
+        cursor(key);
+
+        key = penKey(10);
+        key.quickSize = true;
+        cursor(key);
+
+        REQUIRE(draws == 5);
+        REQUIRE(cache.size() == 5);
+    }
+
+    SECTION("The least recently used cursor goes once 8 are cached")
+    {
+        for (int width = 1; width <= 8; width++)
+        {
+            cursor(penKey(width));
+        }
+        REQUIRE(cache.size() == 8);
+
+        cursor(penKey(1)); // used again, width 2 is now the least recently used
+        cursor(penKey(9));
+        REQUIRE(cache.size() == 8);
+        REQUIRE(draws == 9);
+
+        cursor(penKey(1));
+        REQUIRE(draws == 9);
+        cursor(penKey(2));
+        REQUIRE(draws == 10);
+    }
+
+    SECTION("Cleared")
+    {
+        cursor(penKey(10));
+        cache.clear();
+        REQUIRE(cache.size() == 0);
+        cursor(penKey(10));
+        REQUIRE(draws == 2);
+    }
+}
@@ -0,0 +1,147 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "catch.hpp"
+
+#include <random>
+#include <QtConcurrent>
+#include "frameaccumulator.h"
+#include "framerenderer.h"
+#include "bitmapimage.h"
+#include "layerbitmap.h"
+#include "object.h"
+
+
+static QImage filledImage(QSize size, QColor color)
+{
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(color);
+    return image;
+}
+
+// an object with a few overlapping bitmap layers
+static Object* createObject(QSize size)
+{
+    Object* object = new Object;
+    const QColor colors[] = { QColor(200, 30, 30, 255), QColor(30, 200, 30, 128), QColor(30, 30, 200, 60) };
+    for (int i = 0; i < 3; i++)
+    {
+        LayerBitmap* layer = object->addNewBitmapLayer();
+        const QSize imageSize(size.width() / 2, size.height() / 2);
+        layer->addKeyFrame(2, new BitmapImage(QPoint(i * size.width() / 6, i * size.height() / 6), filledImage(imageSize, colors[i])));
+    }
+    return object;
+}
+
+TEST_CASE("FrameAccumulator", "[FrameAccumulator]")
+{
+    FrameAccumulator accumulator;
+    REQUIRE(accumulator.average().isNull());
+
+    SECTION("Average of two samples")
+    {
+        accumulator.add(filledImage(QSize(7, 3), QColor(32, 64, 96, 255)));
+        accumulator.add(filledImage(QSize(7, 3), Qt::transparent));
+        REQUIRE(accumulator.sampleCount() == 2);
+
+        const QImage average = accumulator.average();
+        REQUIRE(average.size() == QSize(7, 3));
+        REQUIRE(average.pixel(6, 2) == qRgba(16, 32, 48, 128));
+
+        accumulator.clear();
+        REQUIRE(accumulator.sampleCount() == 0);
+    }
+
+    SECTION("The same sample many times")
+    {
+        const QImage sample = filledImage(QSize(5, 5), QColor(10, 20, 30, 40));
+        for (int i = 0; i < FrameAccumulator::MAX_SAMPLES; i++)
+        {
+            accumulator.add(sample);
+        }
+        REQUIRE(accumulator.average() == sample);
+    }
+
+    SECTION("SIMD and scalar versions agree")
+    {
+        std::mt19937 rng(13);
+        std::uniform_int_distribution<int> byte(0, 255);
+        for (int run = 0; run < 500; run++)
+        {
+            const int count = run % 37;
+            const int samples = 1 + run % FrameAccumulator::MAX_SAMPLES;
+            QVector<quint16> a(count * 4), b(count * 4);
+            QVector<QRgb> pixels(count);
+            for (int s = 0; s < samples; s++)
+            {
+                for (QRgb& pixel : pixels)
+                {
+                    pixel = qPremultiply(qRgba(byte(rng), byte(rng), byte(rng), byte(rng)));
+                }
+                FrameAccumulator::addRow(a.data(), pixels.constData(), count);
+                FrameAccumulator::addRowScalar(b.data(), pixels.constData(), count);
+            }
+            REQUIRE(a == b);
+
+            QVector<QRgb> averageA(count), averageB(count);
+            FrameAccumulator::averageRow(averageA.data(), a.constData(), count, samples);
+            FrameAccumulator::averageRowScalar(averageB.data(), a.constData(), count, samples);
+            REQUIRE(averageA == averageB);
+            for (QRgb pixel : averageA)
+            {
+                REQUIRE(qRed(pixel) <= qAlpha(pixel));
+            }
+        }
+    }
+}
+
+TEST_CASE("FrameRenderer", "[FrameAccumulator]")
+{
+    const QSize size(120, 90);
+    Object* object = createObject(size);
+
+    QImage expected = filledImage(size, Qt::white);
+    QPainter painter(&expected);
+    object->paintImage(painter, 3, false, true);
+    painter.end();
+
+    SECTION("Paints like Object::paintImage")
+    {
+        QImage image = filledImage(size, Qt::white);
+        QPainter painter(&image);
+        FrameRenderer(object, 3).paint(painter);
+        painter.end();
+        REQUIRE(image == expected);
+    }
+
+    SECTION("Paints from several threads at once")
+    {
+        const FrameRenderer renderer(object, 3);
+        std::function<QImage(const int&)> render = [&](const int&)
+        {
+            QImage image = filledImage(size, Qt::white);
+            QPainter painter(&image);
+            renderer.paint(painter);
+            return image;
+        };
+        const QList<QImage> images = QtConcurrent::blockingMapped(QList<int>() << 1 << 2 << 3 << 4 << 5 << 6 << 7 << 8, render);
+        for (const QImage& image : images)
+        {
+            REQUIRE(image == expected);
+        }
+    }
+
+    delete object;
+}
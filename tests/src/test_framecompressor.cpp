@@ -0,0 +1,130 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "catch.hpp"
+
+#include <random>
+#include <QPainter>
+#include "framecompressor.h"
+
+
+static QImage lineArt(QSize size)
+{
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(QPen(QColor(20, 20, 20), 2.5));
+    for (int i = 0; i < 40; i++)
+    {
+        painter.drawLine(QPointF(i * size.width() / 40.0, 0), QPointF(size.width() - i * 7, size.height()));
+    }
+    painter.setBrush(QColor(200, 120, 80));
+    painter.drawEllipse(QRectF(size.width() / 4, size.height() / 4, size.width() / 3, size.height() / 3));
+    painter.end();
+    return image;
+}
+
+static QImage painting(QSize size, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> noise(-6, 6);
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    for (int y = 0; y < image.height(); y++)
+    {
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < image.width(); x++)
+        {
+            line[x] = qRgba(qBound(0, x / 8 + noise(rng), 255), qBound(0, y / 5 + noise(rng), 255), 128, 255);
+        }
+    }
+    return image;
+}
+
+TEST_CASE("FrameCompressor", "[FrameCompressor]")
+{
+    SECTION("Line art is run-length encoded")
+    {
+        const QImage image = lineArt(QSize(640, 480));
+        const QByteArray data = FrameCompressor::compress(image);
+        REQUIRE(FrameCompressor::method(data) == FrameCompressor::RunLength);
+        REQUIRE(data.size() < image.bytesPerLine() * image.height() / 4);
+        REQUIRE(FrameCompressor::decompress(data) == image);
+    }
+
+    SECTION("Painted frames are deflated")
+    {
+        const QImage image = painting(QSize(640, 480), 3);
+        const QByteArray data = FrameCompressor::compress(image);
+        REQUIRE(FrameCompressor::method(data) == FrameCompressor::Zlib);
+        REQUIRE(FrameCompressor::decompress(data) == image);
+    }
+
+    SECTION("Other formats")
+    {
+        QImage rgb = lineArt(QSize(100, 60)).convertToFormat(QImage::Format_RGB32);
+        REQUIRE(FrameCompressor::decompress(FrameCompressor::compress(rgb)) == rgb);
+
+        QImage gray = painting(QSize(101, 33), 5).convertToFormat(QImage::Format_Grayscale8);
+        REQUIRE(FrameCompressor::decompress(FrameCompressor::compress(gray)) == gray);
+
+        REQUIRE(FrameCompressor::decompress(FrameCompressor::compress(QImage())).isNull());
+    }
+
+    SECTION("Damaged data gives a null image")
+    {
+        QByteArray data = FrameCompressor::compress(lineArt(QSize(64, 64)));
+        REQUIRE(FrameCompressor::decompress(data.left(data.size() - 4)).isNull());
+        REQUIRE(FrameCompressor::decompress(data.left(8)).isNull());
+
+        data = FrameCompressor::compress(painting(QSize(64, 64), 1));
+        REQUIRE(FrameCompressor::decompress(data.left(data.size() / 2)).isNull());
+    }
+
+    SECTION("Runs and literal spans")
+    {
+        std::mt19937 rng(17);
+        for (int run = 0; run < 2000; run++)
+        {
+            const int count = run % 97;
+            QVector<quint32> pixels(count);
+            quint32 pixel = 0;
+            for (quint32& p : pixels)
+            {
+                if (rng() % (run % 5 + 2) == 0)
+                {
+                    pixel = rng() % 3;
+                }
+                p = pixel;
+            }
+
+            QVector<quint32> words(FrameCompressor::encodedSizeBound(count));
+            const int size = FrameCompressor::encodeRunLength(pixels.constData(), count, words.data(), words.size());
+            REQUIRE(size >= 0);
+            REQUIRE(size <= count + 1);
+
+            // the words stop as soon as they overflow a smaller buffer
+            if (size > 0)
+            {
+                REQUIRE(FrameCompressor::encodeRunLength(pixels.constData(), count, words.data(), size - 1) == -1);
+                REQUIRE(FrameCompressor::encodeRunLength(pixels.constData(), count, words.data(), size) == size);
+            }
+
+            QVector<quint32> decoded(count);
+            REQUIRE(FrameCompressor::decodeRunLength(words.constData(), size, decoded.data(), count));
+            REQUIRE(decoded == pixels);
+        }
+    }
+}
@@ -0,0 +1,90 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "catch.hpp"
+
+#include "framerangeset.h"
+#include "layerbitmap.h"
+#include "object.h"
+
+
+TEST_CASE("FrameRangeSet", "[FrameRangeSet]")
+{
+    FrameRangeSet set;
+
+    SECTION("Overlapping and adjacent ranges are merged")
+    {
+        set.add(10, 20);
+        set.add(30);
+        set.add(21, 25);
+        REQUIRE(set.ranges() == (QList<FrameRange>() << FrameRange(10, 25) << FrameRange(30, 30)));
+
+        set.add(26, 29);
+        REQUIRE(set.rangeCount() == 1);
+        REQUIRE(set.ranges().first() == FrameRange(10, 30));
+
+        set.add(1, 100);
+        REQUIRE(set.ranges().first() == FrameRange(1, 100));
+    }
+
+    SECTION("Separate ranges stay apart")
+    {
+        set.add(5, 3);
+        set.add(8, 9);
+        set.add(1);
+        REQUIRE(set.ranges() == (QList<FrameRange>() << FrameRange(1, 1) << FrameRange(3, 5) << FrameRange(8, 9)));
+        REQUIRE(set.contains(4));
+        REQUIRE_FALSE(set.contains(6));
+        REQUIRE_FALSE(set.contains(0));
+        REQUIRE(set.contains(9));
+        REQUIRE_FALSE(set.contains(10));
+    }
+
+    SECTION("Thousands of frames in a row are one range")
+    {
+        for (int i = 5000; i >= 1; i--)
+        {
+            set.add(i);
+        }
+        REQUIRE(set.rangeCount() == 1);
+
+        set.clear();
+        REQUIRE(set.isEmpty());
+    }
+}
+
+TEST_CASE("Layer dirty frames", "[FrameRangeSet]")
+{
+    Object* obj = new Object;
+    Layer* layer = obj->addNewBitmapLayer();
+    for (int i = 2; i <= 1000; i++)
+    {
+        layer->addNewKeyFrameAt(i);
+    }
+    layer->clearDirtyFrames();
+
+    layer->setFrameSelected(10, true);
+    layer->extendSelectionTo(1000);
+    layer->moveSelectedFrames(100);
+    REQUIRE(layer->dirtyFrames().ranges() == (QList<FrameRange>() << FrameRange(10, 1100)));
+
+    layer->clearDirtyFrames();
+    layer->markFrameAsDirty(3);
+    layer->setFrameSelected(500, true);
+    layer->moveSelectedFrames(-2);
+    REQUIRE(layer->dirtyFrames().ranges() == (QList<FrameRange>() << FrameRange(3, 3) << FrameRange(498, 500)));
+
+    delete obj;
+}
@@ -0,0 +1,163 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "catch.hpp"
+
+#include <memory>
+#include <random>
+#include "keyframe.h"
+#include "keyframeindex.h"
+#include "layerbitmap.h"
+#include "object.h"
+
+
+// the reference lookup, on the map as Layer used to do it
+static KeyFrame* lastKeyInMap(const KeyFrameIndex::KeyMap& keys, int frame)
+{
+    auto it = keys.lower_bound(frame);
+    return (it != keys.end()) ? it->second : nullptr;
+}
+
+TEST_CASE("KeyFrameIndex", "[KeyFrameIndex]")
+{
+    std::vector<std::unique_ptr<KeyFrame>> storage;
+    KeyFrameIndex::KeyMap keys;
+    auto addKey = [&](int pos, int length)
+    {
+        storage.emplace_back(new KeyFrame);
+        storage.back()->setPos(pos);
+        storage.back()->setLength(length);
+        keys[pos] = storage.back().get();
+    };
+
+    KeyFrameIndex index;
+    REQUIRE_FALSE(index.isValid());
+
+    SECTION("No keys")
+    {
+        index.rebuild(keys);
+        REQUIRE(index.isValid());
+        REQUIRE(index.lastKeyFrameAt(1) == nullptr);
+        REQUIRE(index.keyFrameWhichCovers(1) == nullptr);
+    }
+
+    SECTION("Last key at a frame")
+    {
+        addKey(3, 1);
+        addKey(7, 1);
+        addKey(8, 1);
+        index.rebuild(keys);
+
+        REQUIRE(index.count() == 3);
+        REQUIRE(index.lastKeyFrameAt(2) == nullptr);
+        REQUIRE(index.lastKeyFrameAt(3) == keys[3]);
+        REQUIRE(index.lastKeyFrameAt(6) == keys[3]);
+        REQUIRE(index.lastKeyFrameAt(7) == keys[7]);
+        REQUIRE(index.lastKeyFrameAt(1000) == keys[8]);
+    }
+
+    SECTION("Keys cover their length")
+    {
+        addKey(1, 1);
+        addKey(5, 3);
+        index.rebuild(keys);
+
+        REQUIRE(index.keyFrameWhichCovers(1) == keys[1]);
+        REQUIRE(index.keyFrameWhichCovers(2) == nullptr);
+        REQUIRE(index.keyFrameWhichCovers(7) == keys[5]);
+        REQUIRE(index.keyFrameWhichCovers(8) == nullptr);
+    }
+
+    SECTION("The cached range agrees with the search")
+    {
+        std::mt19937 rng(3);
+        std::uniform_int_distribution<int> position(1, 300);
+        for (int i = 0; i < 60; i++)
+        {
+            const int pos = position(rng);
+            if (keys.find(pos) == keys.end())
+            {
+                addKey(pos, 1);
+            }
+        }
+
+        // set before and after the index is built
+        index.setCachedRange(50, 250);
+        index.rebuild(keys);
+        REQUIRE(index.isCached(50));
+        REQUIRE_FALSE(index.isCached(251));
+        for (int frame = 1; frame <= 320; frame++)
+        {
+            REQUIRE(index.lastKeyFrameAt(frame) == lastKeyInMap(keys, frame));
+        }
+
+        index.setCachedRange(1, 400);
+        for (int frame = 1; frame <= 400; frame++)
+        {
+            REQUIRE(index.lastKeyFrameAt(frame) == lastKeyInMap(keys, frame));
+        }
+
+        index.clearCachedRange();
+        REQUIRE_FALSE(index.isCached(1));
+    }
+}
+
+TEST_CASE("Layer keyframe lookups", "[KeyFrameIndex]")
+{
+    Object* obj = new Object;
+    Layer* layer = obj->addNewBitmapLayer();
+    layer->addNewKeyFrameAt(2);
+    layer->addNewKeyFrameAt(10);
+
+    SECTION("The index follows the keys")
+    {
+        REQUIRE(layer->getLastKeyFrameAtPosition(5)->pos() == 2);
+
+        layer->addNewKeyFrameAt(4);
+        REQUIRE(layer->getLastKeyFrameAtPosition(5)->pos() == 4);
+
+        layer->removeKeyFrame(4);
+        REQUIRE(layer->getLastKeyFrameAtPosition(5)->pos() == 2);
+
+        layer->setFrameSelected(2, true);
+        layer->moveSelectedFrames(4);
+        REQUIRE(layer->getLastKeyFrameAtPosition(5) == nullptr);
+        REQUIRE(layer->getLastKeyFrameAtPosition(6)->pos() == 6);
+
+        layer->swapKeyFrames(6, 10);
+        REQUIRE(layer->getKeyFrameWhichCovers(6)->pos() == 6);
+        REQUIRE(layer->getKeyFrameWhichCovers(7) == nullptr);
+    }
+
+    SECTION("Frames before the first one")
+    {
+        layer->addNewKeyFrameAt(1);
+        REQUIRE(layer->getLastKeyFrameAtPosition(0)->pos() == 1);
+        REQUIRE(layer->getKeyFrameWhichCovers(-5)->pos() == 1);
+    }
+
+    SECTION("Changes during playback")
+    {
+        layer->setCachedFrameRange(1, 20);
+        REQUIRE(layer->getLastKeyFrameAtPosition(15)->pos() == 10);
+
+        layer->addNewKeyFrameAt(12);
+        REQUIRE(layer->getLastKeyFrameAtPosition(15)->pos() == 12);
+        layer->clearCachedFrameRange();
+        REQUIRE(layer->getLastKeyFrameAtPosition(15)->pos() == 12);
+    }
+
+    delete obj;
+}
@@ -0,0 +1,125 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "catch.hpp"
+
+#include "keyframeselection.h"
+#include "layerbitmap.h"
+#include "object.h"
+
+
+TEST_CASE("KeyFrameSelection", "[KeyFrameSelection]")
+{
+    KeyFrameSelection selection;
+
+    SECTION("Positions are kept in order")
+    {
+        REQUIRE(selection.insert(30));
+        REQUIRE(selection.insert(5));
+        REQUIRE(selection.insert(12));
+        REQUIRE_FALSE(selection.insert(12));
+
+        REQUIRE(selection.count() == 3);
+        REQUIRE(selection.positions() == (QList<int>() << 5 << 12 << 30));
+        REQUIRE(selection.first() == 5);
+        REQUIRE(selection.last() == 30);
+        REQUIRE(selection.contains(12));
+        REQUIRE_FALSE(selection.contains(13));
+        REQUIRE_FALSE(selection.contains(1000));
+        REQUIRE_FALSE(selection.contains(-1));
+    }
+
+    SECTION("The last selected position")
+    {
+        REQUIRE(selection.lastSelected() == 0);
+        selection.insert(QList<int>() << 8 << 3 << 20);
+        REQUIRE(selection.lastSelected() == 20);
+
+        selection.remove(20);
+        REQUIRE(selection.lastSelected() == 3);
+        REQUIRE_FALSE(selection.remove(20));
+
+        // selecting again doesn't change the order
+        selection.insert(8);
+        REQUIRE(selection.lastSelected() == 3);
+    }
+
+    SECTION("Shifting the selection")
+    {
+        selection.insert(QList<int>() << 10 << 2 << 6);
+        selection.shift(5);
+        REQUIRE(selection.positions() == (QList<int>() << 7 << 11 << 15));
+        REQUIRE(selection.lastSelected() == 11);
+        REQUIRE(selection.contains(7));
+        REQUIRE_FALSE(selection.contains(2));
+
+        selection.shift(-6);
+        REQUIRE(selection.positions() == (QList<int>() << 1 << 5 << 9));
+        REQUIRE(selection.lastSelected() == 5);
+    }
+
+    SECTION("Clearing")
+    {
+        selection.insert(QList<int>() << 1 << 2 << 3);
+        selection.clear();
+        REQUIRE(selection.isEmpty());
+        REQUIRE_FALSE(selection.contains(2));
+        REQUIRE(selection.lastSelected() == 0);
+    }
+}
+
+TEST_CASE("Layer frame selection", "[KeyFrameSelection]")
+{
+    Object* obj = new Object;
+    Layer* layer = obj->addNewBitmapLayer();
+    for (int i = 2; i <= 20; i++)
+    {
+        layer->addNewKeyFrameAt(i);
+    }
+
+    SECTION("Extending the selection selects the keys in between")
+    {
+        layer->setFrameSelected(15, true);
+        layer->extendSelectionTo(5);
+
+        REQUIRE(layer->getSelectedFrameList().size() == 11);
+        REQUIRE(layer->isFrameSelected(5));
+        REQUIRE(layer->isFrameSelected(15));
+        REQUIRE_FALSE(layer->isFrameSelected(4));
+        REQUIRE(layer->getKeyFrameAt(10)->isSelected());
+
+        // the keys of the range were selected from the first one to the last one
+        layer->setFrameSelected(2, true);
+        layer->setFrameSelected(2, false);
+        layer->extendSelectionTo(18);
+        REQUIRE(layer->getSelectedFrameList().size() == 14);
+        REQUIRE_FALSE(layer->isFrameSelected(4));
+    }
+
+    SECTION("Moving the selection moves the selected positions")
+    {
+        layer->setFrameSelected(3, true);
+        layer->setFrameSelected(4, true);
+        layer->deselectAll();
+        REQUIRE(layer->getSelectedFrameList().isEmpty());
+
+        layer->setFrameSelected(20, true);
+        REQUIRE(layer->moveSelectedFrames(3));
+        REQUIRE(layer->getSelectedFrameList() == (QList<int>() << 23));
+        REQUIRE(layer->isFrameSelected(23));
+    }
+
+    delete obj;
+}
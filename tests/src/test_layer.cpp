@@ -15,11 +15,14 @@ GNU General Public License for more details.
 */
 #include "catch.hpp"
 
+#include <map>
+#include <random>
 #include "layer.h"
 #include "layerbitmap.h"
 #include "layervector.h"
 #include "layercamera.h"
 #include "layersound.h"
+#include "soundclip.h"
 #include "object.h"
 #include "util.h"
 
@@ -341,3 +344,233 @@ TEST_CASE("Layer::getPreviousFrameNumber()")
     }
     delete obj;
 }
+
+TEST_CASE("Layer::foreachKeyFrameInRange()")
+{
+    Object* obj = new Object;
+
+    auto positionsInRange = [](Layer* layer, int from, int to)
+    {
+        QList<int> positions;
+        layer->foreachKeyFrameInRange(from, to, [&positions](KeyFrame* key)
+        {
+            positions.append(key->pos());
+        });
+        return positions;
+    };
+
+    SECTION("Bitmap")
+    {
+        Layer* layer = obj->addNewBitmapLayer();
+        for (int i = 5; i <= 100; i += 5)
+        {
+            CHECK(layer->addNewKeyFrameAt(i));
+        }
+
+        // from the last key to the first one, like foreachKeyFrame()
+        REQUIRE(positionsInRange(layer, 10, 20) == (QList<int>() << 20 << 15 << 10));
+        REQUIRE(positionsInRange(layer, 11, 14).isEmpty());
+        REQUIRE(positionsInRange(layer, 96, 200) == (QList<int>() << 100));
+        REQUIRE(positionsInRange(layer, 0, 1) == (QList<int>() << 1));
+        REQUIRE(positionsInRange(layer, 1, 1000).size() == layer->keyFrameCount());
+    }
+
+    SECTION("A sound clip reaching into the range")
+    {
+        Layer* layer = obj->addNewSoundLayer();
+        SoundClip* clip = new SoundClip;
+        clip->setLength(10);
+        CHECK(layer->addKeyFrame(3, clip));
+
+        REQUIRE(positionsInRange(layer, 8, 20) == (QList<int>() << 3));
+        REQUIRE(positionsInRange(layer, 12, 20) == (QList<int>() << 3));
+        REQUIRE(positionsInRange(layer, 13, 20).isEmpty());
+    }
+
+    delete obj;
+}
+
+TEST_CASE("Layer::keyFrameRevision()")
+{
+    Object* obj = new Object;
+    Layer* layer = obj->addNewBitmapLayer();
+    Layer* other = obj->addNewVectorLayer();
+    REQUIRE(layer->keyFrameRevision() != other->keyFrameRevision());
+
+    quint64 revision = layer->keyFrameRevision();
+    auto changed = [&]()
+    {
+        bool isChanged = (layer->keyFrameRevision() != revision);
+        revision = layer->keyFrameRevision();
+        return isChanged;
+    };
+
+    CHECK(layer->addNewKeyFrameAt(5));
+    REQUIRE(changed());
+
+    layer->setFrameSelected(5, true);
+    REQUIRE(changed());
+
+    layer->moveSelectedFrames(2);
+    REQUIRE(changed());
+    REQUIRE(layer->keyExists(7));
+
+    layer->deselectAll();
+    REQUIRE(changed());
+
+    layer->removeKeyFrame(7);
+    REQUIRE(changed());
+
+    layer->keyExists(1);
+    REQUIRE_FALSE(changed());
+
+    delete obj;
+}
+
+TEST_CASE("Layer::moveSelectedFrames()")
+{
+    Object* obj = new Object;
+    Layer* layer = obj->addNewBitmapLayer();
+
+    auto positions = [layer]()
+    {
+        QList<int> list;
+        layer->foreachKeyFrame([&list](KeyFrame* key) { list.prepend(key->pos()); });
+        return list;
+    };
+
+    SECTION("The keys passed over slide back")
+    {
+        for (int i = 2; i <= 5; i++)
+        {
+            layer->addNewKeyFrameAt(i);
+        }
+        KeyFrame* key2 = layer->getKeyFrameAt(2);
+        KeyFrame* key3 = layer->getKeyFrameAt(3);
+
+        layer->setFrameSelected(2, true);
+        REQUIRE(layer->moveSelectedFrames(2));
+        REQUIRE(positions() == (QList<int>() << 1 << 2 << 3 << 4 << 5));
+        REQUIRE(layer->getKeyFrameAt(4) == key2);
+        REQUIRE(layer->getKeyFrameAt(2) == key3);
+        REQUIRE(key2->pos() == 4);
+        REQUIRE(layer->isFrameSelected(4));
+
+        REQUIRE(layer->moveSelectedFrames(-3));
+        REQUIRE(layer->getKeyFrameAt(1) == key2);
+        REQUIRE_FALSE(layer->moveSelectedFrames(-1));
+    }
+
+    SECTION("Empty frames slide back too")
+    {
+        layer->addNewKeyFrameAt(2);
+        layer->addNewKeyFrameAt(5);
+
+        layer->setFrameSelected(2, true);
+        layer->moveSelectedFrames(2);
+        REQUIRE(positions() == (QList<int>() << 1 << 4 << 5));
+    }
+
+    SECTION("Several keys")
+    {
+        for (int i = 2; i <= 10; i++)
+        {
+            layer->addNewKeyFrameAt(i);
+        }
+        layer->removeKeyFrame(7);
+
+        layer->setFrameSelected(3, true);
+        layer->setFrameSelected(5, true);
+        layer->setFrameSelected(6, true);
+        KeyFrame* key3 = layer->getKeyFrameAt(3);
+        KeyFrame* key8 = layer->getKeyFrameAt(8);
+
+        layer->moveSelectedFrames(3);
+        REQUIRE(positions() == (QList<int>() << 1 << 2 << 3 << 5 << 6 << 7 << 8 << 9 << 10));
+        REQUIRE(layer->getKeyFrameAt(6) == key3);
+        REQUIRE(layer->getKeyFrameAt(5) == key8);
+        REQUIRE(layer->getSelectedFrameList() == (QList<int>() << 6 << 8 << 9));
+    }
+
+    delete obj;
+}
+
+// Moves the selected keys one at a time, sliding the keys they pass over back one frame at a time,
+// as Layer::moveSelectedFrames() used to. The keys are ids by position.
+static std::map<int, int> slideFrameByFrame(std::map<int, int> keys, const std::vector<int>& selected, int offset)
+{
+    const int step = (offset > 0) ? -1 : 1;
+    const int count = static_cast<int>(selected.size());
+    for (int i = (offset > 0) ? count - 1 : 0; i >= 0 && i < count; i += step)
+    {
+        const int fromPos = selected[i];
+        const int toPos = fromPos + offset;
+        const int id = keys.at(fromPos);
+        keys.erase(fromPos);
+        for (int target = fromPos; target != toPos; target -= step)
+        {
+            auto it = keys.find(target - step);
+            if (it != keys.end())
+            {
+                const int slid = it->second;
+                keys.erase(it);
+                keys[target] = slid;
+            }
+        }
+        keys[toPos] = id;
+    }
+    return keys;
+}
+
+TEST_CASE("Layer::moveSelectedFrames() agrees with the frame by frame slide", "[Layer]")
+{
+    std::mt19937 rng(43);
+    for (int run = 0; run < 500; run++)
+    {
+        Object* obj = new Object;
+        Layer* layer = obj->addNewBitmapLayer();
+
+        std::map<int, int> keys;
+        std::vector<int> selected;
+        for (int position = 2; position <= 40; position++)
+        {
+            if (rng() % 2 == 0)
+            {
+                layer->addNewKeyFrameAt(position);
+            }
+        }
+        QList<KeyFrame*> ids;
+        layer->foreachKeyFrame([&](KeyFrame* key)
+        {
+            keys[key->pos()] = ids.size();
+            ids.append(key);
+        });
+        for (const auto& pair : keys)
+        {
+            if (rng() % 3 == 0)
+            {
+                selected.push_back(pair.first);
+                layer->setFrameSelected(pair.first, true);
+            }
+        }
+
+        int offset = static_cast<int>(rng() % 21) - 10;
+        if (offset == 0) { offset = 1; }
+        if (selected.empty() || selected.front() + offset < 1)
+        {
+            REQUIRE_FALSE(layer->moveSelectedFrames(offset));
+            delete obj;
+            continue;
+        }
+
+        REQUIRE(layer->moveSelectedFrames(offset));
+        const std::map<int, int> expected = slideFrameByFrame(keys, selected, offset);
+        REQUIRE(layer->keyFrameCount() == static_cast<int>(expected.size()));
+        for (const auto& pair : expected)
+        {
+            REQUIRE(layer->getKeyFrameAt(pair.first) == ids[pair.second]);
+            REQUIRE(ids[pair.second]->pos() == pair.first);
+        }
+        delete obj;
+    }
+}
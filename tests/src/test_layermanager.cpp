@@ -18,6 +18,8 @@ GNU General Public License for more details.
 #include "object.h"
 #include "editor.h"
 #include "layermanager.h"
+#include "layersound.h"
+#include "soundclip.h"
 #include "pencilerror.h"
 
 
@@ -92,3 +94,76 @@ TEST_CASE("LayerManager::deleteLayer()")
     }
     delete editor;
 }
+
+TEST_CASE("LayerManager::animationLength()")
+{
+    Object* object = new Object;
+    Editor* editor = new Editor;
+    editor->setObject(object);
+
+    LayerManager* layerMgr = new LayerManager(editor);
+    layerMgr->init();
+    object->init();
+
+    SECTION("Follows the keyframes")
+    {
+        Layer* bitmap = layerMgr->createBitmapLayer("Bitmap1");
+        REQUIRE(layerMgr->animationLength() == 1);
+
+        bitmap->addNewKeyFrameAt(20);
+        REQUIRE(layerMgr->animationLength() == 20);
+
+        bitmap->removeKeyFrame(20);
+        REQUIRE(layerMgr->animationLength() == 1);
+
+        bitmap->setFrameSelected(1, true);
+        bitmap->moveSelectedFrames(9);
+        REQUIRE(layerMgr->animationLength() == 10);
+
+        layerMgr->createBitmapLayer("Bitmap2")->addNewKeyFrameAt(30);
+        REQUIRE(layerMgr->animationLength() == 30);
+        layerMgr->deleteLayer(1);
+        REQUIRE(layerMgr->animationLength() == 10);
+    }
+
+    SECTION("Sounds count with their length")
+    {
+        layerMgr->createBitmapLayer("Bitmap1")->addNewKeyFrameAt(8);
+
+        LayerSound* sound = layerMgr->createSoundLayer("Sound1");
+        SoundClip* clip = new SoundClip;
+        clip->setLength(10);
+        sound->addKeyFrame(5, clip);
+        REQUIRE(layerMgr->animationLength(true) == 14);
+        REQUIRE(layerMgr->animationLength(false) == 8);
+
+        clip->setLength(2);
+        sound->keyFramesChanged();
+        REQUIRE(layerMgr->animationLength(true) == 8);
+    }
+
+    SECTION("Changes are notified once per batch")
+    {
+        Layer* bitmap = layerMgr->createBitmapLayer("Bitmap1");
+        QList<int> lengths;
+        QObject::connect(layerMgr, &LayerManager::animationLengthChanged, [&lengths](int length)
+        {
+            lengths.append(length);
+        });
+
+        {
+            LayerManager::BatchUpdate batchUpdate(layerMgr);
+            for (int i = 2; i <= 100; i++)
+            {
+                bitmap->addNewKeyFrameAt(i);
+                layerMgr->notifyAnimationLengthChanged();
+            }
+            REQUIRE(lengths.isEmpty());
+        }
+        REQUIRE(lengths == QList<int>() << 100);
+
+        layerMgr->notifyAnimationLengthChanged();
+        REQUIRE(lengths.size() == 2);
+    }
+    delete editor;
+}
@@ -0,0 +1,83 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "catch.hpp"
+
+#include <QCoreApplication>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include "object.h"
+#include "editor.h"
+#include "scribblearea.h"
+#include "layerbitmap.h"
+#include "bitmapimage.h"
+#include "layermanager.h"
+#include "toolmanager.h"
+#include "viewmanager.h"
+
+
+static void sendMouse(ScribbleArea* scribbleArea, QEvent::Type type, QPointF pos, Qt::MouseButtons buttons)
+{
+    QMouseEvent event(type, pos, Qt::LeftButton, buttons, Qt::NoModifier);
+    QCoreApplication::sendEvent(scribbleArea, &event);
+}
+
+TEST_CASE("ScribbleArea: Escape cancels an eraser stroke", "[ScribbleArea]")
+{
+    // same initialize order as MainWindow2
+    Editor* editor = new Editor;
+    ScribbleArea* scribbleArea = new ScribbleArea(nullptr);
+    editor->setScribbleArea(scribbleArea);
+    editor->init();
+
+    Object* object = new Object;
+    object->init();
+    object->createDefaultLayers();
+    editor->setObject(object);
+
+    scribbleArea->setEditor(editor);
+    scribbleArea->init();
+    scribbleArea->resize(400, 300);
+    scribbleArea->show();
+
+    REQUIRE(editor->layers()->currentLayer()->type() == Layer::BITMAP);
+    auto layer = static_cast<LayerBitmap*>(editor->layers()->currentLayer());
+    BitmapImage* frame = layer->getBitmapImageAtFrame(editor->currentFrame());
+    REQUIRE(frame != nullptr);
+
+    frame->drawRect(QRectF(-100, -100, 200, 200), Qt::NoPen, QBrush(Qt::green), QPainter::CompositionMode_SourceOver, false);
+    const QImage before = frame->image()->copy();
+    const QRect beforeBounds = frame->bounds();
+
+    editor->tools()->setCurrentTool(ERASER);
+
+    const QPointF from = editor->view()->mapCanvasToScreen(QPointF(-50, 0));
+    const QPointF to = editor->view()->mapCanvasToScreen(QPointF(50, 0));
+    sendMouse(scribbleArea, QEvent::MouseButtonPress, from, Qt::LeftButton);
+    sendMouse(scribbleArea, QEvent::MouseMove, (from + to) / 2, Qt::LeftButton);
+    sendMouse(scribbleArea, QEvent::MouseMove, to, Qt::LeftButton);
+
+    QKeyEvent escape(QEvent::KeyPress, Qt::Key_Escape, Qt::NoModifier);
+    QCoreApplication::sendEvent(scribbleArea, &escape);
+
+    sendMouse(scribbleArea, QEvent::MouseButtonRelease, to, Qt::NoButton);
+    editor->tools()->finishPendingStrokes();
+
+    REQUIRE(frame->bounds() == beforeBounds);
+    REQUIRE(*frame->image() == before);
+
+    delete editor;
+    delete scribbleArea;
+}
@@ -0,0 +1,142 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "catch.hpp"
+
+#include <random>
+#include "smudgeengine.h"
+#include "bitmapimage.h"
+
+
+// a frame with its left half red and its right half transparent
+static QImage halfRedFrame(int width, int height)
+{
+    QImage frame(width, height, QImage::Format_ARGB32_Premultiplied);
+    frame.fill(Qt::transparent);
+    for (int y = 0; y < height; y++)
+    {
+        QRgb* line = reinterpret_cast<QRgb*>(frame.scanLine(y));
+        std::fill(line, line + width / 2, qRgba(255, 0, 0, 255));
+    }
+    return frame;
+}
+
+static QList<QPointF> horizontalStroke(qreal fromX, qreal toX, qreal y, qreal step)
+{
+    QList<QPointF> points;
+    for (qreal x = fromX + step; x <= toX; x += step)
+    {
+        points.append(QPointF(x, y));
+    }
+    return points;
+}
+
+TEST_CASE("SmudgeEngine", "[SmudgeEngine]")
+{
+    SmudgeEngine engine;
+    SmudgeEngine::Brush brush;
+    brush.diameter = 10.0;
+
+    const QImage frame = halfRedFrame(100, 40);
+    QImage buffer(100, 40, QImage::Format_ARGB32_Premultiplied);
+    buffer.fill(Qt::transparent);
+
+    SECTION("Smudging drags the paint along")
+    {
+        engine.drawStroke(frame, QPoint(0, 0), buffer, QPoint(0, 0), QPointF(45, 20),
+                          horizontalStroke(45, 65, 20, 2), brush, SmudgeEngine::Smudge);
+
+        // red is carried past the edge of the frame paint, no further than the stroke
+        REQUIRE(qRed(buffer.pixel(55, 20)) > 0);
+        REQUIRE(buffer.pixel(90, 20) == qRgba(0, 0, 0, 0));
+        REQUIRE(buffer.pixel(55, 2) == qRgba(0, 0, 0, 0));
+
+        // the frame is only read
+        REQUIRE(frame == halfRedFrame(100, 40));
+    }
+
+    SECTION("Smudging transparent pixels leaves nothing")
+    {
+        engine.drawStroke(frame, QPoint(0, 0), buffer, QPoint(0, 0), QPointF(70, 20),
+                          horizontalStroke(70, 90, 20, 2), brush, SmudgeEngine::Smudge);
+        for (int x = 0; x < buffer.width(); x++)
+        {
+            REQUIRE(qAlpha(buffer.pixel(x, 20)) == 0);
+        }
+    }
+
+    SECTION("Liquify pushes the pixels under the center of the brush")
+    {
+        engine.drawStroke(frame, QPoint(0, 0), buffer, QPoint(0, 0), QPointF(46, 20),
+                          QList<QPointF>() << QPointF(50, 20), brush, SmudgeEngine::Liquify);
+
+        // the center moved 4 px right, the red edge came along
+        REQUIRE(buffer.pixel(51, 20) == qRgba(255, 0, 0, 255));
+        REQUIRE(qAlpha(buffer.pixel(58, 20)) == 0);
+    }
+
+    SECTION("Frame and buffer at different canvas positions")
+    {
+        // the frame covers the canvas from (-50, -20), the buffer from (0, 0)
+        engine.drawStroke(frame, QPoint(-50, -20), buffer, QPoint(0, 0), QPointF(10, 0),
+                          horizontalStroke(10, 20, 0, 2), brush, SmudgeEngine::Smudge);
+        REQUIRE(qAlpha(buffer.pixel(15, 0)) == 0);
+
+        engine.drawStroke(frame, QPoint(-50, -20), buffer, QPoint(0, 0), QPointF(-4, 5),
+                          horizontalStroke(-4, 6, 5, 2), brush, SmudgeEngine::Smudge);
+        REQUIRE(qRed(buffer.pixel(3, 5)) > 0);
+    }
+
+    SECTION("SIMD and scalar blending agree")
+    {
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> byte(0, 255);
+        auto premultiplied = [&]()
+        {
+            return qPremultiply(qRgba(byte(rng), byte(rng), byte(rng), byte(rng)));
+        };
+
+        for (int run = 0; run < 1000; run++)
+        {
+            const int count = run % 37;
+            const int strength = byte(rng);
+            QVector<QRgb> a(count), b(count), src(count);
+            QVector<quint8> mask(count);
+            for (int i = 0; i < count; i++)
+            {
+                a[i] = b[i] = premultiplied();
+                src[i] = premultiplied();
+                mask[i] = (byte(rng) < 64) ? 0 : quint8(byte(rng));
+            }
+            SmudgeEngine::blendRow(a.data(), src.constData(), mask.constData(), count, strength);
+            SmudgeEngine::blendRowScalar(b.data(), src.constData(), mask.constData(), count, strength);
+            REQUIRE(a == b);
+        }
+    }
+}
+
+TEST_CASE("BitmapImage::drawSmudge()", "[SmudgeEngine]")
+{
+    SmudgeEngine engine;
+    SmudgeEngine::Brush brush;
+    brush.diameter = 10.0;
+
+    BitmapImage frame(QPoint(0, 0), halfRedFrame(100, 40));
+    BitmapImage buffer;
+    buffer.drawSmudge(engine, &frame, QPointF(45, 20), horizontalStroke(45, 65, 20, 2), brush, SmudgeEngine::Smudge);
+
+    REQUIRE(buffer.bounds().contains(QPoint(65, 20)));
+    REQUIRE(qRed(buffer.pixel(55, 20)) > 0);
+}
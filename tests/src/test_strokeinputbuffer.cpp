@@ -0,0 +1,304 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "catch.hpp"
+
+#include <random>
+#include <thread>
+#include <QLineF>
+#include "pencildef.h"
+#include "strokeinputbuffer.h"
+#include "strokestabilizer.h"
+#include "strokelatencymonitor.h"
+#include "strokemanager.h"
+
+
+static StrokeSample sampleAt(qreal x, qreal y, quint64 timestamp = 0)
+{
+    StrokeSample sample;
+    sample.pos = QPointF(x, y);
+    sample.timestamp = timestamp;
+    return sample;
+}
+
+TEST_CASE("StrokeInputBuffer", "[StrokeInputBuffer]")
+{
+    StrokeInputBuffer buffer(8);
+    QVector<StrokeSample> samples;
+
+    SECTION("Samples are read in order, once")
+    {
+        for (int i = 0; i < 5; i++)
+        {
+            REQUIRE(buffer.push(sampleAt(i, 0, i)));
+        }
+        REQUIRE(buffer.read(samples) == 5);
+        REQUIRE(samples.size() == 5);
+        for (int i = 0; i < 5; i++)
+        {
+            REQUIRE(samples[i].timestamp == quint64(i));
+        }
+        REQUIRE(buffer.read(samples) == 0);
+    }
+
+    SECTION("A full buffer drops and counts the new samples")
+    {
+        int pushed = 0;
+        while (buffer.push(sampleAt(pushed, 0, pushed)))
+        {
+            pushed++;
+        }
+        REQUIRE(pushed == buffer.capacity());
+        REQUIRE(buffer.droppedCount() == 1);
+
+        buffer.read(samples);
+        REQUIRE(samples.size() == pushed);
+        REQUIRE(samples.last().timestamp == quint64(pushed - 1));
+    }
+
+    SECTION("Reading and writing around the end of the ring")
+    {
+        quint64 next = 0;
+        quint64 expected = 0;
+        for (int round = 0; round < 10; round++)
+        {
+            for (int i = 0; i < 5; i++)
+            {
+                REQUIRE(buffer.push(sampleAt(0, 0, next++)));
+            }
+            samples.clear();
+            buffer.read(samples);
+            for (const StrokeSample& sample : samples)
+            {
+                REQUIRE(sample.timestamp == expected++);
+            }
+        }
+        REQUIRE(expected == next);
+    }
+
+    SECTION("Discarded samples are not read")
+    {
+        buffer.push(sampleAt(1, 1));
+        buffer.push(sampleAt(2, 2));
+        buffer.discard();
+        REQUIRE(buffer.read(samples) == 0);
+
+        buffer.push(sampleAt(3, 3));
+        REQUIRE(buffer.read(samples) == 1);
+        REQUIRE(samples[0].pos == QPointF(3, 3));
+    }
+}
+
+TEST_CASE("StrokeInputBuffer across threads", "[StrokeInputBuffer]")
+{
+    const quint64 sampleCount = 200000;
+    StrokeInputBuffer buffer(256);
+
+    std::thread producer([&buffer, sampleCount]()
+    {
+        for (quint64 i = 0; i < sampleCount; i++)
+        {
+            while (!buffer.push(sampleAt(0, 0, i)))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    QVector<StrokeSample> samples;
+    quint64 expected = 0;
+    bool inOrder = true;
+    while (expected < sampleCount)
+    {
+        samples.clear();
+        buffer.read(samples);
+        for (const StrokeSample& sample : samples)
+        {
+            inOrder = inOrder && (sample.timestamp == expected);
+            expected++;
+        }
+    }
+    producer.join();
+
+    REQUIRE(inOrder);
+    REQUIRE(expected == sampleCount);
+}
+
+TEST_CASE("StrokeStabilizer", "[StrokeInputBuffer]")
+{
+    StrokeStabilizer stabilizer;
+
+    SECTION("No stabilization")
+    {
+        stabilizer.reset(StabilizationLevel::NONE, QPointF(0, 0));
+        REQUIRE(stabilizer.filter(sampleAt(10, 5)).pos == QPointF(10, 5));
+        REQUIRE(stabilizer.flush().isEmpty());
+    }
+
+    SECTION("Only the position is smoothed")
+    {
+        stabilizer.reset(StabilizationLevel::SIMPLE, QPointF(0, 0));
+        StrokeSample sample = sampleAt(10, 0, 42);
+        sample.pressure = 0.3;
+        sample.xTilt = 12.0;
+
+        const StrokeSample result = stabilizer.filter(sample);
+        REQUIRE(result.pos == QPointF(5, 0));
+        REQUIRE(result.pressure == 0.3);
+        REQUIRE(result.xTilt == 12.0);
+        REQUIRE(result.timestamp == 42);
+    }
+
+    SECTION("Stronger stabilization shakes less")
+    {
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<qreal> jitter(-3.0, 3.0);
+
+        auto shake = [&](int level)
+        {
+            rng.seed(11);
+            stabilizer.reset(level, QPointF(0, 0));
+            qreal total = 0;
+            QPointF last(0, 0);
+            for (int i = 0; i < 500; i++)
+            {
+                const QPointF pos = stabilizer.filter(sampleAt(i, jitter(rng))).pos;
+                total += qAbs(pos.y() - last.y());
+                last = pos;
+            }
+            return total;
+        };
+
+        const qreal none = shake(StabilizationLevel::NONE);
+        const qreal simple = shake(StabilizationLevel::SIMPLE);
+        const qreal strong = shake(StabilizationLevel::STRONG);
+        REQUIRE(simple < none);
+        REQUIRE(strong < simple);
+    }
+
+    SECTION("Flushing catches up with the pen")
+    {
+        for (int level : { int(StabilizationLevel::SIMPLE), int(StabilizationLevel::STRONG) })
+        {
+            stabilizer.reset(level, QPointF(0, 0));
+            stabilizer.filter(sampleAt(100, 0));
+
+            const QVector<StrokeSample> tail = stabilizer.flush();
+            REQUIRE_FALSE(tail.isEmpty());
+            REQUIRE(QLineF(tail.last().pos, QPointF(100, 0)).length() <= 0.5);
+        }
+    }
+}
+
+TEST_CASE("StrokeLatencyMonitor", "[StrokeInputBuffer]")
+{
+    StrokeLatencyMonitor monitor;
+    const qint64 MS = 1000000;
+
+    SECTION("Nothing measured")
+    {
+        monitor.presented(10 * MS);
+        REQUIRE(monitor.count() == 0);
+        REQUIRE(monitor.meanMs() == 0.0);
+        REQUIRE(monitor.percentileMs(95.0) == 0.0);
+    }
+
+    SECTION("Samples are measured at the first paint after they are read")
+    {
+        for (int i = 1; i <= 10; i++)
+        {
+            monitor.sampleRead(i * MS);
+        }
+        monitor.presented(12 * MS);
+        monitor.presented(20 * MS);
+
+        // latencies of 2 to 11 ms
+        REQUIRE(monitor.count() == 10);
+        REQUIRE(monitor.meanMs() == Approx(6.5));
+        REQUIRE(monitor.maxMs() == Approx(11.0));
+        REQUIRE(monitor.percentileMs(50.0) == Approx(6.0));
+        REQUIRE(monitor.percentileMs(100.0) == Approx(11.0));
+
+        monitor.reset();
+        REQUIRE(monitor.count() == 0);
+    }
+
+    SECTION("Percentiles cover the latest samples only")
+    {
+        const int count = StrokeLatencyMonitor::RECENT_COUNT;
+        for (int i = 0; i < count; i++)
+        {
+            monitor.sampleRead(1);
+        }
+        monitor.presented(1 + 100 * MS);
+        for (int i = 0; i < count; i++)
+        {
+            monitor.sampleRead(1);
+        }
+        monitor.presented(1 + 2 * MS);
+
+        REQUIRE(monitor.count() == 2 * count);
+        REQUIRE(monitor.meanMs() == Approx(51.0));
+        REQUIRE(monitor.maxMs() == Approx(100.0));
+        REQUIRE(monitor.percentileMs(100.0) == Approx(2.0));
+    }
+
+    SECTION("The clock moves forward")
+    {
+        const qint64 before = StrokeLatencyMonitor::now();
+        REQUIRE(StrokeLatencyMonitor::now() >= before);
+    }
+}
+
+TEST_CASE("StrokeManager::extrapolate()", "[StrokeInputBuffer]")
+{
+    QVector<StrokeSample> recent;
+
+    SECTION("Not enough samples to know where the stroke goes")
+    {
+        REQUIRE(StrokeManager::extrapolate(recent, 16.0).isEmpty());
+        recent << sampleAt(0, 0, 10);
+        REQUIRE(StrokeManager::extrapolate(recent, 16.0).isEmpty());
+        recent << sampleAt(5, 0, 10);
+        REQUIRE(StrokeManager::extrapolate(recent, 16.0).isEmpty());
+    }
+
+    SECTION("The stroke continues at the same velocity")
+    {
+        // 1 px per ms to the right, 0.5 px per ms down
+        recent << sampleAt(0, 0, 100) << sampleAt(4, 2, 104) << sampleAt(8, 4, 108);
+        const QVector<StrokeSample> predicted = StrokeManager::extrapolate(recent, 16.0);
+
+        REQUIRE(predicted.size() == 4);
+        REQUIRE(predicted.first().pos.x() == Approx(12.0));
+        REQUIRE(predicted.last().pos.x() == Approx(24.0));
+        REQUIRE(predicted.last().pos.y() == Approx(12.0));
+        REQUIRE(predicted.last().timestamp == 124);
+        REQUIRE(predicted.last().received == 0);
+    }
+
+    SECTION("Pressure follows its trend, within range")
+    {
+        StrokeSample a = sampleAt(0, 0, 0);
+        StrokeSample b = sampleAt(10, 0, 10);
+        a.pressure = 0.5;
+        b.pressure = 0.9;
+        recent << a << b;
+
+        const QVector<StrokeSample> predicted = StrokeManager::extrapolate(recent, 20.0);
+        REQUIRE(predicted.first().pressure > 0.9);
+        REQUIRE(predicted.last().pressure == 1.0);
+    }
+}
@@ -0,0 +1,100 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "catch.hpp"
+
+#include "beziercurve.h"
+#include "vectorhittester.h"
+#include "vectorfillengine.h"
+#include "vectorimage.h"
+
+
+// a closed square, cut in two by a line with vertices where it crosses the sides
+static QList<BezierCurve> squareWithLine()
+{
+    QList<BezierCurve> curves;
+    curves.append(BezierCurve(QList<QPointF>({ QPointF(0, 0), QPointF(100, 0), QPointF(100, 100),
+                                               QPointF(0, 100), QPointF(0, 0) }), false));
+    curves.append(BezierCurve(QList<QPointF>({ QPointF(-20, 50), QPointF(0, 50),
+                                               QPointF(100, 50), QPointF(120, 50) }), false));
+    return curves;
+}
+
+TEST_CASE("VectorFillEngine::findArea()", "[VectorFillEngine]")
+{
+    QList<BezierCurve> curves = squareWithLine();
+    VectorHitTester hitTester;
+    hitTester.build(curves);
+    VectorFillEngine fillEngine(curves, hitTester);
+
+    SECTION("Upper half")
+    {
+        QList<VertexRef> area = fillEngine.findArea(QPointF(50, 25), 1.0);
+        REQUIRE(area.size() == 4);
+        REQUIRE(area.contains(VertexRef(0, -1)));
+        REQUIRE(area.contains(VertexRef(0, 0)));
+        REQUIRE(area.contains(VertexRef(1, 0)));
+        REQUIRE(area.contains(VertexRef(1, 1)));
+    }
+
+    SECTION("Lower half")
+    {
+        QList<VertexRef> area = fillEngine.findArea(QPointF(50, 75), 1.0);
+        REQUIRE(area.size() == 4);
+        REQUIRE(area.contains(VertexRef(0, 1)));
+        REQUIRE(area.contains(VertexRef(0, 2)));
+        REQUIRE(area.contains(VertexRef(1, 0)));
+        REQUIRE(area.contains(VertexRef(1, 1)));
+    }
+
+    SECTION("Open or outside areas")
+    {
+        REQUIRE(fillEngine.findArea(QPointF(110, 75), 1.0).isEmpty());
+        REQUIRE(fillEngine.findArea(QPointF(500, 500), 1.0).isEmpty());
+    }
+
+    SECTION("Coarse view")
+    {
+        // zoomed out, the mask is much coarser but the square is still closed
+        REQUIRE(fillEngine.findArea(QPointF(50, 25), 0.1).size() == 4);
+    }
+}
+
+TEST_CASE("VectorImage::fillAreaAt()", "[VectorFillEngine]")
+{
+    VectorImage image;
+    QList<BezierCurve> curves = squareWithLine();
+    for (BezierCurve& curve : curves)
+    {
+        image.addCurve(curve, 1.0, false);
+    }
+
+    REQUIRE(image.fillAreaAt(QPointF(50, 25), 2, 1.0));
+    REQUIRE(image.mArea.size() == 1);
+    REQUIRE(image.mArea[0].getColorNumber() == 2);
+    REQUIRE(image.mArea[0].mPath.contains(QPointF(50, 25)));
+    REQUIRE_FALSE(image.mArea[0].mPath.contains(QPointF(50, 75)));
+
+    REQUIRE_FALSE(image.fillAreaAt(QPointF(-10, 75), 2, 1.0));
+    REQUIRE(image.mArea.size() == 1);
+
+    // filling the area again doesn't stack another one on top
+    REQUIRE(image.fillAreaAt(QPointF(50, 25), 2, 1.0));
+    REQUIRE(image.mArea.size() == 1);
+
+    REQUIRE(image.fillAreaAt(QPointF(50, 25), 3, 1.0));
+    REQUIRE(image.mArea.size() == 1);
+    REQUIRE(image.mArea[0].getColorNumber() == 3);
+}
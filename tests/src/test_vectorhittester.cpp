@@ -0,0 +1,155 @@
+/*
+
+Pencil2D - Traditional Animation Software
+Copyright (C) 2012-2020 Matthew Chiawen Chang
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+*/
+#include "catch.hpp"
+
+#include <random>
+#include "beziercurve.h"
+#include "vectorhittester.h"
+#include "vectorimage.h"
+
+
+// deterministic wiggly strokes spread over a size x size area
+static QList<BezierCurve> randomCurves(int count, qreal size)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<qreal> coord(0.0, size);
+    std::uniform_real_distribution<qreal> step(-20.0, 20.0);
+
+    QList<BezierCurve> curves;
+    for (int c = 0; c < count; c++)
+    {
+        QList<QPointF> points;
+        QPointF p(coord(rng), coord(rng));
+        for (int i = 0; i < 8; i++)
+        {
+            points.append(p);
+            p += QPointF(step(rng), step(rng));
+        }
+        curves.append(BezierCurve(points, true));
+    }
+    return curves;
+}
+
+TEST_CASE("VectorHitTester queries", "[VectorHitTester]")
+{
+    QList<BezierCurve> curves;
+    curves.append(BezierCurve(QList<QPointF>({ QPointF(0, 0), QPointF(100, 0) }), false));
+    curves.append(BezierCurve(QList<QPointF>({ QPointF(0, 10), QPointF(100, 10) }), false));
+    curves.append(BezierCurve(QList<QPointF>({ QPointF(500, 500), QPointF(600, 600) }), false));
+
+    VectorHitTester hitTester;
+    REQUIRE_FALSE(hitTester.isValid());
+    hitTester.build(curves);
+    REQUIRE(hitTester.isValid());
+
+    SECTION("Curves close to a point")
+    {
+        REQUIRE(hitTester.curvesCloseTo(QPointF(50, 2), 3.0) == QList<int>({ 0 }));
+        REQUIRE(hitTester.curvesCloseTo(QPointF(50, 5), 6.0) == QList<int>({ 0, 1 }));
+        REQUIRE(hitTester.curvesCloseTo(QPointF(300, 300), 20.0).isEmpty());
+        REQUIRE(hitTester.curvesCloseTo(QPointF(50, 5), 6.0, QVector<bool>({ true, false, false })) == QList<int>({ 1 }));
+    }
+
+    SECTION("Closest curve")
+    {
+        qreal distance = 0.0;
+        REQUIRE(hitTester.closestCurveTo(QPointF(50, 7), 10.0, QVector<bool>(), &distance) == 1);
+        REQUIRE(distance == Approx(3.0).margin(0.01));
+        REQUIRE(hitTester.closestCurveTo(QPointF(550, 549), 5.0) == 2);
+        REQUIRE(hitTester.closestCurveTo(QPointF(300, 300), 5.0) == -1);
+    }
+
+    SECTION("Vertices close to a point")
+    {
+        QList<VertexRef> vertices = hitTester.verticesCloseTo(QPointF(0, 5), 6.0);
+        REQUIRE(vertices.size() == 2);
+        REQUIRE(vertices[0] == VertexRef(0, -1));
+        REQUIRE(vertices[1] == VertexRef(1, -1));
+
+        REQUIRE(hitTester.closestVertexTo(QPointF(99, 9), 5.0) == VertexRef(1, 0));
+        REQUIRE(hitTester.closestVertexTo(QPointF(50, 5), 5.0) == VertexRef(-1, -1));
+    }
+
+    SECTION("Points far outside the canvas")
+    {
+        REQUIRE(hitTester.curvesCloseTo(QPointF(-1e6, -1e6), 10.0).isEmpty());
+        REQUIRE(hitTester.closestVertexTo(QPointF(1e6, -1e6), 10.0) == VertexRef(-1, -1));
+    }
+}
+
+TEST_CASE("VectorImage hit testing", "[VectorHitTester]")
+{
+    VectorImage image;
+    QList<BezierCurve> curves = randomCurves(300, 1000.0);
+    for (BezierCurve& curve : curves)
+    {
+        image.addCurve(curve, 1.0, false);
+    }
+
+    SECTION("Matches a brute force search")
+    {
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<qreal> coord(0.0, 1000.0);
+        for (int q = 0; q < 200; q++)
+        {
+            const QPointF p(coord(rng), coord(rng));
+
+            QList<VertexRef> expectedVertices;
+            for (int c = 0; c < curves.size(); c++)
+            {
+                for (int v = -1; v < curves[c].getVertexSize(); v++)
+                {
+                    if (QLineF(curves[c].getVertex(v), p).length() < 15.0)
+                        expectedVertices.append(VertexRef(c, v));
+                }
+            }
+            REQUIRE(image.getVerticesCloseTo(p, 15.0) == expectedVertices);
+
+            // every curve found really is that close
+            for (int c : image.getCurvesCloseTo(p, 4.0))
+            {
+                QPointF nearest;
+                qreal t = 0.0;
+                qreal distance = 1e9;
+                for (int i = 0; i < curves[c].getVertexSize(); i++)
+                {
+                    distance = qMin(distance, BezierCurve::findDistance(curves[c], i, p, nearest, t));
+                }
+                REQUIRE(distance < 4.5);
+            }
+        }
+    }
+
+    SECTION("The index follows edits")
+    {
+        const QPointF p = curves[0].getVertex(-1);
+        REQUIRE(image.getVerticesCloseTo(p, 0.5).contains(VertexRef(0, -1)));
+
+        image.removeCurveAt(0);
+        REQUIRE_FALSE(image.getVerticesCloseTo(p, 0.5).contains(VertexRef(0, -1)));
+    }
+
+    SECTION("The selection being moved is tested where it is drawn")
+    {
+        image.setSelected(0, true);
+        image.setSelectionTransformation(QTransform::fromTranslate(5000, 0));
+
+        const QPointF p = curves[0].getVertex(-1);
+        REQUIRE_FALSE(image.getVerticesCloseTo(p, 0.5).contains(VertexRef(0, -1)));
+        REQUIRE(image.getVerticesCloseTo(p + QPointF(5000, 0), 0.5) == QList<VertexRef>({ VertexRef(0, -1) }));
+        REQUIRE(image.getCurvesCloseTo(p + QPointF(5000, 0), 1.0) == QList<int>({ 0 }));
+    }
+}
@@ -6,7 +6,7 @@
 
 ! include( ../util/common.pri ) { error( Could not find the common.pri file! ) }
 
-QT += core widgets gui xml xmlpatterns multimedia svg testlib
+QT += core widgets gui xml xmlpatterns multimedia svg concurrent testlib
 
 TEMPLATE = app
 
@@ -39,11 +39,29 @@ SOURCES += \
     src/main.cpp \
     src/test_colormanager.cpp \
     src/test_layer.cpp \
+    src/test_keyframeselection.cpp \
+    src/test_framerangeset.cpp \
+    src/test_keyframeindex.cpp \
+    src/test_camerapath.cpp \
     src/test_layermanager.cpp \
     src/test_object.cpp \
+    src/test_activeframepool.cpp \
     src/test_filemanager.cpp \
     src/test_bitmapimage.cpp \
-    src/test_viewmanager.cpp
+    src/test_viewmanager.cpp \
+    src/test_bezierintersector.cpp \
+    src/test_beziercurvefitter.cpp \
+    src/test_vectorhittester.cpp \
+    src/test_vectorfillengine.cpp \
+    src/test_brushdabengine.cpp \
+    src/test_frameaccumulator.cpp \
+    src/test_framecompressor.cpp \
+    src/test_smudgeengine.cpp \
+    src/test_strokeinputbuffer.cpp \
+    src/test_bitmapcompositor.cpp \
+    src/test_bitmapshadow.cpp \
+    src/test_cursorcache.cpp \
+    src/test_scribblearea.cpp
 
 # --- core_lib ---
 